@@ -0,0 +1,190 @@
+/**
+ * @author Batto1
+ * @brief  Test of the std::chrono adapters at run time: format_clock() gives the same string as Clock_Format() for all 128 field and zero pad
+ *         combinations, to_clock() and from_clock() agree with the C conversions, the clocks read the C counters and every pair of
+ *         chrono_codegen.cpp returns the same value. Then the cost of now(), duration_cast and to_clock() against the C calls.
+ * @note   Clocks are normalized ones from random durations of every magnitude, and not normalized ones with every field random, like a clock
+ *         someone filled by hand. The instructions of the codegen pairs are compared by chrono_codegen_check.py.
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+#include "time_and_clock_chrono.hpp"
+
+#include "chrono_codegen.h"
+#include "host_test.h"
+
+#define TEST_COMBINATIONS 	128U 		/* CLOCK_FIELD_* and CLOCK_FORMAT_ZERO_PAD */
+#define TEST_CLOCKS 		2000U 		/* per combination */
+#define TEST_CONVERSIONS 	1000000U
+#define TEST_BENCH_CALLS 	20000000U
+
+using namespace time_and_clock;
+
+static bool Clock_Is_Equal(const TimeElapsedClock & a_x, const TimeElapsedClock & a_y)
+{
+	return (a_x.day == a_y.day) && (a_x.hour == a_y.hour) && (a_x.min == a_y.min) && (a_x.sec == a_y.sec) && (a_x.m_sec == a_y.m_sec) &&
+	       (a_x.u_sec == a_y.u_sec);
+}
+
+static uint32_t Combination_Fields(uint32_t a_combination)
+{
+	return (a_combination & CLOCK_FIELD_ALL) | (((a_combination & 0x40U) != 0U) ? CLOCK_FORMAT_ZERO_PAD : 0U);
+}
+
+/**
+ * @brief Random clock: every other one normalized from a non-negative duration, the rest with every field random.
+*/
+static TimeElapsedClock Random_Clock(uint64_t * a_rng, uint32_t a_i)
+{
+	uint64_t r = Random_U64(a_rng);
+	TimeElapsedClock clk{};
+
+	if((a_i % 2U) == 0U){
+		(void)Duration_To_Clock(&clk, (TimeDuration)(r >> (1U + (a_i % 40U))));
+		return clk;
+	}
+	clk.day   = (uint32_t)r;
+	clk.hour  = (uint8_t)(r >> 32);
+	clk.min   = (uint8_t)(r >> 40);
+	clk.sec   = (uint8_t)(r >> 48);
+	clk.m_sec = (uint16_t)Random_U64(a_rng);
+	clk.u_sec = (uint16_t)(r >> 56) | (uint16_t)(Random_U64(a_rng) & 0xFF00U);
+
+	return clk;
+}
+
+static void Test_Format_Clock(void)
+{
+	uint64_t rng = 0x6A09E667F3BCC908ULL;
+	char expected[40];
+
+	for(uint32_t combination = 0; combination < TEST_COMBINATIONS; combination++){
+		uint32_t fields = Combination_Fields(combination);
+
+		for(uint32_t i = 0; i < TEST_CLOCKS; i++){
+			TimeElapsedClock clk = Random_Clock(&rng, i);
+			clock_string str     = format_clock(clk, fields);
+			int expected_len     = Clock_Format(expected, sizeof(expected), &clk, fields);
+
+			HOST_TEST_CHECK((str.size == (size_t)expected_len) && (std::strcmp(str.c_str(), expected) == 0),
+					"fields 0x%02x: format_clock %s (%zu), Clock_Format %s (%d)", fields, str.c_str(), str.size, expected, expected_len);
+		}
+	}
+}
+
+/**
+ * @brief Ticks up to 2^48 (890 years at 10 kHz) and cycles up to 2^62, where duration_cast to micro seconds doesn't overflow.
+*/
+static void Test_Conversions(void)
+{
+	uint64_t rng = 0xBB67AE8584CAA73BULL;
+
+	for(uint32_t i = 0; i < TEST_CONVERSIONS; i++){
+		int64_t ticks = (int64_t)(Random_U64(&rng) >> (16U + (i % 40U))); // all magnitudes
+		TimeElapsedClock expected = Ticks_To_Clock_Time(ticks);
+		TimeElapsedClock clk      = to_clock(uptime_tick_clock::duration(ticks));
+
+		HOST_TEST_CHECK(Clock_Is_Equal(clk, expected), "to_clock of %" PRId64 " ticks", ticks);
+		HOST_TEST_CHECK(from_clock(clk).count() == Clock_To_Duration(&expected), "from_clock of %" PRId64 " ticks", ticks);
+		HOST_TEST_CHECK(to_duration(uptime_tick_clock::duration(ticks)) == Ticks_To_Duration(ticks), "to_duration of %" PRId64 " ticks", ticks);
+#if TIME_AND_CLOCK_CHRONO_HW_CYCLE_CLOCK
+		uint64_t cycles = Random_U64(&rng) >> (2U + (i % 40U));
+		expected = HW_Cycles_To_Clock_Time_64(cycles);
+		clk      = to_clock(hw_cycle_clock::duration((int64_t)cycles));
+		HOST_TEST_CHECK(Clock_Is_Equal(clk, expected), "to_clock of %" PRIu64 " cycles", cycles);
+		HOST_TEST_CHECK(to_duration(hw_cycle_clock::duration((int64_t)cycles)) == HW_Cycles_To_Duration_64(cycles), "to_duration of %" PRIu64 " cycles", cycles);
+#endif
+#if CHRONO_CODEGEN_TICKS_TO_US
+		HOST_TEST_CHECK(Codegen_Wrapper_Ticks_To_Us(ticks) == Codegen_C_Ticks_To_Us(ticks), "codegen pair Ticks_To_Us of %" PRId64, ticks);
+#endif
+	}
+}
+
+/**
+ * @brief Clocks read between two reads of the C counters; the codegen pairs that read them too.
+*/
+static void Test_Now(void)
+{
+	for(uint32_t i = 0; i < 1000U; i++){
+		int64_t before = k_uptime_ticks();
+		int64_t now    = uptime_tick_clock::now().time_since_epoch().count();
+		int64_t pair   = Codegen_Wrapper_Tick_Now();
+		int64_t after  = Codegen_C_Tick_Now();
+
+		HOST_TEST_CHECK((before <= now) && (now <= pair) && (pair <= after), "uptime_tick_clock::now() isn't between k_uptime_ticks() reads");
+#if CHRONO_CODEGEN_TICKS_TO_US
+		int64_t elapsed = Codegen_Wrapper_Elapsed_Us(before);
+		HOST_TEST_CHECK((elapsed >= 0) && (elapsed <= Codegen_C_Elapsed_Us(before)), "codegen pair Elapsed_Us");
+#endif
+#if TIME_AND_CLOCK_CHRONO_HW_CYCLE_CLOCK
+		int64_t cycles_before = (int64_t)Get_Uptime_HW_Cycles_64();
+		int64_t cycles_now    = hw_cycle_clock::now().time_since_epoch().count();
+		int64_t cycles_pair   = Codegen_Wrapper_Cycle_Now();
+		int64_t cycles_after  = Codegen_C_Cycle_Now();
+
+		HOST_TEST_CHECK((cycles_before <= cycles_now) && (cycles_now <= cycles_pair) && (cycles_pair <= cycles_after),
+				"hw_cycle_clock::now() isn't between Get_Uptime_HW_Cycles_64() reads");
+#endif
+	}
+}
+
+/**
+ * @brief ns per call of a_fn(i) over TEST_BENCH_CALLS calls. The input is hidden from the compiler and the results are summed, so that calls
+ * aren't folded into a closed form or dropped.
+*/
+template <class Fn>
+static double Bench_Ns(Fn a_fn, uint64_t * a_sink)
+{
+	uint64_t start = Monotonic_Ns();
+
+	for(uint32_t i = 0; i < TEST_BENCH_CALLS; i++){
+		uint32_t input = i;
+
+		__asm__ __volatile__("" : "+r"(input));
+		* a_sink += (uint64_t)a_fn(input);
+	}
+
+	return (double)(Monotonic_Ns() - start) / TEST_BENCH_CALLS;
+}
+
+static void Print_Pair(const char * a_name, double a_wrapper_ns, const char * a_c_name, double a_c_ns)
+{
+	printf("%-45s %6.2f ns, %-40s %6.2f ns\n", a_name, a_wrapper_ns, a_c_name, a_c_ns);
+}
+
+static void Bench_Wrappers(void)
+{
+	const int64_t step = 1234567; // ticks or cycles between inputs, so that every field changes
+	uint64_t sink = 0;
+
+	Print_Pair("uptime_tick_clock::now()", Bench_Ns([](uint32_t){ return uptime_tick_clock::now().time_since_epoch().count(); }, &sink),
+		   "k_uptime_ticks()", Bench_Ns([](uint32_t){ return k_uptime_ticks(); }, &sink));
+	Print_Pair("duration_cast<microseconds>(ticks)",
+		   Bench_Ns([&](uint32_t a_i){ return std::chrono::duration_cast<std::chrono::microseconds>(uptime_tick_clock::duration(a_i * step)).count(); }, &sink),
+		   "k_ticks_to_us_floor64()", Bench_Ns([&](uint32_t a_i){ return k_ticks_to_us_floor64(a_i * step); }, &sink));
+	Print_Pair("to_clock(ticks)", Bench_Ns([&](uint32_t a_i){ return to_clock(uptime_tick_clock::duration(a_i * step)).sec; }, &sink),
+		   "Ticks_To_Clock_Time()", Bench_Ns([&](uint32_t a_i){ return Ticks_To_Clock_Time(a_i * step).sec; }, &sink));
+#if TIME_AND_CLOCK_CHRONO_HW_CYCLE_CLOCK
+	Print_Pair("hw_cycle_clock::now()", Bench_Ns([](uint32_t){ return hw_cycle_clock::now().time_since_epoch().count(); }, &sink),
+		   "Get_Uptime_HW_Cycles_64()", Bench_Ns([](uint32_t){ return Get_Uptime_HW_Cycles_64(); }, &sink));
+	Print_Pair("duration_cast<microseconds>(cycles)",
+		   Bench_Ns([&](uint32_t a_i){ return std::chrono::duration_cast<std::chrono::microseconds>(hw_cycle_clock::duration(a_i * step)).count(); }, &sink),
+		   "HW_Cycles_To_Duration_64()", Bench_Ns([&](uint32_t a_i){ return HW_Cycles_To_Duration_64((uint64_t)(a_i * step)); }, &sink));
+	Print_Pair("to_clock(cycles)", Bench_Ns([&](uint32_t a_i){ return to_clock(hw_cycle_clock::duration(a_i * step)).sec; }, &sink),
+		   "HW_Cycles_To_Clock_Time_64()", Bench_Ns([&](uint32_t a_i){ return HW_Cycles_To_Clock_Time_64((uint64_t)(a_i * step)).sec; }, &sink));
+#endif
+	printf("(%" PRIu64 ")\n", sink);
+}
+
+int main(void)
+{
+	Test_Format_Clock();
+	Test_Conversions();
+	Test_Now();
+	Bench_Wrappers();
+
+	return HOST_TEST_RESULT();
+}
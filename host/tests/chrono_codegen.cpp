@@ -0,0 +1,64 @@
+/**
+ * @author Batto1
+ * @brief  Pairs of functions for chrono_codegen_check.py: Codegen_Wrapper_<name> does through time_and_clock_chrono.hpp what Codegen_C_<name>
+ *         does with the C API. Built with optimization and without exceptions, every pair must compile to the same instructions.
+ * @note   Only the conversions that are the same operation on both sides are paired: tick to micro second conversion when it's a multiplication.
+ *         duration_cast divides signed reps where the C conversions divide unsigned ones, and to_clock() is a different algorithm than the
+ *         division-free Ticks_To_Clock_Time(); those are compared by the benchmark of chrono_clocks.cpp instead.
+ *         chrono_clocks.cpp also calls every pair and checks that both return the same value.
+*/
+
+#include <chrono>
+#include <cstdint>
+
+#include "time_and_clock_chrono.hpp"
+
+#include "chrono_codegen.h"
+
+using namespace time_and_clock;
+
+int64_t Codegen_Wrapper_Tick_Now(void)
+{
+	return uptime_tick_clock::now().time_since_epoch().count();
+}
+
+int64_t Codegen_C_Tick_Now(void)
+{
+	return k_uptime_ticks();
+}
+
+#if TIME_AND_CLOCK_CHRONO_HW_CYCLE_CLOCK
+int64_t Codegen_Wrapper_Cycle_Now(void)
+{
+	return hw_cycle_clock::now().time_since_epoch().count();
+}
+
+int64_t Codegen_C_Cycle_Now(void)
+{
+	return static_cast<int64_t>(Get_Uptime_HW_Cycles_64());
+}
+#endif
+
+#if CHRONO_CODEGEN_TICKS_TO_US
+int64_t Codegen_Wrapper_Ticks_To_Us(int64_t a_ticks)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(uptime_tick_clock::duration(a_ticks)).count();
+}
+
+int64_t Codegen_C_Ticks_To_Us(int64_t a_ticks)
+{
+	return static_cast<int64_t>(k_ticks_to_us_floor64(a_ticks));
+}
+
+int64_t Codegen_Wrapper_Elapsed_Us(int64_t a_start_ticks)
+{
+	uptime_tick_clock::time_point start{uptime_tick_clock::duration(a_start_ticks)};
+
+	return std::chrono::duration_cast<std::chrono::microseconds>(uptime_tick_clock::now() - start).count();
+}
+
+int64_t Codegen_C_Elapsed_Us(int64_t a_start_ticks)
+{
+	return static_cast<int64_t>(k_ticks_to_us_floor64(k_uptime_ticks() - a_start_ticks));
+}
+#endif
@@ -0,0 +1,35 @@
+/**
+ * @author Batto1
+ * @brief  Function pairs of chrono_codegen.cpp, see there.
+*/
+
+#ifndef CHRONO_CODEGEN_H
+#define CHRONO_CODEGEN_H
+
+#include <cstdint>
+
+#include "time_and_clock_chrono.hpp"
+
+/* tick to micro second conversion is a multiplication */
+#define CHRONO_CODEGEN_TICKS_TO_US 	((1000000 % CONFIG_SYS_CLOCK_TICKS_PER_SEC) == 0)
+
+extern "C" {
+
+int64_t Codegen_Wrapper_Tick_Now(void);
+int64_t Codegen_C_Tick_Now(void);
+
+#if TIME_AND_CLOCK_CHRONO_HW_CYCLE_CLOCK
+int64_t Codegen_Wrapper_Cycle_Now(void);
+int64_t Codegen_C_Cycle_Now(void);
+#endif
+
+#if CHRONO_CODEGEN_TICKS_TO_US
+int64_t Codegen_Wrapper_Ticks_To_Us(int64_t a_ticks);
+int64_t Codegen_C_Ticks_To_Us(int64_t a_ticks);
+int64_t Codegen_Wrapper_Elapsed_Us(int64_t a_start_ticks);
+int64_t Codegen_C_Elapsed_Us(int64_t a_start_ticks);
+#endif
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+#
+# Disassembles the chrono_codegen object (host/tests/chrono_codegen.cpp) and checks that every Codegen_Wrapper_<name> function compiles to the
+# same instructions as its Codegen_C_<name> pair: the std::chrono wrappers cost nothing over the C calls. Addresses are compared relative to
+# the function, calls and jumps out of it by their relocation symbol; alignment padding after the last instruction is ignored.
+#
+#   python3 host/tests/chrono_codegen_check.py objdump build/CMakeFiles/chrono_codegen.dir/tests/chrono_codegen.cpp.o
+
+import re
+import subprocess
+import sys
+
+SKIP = 77  # ctest SKIP_RETURN_CODE
+
+FUNCTION = re.compile(r"^[0-9a-f]+ <(\w+)>:$")
+INSTRUCTION = re.compile(r"^\s*([0-9a-f]+):\t(.*)$")
+RELOCATION = re.compile(r"^\s*[0-9a-f]+: (R_\w+)\t(\S+)$")
+TARGET = re.compile(r"[0-9a-f]+ <(\w+)(\+0x[0-9a-f]+)?>")
+PADDING = ("nop", "xchg   %ax,%ax", "cs nopw", "data16", "int3")
+
+
+def disassemble(objdump, obj):
+    out = subprocess.run([objdump, "-d", "-r", "--no-show-raw-insn", obj], capture_output=True, text=True)
+    if out.returncode != 0:
+        print("objdump failed: " + out.stderr)
+        sys.exit(SKIP)
+
+    functions = {}
+    name = None
+    for line in out.stdout.splitlines():
+        m = FUNCTION.match(line)
+        if m:
+            name = m.group(1)
+            functions[name] = []
+            continue
+        if name is None:
+            continue
+        m = RELOCATION.match(line)
+        if m:
+            functions[name].append("reloc %s %s" % m.groups())
+            continue
+        m = INSTRUCTION.match(line)
+        if m:
+            text = m.group(2).split("#")[0].strip()
+            # branch targets: inside the function by offset, outside by the relocation that follows
+            text = TARGET.sub(lambda t: "<%s>" % (t.group(2) or "+0x0") if t.group(1) == name else "<ext>", text)
+            functions[name].append(text)
+    for name, code in functions.items():
+        while code and code[-1].startswith(PADDING):
+            code.pop()
+    return functions
+
+
+def main():
+    objdump, obj = sys.argv[1], sys.argv[2]
+    functions = disassemble(objdump, obj)
+
+    pairs = sorted(name[len("Codegen_Wrapper_"):] for name in functions if name.startswith("Codegen_Wrapper_"))
+    if not pairs:
+        print("no Codegen_Wrapper_* functions in " + obj)
+        return 1
+
+    failures = 0
+    for pair in pairs:
+        wrapper = functions["Codegen_Wrapper_" + pair]
+        c = functions.get("Codegen_C_" + pair)
+        if c == wrapper:
+            print("%s: same %d instructions" % (pair, len([i for i in c if not i.startswith("reloc")])))
+            continue
+        failures += 1
+        print("%s: wrapper differs from the C call" % pair)
+        print("  wrapper: " + "\n           ".join(wrapper))
+        print("  C:       " + "\n           ".join(c or ["(missing)"]))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,138 @@
+/**
+ * @author Batto1
+ * @brief  Exhaustive day by day round trip of Civil_From_Days() and Days_From_Civil() from 1970-01-01 to 2400-12-31, checked against a
+ *         calendar counted one day at a time and against gmtime_r(); then the throughput of the conversions compared to gmtime_r()/timegm().
+*/
+
+#define _DEFAULT_SOURCE 	/* timegm() */
+
+#include <stdint.h>
+#include <time.h>
+
+#include "wall_clock.h"
+
+#include "host_test.h"
+
+#define TEST_FIRST_YEAR 	1970
+#define TEST_LAST_YEAR 		2400
+#define TEST_BENCH_CALLS 	5000000U
+
+static volatile int64_t bench_sink_i64;
+static volatile uint32_t bench_sink_u32;
+
+static uint32_t Days_In_Month(int32_t a_year, uint32_t a_month)
+{
+	static const uint8_t days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+	uint32_t is_leap = ((a_year % 4) == 0) && (((a_year % 100) != 0) || ((a_year % 400) == 0));
+
+	return days[a_month - 1U] + ((a_month == 2U) ? is_leap : 0U);
+}
+
+/**
+ * @brief Walks every day of the range with a plain calendar, converting each one both ways.
+*/
+static void Test_Every_Day(void)
+{
+	int32_t  year     = TEST_FIRST_YEAR;
+	uint32_t month    = 1;
+	uint32_t day      = 1;
+	uint32_t year_day = 1;
+	int64_t  days     = 0;
+
+	while(year <= TEST_LAST_YEAR){
+		int32_t c_year;
+		uint8_t c_month;
+		uint8_t c_day;
+		CivilDateTime civil;
+
+		Civil_From_Days(days, &c_year, &c_month, &c_day);
+		HOST_TEST_CHECK((c_year == year) && (c_month == month) && (c_day == day), "day %" PRId64 ": %d-%u-%u, expected %d-%u-%u",
+				days, c_year, c_month, c_day, year, month, day);
+		HOST_TEST_CHECK(Days_From_Civil(year, month, day) == days, "%d-%u-%u: %" PRId64 " days, expected %" PRId64,
+				year, month, day, Days_From_Civil(year, month, day), days);
+
+		Wall_Time_To_Civil(&civil, (days * TIME_DURATION_USEC_PER_DAY) + TIME_DURATION_USEC_PER_DAY - 1);
+		HOST_TEST_CHECK(civil.year_day == year_day, "day %" PRId64 ": year day %u, expected %u", days, civil.year_day, year_day);
+		HOST_TEST_CHECK(civil.week_day == (uint8_t)((days + 4) % 7), "day %" PRId64 ": week day %u", days, civil.week_day);
+		HOST_TEST_CHECK((civil.hour == 23) && (civil.min == 59) && (civil.sec == 59) && (civil.m_sec == 999) && (civil.u_sec == 999),
+				"day %" PRId64 ": last micro second of the day", days);
+
+		time_t t = (time_t)days * 86400;
+		struct tm tm;
+		gmtime_r(&t, &tm);
+		HOST_TEST_CHECK((tm.tm_year + 1900 == year) && (tm.tm_mon + 1 == (int)month) && (tm.tm_mday == (int)day) && (tm.tm_yday + 1 == (int)year_day),
+				"day %" PRId64 ": gmtime_r() gives %d-%d-%d", days, tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
+
+		days++;
+		year_day++;
+		if(++day > Days_In_Month(year, month)){
+			day = 1;
+			if(++month > 12U){
+				month    = 1;
+				year_day = 1;
+				year++;
+			}
+		}
+	}
+	printf("round trip: %" PRId64 " days from %d-01-01 to %d-12-31\n", days, TEST_FIRST_YEAR, TEST_LAST_YEAR);
+}
+
+/**
+ * @brief ns per call of each conversion over days spread across the range, next to the C library's gmtime_r() and timegm().
+*/
+static void Bench_Conversions(void)
+{
+	const int64_t range = Days_From_Civil(TEST_LAST_YEAR + 1, 1, 1);
+	int64_t days = 0;
+	uint64_t start;
+
+	start = Monotonic_Ns();
+	for(uint32_t i = 0; i < TEST_BENCH_CALLS; i++){
+		int32_t year;
+		uint8_t month;
+		uint8_t day;
+
+		Civil_From_Days(days, &year, &month, &day);
+		bench_sink_u32 = (uint32_t)year + month + day;
+		days += 7919; 			// prime stride, visits the whole range
+		days -= (days >= range) ? range : 0;
+	}
+	double from_days_ns = (double)(Monotonic_Ns() - start) / TEST_BENCH_CALLS;
+
+	start = Monotonic_Ns();
+	for(uint32_t i = 0; i < TEST_BENCH_CALLS; i++){
+		bench_sink_i64 = Days_From_Civil(TEST_FIRST_YEAR + (int32_t)(i % 431U), 1U + (i % 12U), 1U + (i % 28U));
+	}
+	double to_days_ns = (double)(Monotonic_Ns() - start) / TEST_BENCH_CALLS;
+
+	start = Monotonic_Ns();
+	for(uint32_t i = 0; i < TEST_BENCH_CALLS; i++){
+		time_t t = (time_t)days * 86400;
+		struct tm tm;
+
+		gmtime_r(&t, &tm);
+		bench_sink_u32 = (uint32_t)(tm.tm_year + tm.tm_mon + tm.tm_mday);
+		days += 7919;
+		days -= (days >= range) ? range : 0;
+	}
+	double gmtime_ns = (double)(Monotonic_Ns() - start) / TEST_BENCH_CALLS;
+
+	start = Monotonic_Ns();
+	for(uint32_t i = 0; i < TEST_BENCH_CALLS; i++){
+		struct tm tm = {.tm_year = TEST_FIRST_YEAR - 1900 + (int)(i % 431U), .tm_mon = (int)(i % 12U), .tm_mday = 1 + (int)(i % 28U)};
+
+		bench_sink_i64 = timegm(&tm);
+	}
+	double timegm_ns = (double)(Monotonic_Ns() - start) / TEST_BENCH_CALLS;
+
+	printf("Civil_From_Days %.2f ns/call (%.1f M/s), gmtime_r %.2f ns/call\n", from_days_ns, 1000.0 / from_days_ns, gmtime_ns);
+	printf("Days_From_Civil %.2f ns/call (%.1f M/s), timegm %.2f ns/call\n", to_days_ns, 1000.0 / to_days_ns, timegm_ns);
+}
+
+int main(void)
+{
+	Test_Every_Day();
+	Bench_Conversions();
+
+	return HOST_TEST_RESULT();
+}
@@ -0,0 +1,408 @@
+/**
+ * @author Batto1
+ * @brief  Round trip fuzz test of Clock_Parse() and Duration_Parse() against Clock_Format(), then their throughput in MB/s.
+ * @note   Random clocks are formatted with every CLOCK_FIELD_* combination, with and without CLOCK_FORMAT_ZERO_PAD, and parsed back; the same clock
+ *         is written as a duration literal and must parse to the same duration. Malformed inputs are formatted clocks and literals with random
+ *         bytes replaced, inserted, deleted or cut off: parsing them must fail cleanly or give a value that round trips itself.
+ *         Every input is parsed from a heap buffer of exactly its length, so a read past a_len shows up under -fsanitize=address.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "time_and_clock_utils.h"
+
+#include "host_test.h"
+
+#define TEST_CLOCKS 		20000U 		/* per field combination */
+#define TEST_MUTATIONS 		2000000U
+#define TEST_BENCH_STRINGS 	4096U
+#define TEST_BENCH_ROUNDS 	500U
+
+static const char test_alphabet[] = "0123456789[]:.,-wdhmsu x";
+static volatile uint32_t bench_sink_u32;
+
+/**
+ * @brief Random normalized clock; every field is often at its minimum or maximum.
+*/
+static TimeElapsedClock Random_Clock(uint64_t * a_rng)
+{
+	TimeElapsedClock clk;
+	uint64_t r = Random_U64(a_rng);
+
+	switch(r % 4U){
+	case 0:  clk.day = 0; break;
+	case 1:  clk.day = UINT32_MAX; break;
+	case 2:  clk.day = (uint32_t)(Random_U64(a_rng) % 1000U); break;
+	default: clk.day = (uint32_t)Random_U64(a_rng); break;
+	}
+	clk.hour  = (uint8_t)(((r >> 8) & 1U) ? 23U : (Random_U64(a_rng) % 24U));
+	clk.min   = (uint8_t)(((r >> 9) & 1U) ? 0U : (Random_U64(a_rng) % 60U));
+	clk.sec   = (uint8_t)(((r >> 10) & 1U) ? 59U : (Random_U64(a_rng) % 60U));
+	clk.m_sec = (uint16_t)(((r >> 11) & 1U) ? 999U : (Random_U64(a_rng) % 1000U));
+	clk.u_sec = (uint16_t)(((r >> 12) & 1U) ? 0U : (Random_U64(a_rng) % 1000U));
+
+	return clk;
+}
+
+/**
+ * @brief Clock with the fields that aren't in a_fields set to 0, like Clock_Parse() leaves them.
+*/
+static TimeElapsedClock Mask_Clock(const TimeElapsedClock * a_clk, uint32_t a_fields)
+{
+	TimeElapsedClock clk = {0};
+
+	clk.day   = (a_fields & CLOCK_FIELD_DAY)  ? a_clk->day   : 0U;
+	clk.hour  = (a_fields & CLOCK_FIELD_HOUR) ? a_clk->hour  : 0U;
+	clk.min   = (a_fields & CLOCK_FIELD_MIN)  ? a_clk->min   : 0U;
+	clk.sec   = (a_fields & CLOCK_FIELD_SEC)  ? a_clk->sec   : 0U;
+	clk.m_sec = (a_fields & CLOCK_FIELD_MSEC) ? a_clk->m_sec : 0U;
+	clk.u_sec = (a_fields & CLOCK_FIELD_USEC) ? a_clk->u_sec : 0U;
+
+	return clk;
+}
+
+static int Clock_Equal(const TimeElapsedClock * a_a, const TimeElapsedClock * a_b)
+{
+	return (a_a->day == a_b->day) && (a_a->hour == a_b->hour) && (a_a->min == a_b->min) && (a_a->sec == a_b->sec)
+	    && (a_a->m_sec == a_b->m_sec) && (a_a->u_sec == a_b->u_sec);
+}
+
+/**
+ * @brief Writes the fields of a clock as a duration literal i.e. "1d2h3m4s5ms6us"; seconds with their fraction ("4.005006s") if a_fraction.
+ * @return length of the literal.
+*/
+static int Format_Duration_Literal(char * a_buf, size_t a_buf_size, const TimeElapsedClock * a_clk, uint32_t a_fields, int a_fraction)
+{
+	int len = 0;
+
+	if(0U == (a_fields & CLOCK_FIELD_ALL)){
+		return snprintf(a_buf, a_buf_size, "0s");
+	}
+	if(a_fields & CLOCK_FIELD_DAY){
+		len += snprintf(&a_buf[len], a_buf_size - (size_t)len, "%ud", a_clk->day);
+	}
+	if(a_fields & CLOCK_FIELD_HOUR){
+		len += snprintf(&a_buf[len], a_buf_size - (size_t)len, "%uh", a_clk->hour);
+	}
+	if(a_fields & CLOCK_FIELD_MIN){
+		len += snprintf(&a_buf[len], a_buf_size - (size_t)len, "%um", a_clk->min);
+	}
+	if(a_fraction && (a_fields & CLOCK_FIELD_SEC)){
+		uint32_t m_sec = (a_fields & CLOCK_FIELD_MSEC) ? a_clk->m_sec : 0U;
+		uint32_t u_sec = (a_fields & CLOCK_FIELD_USEC) ? a_clk->u_sec : 0U;
+
+		return len + snprintf(&a_buf[len], a_buf_size - (size_t)len, "%u.%03u%03us", a_clk->sec, m_sec, u_sec);
+	}
+	if(a_fields & CLOCK_FIELD_SEC){
+		len += snprintf(&a_buf[len], a_buf_size - (size_t)len, "%us", a_clk->sec);
+	}
+	if(a_fields & CLOCK_FIELD_MSEC){
+		len += snprintf(&a_buf[len], a_buf_size - (size_t)len, "%ums", a_clk->m_sec);
+	}
+	if(a_fields & CLOCK_FIELD_USEC){
+		len += snprintf(&a_buf[len], a_buf_size - (size_t)len, "%uus", a_clk->u_sec);
+	}
+
+	return len;
+}
+
+/**
+ * @brief Copies the input to a heap buffer of exactly its length, so reading past it is caught by the address sanitizer.
+*/
+static TimeAndClockErrors Parse_Clock_Exact(TimeElapsedClock * a_clk, const char * a_str, size_t a_len, uint32_t a_fields, size_t * a_end)
+{
+	char * exact = malloc(a_len + 1U); // malloc(0) may return NULL
+	memcpy(exact, a_str, a_len);
+	TimeAndClockErrors err = Clock_Parse(a_clk, exact, a_len, a_fields, a_end);
+	free(exact);
+
+	return err;
+}
+
+static TimeAndClockErrors Parse_Duration_Exact(TimeDuration * a_duration, const char * a_str, size_t a_len, size_t * a_end)
+{
+	char * exact = malloc(a_len + 1U);
+	memcpy(exact, a_str, a_len);
+	TimeAndClockErrors err = Duration_Parse(a_duration, exact, a_len, a_end);
+	free(exact);
+
+	return err;
+}
+
+/**
+ * @brief Every field combination, padded and unpadded: clock string, legend and duration literal round trips.
+*/
+static void Test_Round_Trip(void)
+{
+	uint64_t rng = 0x9E3779B97F4A7C15ULL;
+	uint32_t checked = 0;
+
+	for(uint32_t flags = 0; flags <= (CLOCK_FIELD_ALL | CLOCK_FORMAT_ZERO_PAD); flags++){
+		uint32_t fields = flags & CLOCK_FIELD_ALL;
+		char legend[CLOCK_LEGEND_MAX_STRING_SIZE];
+		uint32_t parsed_fields = 0;
+		size_t end = 0;
+
+		int legend_len = Clock_Legend_Format(legend, sizeof(legend), fields);
+		HOST_TEST_CHECK((Clock_Legend_Parse(&parsed_fields, legend, (size_t)legend_len, &end) == TIME_UTIL_ERROR_NONE)
+				&& (parsed_fields == fields) && (end == (size_t)legend_len), "legend \"%s\"", legend);
+
+		for(uint32_t i = 0; i < TEST_CLOCKS; i++){
+			TimeElapsedClock clk      = Random_Clock(&rng);
+			TimeElapsedClock expected = Mask_Clock(&clk, fields);
+			TimeElapsedClock parsed;
+			TimeDuration duration;
+			char buf[CLOCK_MAX_STRING_SIZE + 8];
+
+			int len = Clock_Format(buf, sizeof(buf), &clk, flags);
+			HOST_TEST_CHECK((len > 0) && ((size_t)len < CLOCK_MAX_STRING_SIZE), "length %d", len);
+
+			memcpy(&buf[len], "]x:1", 5); // text after the clock isn't read
+			TimeAndClockErrors err = Parse_Clock_Exact(&parsed, buf, (size_t)len + 4U, fields, &end);
+			HOST_TEST_CHECK((err == TIME_UTIL_ERROR_NONE) && (end == (size_t)len) && Clock_Equal(&parsed, &expected),
+					"flags 0x%02x: \"%.*s\" gives error %d at %zu", flags, len, buf, err, end);
+
+			// days above 106751991 don't fit in TimeDuration, the literal must be rejected then.
+			unsigned __int128 micros = ((unsigned __int128)expected.day * (uint64_t)TIME_DURATION_USEC_PER_DAY)
+						 + (uint64_t)Clock_To_Duration(&(TimeElapsedClock){.hour = expected.hour, .min = expected.min,
+							.sec = expected.sec, .m_sec = expected.m_sec, .u_sec = expected.u_sec});
+			int lit_len = Format_Duration_Literal(buf, sizeof(buf), &clk, fields, (int)(i & 1U));
+			err = Parse_Duration_Exact(&duration, buf, (size_t)lit_len, &end);
+			if(micros > (unsigned __int128)INT64_MAX){
+				HOST_TEST_CHECK((err == TIME_UTIL_ERROR_RANGE) && (end == 0U), "\"%.*s\" overflows, gives error %d at %zu", lit_len, buf, err, end);
+				checked++;
+				continue;
+			}
+			HOST_TEST_CHECK((err == TIME_UTIL_ERROR_NONE) && (end == (size_t)lit_len) && (duration == (TimeDuration)micros),
+					"\"%.*s\" gives error %d, %" PRId64 " us, expected %" PRId64, lit_len, buf, err, duration, (TimeDuration)micros);
+
+			buf[lit_len] = '-'; // negative, from a buffer that starts one byte before
+			memmove(&buf[1], buf, (size_t)lit_len);
+			buf[0] = '-';
+			err = Parse_Duration_Exact(&duration, buf, (size_t)lit_len + 1U, &end);
+			HOST_TEST_CHECK((err == TIME_UTIL_ERROR_NONE) && (duration == -(TimeDuration)micros), "\"%.*s\"", lit_len + 1, buf);
+			checked++;
+		}
+	}
+	printf("round trip: %u clocks over %u field and padding combinations\n", checked, (CLOCK_FIELD_ALL | CLOCK_FORMAT_ZERO_PAD) + 1U);
+}
+
+/**
+ * @brief Values out of range and prefixes of valid strings.
+*/
+static void Test_Rejects(void)
+{
+	static const struct{
+		const char * 		str;
+		TimeAndClockErrors 	err;
+		size_t 			end;
+	}clock_cases[] = {
+		{ "[0:24:00:00.000,000]",  TIME_UTIL_ERROR_RANGE,  3 },
+		{ "[0:23:60:00.000,000]",  TIME_UTIL_ERROR_RANGE,  6 },
+		{ "[0:23:59:60.000,000]",  TIME_UTIL_ERROR_RANGE,  9 },
+		{ "[0:23:59:59.1000,000]", TIME_UTIL_ERROR_RANGE,  12 },
+		{ "[0:23:59:59.999,1000]", TIME_UTIL_ERROR_RANGE,  16 },
+		{ "[4294967296:0:0:0.0,0]", TIME_UTIL_ERROR_RANGE, 1 },
+		{ "[00000000001:0:0:0.0,0]", TIME_UTIL_ERROR_RANGE, 1 },
+		{ "[0:0:0:0,0]",           TIME_UTIL_ERROR_SYNTAX, 8 },
+		{ "[0:0:0:0.0,0",          TIME_UTIL_ERROR_SYNTAX, 12 },
+		{ "0:0:0:0.0,0]",          TIME_UTIL_ERROR_SYNTAX, 0 },
+		{ "[0:0::0.0,0]",          TIME_UTIL_ERROR_SYNTAX, 5 },
+		{ "[0:-1:0:0.0,0]",        TIME_UTIL_ERROR_SYNTAX, 3 },
+	};
+	static const char * duration_cases[] = {
+		"", "-", "s", "1", "1.s", "1.5", "1x", "1s1s", "1s1m", "1ms1s", "1.5us", "0.0000001s", "--1s",
+		"9223372036854775808us", "106751991168d", "15250284453w", "1.2.3s",
+	};
+
+	for(size_t i = 0; i < sizeof(clock_cases) / sizeof(clock_cases[0]); i++){
+		TimeElapsedClock clk = {.day = 7};
+		size_t end = 0;
+		TimeAndClockErrors err = Parse_Clock_Exact(&clk, clock_cases[i].str, strlen(clock_cases[i].str), CLOCK_FIELD_ALL, &end);
+
+		HOST_TEST_CHECK((err == clock_cases[i].err) && (end == clock_cases[i].end), "\"%s\" gives error %d at %zu, expected %d at %zu",
+				clock_cases[i].str, err, end, clock_cases[i].err, clock_cases[i].end);
+		HOST_TEST_CHECK(clk.day == 7U, "\"%s\" modified the clock", clock_cases[i].str);
+	}
+
+	for(size_t i = 0; i < sizeof(duration_cases) / sizeof(duration_cases[0]); i++){
+		TimeDuration duration = 7;
+		size_t end = 0;
+		TimeAndClockErrors err = Parse_Duration_Exact(&duration, duration_cases[i], strlen(duration_cases[i]), &end);
+
+		HOST_TEST_CHECK((err != TIME_UTIL_ERROR_NONE) || (end < strlen(duration_cases[i])), "\"%s\" accepted", duration_cases[i]);
+		HOST_TEST_CHECK((err != TIME_UTIL_ERROR_NONE) || (duration != 7), "\"%s\" gave no value", duration_cases[i]);
+		HOST_TEST_CHECK((err == TIME_UTIL_ERROR_NONE) || (duration == 7), "\"%s\" modified the duration", duration_cases[i]);
+	}
+
+	// every proper prefix of a clock string is incomplete.
+	char buf[CLOCK_MAX_STRING_SIZE];
+	TimeElapsedClock clk = {.day = 123, .hour = 4, .min = 5, .sec = 6, .m_sec = 7, .u_sec = 8};
+	int len = Clock_Format(buf, sizeof(buf), &clk, CLOCK_FIELD_ALL | CLOCK_FORMAT_ZERO_PAD);
+	for(int cut = 0; cut < len; cut++){
+		TimeElapsedClock parsed;
+		HOST_TEST_CHECK(Parse_Clock_Exact(&parsed, buf, (size_t)cut, CLOCK_FIELD_ALL, NULL) == TIME_UTIL_ERROR_SYNTAX, "prefix of %d", cut);
+	}
+}
+
+/**
+ * @brief Replaces, inserts or deletes up to 3 bytes, or cuts the string short.
+*/
+static size_t Mutate(char * a_buf, size_t a_len, size_t a_buf_size, uint64_t * a_rng)
+{
+	uint32_t edits = 1U + (uint32_t)(Random_U64(a_rng) % 3U);
+
+	for(uint32_t e = 0; e < edits; e++){
+		uint64_t r   = Random_U64(a_rng);
+		size_t   pos = (a_len == 0U) ? 0U : (size_t)((r >> 8) % a_len);
+		char     c   = ((r >> 40) & 1U) ? test_alphabet[(r >> 16) % (sizeof(test_alphabet) - 1U)] : (char)(r >> 24);
+
+		switch(r % 4U){
+		case 0:
+			if(a_len > 0U){
+				a_buf[pos] = c;
+			}
+			break;
+		case 1:
+			if(a_len < a_buf_size){
+				memmove(&a_buf[pos + 1U], &a_buf[pos], a_len - pos);
+				a_buf[pos] = c;
+				a_len++;
+			}
+			break;
+		case 2:
+			if(a_len > 0U){
+				memmove(&a_buf[pos], &a_buf[pos + 1U], a_len - pos - 1U);
+				a_len--;
+			}
+			break;
+		default:
+			a_len = pos;
+			break;
+		}
+	}
+
+	return a_len;
+}
+
+/**
+ * @brief Malformed inputs must be rejected without touching the output, or parse to a value that formats and parses back to itself.
+*/
+static void Test_Malformed(void)
+{
+	uint64_t rng = 0x0123456789ABCDEFULL;
+	uint32_t clock_accepted = 0;
+	uint32_t duration_accepted = 0;
+
+	for(uint32_t i = 0; i < TEST_MUTATIONS; i++){
+		uint32_t flags  = (uint32_t)(Random_U64(&rng) % ((CLOCK_FIELD_ALL | CLOCK_FORMAT_ZERO_PAD) + 1U));
+		uint32_t fields = flags & CLOCK_FIELD_ALL;
+		TimeElapsedClock clk = Random_Clock(&rng);
+		char buf[64];
+		size_t end = SIZE_MAX;
+		size_t len;
+
+		if((i & 1U) == 0U){
+			TimeElapsedClock parsed = {.day = 7};
+			TimeElapsedClock again;
+
+			len = Mutate(buf, (size_t)Clock_Format(buf, sizeof(buf), &clk, flags), sizeof(buf), &rng);
+			TimeAndClockErrors err = Parse_Clock_Exact(&parsed, buf, len, fields, &end);
+			HOST_TEST_CHECK(end <= len, "end %zu past length %zu", end, len);
+			if(err != TIME_UTIL_ERROR_NONE){
+				HOST_TEST_CHECK((err == TIME_UTIL_ERROR_SYNTAX) || (err == TIME_UTIL_ERROR_RANGE), "error %d", err);
+				HOST_TEST_CHECK(parsed.day == 7U, "\"%.*s\" rejected but modified the clock", (int)len, buf);
+				continue;
+			}
+			clock_accepted++;
+			int again_len = Clock_Format(buf, sizeof(buf), &parsed, flags);
+			HOST_TEST_CHECK((Parse_Clock_Exact(&again, buf, (size_t)again_len, fields, NULL) == TIME_UTIL_ERROR_NONE)
+					&& Clock_Equal(&again, &parsed), "accepted \"%.*s\" doesn't round trip", again_len, buf);
+		}else{
+			TimeDuration duration = 7;
+			TimeDuration again;
+			size_t again_end;
+
+			len = Mutate(buf, (size_t)Format_Duration_Literal(buf, sizeof(buf), &clk, fields, (int)((i >> 1) & 1U)), sizeof(buf), &rng);
+			TimeAndClockErrors err = Parse_Duration_Exact(&duration, buf, len, &end);
+			HOST_TEST_CHECK(end <= len, "end %zu past length %zu", end, len);
+			if(err != TIME_UTIL_ERROR_NONE){
+				HOST_TEST_CHECK((err == TIME_UTIL_ERROR_SYNTAX) || (err == TIME_UTIL_ERROR_RANGE), "error %d", err);
+				HOST_TEST_CHECK(duration == 7, "\"%.*s\" rejected but modified the duration", (int)len, buf);
+				continue;
+			}
+			duration_accepted++;
+			// parsing only the accepted part gives the same duration.
+			HOST_TEST_CHECK((Parse_Duration_Exact(&again, buf, end, &again_end) == TIME_UTIL_ERROR_NONE) && (again == duration) && (again_end == end),
+					"\"%.*s\" doesn't parse the same without its tail", (int)len, buf);
+		}
+	}
+	printf("malformed: %u inputs, %u clocks and %u literals still valid after mutation\n", TEST_MUTATIONS, clock_accepted, duration_accepted);
+}
+
+/**
+ * @brief MB/s of formatting and parsing clock strings and of parsing duration literals, over random clocks with every field.
+*/
+static void Bench_Throughput(void)
+{
+	static char clocks[TEST_BENCH_STRINGS][CLOCK_MAX_STRING_SIZE];
+	static char literals[TEST_BENCH_STRINGS][48];
+	static TimeElapsedClock values[TEST_BENCH_STRINGS];
+	static uint8_t clock_lens[TEST_BENCH_STRINGS];
+	static uint8_t literal_lens[TEST_BENCH_STRINGS];
+	uint64_t rng = 0xDEADBEEFCAFEF00DULL;
+	uint64_t clock_bytes = 0;
+	uint64_t literal_bytes = 0;
+
+	for(uint32_t i = 0; i < TEST_BENCH_STRINGS; i++){
+		values[i]       = Random_Clock(&rng);
+		clock_lens[i]   = (uint8_t)Clock_Format(clocks[i], sizeof(clocks[i]), &values[i], CLOCK_FIELD_ALL | CLOCK_FORMAT_ZERO_PAD);
+		literal_lens[i] = (uint8_t)Format_Duration_Literal(literals[i], sizeof(literals[i]), &values[i], CLOCK_FIELD_ALL, 0);
+		clock_bytes    += clock_lens[i];
+		literal_bytes  += literal_lens[i];
+	}
+
+	uint64_t start = Monotonic_Ns();
+	for(uint32_t round = 0; round < TEST_BENCH_ROUNDS; round++){
+		for(uint32_t i = 0; i < TEST_BENCH_STRINGS; i++){
+			bench_sink_u32 = (uint32_t)Clock_Format(clocks[i], sizeof(clocks[i]), &values[i], CLOCK_FIELD_ALL | CLOCK_FORMAT_ZERO_PAD);
+		}
+	}
+	double format_ns = (double)(Monotonic_Ns() - start);
+
+	start = Monotonic_Ns();
+	for(uint32_t round = 0; round < TEST_BENCH_ROUNDS; round++){
+		for(uint32_t i = 0; i < TEST_BENCH_STRINGS; i++){
+			TimeElapsedClock clk;
+			bench_sink_u32 = (uint32_t)Clock_Parse(&clk, clocks[i], clock_lens[i], CLOCK_FIELD_ALL, NULL) + clk.u_sec;
+		}
+	}
+	double clock_ns = (double)(Monotonic_Ns() - start);
+
+	start = Monotonic_Ns();
+	for(uint32_t round = 0; round < TEST_BENCH_ROUNDS; round++){
+		for(uint32_t i = 0; i < TEST_BENCH_STRINGS; i++){
+			TimeDuration duration;
+			bench_sink_u32 = (uint32_t)Duration_Parse(&duration, literals[i], literal_lens[i], NULL) + (uint32_t)duration;
+		}
+	}
+	double duration_ns = (double)(Monotonic_Ns() - start);
+
+	// bytes per ns * 1000 = MB/s
+	printf("Clock_Format %.0f MB/s, Clock_Parse %.0f MB/s (%.1f ns per string), Duration_Parse %.0f MB/s (%.1f ns per literal)\n",
+	       (double)(clock_bytes * TEST_BENCH_ROUNDS) * 1000.0 / format_ns,
+	       (double)(clock_bytes * TEST_BENCH_ROUNDS) * 1000.0 / clock_ns, clock_ns / (TEST_BENCH_STRINGS * TEST_BENCH_ROUNDS),
+	       (double)(literal_bytes * TEST_BENCH_ROUNDS) * 1000.0 / duration_ns, duration_ns / (TEST_BENCH_STRINGS * TEST_BENCH_ROUNDS));
+}
+
+int main(void)
+{
+	Test_Round_Trip();
+	Test_Rejects();
+	Test_Malformed();
+	Bench_Throughput();
+
+	return HOST_TEST_RESULT();
+}
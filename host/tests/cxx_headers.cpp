@@ -0,0 +1,37 @@
+/**
+ * @author Batto1
+ * @brief  Every header of the library included from a C++17 translation unit, with a few calls through the C++ linkage.
+*/
+
+#include "time_and_clock_utils.h"
+#include "time_and_clock_chrono.hpp"
+#include "cycle_counter_64.h"
+#include "user_timebase.h"
+#include "stopwatch.h"
+#include "latency_histogram.h"
+#include "span_tracer.h"
+#include "log_clock_timestamp.h"
+#include "software_clock.h"
+#include "wall_clock.h"
+#include "thread_usage.h"
+#include "timestamp_codec.h"
+#include "timer_wheel.h"
+
+#include "host_test.h"
+
+int main(void)
+{
+	TimerWheel wheel;
+	LatencyHistogram hist = {};
+
+	Timer_Wheel_Init(&wheel, 0);
+	HOST_TEST_CHECK(Timer_Wheel_Next_Event(&wheel) == TIMER_WHEEL_NO_EVENT, "empty wheel has an event");
+
+	Latency_Histogram_Record_Cycles(&hist, 1000U);
+	HOST_TEST_CHECK(hist.counts[Latency_Histogram_Bucket_Index(1000U)] == 1, "value not counted");
+
+	TimeElapsedClock clock = time_and_clock::to_clock(std::chrono::seconds(90061));
+	HOST_TEST_CHECK(Clock_To_Duration(&clock) == 90061 * TIME_DURATION_USEC_PER_SEC, "to_clock() differs from Clock_To_Duration()");
+
+	return HOST_TEST_RESULT();
+}
@@ -0,0 +1,130 @@
+/**
+ * @author Batto1
+ * @brief  HW cycle conversions against the exact floor of k_cyc_to_us_floor64(), the calibrated Cycle_Conversion_* bound, and concurrent
+ *         Cycle_Conversion_Set_Frequency() / Cycle_Conversion_Set_Correction() calls not undoing each other.
+*/
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "time_and_clock_utils.h"
+
+#include "host_test.h"
+
+#define TEST_CONVERSIONS 	2000000U
+#define TEST_UPDATES 		200000U
+
+static CycleConversion shared_conv;
+static volatile int updaters_done;
+
+/**
+ * @brief HW_Cycles_To_* give exactly k_cyc_to_*_floor64(); whole seconds of cycles give whole seconds.
+*/
+static void Test_Default_Is_Exact(void)
+{
+	const uint64_t rate = (uint64_t)sys_clock_hw_cycles_per_sec();
+	uint64_t rng = 0x9E3779B97F4A7C15ULL;
+
+	for(uint32_t i = 0; i < TEST_CONVERSIONS; i++){
+		uint64_t secs   = Random_U64(&rng) % (100ULL * 365U * 24U * 3600U);
+		uint64_t cycles = ((i & 1U) == 0U) ? (secs * rate) : (Random_U64(&rng) % (secs * rate + 1U));
+
+		HOST_TEST_CHECK(((i & 1U) != 0U) || (HW_Cycles_To_Seconds_64(cycles) == secs), "%" PRIu64 " s of cycles gives %" PRIu64 " s",
+				secs, HW_Cycles_To_Seconds_64(cycles));
+		HOST_TEST_CHECK((uint64_t)HW_Cycles_To_Duration_64(cycles) == k_cyc_to_us_floor64(cycles), "%" PRIu64 " cycles: %" PRId64 " us, expected %" PRIu64,
+				cycles, HW_Cycles_To_Duration_64(cycles), k_cyc_to_us_floor64(cycles));
+		HOST_TEST_CHECK(HW_Cycles_To_Milliseconds_64(cycles) == k_cyc_to_ms_floor64(cycles), "%" PRIu64 " cycles: ms", cycles);
+		HOST_TEST_CHECK(HW_Cycles_To_Milliseconds_32((uint32_t)cycles) == k_cyc_to_ms_floor32((uint32_t)cycles), "%" PRIu64 " cycles: ms 32", cycles);
+	}
+}
+
+/**
+ * @brief Calibrated conversion without correction: the exact floor or 1 micro second less, at several rates.
+*/
+static void Test_Calibrated_Bound(void)
+{
+	static const uint32_t rates[] = {32768U, 1000000U, 19200000U, 64000000U, 168000000U, 1000000000U, 3579545U, UINT32_MAX};
+	uint64_t rng = 0x0123456789ABCDEFULL;
+	uint32_t below = 0;
+
+	for(size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++){
+		CycleConversion conv;
+
+		Cycle_Conversion_Init(&conv, rates[r], 0);
+		for(uint32_t i = 0; i < TEST_CONVERSIONS / 8U; i++){
+			uint64_t counts = Random_U64(&rng) >> (Random_U64(&rng) % 40U);
+			uint64_t exact  = (uint64_t)(((unsigned __int128)counts * 1000000U) / rates[r]);
+			uint64_t value  = Cycle_Conversion_To_Micro_Sec(&conv, counts);
+
+			if(exact > (uint64_t)INT64_MAX){
+				continue;
+			}
+			HOST_TEST_CHECK((value == exact) || (value + 1U == exact), "%u Hz, %" PRIu64 " counts: %" PRIu64 " us, exact %" PRIu64,
+					rates[r], counts, value, exact);
+			below += (value != exact);
+		}
+	}
+	printf("calibrated: %u of %u conversions 1 us below the exact floor\n", below, TEST_CONVERSIONS);
+}
+
+/**
+ * @brief Sets increasing rates while the other updater sets increasing corrections.
+*/
+static void * Rate_Updater(void * a_arg)
+{
+	(void)a_arg;
+	for(uint32_t i = 1; i <= TEST_UPDATES; i++){
+		Cycle_Conversion_Set_Frequency(&shared_conv, 1000000U + i);
+	}
+
+	return NULL;
+}
+
+static void * Correction_Updater(void * a_arg)
+{
+	(void)a_arg;
+	for(uint32_t i = 1; i <= TEST_UPDATES; i++){
+		Cycle_Conversion_Set_Correction(&shared_conv, (int32_t)i);
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Neither value may go back: that would be an update published with a stale copy of the other value.
+*/
+static void Test_Concurrent_Updates(void)
+{
+	pthread_t rate_thread;
+	pthread_t correction_thread;
+	uint32_t last_rate = 0;
+	int32_t last_correction = 0;
+
+	Cycle_Conversion_Init(&shared_conv, 1000000U, 0);
+	pthread_create(&rate_thread, NULL, Rate_Updater, NULL);
+	pthread_create(&correction_thread, NULL, Correction_Updater, NULL);
+
+	for(uint32_t i = 0; i < 20U * TEST_UPDATES; i++){
+		uint32_t rate       = __atomic_load_n(&shared_conv.counts_per_sec, __ATOMIC_RELAXED);
+		int32_t  correction = __atomic_load_n(&shared_conv.correction_ppb, __ATOMIC_RELAXED);
+
+		HOST_TEST_CHECK(rate >= last_rate, "rate went back from %u to %u", last_rate, rate);
+		HOST_TEST_CHECK(correction >= last_correction, "correction went back from %d to %d", last_correction, correction);
+		last_rate       = rate;
+		last_correction = correction;
+	}
+	pthread_join(rate_thread, NULL);
+	pthread_join(correction_thread, NULL);
+
+	HOST_TEST_CHECK(shared_conv.counts_per_sec == 1000000U + TEST_UPDATES, "final rate %u", shared_conv.counts_per_sec);
+	HOST_TEST_CHECK(shared_conv.correction_ppb == (int32_t)TEST_UPDATES, "final correction %d", shared_conv.correction_ppb);
+}
+
+int main(void)
+{
+	Test_Default_Is_Exact();
+	Test_Calibrated_Bound();
+	Test_Concurrent_Updates();
+
+	return HOST_TEST_RESULT();
+}
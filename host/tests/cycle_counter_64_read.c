@@ -0,0 +1,56 @@
+/**
+ * @author Batto1
+ * @brief  Read cost of the software extended 64 bit cycle counter on the backend's real 32 bit counter, next to the backend's native
+ *         k_cycle_get_64() and k_cycle_get_32().
+ * @note   Built apart from cycle_counter_64_wrap.c, which replaces the 32 bit counter with a fake one for its whole translation unit.
+*/
+
+#include <stdint.h>
+
+#include "cycle_counter_64.h"
+
+#include "host_test.h"
+
+int Bench_Read_Real_Counter(uint32_t a_reads);
+
+/**
+ * @brief Times a_reads calls of each read. The state is set from the native 64 bit counter first, so that both read the same value.
+ * @retval number of failed checks: extended reads must be between the native reads around them.
+*/
+int Bench_Read_Real_Counter(uint32_t a_reads)
+{
+	volatile uint64_t sink = 0;
+
+	cycle_counter_64_half_periods = (atomic_t)(uint32_t)(k_cycle_get_64() >> 31);
+	for(uint32_t i = 0; i < 100000U; i++){
+		uint64_t before = k_cycle_get_64();
+		uint64_t value  = Cycle_Counter_64_Get();
+		uint64_t after  = k_cycle_get_64();
+
+		HOST_TEST_CHECK((value >= before) && (value <= after), "read %" PRIu64 " outside [%" PRIu64 ", %" PRIu64 "]", value, before, after);
+	}
+
+	uint64_t start = Monotonic_Ns();
+	for(uint32_t i = 0; i < a_reads; i++){
+		sink = k_cycle_get_64();
+	}
+	uint64_t native_64_ns = Monotonic_Ns() - start;
+
+	start = Monotonic_Ns();
+	for(uint32_t i = 0; i < a_reads; i++){
+		sink = k_cycle_get_32();
+	}
+	uint64_t native_32_ns = Monotonic_Ns() - start;
+
+	start = Monotonic_Ns();
+	for(uint32_t i = 0; i < a_reads; i++){
+		sink = Cycle_Counter_64_Get();
+	}
+	uint64_t extended_ns = Monotonic_Ns() - start;
+	(void)sink;
+
+	printf("read on the real counter: k_cycle_get_64() %.2f ns, k_cycle_get_32() %.2f ns, Cycle_Counter_64_Get() %.2f ns\n",
+	       (double)native_64_ns / a_reads, (double)native_32_ns / a_reads, (double)extended_ns / a_reads);
+
+	return host_test_failures;
+}
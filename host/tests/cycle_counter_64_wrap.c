@@ -0,0 +1,143 @@
+/**
+ * @author Batto1
+ * @brief  Wrap stress test of the software extended 64 bit cycle counter on a fake 32 bit counter. Then the cost of an extended read on the
+ *         backend's real counter against its native 64 bit read, see cycle_counter_64_read.c.
+ * @note   The fake counter is the low 32 bits of a 64 bit true count. It starts just below 2^32 and is advanced by random steps; the state is
+ *         refreshed only just before 2^31 cycles pass (delayed refresh). Every extended read must equal the true count at the time of the read.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+static uint64_t fake_count;
+
+#define CYCLE_COUNTER_64_READ_32() 	((uint32_t)__atomic_load_n(&fake_count, __ATOMIC_SEQ_CST))
+
+#include "cycle_counter_64.h"
+
+#include "host_test.h"
+
+#define TEST_START_COUNT 	(BIT64(32) - 1000U)
+#define TEST_REFRESH_LIMIT 	(BIT64(31) - 1U) 	/* longest gap between two state updates */
+#define TEST_STEPS 		4000000U
+#define TEST_READERS 		3
+#define TEST_BENCH_READS 	20000000U
+
+/* cycle_counter_64_read.c, on the real 32 bit counter */
+int Bench_Read_Real_Counter(uint32_t a_reads);
+
+static volatile int writer_done;
+static uint64_t reader_reads[TEST_READERS];
+
+/**
+ * @brief Single thread: random steps up to the refresh limit, a read after each; and reads right at both sides of every half period boundary.
+*/
+static void Test_Single_Thread(void)
+{
+	uint64_t rng = 0x9E3779B97F4A7C15ULL;
+
+	fake_count = TEST_START_COUNT;
+	cycle_counter_64_half_periods = 0;
+	HOST_TEST_CHECK(Cycle_Counter_64_Get() == TEST_START_COUNT, "first read before the first wrap");
+
+	for(uint32_t i = 0; i < TEST_STEPS; i++){
+		uint64_t step;
+
+		switch(i % 4U){
+		case 0:  step = Random_U64(&rng) % (TEST_REFRESH_LIMIT + 1U); break; 	// anywhere up to the longest allowed gap
+		case 1:  step = TEST_REFRESH_LIMIT; break; 					// always the longest gap
+		case 2:  step = BIT64(31) - (fake_count % BIT64(31)) - 1U; break; 		// last cycle of a half period
+		default: step = 1U; break; 							// first cycle of the next one
+		}
+		fake_count += step;
+
+		uint64_t value = Cycle_Counter_64_Get();
+		HOST_TEST_CHECK(value == fake_count, "step %u: read %" PRIu64 ", true count %" PRIu64, i, value, fake_count);
+	}
+	printf("single thread: %u reads up to %" PRIu64 " cycles (%" PRIu64 " wraps of the 32 bit counter)\n",
+	       TEST_STEPS, fake_count, fake_count >> 32);
+}
+
+/**
+ * @brief Advances the fake counter and refreshes the state like the kernel timer would, but only when the refresh limit is about to be reached.
+*/
+static void * Writer(void * a_arg)
+{
+	uint64_t rng = 0x1234567887654321ULL;
+	uint64_t since_refresh = 0;
+
+	(void)a_arg;
+	for(uint32_t i = 0; i < TEST_STEPS; i++){
+		uint64_t step = 1U + (Random_U64(&rng) % BIT64(24));
+
+		if(since_refresh + step > TEST_REFRESH_LIMIT){
+			Cycle_Counter_64_Tick();
+			since_refresh = 0;
+		}
+		__atomic_add_fetch(&fake_count, step, __ATOMIC_SEQ_CST);
+		since_refresh += step;
+	}
+	writer_done = 1;
+
+	return NULL;
+}
+
+/**
+ * @brief Every extended read must be between the true counts read before and after it, and never go back.
+*/
+static void * Reader(void * a_arg)
+{
+	uint64_t * reads = a_arg;
+	uint64_t last = 0;
+
+	while(!writer_done){
+		uint64_t before = __atomic_load_n(&fake_count, __ATOMIC_SEQ_CST);
+		uint64_t value  = Cycle_Counter_64_Get();
+		uint64_t after  = __atomic_load_n(&fake_count, __ATOMIC_SEQ_CST);
+
+		HOST_TEST_CHECK((value >= before) && (value <= after), "read %" PRIu64 " outside [%" PRIu64 ", %" PRIu64 "]", value, before, after);
+		HOST_TEST_CHECK(value >= last, "read %" PRIu64 " went back from %" PRIu64, value, last);
+		last = value;
+		(* reads)++;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Readers race with a writer that refreshes the state late; readers update the state themselves on every read too.
+*/
+static void Test_Concurrent(void)
+{
+	pthread_t writer;
+	pthread_t readers[TEST_READERS];
+	uint64_t total_reads = 0;
+
+	fake_count = TEST_START_COUNT;
+	cycle_counter_64_half_periods = 0;
+	writer_done = 0;
+	Cycle_Counter_64_Tick(); // Cycle_Counter_64_Init(), before the first wrap
+
+	for(int r = 0; r < TEST_READERS; r++){
+		pthread_create(&readers[r], NULL, Reader, &reader_reads[r]);
+	}
+	pthread_create(&writer, NULL, Writer, NULL);
+	pthread_join(writer, NULL);
+	for(int r = 0; r < TEST_READERS; r++){
+		pthread_join(readers[r], NULL);
+		total_reads += reader_reads[r];
+	}
+
+	HOST_TEST_CHECK(Cycle_Counter_64_Get() == fake_count, "final read differs from the true count");
+	printf("concurrent: %d readers, %" PRIu64 " reads, %" PRIu64 " wraps of the 32 bit counter\n", TEST_READERS, total_reads, fake_count >> 32);
+}
+
+int main(void)
+{
+	Test_Single_Thread();
+	Test_Concurrent();
+	HOST_TEST_CHECK(Bench_Read_Real_Counter(TEST_BENCH_READS) == 0, "extended read on the real counter");
+
+	return HOST_TEST_RESULT();
+}
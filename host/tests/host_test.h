@@ -0,0 +1,56 @@
+/**
+ * @author Batto1
+ * @brief  Minimal checks for the host tests. A failed check prints its location and makes the test return non-zero; the test keeps running.
+ *         Also the pseudo random numbers and the host clock the tests and their benchmarks share.
+*/
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <time.h>
+
+static int host_test_failures = 0;
+
+#define HOST_TEST_CHECK(a_cond, ...) 									\
+	do{ 												\
+		if(!(a_cond)){ 										\
+			if(host_test_failures < 20){ 							\
+				printf("%s:%d: check failed: %s: ", __FILE__, __LINE__, #a_cond); 	\
+				printf(__VA_ARGS__); 							\
+				printf("\n"); 								\
+			} 										\
+			__atomic_add_fetch(&host_test_failures, 1, __ATOMIC_RELAXED); 			\
+		} 											\
+	}while(0)
+
+/* Returns from main(): 0 if every check passed. */
+#define HOST_TEST_RESULT() 	((host_test_failures == 0) ? 0 : (printf("%d checks failed\n", host_test_failures), 1))
+
+/**
+ * @brief xorshift64* pseudo random numbers: fast, and the same sequence on every host for a given seed. a_state must not be 0.
+*/
+static inline uint64_t Random_U64(uint64_t * a_state)
+{
+	* a_state ^= * a_state >> 12;
+	* a_state ^= * a_state << 25;
+	* a_state ^= * a_state >> 27;
+
+	return * a_state * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * @brief Host monotonic clock in nano seconds, for timing benchmark loops.
+*/
+static inline uint64_t Monotonic_Ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+#endif
@@ -0,0 +1,60 @@
+/**
+ * @author Batto1
+ * @brief  Test of extending 32 bit log timestamps to 64 bits: wraps are counted, timestamps out of order don't jump a wrap ahead.
+ * @note   The true count is advanced by random steps below 2^31 over many wraps, and every few steps an older timestamp
+ *         (up to 2^31 - 1 counts back) is logged in between, like a thread preempted between reading and logging its timestamp.
+*/
+
+#include <stdint.h>
+
+#include "log_clock_timestamp.h"
+
+#include "host_test.h"
+
+#define TEST_STEPS 	2000000U
+
+/**
+ * @brief First timestamp above 2^31 before the first wrap, and a timestamp just before the wrap logged right after it.
+*/
+static void Test_Edges(void)
+{
+	LogClockTimestamp ts;
+
+	Log_Clock_Timestamp_Setup(&ts, LOG_CLOCK_TIMESTAMP_HW_CYCLES, CLOCK_FIELD_ALL);
+	HOST_TEST_CHECK(Log_Clock_Timestamp_Extend_32(&ts, 0xB2D05E00U) == 0xB2D05E00U, "first timestamp above 2^31");
+	HOST_TEST_CHECK(Log_Clock_Timestamp_Extend_32(&ts, 0x00000010U) == BIT64(32) + 0x10U, "wrap");
+	HOST_TEST_CHECK(Log_Clock_Timestamp_Extend_32(&ts, 0xFFFFFFF0U) == 0xFFFFFFF0U, "older timestamp across the wrap");
+	HOST_TEST_CHECK(Log_Clock_Timestamp_Extend_32(&ts, 0x00000008U) == BIT64(32) + 0x8U, "older timestamp after the wrap");
+	HOST_TEST_CHECK(Log_Clock_Timestamp_Extend_32(&ts, 0x00000020U) == BIT64(32) + 0x20U, "in order again");
+}
+
+static void Test_Random_Out_Of_Order(void)
+{
+	LogClockTimestamp ts;
+	uint64_t rng   = 0x9E3779B97F4A7C15ULL;
+	uint64_t count = 0;
+
+	Log_Clock_Timestamp_Setup(&ts, LOG_CLOCK_TIMESTAMP_HW_CYCLES, CLOCK_FIELD_ALL);
+	for(uint32_t i = 0; i < TEST_STEPS; i++){
+		count += Random_U64(&rng) % BIT64(31);
+
+		uint64_t value = Log_Clock_Timestamp_Extend_32(&ts, (uint32_t)count);
+		HOST_TEST_CHECK(value == count, "step %u: extended %" PRIu64 ", true count %" PRIu64, i, value, count);
+
+		if((i % 4U) == 0U){
+			uint64_t older = count - MIN(count, Random_U64(&rng) % BIT64(31));
+
+			value = Log_Clock_Timestamp_Extend_32(&ts, (uint32_t)older);
+			HOST_TEST_CHECK(value == older, "step %u: older extended %" PRIu64 ", true count %" PRIu64, i, value, older);
+		}
+	}
+	printf("out of order: %u timestamps over %" PRIu64 " wraps\n", TEST_STEPS, count >> 32);
+}
+
+int main(void)
+{
+	Test_Edges();
+	Test_Random_Out_Of_Order();
+
+	return HOST_TEST_RESULT();
+}
@@ -0,0 +1,192 @@
+/**
+ * @author Batto1
+ * @brief  Test of formatting log timestamps: the output equals Clock_Format() of Ticks_To_Clock_Time() / HW_Cycles_To_Clock_Time_64() for all
+ *         128 field and zero pad combinations over many timestamps, the "[d:h:m:s" prefix is reused only within its second and field set,
+ *         and short buffers are truncated like Clock_Format() does. Then the cost of a message within the same second against formatting it whole.
+ * @note   Timestamps go forward by steps within a second, across seconds and days, and now and then back, so that both the cached prefix
+ *         and a new one are used for every combination.
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "log_clock_timestamp.h"
+
+#include "host_test.h"
+
+#define TEST_COMBINATIONS 		128U 	/* CLOCK_FIELD_* and CLOCK_FORMAT_ZERO_PAD */
+#define TEST_TIMESTAMPS 		4000U 	/* per combination and source */
+#define TEST_BENCH_MESSAGES 		10000000U
+
+static uint32_t Combination_Fields(uint32_t a_combination)
+{
+	return (a_combination & CLOCK_FIELD_ALL) | (((a_combination & 0x40U) != 0U) ? CLOCK_FORMAT_ZERO_PAD : 0U);
+}
+
+/**
+ * @brief Formats a raw timestamp without the formatter: whole conversion and Clock_Format().
+*/
+static int Reference_Format(char * a_buf, size_t a_buf_size, LogClockTimestampSource a_source, uint64_t a_raw, uint32_t a_fields)
+{
+	TimeElapsedClock clk = (a_source == LOG_CLOCK_TIMESTAMP_TICKS) ? Ticks_To_Clock_Time((int64_t)a_raw) : HW_Cycles_To_Clock_Time_64(a_raw);
+
+	return Clock_Format(a_buf, a_buf_size, &clk, a_fields);
+}
+
+/**
+ * @brief Next timestamp: mostly small steps within the same second, sometimes a second or a day ahead, sometimes back.
+*/
+static uint64_t Next_Raw(uint64_t * a_rng, uint64_t a_raw, uint64_t a_per_sec)
+{
+	uint64_t r = Random_U64(a_rng);
+
+	switch(r % 16U){
+	case 0:
+		return a_raw + a_per_sec + ((r >> 8) % a_per_sec);
+	case 1:
+		return a_raw + (86400U * a_per_sec) + ((r >> 8) % a_per_sec);
+	case 2:
+		return a_raw - MIN(a_raw, (r >> 8) % (2U * a_per_sec));
+	default:
+		return a_raw + ((r >> 8) % (a_per_sec / 64U));
+	}
+}
+
+static void Test_All_Combinations(LogClockTimestampSource a_source)
+{
+	uint64_t per_sec = (a_source == LOG_CLOCK_TIMESTAMP_TICKS) ? CONFIG_SYS_CLOCK_TICKS_PER_SEC : (uint64_t)Get_HW_Cycles_Per_Sec();
+	uint64_t rng = 0x2545F4914F6CDD1DULL + (uint64_t)a_source;
+	char buf[CLOCK_MAX_STRING_SIZE];
+	char expected[CLOCK_MAX_STRING_SIZE];
+
+	for(uint32_t combination = 0; combination < TEST_COMBINATIONS; combination++){
+		uint32_t fields = Combination_Fields(combination);
+		uint64_t raw = (Random_U64(&rng) % (1000U * 86400U)) * per_sec; // starts within the first 1000 days, on a second
+		LogClockTimestamp ts;
+
+		Log_Clock_Timestamp_Setup(&ts, a_source, fields);
+		for(uint32_t i = 0; i < TEST_TIMESTAMPS; i++){
+			int len          = Log_Clock_Timestamp_Format(&ts, buf, sizeof(buf), raw);
+			int expected_len = Reference_Format(expected, sizeof(expected), a_source, raw, fields);
+
+			HOST_TEST_CHECK((len == expected_len) && (strcmp(buf, expected) == 0), "source %d fields 0x%02x raw %"PRIu64": %s (%d), expected %s (%d)",
+					(int)a_source, fields, raw, buf, len, expected, expected_len);
+			raw = Next_Raw(&rng, raw, per_sec);
+		}
+	}
+}
+
+/**
+ * @brief The prefix is formatted once per second and field set: a corrupted cached prefix shows up within its second and not after it.
+*/
+static void Test_Prefix_Cache(void)
+{
+	const uint64_t per_sec = CONFIG_SYS_CLOCK_TICKS_PER_SEC;
+	const uint64_t second  = (((((3U * 24U) + 4U) * 60U) + 5U) * 60U) + 6U; // [3:4:5:6
+	LogClockTimestamp ts;
+	char buf[CLOCK_MAX_STRING_SIZE];
+
+	Log_Clock_Timestamp_Setup(&ts, LOG_CLOCK_TIMESTAMP_TICKS, CLOCK_FIELD_ALL);
+	HOST_TEST_CHECK(ts.prefix_len == 0U, "prefix cached before the first message");
+
+	(void)Log_Clock_Timestamp_Format(&ts, buf, sizeof(buf), second * per_sec);
+	HOST_TEST_CHECK(strcmp(buf, "[3:4:5:6.0,0]") == 0, "first message: %s", buf);
+	HOST_TEST_CHECK((ts.prefix_sec == second) && (ts.prefix_len == strlen("[3:4:5:6")), "prefix of the first message isn't cached");
+
+	ts.prefix[1] = '9';
+	(void)Log_Clock_Timestamp_Format(&ts, buf, sizeof(buf), (second * per_sec) + (per_sec - 1U));
+	HOST_TEST_CHECK(strcmp(buf, "[9:4:5:6.999,900]") == 0, "same second doesn't reuse the prefix: %s", buf);
+
+	(void)Log_Clock_Timestamp_Format(&ts, buf, sizeof(buf), (second + 1U) * per_sec);
+	HOST_TEST_CHECK(strcmp(buf, "[3:4:5:7.0,0]") == 0, "next second reuses the prefix: %s", buf);
+
+	ts.prefix[1] = '9';
+	(void)Log_Clock_Timestamp_Format(&ts, buf, sizeof(buf), second * per_sec);
+	HOST_TEST_CHECK(strcmp(buf, "[3:4:5:6.0,0]") == 0, "previous second reuses the prefix: %s", buf);
+
+	// changing fields at run time, like Log_Clock_Timestamp_Set_Fields() does, formats a new prefix within the same second.
+	ts.prefix[1] = '9';
+	ts.fields = CLOCK_FIELD_ALL | CLOCK_FORMAT_ZERO_PAD;
+	(void)Log_Clock_Timestamp_Format(&ts, buf, sizeof(buf), second * per_sec);
+	HOST_TEST_CHECK(strcmp(buf, "[3:04:05:06.000,000]") == 0, "new fields reuse the prefix: %s", buf);
+
+	ts.fields = CLOCK_FIELD_SEC | CLOCK_FIELD_MSEC;
+	(void)Log_Clock_Timestamp_Format(&ts, buf, sizeof(buf), (second * per_sec) + 1234U);
+	HOST_TEST_CHECK(strcmp(buf, "[:6.123]") == 0, "seconds and milliseconds only: %s", buf);
+
+	ts.fields = CLOCK_FIELD_USEC;
+	(void)Log_Clock_Timestamp_Format(&ts, buf, sizeof(buf), (second * per_sec) + 1234U);
+	HOST_TEST_CHECK(strcmp(buf, "[,400]") == 0, "micro seconds only: %s", buf);
+
+	ts.fields = 0;
+	(void)Log_Clock_Timestamp_Format(&ts, buf, sizeof(buf), (second * per_sec) + 1234U);
+	HOST_TEST_CHECK(strcmp(buf, "[]") == 0, "no fields: %s", buf);
+}
+
+/**
+ * @brief Every buffer size up to the whole string: same length returned, the string cut and NUL terminated; size 0 doesn't write.
+*/
+static void Test_Truncation(void)
+{
+	const uint64_t raw = (49710ULL * 86400U * CONFIG_SYS_CLOCK_TICKS_PER_SEC) + 12345678U; // 5 digit day
+	char expected[CLOCK_MAX_STRING_SIZE];
+	char buf[CLOCK_MAX_STRING_SIZE + 1];
+
+	for(uint32_t combination = 0; combination < TEST_COMBINATIONS; combination++){
+		uint32_t fields  = Combination_Fields(combination);
+		int expected_len = Reference_Format(expected, sizeof(expected), LOG_CLOCK_TIMESTAMP_TICKS, raw, fields);
+		LogClockTimestamp ts;
+
+		Log_Clock_Timestamp_Setup(&ts, LOG_CLOCK_TIMESTAMP_TICKS, fields);
+		for(size_t size = 0; size <= (size_t)expected_len + 1U; size++){
+			memset(buf, '#', sizeof(buf));
+			int len = Log_Clock_Timestamp_Format(&ts, buf, size, raw);
+
+			HOST_TEST_CHECK(len == expected_len, "fields 0x%02x size %zu: length %d, expected %d", fields, size, len, expected_len);
+			if(size == 0U){
+				HOST_TEST_CHECK(buf[0] == '#', "fields 0x%02x: size 0 wrote the buffer", fields);
+				continue;
+			}
+			size_t copied = MIN(size - 1U, (size_t)expected_len);
+			HOST_TEST_CHECK((strncmp(buf, expected, copied) == 0) && (buf[copied] == '\0') && (buf[copied + 1U] == '#'),
+					"fields 0x%02x size %zu: %s", fields, size, buf);
+		}
+	}
+}
+
+/**
+ * @brief Messages 100 us apart: the formatter against converting and formatting every timestamp whole.
+*/
+static void Bench_Format(void)
+{
+	LogClockTimestamp ts;
+	char buf[CLOCK_MAX_STRING_SIZE];
+	size_t sink = 0;
+
+	Log_Clock_Timestamp_Setup(&ts, LOG_CLOCK_TIMESTAMP_TICKS, CLOCK_FIELD_ALL);
+	uint64_t start = Monotonic_Ns();
+	for(uint32_t i = 0; i < TEST_BENCH_MESSAGES; i++){
+		sink += (size_t)Log_Clock_Timestamp_Format(&ts, buf, sizeof(buf), i);
+	}
+	uint64_t formatter_ns = Monotonic_Ns() - start;
+
+	start = Monotonic_Ns();
+	for(uint32_t i = 0; i < TEST_BENCH_MESSAGES; i++){
+		sink += (size_t)Reference_Format(buf, sizeof(buf), LOG_CLOCK_TIMESTAMP_TICKS, i, CLOCK_FIELD_ALL);
+	}
+	uint64_t reference_ns = Monotonic_Ns() - start;
+
+	printf("format, messages 1 tick apart: Log_Clock_Timestamp_Format %.1f ns, Clock_Format(Ticks_To_Clock_Time()) %.1f ns (%zu)\n",
+	       (double)formatter_ns / TEST_BENCH_MESSAGES, (double)reference_ns / TEST_BENCH_MESSAGES, sink);
+}
+
+int main(void)
+{
+	Test_All_Combinations(LOG_CLOCK_TIMESTAMP_TICKS);
+	Test_All_Combinations(LOG_CLOCK_TIMESTAMP_HW_CYCLES);
+	Test_Prefix_Cache();
+	Test_Truncation();
+	Bench_Format();
+
+	return HOST_TEST_RESULT();
+}
@@ -0,0 +1,215 @@
+/**
+ * @author Batto1
+ * @brief  Ten simulated years of a raw time accumulator in ticks and in HW cycles, with a reboot every simulated day and a firmware update
+ *         that changes the counter rate halfway. Every reading is checked against exact integer math on the true count, so there is no drift.
+ * @note   Simulated intervals are added with Raw_Time_Accumulator_Add(), reboots carry the total over with Raw_Time_Accumulator_Init() like a
+ *         retained variable would. Converting each interval to milliseconds before accumulating it must drift behind.
+ * @note   Then Accumulate_Time_Secs(), Accumulate_Time_Clk() and a raw accumulator of ticks are driven through the same simulated uptime
+ *         (built with TIME_AND_CLOCK_PORT_POSIX_FAKE_UPTIME): the raw accumulator must match the true time to the micro second while
+ *         the older functions lose what's below their unit at every reboot.
+*/
+
+#include <stdint.h>
+
+#include "time_and_clock_utils.h"
+
+#include "host_test.h"
+
+#define TEST_YEARS 		10U
+#define TEST_SECS_PER_DAY 	(24U * 3600U)
+#define TEST_DAYS 		(TEST_YEARS * 365U)
+#define TEST_OLD_RATE 		32768U 		/* counter rate of the firmware before the update */
+#define TEST_MAX_STEP_SECS 	120U
+#define TEST_MAX_UPDATE_SECS 	600U 		/* between updates on the simulated uptime */
+
+/**
+ * @brief Checks every reading of the accumulator against the exact conversion of a_expected_total.
+*/
+static void Check_Readings(const RawTimeAccumulator * a_acc, uint64_t a_expected_total, uint32_t a_day)
+{
+	uint64_t rate        = a_acc->units_per_sec;
+	TimeDuration exp_dur = (TimeDuration)(((unsigned __int128)a_expected_total * TIME_DURATION_USEC_PER_SEC) / rate);
+	TimeElapsedClock exp_clk;
+	TimeElapsedClock clk = Raw_Time_Accumulator_Get_Clock(a_acc);
+
+	(void)Duration_To_Clock(&exp_clk, exp_dur);
+
+	HOST_TEST_CHECK(a_acc->total == a_expected_total, "day %u: total %" PRIu64 ", expected %" PRIu64, a_day, a_acc->total, a_expected_total);
+	HOST_TEST_CHECK(Raw_Time_Accumulator_Get_Secs(a_acc) == a_expected_total / rate, "day %u: seconds", a_day);
+	HOST_TEST_CHECK(Raw_Time_Accumulator_Get_Duration(a_acc) == exp_dur, "day %u: duration %" PRId64 ", expected %" PRId64,
+			a_day, Raw_Time_Accumulator_Get_Duration(a_acc), exp_dur);
+	HOST_TEST_CHECK(Clock_To_Duration(&clk) == exp_dur, "day %u: clock", a_day);
+}
+
+/**
+ * @brief Simulates a day of random intervals at a_rate units per second.
+ * @param [in, out] a_true_units 	exact count of the day is added to it.
+ * @param [in, out] a_naive_ms 	each interval converted to milliseconds on its own is added to it.
+*/
+static uint64_t Simulate_Day(uint64_t * a_rng, uint64_t a_rate, uint64_t * a_true_units, uint64_t * a_naive_ms, RawTimeAccumulator * a_acc)
+{
+	uint64_t day_units = a_rate * TEST_SECS_PER_DAY;
+	uint64_t done      = 0;
+
+	while(done < day_units){
+		uint64_t step = 1U + (Random_U64(a_rng) % (a_rate * TEST_MAX_STEP_SECS));
+
+		step = MIN(step, day_units - done);
+		if(a_acc != NULL){
+			Raw_Time_Accumulator_Add(a_acc, step);
+		}
+		* a_naive_ms += (step * 1000U) / a_rate;
+		done += step;
+	}
+	* a_true_units += done;
+
+	return done;
+}
+
+/**
+ * @brief Five years on the old firmware (counted by the test at TEST_OLD_RATE), an update, then five years on the accumulator.
+*/
+static void Test_Ten_Years(TimeAccumulatorSource a_source, const char * a_name)
+{
+	RawTimeAccumulator acc;
+	uint64_t rng       = 0x9E3779B97F4A7C15ULL;
+	uint64_t old_total = 0;
+	uint64_t naive_ms  = 0;
+	uint64_t expected;
+
+	for(uint32_t day = 0; day < TEST_DAYS / 2U; day++){
+		(void)Simulate_Day(&rng, TEST_OLD_RATE, &old_total, &naive_ms, NULL);
+	}
+
+	// firmware update: the retained total is rescaled to the new rate once, rounded down.
+	Raw_Time_Accumulator_Init(&acc, a_source, old_total, TEST_OLD_RATE);
+	uint64_t rate = acc.units_per_sec;
+	expected = (uint64_t)(((unsigned __int128)old_total * rate) / TEST_OLD_RATE);
+	Check_Readings(&acc, expected, TEST_DAYS / 2U);
+
+	for(uint32_t day = TEST_DAYS / 2U; day < TEST_DAYS; day++){
+		(void)Simulate_Day(&rng, rate, &expected, &naive_ms, &acc);
+		Check_Readings(&acc, expected, day);
+
+		// reboot: total and rate kept in a retained variable.
+		RawTimeAccumulator retained = acc;
+		Raw_Time_Accumulator_Init(&acc, a_source, retained.total, retained.units_per_sec);
+		Check_Readings(&acc, expected, day);
+	}
+
+	// exact time: 5 years at the old rate plus 5 years at the new rate, in whole seconds.
+	uint64_t true_us = (uint64_t)TEST_DAYS * TEST_SECS_PER_DAY * TIME_DURATION_USEC_PER_SEC;
+	int64_t error_us = Raw_Time_Accumulator_Get_Duration(&acc) - (int64_t)true_us;
+	uint64_t unit_us = (TIME_DURATION_USEC_PER_SEC + rate - 1U) / rate;
+
+	HOST_TEST_CHECK((error_us <= 0) && ((uint64_t)(-error_us) <= unit_us + 1U), "%s: error %" PRId64 " us after %u years", a_name, error_us, TEST_YEARS);
+	HOST_TEST_CHECK(naive_ms < true_us / 1000U, "%s: converting every interval to ms doesn't drift", a_name);
+	printf("%s at %" PRIu64 " Hz: %u years, %u reboots, error %" PRId64 " us; converting every interval to ms drifts %" PRId64 " ms\n",
+	       a_name, rate, TEST_YEARS, TEST_DAYS / 2U, error_us, (int64_t)naive_ms - (int64_t)(true_us / 1000U));
+}
+
+/**
+ * @brief Ten years of the same simulated uptime for Accumulate_Time_Secs(), Accumulate_Time_Clk() and a raw accumulator of ticks, all updated at
+ *        the same random points and carried over a reboot at a random time of every day.
+ * @note Within a boot the older functions are exact too, their differences add up to the last reading. At a reboot Accumulate_Time_Secs() loses
+ *       the fraction of the last second and Accumulate_Time_Clk() the fraction of the last micro second, which is nothing when a tick is whole
+ *       micro seconds. Each is checked against exactly that loss.
+*/
+static void Test_Same_Uptime(void)
+{
+	const uint64_t rate = CONFIG_SYS_CLOCK_TICKS_PER_SEC;
+	uint64_t rng = 0xD1B54A32D192ED03ULL;
+	RawTimeAccumulator acc = {0};
+	uint64_t secs          = 0;
+	TimeElapsedClock clk   = {0};
+	uint64_t true_ticks    = 0;
+	uint64_t expected_secs = 0;
+	int64_t expected_us    = 0;
+
+	for(uint32_t day = 0; day < TEST_DAYS; day++){
+		// power up: uptime starts from 0, previous values of the older functions go back to 0 and retained totals are kept.
+		uint64_t boot_ticks = (TEST_SECS_PER_DAY * rate) - (Random_U64(&rng) % (3600U * rate));
+		uint64_t uptime     = 0;
+		uint64_t prev_secs  = 0;
+		TimeElapsedClock prev_clk = {0};
+
+		Port_Posix_Set_Uptime_Ticks(0);
+		Raw_Time_Accumulator_Init(&acc, TIME_ACCUMULATOR_TICKS, acc.total, acc.units_per_sec);
+		while(uptime < boot_ticks){
+			uint64_t step = 1U + (Random_U64(&rng) % (TEST_MAX_UPDATE_SECS * rate));
+
+			uptime += MIN(step, boot_ticks - uptime);
+			Port_Posix_Set_Uptime_Ticks((int64_t)uptime);
+
+			Accumulate_Time_Secs(&secs, &prev_secs);
+			HOST_TEST_CHECK(Accumulate_Time_Clk(&clk, &prev_clk) == TIME_UTIL_ERROR_NONE, "day %u: Accumulate_Time_Clk failed", day);
+			Raw_Time_Accumulator_Update(&acc);
+		}
+
+		true_ticks    += boot_ticks;
+		expected_secs += boot_ticks / rate;
+		expected_us   += (int64_t)((boot_ticks * TIME_DURATION_USEC_PER_SEC) / rate);
+
+		TimeDuration true_us = (TimeDuration)(((unsigned __int128)true_ticks * TIME_DURATION_USEC_PER_SEC) / rate);
+		HOST_TEST_CHECK(acc.total == true_ticks, "day %u: raw total %" PRIu64 ", true %" PRIu64, day, acc.total, true_ticks);
+		HOST_TEST_CHECK(Raw_Time_Accumulator_Get_Duration(&acc) == true_us, "day %u: raw accumulator %" PRId64 " us, true %" PRId64 " us",
+				day, Raw_Time_Accumulator_Get_Duration(&acc), true_us);
+		HOST_TEST_CHECK(secs == expected_secs, "day %u: Accumulate_Time_Secs %" PRIu64 " s, expected %" PRIu64 " s", day, secs, expected_secs);
+		HOST_TEST_CHECK(Clock_To_Duration(&clk) == expected_us, "day %u: Accumulate_Time_Clk %" PRId64 " us, expected %" PRId64 " us",
+				day, Clock_To_Duration(&clk), expected_us);
+	}
+
+	TimeDuration true_us    = (TimeDuration)(((unsigned __int128)true_ticks * TIME_DURATION_USEC_PER_SEC) / rate);
+	TimeDuration secs_drift = ((TimeDuration)secs * TIME_DURATION_USEC_PER_SEC) - true_us;
+	TimeDuration clk_drift  = Clock_To_Duration(&clk) - true_us;
+
+	// every reboot loses a fraction of a second, about half a second on average.
+	HOST_TEST_CHECK(secs_drift < -((TimeDuration)TEST_DAYS * TIME_DURATION_USEC_PER_SEC / 4), "Accumulate_Time_Secs drifts only %" PRId64 " us", secs_drift);
+	if((TIME_DURATION_USEC_PER_SEC % rate) == 0U){
+		HOST_TEST_CHECK(clk_drift == 0, "Accumulate_Time_Clk drifts %" PRId64 " us with whole micro second ticks", clk_drift);
+	}else{
+		HOST_TEST_CHECK((clk_drift < 0) && (clk_drift >= -(TimeDuration)TEST_DAYS), "Accumulate_Time_Clk drifts %" PRId64 " us", clk_drift);
+	}
+	printf("same uptime at %" PRIu64 " Hz: %u years, %u reboots; raw accumulator error 0 us, Accumulate_Time_Secs drifts %" PRId64 " us, "
+	       "Accumulate_Time_Clk drifts %" PRId64 " us\n", rate, TEST_YEARS, TEST_DAYS, secs_drift, clk_drift);
+}
+
+/**
+ * @brief Updates add exactly the counter delta, the simulated uptime or HW cycles advanced by the test in steps of different sizes.
+*/
+static void Test_Update(TimeAccumulatorSource a_source)
+{
+	RawTimeAccumulator acc;
+	uint64_t expected = 0;
+
+	Port_Posix_Set_Uptime_Ticks(0);
+	Port_Posix_Set_Cycles(0);
+	Raw_Time_Accumulator_Init(&acc, a_source, 0, 0);
+	for(uint32_t i = 0; i < 1000U; i++){
+		uint64_t total    = acc.total;
+		uint64_t last_raw = acc.last_raw;
+		uint64_t step     = ((uint64_t)(i % 7U) + 1U) << (i % 24U);
+
+		if(a_source == TIME_ACCUMULATOR_TICKS){
+			Port_Posix_Set_Uptime_Ticks(k_uptime_ticks() + (int64_t)step);
+		}else{
+			Port_Posix_Set_Cycles(k_cycle_get_64() + step);
+		}
+		expected += step;
+		Raw_Time_Accumulator_Update(&acc);
+		HOST_TEST_CHECK(acc.total - total == acc.last_raw - last_raw, "update %u", i);
+		HOST_TEST_CHECK(acc.last_raw >= last_raw, "counter went back");
+	}
+	HOST_TEST_CHECK(acc.total == expected, "total %" PRIu64 ", counter advanced %" PRIu64, acc.total, expected);
+}
+
+int main(void)
+{
+	Test_Update(TIME_ACCUMULATOR_TICKS);
+	Test_Update(TIME_ACCUMULATOR_HW_CYCLES);
+	Test_Ten_Years(TIME_ACCUMULATOR_TICKS, "ticks");
+	Test_Ten_Years(TIME_ACCUMULATOR_HW_CYCLES, "HW cycles");
+	Test_Same_Uptime();
+
+	return HOST_TEST_RESULT();
+}
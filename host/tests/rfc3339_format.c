@@ -0,0 +1,124 @@
+/**
+ * @author Batto1
+ * @brief  RFC 3339 formatter checked against a gmtime_r() + strftime() + snprintf() reference at every precision, then its throughput
+ *         next to the reference: sequential timestamps (cached prefix) and a new hour on every call (prefix rebuilt each time).
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "wall_clock.h"
+
+#include "host_test.h"
+
+#define TEST_TIMESTAMPS 	1000000U
+#define TEST_BENCH_CALLS 	2000000U
+#define TEST_START 		1791115200000000LL 	/* 2026-10-04T12:00:00Z */
+#define TEST_MAX_WALL_TIME 	253402300799999999LL 	/* 9999-12-31T23:59:59.999999Z */
+
+static const WallClockPrecision test_precisions[] = {WALL_CLOCK_PRECISION_SEC, WALL_CLOCK_PRECISION_MSEC, WALL_CLOCK_PRECISION_USEC};
+static volatile int bench_sink_int;
+
+/**
+ * @brief Formats with the C library, fraction digits truncated.
+*/
+static int Reference_Format(char * a_buf, size_t a_buf_size, int64_t a_wall_time, WallClockPrecision a_precision)
+{
+	int64_t floor_secs = (a_wall_time / 1000000) - ((a_wall_time % 1000000) < 0);
+	time_t secs        = (time_t)floor_secs;
+	uint32_t fraction  = (uint32_t)(a_wall_time - (floor_secs * 1000000));
+	struct tm tm;
+	char date[32];
+
+	gmtime_r(&secs, &tm);
+	snprintf(date, sizeof(date), "%04d", tm.tm_year + 1900); // %Y doesn't pad years below 1000
+	strftime(&date[4], sizeof(date) - 4U, "-%m-%dT%H:%M:%S", &tm);
+	if(WALL_CLOCK_PRECISION_MSEC == a_precision){
+		return snprintf(a_buf, a_buf_size, "%s.%03uZ", date, fraction / 1000U);
+	}
+	if(WALL_CLOCK_PRECISION_USEC == a_precision){
+		return snprintf(a_buf, a_buf_size, "%s.%06uZ", date, fraction);
+	}
+	return snprintf(a_buf, a_buf_size, "%sZ", date);
+}
+
+/**
+ * @brief Half sequential timestamps (a few ms apart, crossing hours), half random over years 0000-9999.
+*/
+static void Test_Against_Reference(void)
+{
+	uint64_t rng = 0x9E3779B97F4A7C15ULL;
+	uint32_t checked = 0;
+
+	for(size_t p = 0; p < sizeof(test_precisions) / sizeof(test_precisions[0]); p++){
+		WallClockRfc3339 fmt;
+		int64_t wall_time = TEST_START;
+
+		Wall_Clock_Rfc3339_Setup(&fmt, test_precisions[p]);
+		for(uint32_t i = 0; i < TEST_TIMESTAMPS; i++){
+			char buf[WALL_CLOCK_RFC3339_MAX_STRING_SIZE];
+			char ref[64];
+			int64_t t;
+
+			if((i % 2U) == 0U){
+				wall_time += (int64_t)(Random_U64(&rng) % 20000U);
+				t = wall_time;
+			}else{
+				t = (int64_t)(Random_U64(&rng) % (uint64_t)(TEST_MAX_WALL_TIME + 62167219200000000LL + 1)) - 62167219200000000LL; // from 0000-01-01
+			}
+
+			int len     = Wall_Clock_Rfc3339_Format(&fmt, buf, sizeof(buf), t);
+			int ref_len = Reference_Format(ref, sizeof(ref), t, test_precisions[p]);
+			HOST_TEST_CHECK((len == ref_len) && (0 == strcmp(buf, ref)), "%" PRId64 ": \"%s\", expected \"%s\"", t, buf, ref);
+			checked++;
+		}
+	}
+
+	char small[8];
+	WallClockRfc3339 fmt;
+	Wall_Clock_Rfc3339_Setup(&fmt, WALL_CLOCK_PRECISION_USEC);
+	HOST_TEST_CHECK(Wall_Clock_Rfc3339_Format(&fmt, small, sizeof(small), TEST_START) == 27, "length of a truncated string");
+	HOST_TEST_CHECK(0 == strcmp(small, "2026-10"), "truncated to \"%s\"", small);
+	HOST_TEST_CHECK(Wall_Clock_Rfc3339_Format(&fmt, small, sizeof(small), TEST_MAX_WALL_TIME + 1) < 0, "year 10000");
+
+	printf("reference: %u timestamps at 3 precisions, years 0000-9999\n", checked);
+}
+
+/**
+ * @brief Million strings per second of the formatter and of the reference.
+ * @param [in] a_step_us 	distance between consecutive timestamps.
+*/
+static void Bench_Format(WallClockPrecision a_precision, int64_t a_step_us, const char * a_name)
+{
+	WallClockRfc3339 fmt;
+	char buf[64];
+	uint64_t start;
+
+	Wall_Clock_Rfc3339_Setup(&fmt, a_precision);
+	start = Monotonic_Ns();
+	for(uint32_t i = 0; i < TEST_BENCH_CALLS; i++){
+		bench_sink_int = Wall_Clock_Rfc3339_Format(&fmt, buf, sizeof(buf), TEST_START + ((int64_t)i * a_step_us));
+	}
+	double ns = (double)(Monotonic_Ns() - start);
+
+	start = Monotonic_Ns();
+	for(uint32_t i = 0; i < TEST_BENCH_CALLS; i++){
+		bench_sink_int = Reference_Format(buf, sizeof(buf), TEST_START + ((int64_t)i * a_step_us), a_precision);
+	}
+	double ref_ns = (double)(Monotonic_Ns() - start);
+
+	printf("%s: %.1f M strings/s, reference %.1f M strings/s\n", a_name, (TEST_BENCH_CALLS * 1000.0) / ns, (TEST_BENCH_CALLS * 1000.0) / ref_ns);
+}
+
+int main(void)
+{
+	Test_Against_Reference();
+
+	Bench_Format(WALL_CLOCK_PRECISION_SEC, 1000, "s, sequential");
+	Bench_Format(WALL_CLOCK_PRECISION_MSEC, 1000, "ms, sequential");
+	Bench_Format(WALL_CLOCK_PRECISION_USEC, 1000, "us, sequential");
+	Bench_Format(WALL_CLOCK_PRECISION_USEC, TIME_DURATION_USEC_PER_HOUR + 1, "us, new hour every call");
+
+	return HOST_TEST_RESULT();
+}
@@ -0,0 +1,184 @@
+/**
+ * @author Batto1
+ * @brief  Software clock against a clock incremented by a 1 ms timer with Increment_a_Millisecond_And_Update_Clock(), both driven from the same
+ *         simulated uptime (built with TIME_AND_CLOCK_PORT_POSIX_FAKE_UPTIME). They must read the same on every tick: across a day rollover and
+ *         through random sets, adjustments, pauses and resumes.
+ * @note   The timer is modelled like a k_timer with a 1 ms period: started when the clock is set or resumed, first expiry 1 ms later, stopped while
+ *         paused; an adjustment changes the value and keeps the timer's phase. Needs a tick rate that is a multiple of 1000, so that a 1 ms timer
+ *         expires on ticks; skipped otherwise.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "software_clock.h"
+
+#include "host_test.h"
+
+#define TEST_TICKS_PER_MSEC 	(CONFIG_SYS_CLOCK_TICKS_PER_SEC / 1000)
+#define TEST_START_TICKS 	123457 		/* uptime at start, not on a millisecond */
+#define TEST_RANDOM_TICKS 	(600 * CONFIG_SYS_CLOCK_TICKS_PER_SEC) 	/* ten simulated minutes */
+#define TEST_OPERATION_CHANCE 	500U 		/* an operation every this many ticks on average */
+
+/**
+ * @brief Clock of the increment pattern and its 1 ms timer.
+*/
+typedef struct incrementClock{
+	TimeElapsedClock 	clk;
+	int64_t 		next_expiry; 	/* uptime ticks of the timer's next expiry */
+	bool 			running;
+}IncrementClock;
+
+static int64_t test_uptime;
+
+static void Set_Uptime(int64_t a_ticks)
+{
+	test_uptime = a_ticks;
+	Port_Posix_Set_Uptime_Ticks(a_ticks);
+}
+
+static void Increment_Clock_Start_Timer(IncrementClock * a_inc)
+{
+	a_inc->next_expiry = test_uptime + TEST_TICKS_PER_MSEC;
+}
+
+/**
+ * @brief Runs the timer expiries that are due at the current uptime.
+*/
+static void Increment_Clock_Run(IncrementClock * a_inc)
+{
+	while(a_inc->running && (test_uptime >= a_inc->next_expiry)){
+		Increment_a_Millisecond_And_Update_Clock(&a_inc->clk);
+		a_inc->next_expiry += TEST_TICKS_PER_MSEC;
+	}
+}
+
+static bool Clock_Is_Equal(const TimeElapsedClock * a_x, const TimeElapsedClock * a_y)
+{
+	return (a_x->day == a_y->day) && (a_x->hour == a_y->hour) && (a_x->min == a_y->min) && (a_x->sec == a_y->sec) &&
+	       (a_x->m_sec == a_y->m_sec) && (a_x->u_sec == a_y->u_sec);
+}
+
+/**
+ * @retval true if the software clock reads the same as the increment clock.
+*/
+static bool Check_Same(SoftwareClock * a_clock, IncrementClock * a_inc, const char * a_when)
+{
+	TimeElapsedClock clk = Software_Clock_Get(a_clock);
+	bool same = Clock_Is_Equal(&clk, &a_inc->clk) && (Software_Clock_Get_Duration(a_clock) == Clock_To_Duration(&a_inc->clk)) &&
+		    (Software_Clock_Is_Running(a_clock) == a_inc->running);
+
+	HOST_TEST_CHECK(same, "%s at tick %" PRId64 ": software clock [%u:%u:%u:%u.%u,%u], increment clock [%u:%u:%u:%u.%u,%u]", a_when, test_uptime,
+			clk.day, clk.hour, clk.min, clk.sec, clk.m_sec, clk.u_sec, a_inc->clk.day, a_inc->clk.hour, a_inc->clk.min, a_inc->clk.sec,
+			a_inc->clk.m_sec, a_inc->clk.u_sec);
+
+	return same;
+}
+
+/**
+ * @brief Both clocks set to 41 days 23:59:59.990,250 and run tick by tick for three seconds, across the day rollover.
+*/
+static void Test_Day_Rollover(void)
+{
+	const TimeElapsedClock initial = {.day = 41, .hour = 23, .min = 59, .sec = 59, .m_sec = 990, .u_sec = 250};
+	IncrementClock inc = {.clk = initial, .running = true};
+	SoftwareClock clock;
+
+	Set_Uptime(TEST_START_TICKS);
+	Software_Clock_Init(&clock, &initial, SOFTWARE_CLOCK_RESOLUTION_MSEC, true);
+	Increment_Clock_Start_Timer(&inc);
+
+	for(int64_t i = 0; i < (3 * CONFIG_SYS_CLOCK_TICKS_PER_SEC); i++){
+		Set_Uptime(TEST_START_TICKS + i);
+		Increment_Clock_Run(&inc);
+		if(!Check_Same(&clock, &inc, "rollover")){
+			return;
+		}
+	}
+
+	TimeElapsedClock clk = Software_Clock_Get(&clock);
+	HOST_TEST_CHECK((clk.day == 42U) && (clk.hour == 0U) && (clk.min == 0U) && (clk.sec == 2U) && (clk.m_sec == 989U) && (clk.u_sec == 250U),
+			"after the rollover: [%u:%u:%u:%u.%u,%u]", clk.day, clk.hour, clk.min, clk.sec, clk.m_sec, clk.u_sec);
+}
+
+/**
+ * @brief Random operations on both clocks at random ticks, compared on every tick.
+*/
+static void Test_Random_Operations(void)
+{
+	uint64_t rng = 0x3C6EF372FE94F82BULL;
+	IncrementClock inc = {0};
+	SoftwareClock clock;
+	uint32_t operations[5] = {0};
+
+	Set_Uptime(TEST_START_TICKS);
+	Software_Clock_Init(&clock, NULL, SOFTWARE_CLOCK_RESOLUTION_MSEC, false);
+
+	for(int64_t i = 1; i <= TEST_RANDOM_TICKS; i++){
+		Set_Uptime(TEST_START_TICKS + i);
+		Increment_Clock_Run(&inc);
+
+		uint64_t r = Random_U64(&rng);
+		if((r % TEST_OPERATION_CHANCE) == 0U){
+			uint32_t operation = (uint32_t)((r >> 16) % 5U);
+
+			r >>= 24;
+			switch(operation){
+			case 0:{ // set, restarts the timer if it runs
+				TimeElapsedClock value;
+				(void)Duration_To_Clock(&value, (TimeDuration)(r % (3U * TIME_DURATION_USEC_PER_DAY)));
+				Software_Clock_Set(&clock, &value);
+				inc.clk = value;
+				Increment_Clock_Start_Timer(&inc);
+				break;
+			}
+			case 1: // pause, stops the timer
+				Software_Clock_Pause(&clock);
+				inc.running = false;
+				break;
+			case 2: // resume, starts the timer if it's stopped
+				Software_Clock_Resume(&clock);
+				if(!inc.running){
+					inc.running = true;
+					Increment_Clock_Start_Timer(&inc);
+				}
+				break;
+			default:{ // adjust by up to +-2 minutes, sometimes below 0, timer keeps its phase
+				TimeDuration delta    = (TimeDuration)(r % (4U * TIME_DURATION_USEC_PER_MIN)) - (2 * TIME_DURATION_USEC_PER_MIN);
+				TimeDuration adjusted = Clock_To_Duration(&inc.clk) + delta;
+				TimeAndClockErrors expected = TIME_UTIL_ERROR_NONE;
+
+				if(adjusted < 0){
+					adjusted = 0;
+					expected = TIME_UTIL_ERROR_NEGATIVE;
+					Increment_Clock_Start_Timer(&inc);
+				}
+				(void)Duration_To_Clock(&inc.clk, adjusted);
+				HOST_TEST_CHECK(Software_Clock_Adjust(&clock, delta) == expected, "adjust by %" PRId64 " at tick %" PRId64, delta, test_uptime);
+				operation = (expected == TIME_UTIL_ERROR_NEGATIVE) ? 4U : 3U;
+				break;
+			}
+			}
+			operations[operation] ++;
+		}
+		if(!Check_Same(&clock, &inc, "random operations")){
+			return;
+		}
+	}
+
+	HOST_TEST_CHECK(operations[4] > 0U, "no adjustment went below 0");
+	printf("%d simulated seconds: %u sets, %u pauses, %u resumes, %u adjustments, %u below 0; same reading on every tick\n",
+	       TEST_RANDOM_TICKS / CONFIG_SYS_CLOCK_TICKS_PER_SEC, operations[0], operations[1], operations[2], operations[3], operations[4]);
+}
+
+int main(void)
+{
+#if (CONFIG_SYS_CLOCK_TICKS_PER_SEC % 1000) != 0
+	printf("skipped: a 1 ms timer doesn't expire on ticks at %d Hz\n", CONFIG_SYS_CLOCK_TICKS_PER_SEC);
+#else
+	Test_Day_Rollover();
+	Test_Random_Operations();
+#endif
+
+	return HOST_TEST_RESULT();
+}
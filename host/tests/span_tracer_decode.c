@@ -0,0 +1,109 @@
+/**
+ * @author Batto1
+ * @brief  Span tracer dump for span_tracer_decode_check.py: known events are recorded into two rings, one of them small enough that records wrap
+ *         around its end and new events are dropped while it's full, and the rings are drained between the phases.
+ * @note   Prints the "#ST" dump to stdout and, interleaved with it, what the decoder must get back out of it:
+ *         "#EXP E <ring id> <type> <event id> <cycles>" for every recorded event in record order, with the HW cycles it was recorded at (the
+ *         ring's head_cycles after recording), and "#EXP R <ring id> <recorded> <dropped>" at the end. The decoder ignores these lines.
+*/
+
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "span_tracer.h"
+
+#include "host_test.h"
+
+#define TEST_SMALL_RING_SIZE 	64U 	/* a few dozen records */
+#define TEST_LARGE_RING_SIZE 	4096U
+
+enum{
+	TEST_EVENT_LOOP = 0,
+	TEST_EVENT_ISR,
+	TEST_EVENT_TICK,
+	TEST_EVENT_COUNT,
+	TEST_EVENT_WIDE = 200, 	/* header needs two bytes; has no name, decoded as event_200 */
+};
+
+static const char * const test_event_names[TEST_EVENT_COUNT] = {"control loop", "isr", "tick"};
+
+static SpanTracerRing test_small_ring;
+static SpanTracerRing test_large_ring;
+static uint8_t test_small_buf[TEST_SMALL_RING_SIZE];
+static uint8_t test_large_buf[TEST_LARGE_RING_SIZE];
+static uint32_t test_dropped[2];
+
+/**
+ * @brief Records an event and prints its expectation if it was recorded, otherwise counts it as dropped.
+*/
+static bool Record(SpanTracerRing * a_ring, SpanTracerEventType a_type, uint16_t a_event_id)
+{
+	uint64_t before = Get_Uptime_HW_Cycles_64();
+	bool recorded   = Span_Tracer_Record(a_ring, a_type, a_event_id);
+	uint64_t after  = Get_Uptime_HW_Cycles_64();
+
+	if(recorded){
+		HOST_TEST_CHECK((a_ring->head_cycles >= before) && (a_ring->head_cycles <= after), "timestamp isn't read while recording");
+		printf("#EXP E %"PRIu32" %u %u %"PRIu64"\n", a_ring->id, (unsigned int)a_type, (unsigned int)a_event_id, a_ring->head_cycles);
+	}else{
+		test_dropped[a_ring->id] ++;
+	}
+
+	return recorded;
+}
+
+/**
+ * @brief Spins for about a_ns so that deltas are of different varint lengths.
+*/
+static void Spin_Ns(uint64_t a_ns)
+{
+	uint64_t end = Monotonic_Ns() + a_ns;
+
+	while(Monotonic_Ns() < end){
+	}
+}
+
+int main(void)
+{
+	Span_Tracer_Init(test_event_names, TEST_EVENT_COUNT);
+	HOST_TEST_CHECK(Span_Tracer_Ring_Init(&test_small_ring, "small ring", test_small_buf, sizeof(test_small_buf)) == 0, "small ring init");
+	HOST_TEST_CHECK(Span_Tracer_Ring_Init(&test_large_ring, "main", test_large_buf, sizeof(test_large_buf)) == 0, "large ring init");
+	HOST_TEST_CHECK((test_small_ring.id == 0U) && (test_large_ring.id == 1U), "ring ids");
+
+	// 1: a few records, drained so that the next ones start in the middle of the small buffer.
+	for(uint32_t i = 0; i < 5U; i++){
+		HOST_TEST_CHECK(Record(&test_small_ring, SPAN_TRACER_INSTANT, TEST_EVENT_TICK), "small ring is full too early");
+		Spin_Ns(1000U * i);
+	}
+	Span_Tracer_Drain_All();
+
+	// 2: nested spans on the large ring, the small ring fills up across its end and drops the rest.
+	uint32_t wrapped_at = 0;
+	for(uint32_t i = 0; i < 40U; i++){
+		(void)Record(&test_large_ring, SPAN_TRACER_BEGIN, TEST_EVENT_LOOP);
+		(void)Record(&test_small_ring, SPAN_TRACER_BEGIN, TEST_EVENT_ISR);
+		Spin_Ns(50U * i);
+		(void)Record(&test_small_ring, SPAN_TRACER_END, TEST_EVENT_ISR);
+		(void)Record(&test_large_ring, SPAN_TRACER_INSTANT, TEST_EVENT_WIDE);
+		(void)Record(&test_large_ring, SPAN_TRACER_END, TEST_EVENT_LOOP);
+		if((wrapped_at == 0U) && ((test_small_ring.head / TEST_SMALL_RING_SIZE) != 0U)){
+			wrapped_at = i;
+		}
+	}
+	HOST_TEST_CHECK(wrapped_at != 0U, "small ring didn't wrap");
+	HOST_TEST_CHECK(test_dropped[0] > 0U, "small ring didn't drop");
+	HOST_TEST_CHECK(test_dropped[1] == 0U, "large ring dropped");
+	Span_Tracer_Drain_All();
+
+	// 3: after draining, the small ring records again; a long gap needs a multi byte delta.
+	Spin_Ns(3000000U);
+	HOST_TEST_CHECK(Record(&test_small_ring, SPAN_TRACER_INSTANT, TEST_EVENT_TICK), "small ring is still full after draining");
+	HOST_TEST_CHECK(Record(&test_large_ring, SPAN_TRACER_INSTANT, TEST_EVENT_TICK), "large ring is full");
+	Span_Tracer_Drain_All();
+
+	printf("#EXP R %"PRIu32" %"PRIu32" %"PRIu32"\n", test_small_ring.id, test_small_ring.recorded, test_dropped[0]);
+	printf("#EXP R %"PRIu32" %"PRIu32" %"PRIu32"\n", test_large_ring.id, test_large_ring.recorded, test_dropped[1]);
+	HOST_TEST_CHECK(test_small_ring.dropped == test_dropped[0], "dropped count %u, expected %u", test_small_ring.dropped, test_dropped[0]);
+
+	return HOST_TEST_RESULT();
+}
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+#
+# Runs the span_tracer_decode dump (host/tests/span_tracer_decode.c), converts its output with scripts/span_tracer_decode.py and checks the
+# trace against the "#EXP" lines of the dump: events of every ring in record order with their names, phases and exact timestamps, the uptime
+# argument, global time order, and the recorded/dropped counts with the dropped warning.
+#
+#   python3 host/tests/span_tracer_decode_check.py build/span_tracer_decode scripts/span_tracer_decode.py
+
+import json
+import subprocess
+import sys
+import tempfile
+
+PHASES = {0: "B", 1: "E", 2: "i"}
+NAMES = {0: "control loop", 1: "isr", 2: "tick"}
+
+failures = []
+
+
+def check(cond, message):
+    if not cond:
+        failures.append(message)
+
+
+def clock_str(micro_sec):
+    # written independently of the decoder: successive divisions, like the library's reference decomposition.
+    u_sec = micro_sec % 1000
+    m_sec = (micro_sec // 1000) % 1000
+    sec = (micro_sec // 1000000) % 60
+    minute = (micro_sec // 60000000) % 60
+    hour = (micro_sec // 3600000000) % 24
+    day = micro_sec // 86400000000
+    return "[%d:%d:%d:%d.%d,%d]" % (day, hour, minute, sec, m_sec, u_sec)
+
+
+def main():
+    dump_exe, decoder = sys.argv[1], sys.argv[2]
+
+    dump = subprocess.run([dump_exe], capture_output=True, text=True)
+    check(dump.returncode == 0, "dump failed:\n" + dump.stdout)
+
+    expected = {}
+    counts = {}
+    cycles_per_sec = None
+    for line in dump.stdout.splitlines():
+        fields = line.split()
+        if line.startswith("#EXP E "):
+            ring, event_type, event_id, cycles = (int(f) for f in fields[2:6])
+            expected.setdefault(ring, []).append((event_type, event_id, cycles))
+        elif line.startswith("#EXP R "):
+            counts[int(fields[2])] = (int(fields[3]), int(fields[4]))
+        elif line.startswith("#ST S "):
+            cycles_per_sec = int(fields[2])
+
+    with tempfile.NamedTemporaryFile("w+", suffix=".log") as log, tempfile.NamedTemporaryFile("w+", suffix=".json") as out:
+        log.write(dump.stdout)
+        log.flush()
+        decoded = subprocess.run([sys.executable, decoder, log.name, "-o", out.name], capture_output=True, text=True)
+        check(decoded.returncode == 0, "decoder failed: " + decoded.stderr)
+        trace = json.load(open(out.name))
+
+    events = [e for e in trace["traceEvents"] if e["ph"] != "M"]
+    threads = {e["tid"]: e["args"]["name"] for e in trace["traceEvents"] if e["ph"] == "M"}
+    check(threads == {0: "small ring", 1: "main"}, "ring names: %s" % threads)
+    check(trace["otherData"]["cycles_per_sec"] == cycles_per_sec, "cycles per second")
+
+    timestamps = [e["args"]["cycles"] for e in events]
+    check(timestamps == sorted(timestamps), "events aren't in time order")
+
+    for ring, records in sorted(expected.items()):
+        got = [e for e in events if e["tid"] == ring]
+        check(len(got) == len(records), "ring %d: %d events decoded, %d recorded" % (ring, len(got), len(records)))
+        for i, (event, (event_type, event_id, cycles)) in enumerate(zip(got, records)):
+            name = NAMES.get(event_id, "event_%d" % event_id)
+            micro_sec = (cycles * 1000000) // cycles_per_sec
+            check(event["ph"] == PHASES[event_type] and event["name"] == name,
+                  "ring %d event %d: %s %s, expected %s %s" % (ring, i, event["ph"], event["name"], PHASES[event_type], name))
+            check(event["args"]["cycles"] == cycles, "ring %d event %d: %d cycles, expected %d" % (ring, i, event["args"]["cycles"], cycles))
+            check(event["ts"] == micro_sec, "ring %d event %d: ts %d, expected %d" % (ring, i, event["ts"], micro_sec))
+            check(event["args"]["uptime"] == clock_str(micro_sec), "ring %d event %d: uptime %s" % (ring, i, event["args"]["uptime"]))
+
+    rings = trace["otherData"]["rings"]
+    for ring, (recorded, dropped) in sorted(counts.items()):
+        stat = rings.get(str(ring), {})
+        check(stat.get("recorded") == recorded and stat.get("dropped") == dropped,
+              "ring %d: recorded %s dropped %s, expected %d %d" % (ring, stat.get("recorded"), stat.get("dropped"), recorded, dropped))
+        check(len(expected.get(ring, [])) == recorded, "ring %d: %d expectations for %d recorded" % (ring, len(expected.get(ring, [])), recorded))
+    check(counts[0][1] > 0 and ("ring 0 (small ring) dropped %d events" % counts[0][1]) in decoded.stderr, "dropped warning: " + decoded.stderr)
+
+    print("%d events in %d rings, %d dropped" % (len(events), len(expected), sum(c[1] for c in counts.values())))
+    for message in failures[:20]:
+        print("check failed: " + message)
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
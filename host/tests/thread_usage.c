@@ -0,0 +1,148 @@
+/**
+ * @author Batto1
+ * @brief  Thread usage table with threads exiting: released entries are reused, lookups stay correct while entries are shifted back,
+ *         and totals follow their thread. Then the cost of a switched out / switched in pair.
+ * @note   There are no threads on the POSIX backend; fake thread pointers are switched in and out by the test like the hooks would.
+*/
+
+#include <stdint.h>
+
+#include "thread_usage.h"
+
+#include "host_test.h"
+
+#define TEST_THREADS 		(2 * THREAD_USAGE_MAX_THREADS) 	/* candidates, at most THREAD_USAGE_MAX_THREADS alive at a time */
+#define TEST_CHURN_STEPS 	200000U
+#define TEST_BENCH_THREADS 	16U
+#define TEST_BENCH_SWITCHES 	10000000U
+
+/* fake k_thread objects, only their addresses are used */
+static uint64_t test_threads[TEST_THREADS];
+
+static void Run(const void * a_thread)
+{
+	Thread_Usage_Switched_In(a_thread);
+	Thread_Usage_Switched_Out();
+}
+
+/**
+ * @brief A full table of threads exits, a new set of threads must get their own entries instead of the overflow entry.
+*/
+static void Test_Entries_Are_Reused(void)
+{
+	ThreadUsageStats stats;
+
+	Thread_Usage_Init();
+	for(uint32_t round = 0; round < 4U; round++){
+		uint32_t first = (round & 1U) * THREAD_USAGE_MAX_THREADS;
+
+		for(uint32_t t = first; t < first + THREAD_USAGE_MAX_THREADS; t++){
+			Run(&test_threads[t]);
+		}
+		for(uint32_t t = first; t < first + THREAD_USAGE_MAX_THREADS; t++){
+			HOST_TEST_CHECK(Thread_Usage_Get(&test_threads[t], &stats) == TIME_UTIL_ERROR_NONE, "round %u: thread %u isn't tracked", round, t);
+			Thread_Usage_Thread_Exited(&test_threads[t]);
+			HOST_TEST_CHECK(Thread_Usage_Get(&test_threads[t], &stats) == TIME_UTIL_ERROR_NOT_FOUND, "round %u: thread %u kept", round, t);
+		}
+	}
+}
+
+/**
+ * @brief Random switches and exits, of other threads and of the running thread itself. Alive threads are always found and their totals
+ *        never go back, exited threads are never found. Catches a stale entry pointer after entries are shifted back.
+ * @note Like on a kernel, a thread is always running: every switched out hook is followed by a switched in hook.
+*/
+static void Test_Churn(void)
+{
+	uint64_t rng = 0x9E3779B97F4A7C15ULL;
+	uint64_t last_total[TEST_THREADS] = {0};
+	bool alive[TEST_THREADS] = {false};
+	uint32_t alive_count = 1;
+	uint32_t running = 0;
+	uint32_t exits = 0;
+
+	Thread_Usage_Init();
+	alive[running] = true;
+	Thread_Usage_Switched_In(&test_threads[running]);
+
+	for(uint32_t step = 0; step < TEST_CHURN_STEPS; step++){
+		uint32_t t = (uint32_t)(Random_U64(&rng) % TEST_THREADS);
+		uint32_t action = (uint32_t)(Random_U64(&rng) % 4U);
+
+		if(alive[t] && (t != running) && (action == 0U)){
+			Thread_Usage_Thread_Exited(&test_threads[t]); 		// aborted by the running thread
+			alive[t] = false;
+			alive_count--;
+			exits++;
+		}else if(alive[t] || (alive_count < THREAD_USAGE_MAX_THREADS)){
+			if(action == 1U){
+				Thread_Usage_Thread_Exited(&test_threads[running]); 	// running thread exits, then the next one is switched in
+				alive[running] = false;
+				alive_count--;
+				exits++;
+			}
+			if(!alive[t]){
+				alive[t] = true;
+				alive_count++;
+				last_total[t] = 0;
+			}
+			Thread_Usage_Switched_Out();
+			Thread_Usage_Switched_In(&test_threads[t]);
+			running = t;
+		}
+
+		for(uint32_t c = 0; c < TEST_THREADS; c++){
+			ThreadUsageStats stats;
+			TimeAndClockErrors err = Thread_Usage_Get(&test_threads[c], &stats);
+
+			if(!alive[c]){
+				HOST_TEST_CHECK(err == TIME_UTIL_ERROR_NOT_FOUND, "step %u: exited thread %u found", step, c);
+				continue;
+			}
+			HOST_TEST_CHECK(err == TIME_UTIL_ERROR_NONE, "step %u: thread %u lost", step, c);
+			HOST_TEST_CHECK(stats.total_cycles >= last_total[c], "step %u: total of thread %u went back", step, c);
+			last_total[c] = stats.total_cycles;
+		}
+	}
+	printf("churn: %u steps, %u exits, up to %d threads in a table of %d\n", TEST_CHURN_STEPS, exits, THREAD_USAGE_MAX_THREADS, THREAD_USAGE_MAX_THREADS);
+}
+
+/**
+ * @brief ns per switch: the switched out hook of one thread and the switched in hook of the next, round robin over the threads.
+ *        Each switch reads the cycle counter twice; the cost of those reads is measured on its own and taken out for the accounting cost.
+*/
+static void Bench_Switch(void)
+{
+	Thread_Usage_Init();
+	for(uint32_t t = 0; t < TEST_BENCH_THREADS; t++){
+		Run(&test_threads[t]);
+	}
+
+	uint64_t start = Monotonic_Ns();
+	for(uint32_t i = 0; i < TEST_BENCH_SWITCHES; i++){
+		Thread_Usage_Switched_Out();
+		Thread_Usage_Switched_In(&test_threads[i % TEST_BENCH_THREADS]);
+	}
+	uint64_t ns = Monotonic_Ns() - start;
+
+	volatile uint32_t sink;
+	start = Monotonic_Ns();
+	for(uint32_t i = 0; i < TEST_BENCH_SWITCHES; i++){
+		sink = k_cycle_get_32();
+		sink = k_cycle_get_32();
+	}
+	uint64_t read_ns = Monotonic_Ns() - start;
+	(void)sink;
+
+	printf("switch: %.2f ns per switched out and switched in pair over %u threads, %.2f ns of it is the two cycle counter reads, %.2f ns the accounting\n",
+	       (double)ns / TEST_BENCH_SWITCHES, TEST_BENCH_THREADS, (double)read_ns / TEST_BENCH_SWITCHES, (double)(int64_t)(ns - read_ns) / TEST_BENCH_SWITCHES);
+}
+
+int main(void)
+{
+	Test_Entries_Are_Reused();
+	Test_Churn();
+	Bench_Switch();
+
+	return HOST_TEST_RESULT();
+}
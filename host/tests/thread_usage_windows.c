@@ -0,0 +1,159 @@
+/**
+ * @author Batto1
+ * @brief  Utilization windows and totals of thread usage with known busy spans: two threads share every sample period 75/25 then 25/75, then
+ *         one thread runs alone, then samples come late. The 1, 10 and 60 sample windows, their sample counts and the totals are exact.
+ * @note   Runs on the fake uptime library: the test sets the HW cycle counter, so spans are exact cycle counts. The counter starts just below
+ *         the 32 bit wrap, like a target's k_cycle_get_32() does sooner or later.
+*/
+
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "thread_usage.h"
+
+#include "host_test.h"
+
+#define TEST_SAMPLES 		(2U * (THREAD_USAGE_WINDOW_LONG + THREAD_USAGE_WINDOW_MEDIUM))
+
+/* fake k_thread objects, only their addresses are used */
+static uint64_t test_thread_a;
+static uint64_t test_thread_b;
+
+static uint64_t test_cycles;
+static uint64_t test_period; 				/* cycles of a sample period, a multiple of 8 so that 75% of 1.5 periods is whole */
+
+/* expected utilization of every sample taken, and the cycles each thread ran */
+static uint16_t test_expected_a[TEST_SAMPLES];
+static uint16_t test_expected_b[TEST_SAMPLES];
+static uint32_t test_sample_count;
+static uint64_t test_total_a;
+static uint64_t test_total_b;
+
+static const uint8_t test_windows[THREAD_USAGE_WINDOW_COUNT] = {THREAD_USAGE_WINDOW_SHORT, THREAD_USAGE_WINDOW_MEDIUM, THREAD_USAGE_WINDOW_LONG};
+
+static void Advance(uint64_t a_cycles)
+{
+	test_cycles += a_cycles;
+	Port_Posix_Set_Cycles(test_cycles);
+}
+
+/**
+ * @brief One sample period of a_length cycles: thread A runs a_a_cycles, then thread B the rest of it, like the switch hooks would account.
+ *        A thread with no cycles isn't switched in.
+*/
+static void Run_Period(uint64_t a_length, uint64_t a_a_cycles)
+{
+	uint64_t b_cycles = a_length - a_a_cycles;
+
+	if(a_a_cycles != 0U){
+		Thread_Usage_Switched_Out();
+		Thread_Usage_Switched_In(&test_thread_a);
+		Advance(a_a_cycles);
+	}
+	if(b_cycles != 0U){
+		Thread_Usage_Switched_Out();
+		Thread_Usage_Switched_In(&test_thread_b);
+		Advance(b_cycles);
+	}
+	Thread_Usage_Sample();
+
+	test_expected_a[test_sample_count] = (uint16_t)((a_a_cycles * THREAD_USAGE_FULL) / a_length);
+	test_expected_b[test_sample_count] = (uint16_t)((b_cycles * THREAD_USAGE_FULL) / a_length);
+	test_sample_count++;
+	test_total_a += a_a_cycles;
+	test_total_b += b_cycles;
+}
+
+/**
+ * @brief Mean of the last min(a_window, samples) expected utilizations, rounded down like the module.
+*/
+static uint16_t Expected_Window(const uint16_t * a_expected, uint32_t a_window, uint8_t * a_samples)
+{
+	uint32_t samples = MIN(MIN(a_window, test_sample_count), (uint32_t)THREAD_USAGE_HISTORY);
+	uint32_t sum = 0;
+
+	for(uint32_t i = test_sample_count - samples; i < test_sample_count; i++){
+		sum += a_expected[i];
+	}
+	* a_samples = (uint8_t)samples;
+
+	return (uint16_t)((samples != 0U) ? (sum / samples) : 0U);
+}
+
+static void Check_Thread(const char * a_name, const void * a_thread, const uint16_t * a_expected, uint64_t a_total)
+{
+	ThreadUsageStats stats;
+
+	if(Thread_Usage_Get(a_thread, &stats) != TIME_UTIL_ERROR_NONE){
+		HOST_TEST_CHECK(false, "sample %u: thread %s isn't tracked", test_sample_count, a_name);
+		return;
+	}
+	for(uint32_t w = 0; w < THREAD_USAGE_WINDOW_COUNT; w++){
+		uint8_t samples;
+		uint16_t window = Expected_Window(a_expected, test_windows[w], &samples);
+
+		HOST_TEST_CHECK((stats.window[w] == window) && (stats.window_samples[w] == samples),
+				"sample %u: thread %s window %u is %u over %u samples, expected %u over %u", test_sample_count, a_name,
+				test_windows[w], stats.window[w], stats.window_samples[w], window, samples);
+	}
+
+	// the total is floored to micro seconds, computed without the library's conversions
+	uint64_t rate = (uint64_t)sys_clock_hw_cycles_per_sec();
+	TimeDuration total_us = (TimeDuration)((a_total / rate) * TIME_DURATION_USEC_PER_SEC + ((a_total % rate) * TIME_DURATION_USEC_PER_SEC) / rate);
+
+	HOST_TEST_CHECK(stats.total_cycles == a_total, "sample %u: thread %s ran %" PRIu64 " cycles, expected %" PRIu64, test_sample_count, a_name,
+			stats.total_cycles, a_total);
+	HOST_TEST_CHECK(Clock_To_Duration(&stats.total) == total_us, "sample %u: thread %s total is %" PRId64 " us, expected %" PRId64,
+			test_sample_count, a_name, Clock_To_Duration(&stats.total), total_us);
+}
+
+static void Check_Windows(const char * a_phase, uint16_t a_a_short, uint16_t a_a_medium, uint16_t a_a_long, uint16_t a_b_long)
+{
+	ThreadUsageStats a;
+	ThreadUsageStats b;
+
+	(void)Thread_Usage_Get(&test_thread_a, &a);
+	(void)Thread_Usage_Get(&test_thread_b, &b);
+	HOST_TEST_CHECK((a.window[0] == a_a_short) && (a.window[1] == a_a_medium) && (a.window[2] == a_a_long),
+			"%s: thread A windows %u %u %u, expected %u %u %u", a_phase, a.window[0], a.window[1], a.window[2], a_a_short, a_a_medium, a_a_long);
+	HOST_TEST_CHECK((b.window[0] == THREAD_USAGE_FULL - a_a_short) && (b.window[1] == THREAD_USAGE_FULL - a_a_medium) && (b.window[2] == a_b_long),
+			"%s: thread B windows %u %u %u, expected %u %u %u", a_phase, b.window[0], b.window[1], b.window[2],
+			THREAD_USAGE_FULL - a_a_short, THREAD_USAGE_FULL - a_a_medium, a_b_long);
+}
+
+static void Run_Periods(uint32_t a_count, uint64_t a_length, uint64_t a_a_cycles)
+{
+	for(uint32_t i = 0; i < a_count; i++){
+		Run_Period(a_length, a_a_cycles);
+		Check_Thread("A", &test_thread_a, test_expected_a, test_total_a);
+		Check_Thread("B", &test_thread_b, test_expected_b, test_total_b);
+	}
+}
+
+int main(void)
+{
+	// a sample period of THREAD_USAGE_SAMPLE_PERIOD_MS, small enough that a late sample of 1.5 periods fits 32 bits
+	test_period = ((uint64_t)sys_clock_hw_cycles_per_sec() * THREAD_USAGE_SAMPLE_PERIOD_MS) / 1000U;
+	test_period = MIN(test_period, (uint64_t)(UINT32_MAX / 2U)) & ~(uint64_t)7U;
+	test_cycles = (uint64_t)UINT32_MAX - (test_period / 2U);
+	Port_Posix_Set_Cycles(test_cycles);
+	Thread_Usage_Init();
+
+	// 75/25 until the history is full: every window is 75%/25%
+	Run_Periods(THREAD_USAGE_WINDOW_LONG, test_period, (test_period * 3U) / 4U);
+	Check_Windows("75/25", 7500U, 7500U, 7500U, 2500U);
+
+	// 25/75 for the medium window: short and medium windows are 25%/75%, the long one 50 samples of 75% and 10 of 25%
+	Run_Periods(THREAD_USAGE_WINDOW_MEDIUM, test_period, test_period / 4U);
+	Check_Windows("25/75", 2500U, 2500U, 6666U, 3333U);
+
+	// thread A alone: B gets no cycles and its total stops; the long window is 40 samples of 75%, 10 of 25% and 10 of 100%
+	Run_Periods(THREAD_USAGE_WINDOW_MEDIUM, test_period, test_period);
+	Check_Windows("A alone", 10000U, 10000U, 7083U, 2916U);
+
+	// a long window of samples 1.5 periods apart: utilization is relative to the time between samples, not the nominal period
+	Run_Periods(TEST_SAMPLES - test_sample_count, test_period + (test_period / 2U), ((test_period + (test_period / 2U)) * 3U) / 4U);
+	Check_Windows("late samples", 7500U, 7500U, 7500U, 2500U);
+
+	return HOST_TEST_RESULT();
+}
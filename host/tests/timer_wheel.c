@@ -0,0 +1,363 @@
+/**
+ * @author Batto1
+ * @brief  Timer wheel under random arm, cancel and advance calls: every timer fires exactly once per arm, inside [expiry, expiry + slack].
+ *         Then 10k timers against a model of k_timer: cancel + arm cost, and wakeups over 10 simulated minutes at several slacks.
+ * @note   k_timer can't run on the host. Its model is the kernel timeout list: a sorted delta list, inserted into by walking from the head.
+ *         The kernel expires all timeouts of a tick in one announcement, so the model takes one wakeup per distinct deadline tick.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "timer_wheel.h"
+
+#include "host_test.h"
+
+#define TEST_TIMERS 		2000U
+#define TEST_OPERATIONS 	200000U
+#define TEST_BENCH_TIMERS 	10000U
+#define TEST_BENCH_ARMS 	1000000U
+#define TEST_BENCH_LIST_ARMS 	10000U
+#define TEST_SIM_TICKS 		(600 * (int64_t)CONFIG_SYS_CLOCK_TICKS_PER_SEC) 	/* 10 minutes */
+
+#define MS_TO_TICKS(a_ms) 	(((int64_t)(a_ms) * CONFIG_SYS_CLOCK_TICKS_PER_SEC) / 1000)
+
+/**
+ * @brief A timer and what the test expects of it.
+*/
+typedef struct testTimer{
+	TimerWheelTimer 	timer;
+	int64_t 		expiry;
+	int64_t 		latest; 	/* last tick it may fire at */
+	uint32_t 		slack;
+	bool 			armed;
+	uint64_t 		rng; 		/* timeouts of this timer, the same sequence as in the k_timer model */
+	uint32_t 		fired;
+	uint64_t 		lateness; 	/* sum of fire tick - expiry */
+}TestTimer;
+
+/**
+ * @brief A timeout of the k_timer model: node of the sorted delta list.
+*/
+typedef struct listTimeout{
+	struct listTimeout * 	next;
+	struct listTimeout * 	prev;
+	int64_t 		delta; 		/* ticks after the previous timeout, the first one after now */
+}ListTimeout;
+
+static TimerWheel wheel;
+static TestTimer test_timers[TEST_BENCH_TIMERS];
+static int64_t advance_now;
+static uint64_t handler_rng = 0x0F1E2D3C4B5A6978ULL;
+static bool handler_churn; 		/* handlers cancel and re-arm other timers too */
+
+static ListTimeout list_head; 		/* sentinel */
+static ListTimeout list_timeouts[TEST_BENCH_TIMERS];
+
+/**
+ * @brief 1 to 30 s, the per connection timeouts of the benchmark.
+*/
+static int64_t Random_Timeout(uint64_t * a_rng)
+{
+	return MS_TO_TICKS(1000) + (int64_t)(Random_U64(a_rng) % (uint64_t)MS_TO_TICKS(29000));
+}
+
+static void Arm(TestTimer * a_timer, int64_t a_expiry, uint32_t a_slack)
+{
+	// a deadline that has passed fires at the first tick not processed yet
+	a_timer->expiry = a_expiry;
+	a_timer->slack  = a_slack;
+	a_timer->latest = MAX(a_expiry + (int64_t)a_slack, wheel.current);
+	a_timer->armed  = true;
+	Timer_Wheel_Arm(&wheel, &a_timer->timer, a_expiry, a_slack);
+}
+
+static void Cancel(TestTimer * a_timer)
+{
+	HOST_TEST_CHECK(Timer_Wheel_Cancel(&wheel, &a_timer->timer) == a_timer->armed, "cancel of timer %td", a_timer - test_timers);
+	a_timer->armed = false;
+}
+
+/**
+ * @brief Checks the fire tick, then cancels and re-arms random timers in the random test, or re-arms itself with its next timeout in the
+ *        simulation.
+*/
+static void Handler(TimerWheelTimer * a_timer, int64_t a_now_ticks)
+{
+	TestTimer * timer = CONTAINER_OF(a_timer, TestTimer, timer);
+
+	HOST_TEST_CHECK(timer->armed, "timer %td fired twice or after a cancel", timer - test_timers);
+	HOST_TEST_CHECK((a_now_ticks >= timer->expiry) && (a_now_ticks <= timer->latest) && (a_now_ticks <= advance_now),
+			"timer %td fired at %" PRId64 ", expiry %" PRId64 " slack %u", timer - test_timers, a_now_ticks, timer->expiry, timer->slack);
+	HOST_TEST_CHECK(!Timer_Wheel_Timer_Is_Armed(a_timer), "timer %td armed in its handler", timer - test_timers);
+	timer->armed     = false;
+	timer->fired++;
+	timer->lateness += (uint64_t)(a_now_ticks - timer->expiry);
+
+	if(!handler_churn){
+		Arm(timer, a_now_ticks + Random_Timeout(&timer->rng), timer->slack);
+		return;
+	}
+
+	uint64_t r = Random_U64(&handler_rng);
+
+	if((r % 4U) == 0U){
+		Cancel(&test_timers[(r >> 8) % TEST_TIMERS]);
+	}
+	if((r % 3U) == 0U){
+		Arm(&test_timers[(r >> 24) % TEST_TIMERS], a_now_ticks + (int64_t)((r >> 40) % 5000U) - 100, (uint32_t)((r >> 56) % 64U));
+	}
+	if((r % 5U) == 0U){
+		Arm(timer, a_now_ticks + (int64_t)((r >> 32) % 200U), 0U);
+	}
+}
+
+/**
+ * @brief Every armed timer is armed in the wheel and hasn't passed the last tick it may fire at.
+*/
+static void Check_Armed(uint32_t a_timers)
+{
+	uint32_t armed = 0;
+
+	for(uint32_t t = 0; t < a_timers; t++){
+		HOST_TEST_CHECK(Timer_Wheel_Timer_Is_Armed(&test_timers[t].timer) == test_timers[t].armed, "timer %u armed", t);
+		if(test_timers[t].armed){
+			armed++;
+			HOST_TEST_CHECK(test_timers[t].latest > advance_now, "timer %u missed: latest %" PRId64 ", wheel advanced to %" PRId64, t,
+					test_timers[t].latest, advance_now);
+		}
+	}
+	HOST_TEST_CHECK(wheel.armed_count == armed, "armed count %u, expected %u", wheel.armed_count, armed);
+}
+
+/**
+ * @brief Random arms (passed deadlines, every level, parked beyond the range), re-arms, cancels, and advances of 0 ticks to twice the range;
+ *        handlers cancel and arm other timers and re-arm themselves.
+*/
+static void Test_Random_Operations(void)
+{
+	uint64_t rng = 0x9E3779B97F4A7C15ULL;
+	uint32_t fired = 0;
+
+	Timer_Wheel_Init(&wheel, 1000);
+	advance_now   = 999;
+	handler_churn = true;
+	for(uint32_t t = 0; t < TEST_TIMERS; t++){
+		Timer_Wheel_Timer_Init(&test_timers[t].timer, Handler);
+		test_timers[t].armed = false;
+		test_timers[t].fired = 0;
+	}
+
+	for(uint32_t op = 0; op < TEST_OPERATIONS; op++){
+		TestTimer * timer = &test_timers[Random_U64(&rng) % TEST_TIMERS];
+		uint64_t r = Random_U64(&rng);
+
+		switch(r % 8U){
+		case 0:
+		case 1:
+		case 2: {
+			// log uniform distance from -64 to 2^32 ticks, slack 0 to 2^20 ticks
+			int64_t distance = (int64_t)(Random_U64(&rng) >> (32U + ((r >> 8) % 32U))) - 64;
+			uint32_t slack   = ((r >> 16) % 2U == 0U) ? 0U : (uint32_t)(Random_U64(&rng) >> (44U + ((r >> 24) % 20U)));
+
+			Arm(timer, advance_now + distance, slack);
+			break;
+		}
+		case 3:
+			Cancel(timer);
+			break;
+		default: {
+			int64_t step = (int64_t)(Random_U64(&rng) >> (33U + ((r >> 8) % 31U)));
+
+			advance_now += step;
+			fired += Timer_Wheel_Advance(&wheel, advance_now);
+			Check_Armed(TEST_TIMERS);
+			break;
+		}
+		}
+	}
+
+	// run every timer out
+	while(wheel.armed_count != 0U){
+		advance_now = Timer_Wheel_Next_Event(&wheel);
+		fired += Timer_Wheel_Advance(&wheel, advance_now);
+	}
+	Check_Armed(TEST_TIMERS);
+
+	uint32_t handled = 0;
+	for(uint32_t t = 0; t < TEST_TIMERS; t++){
+		handled += test_timers[t].fired;
+	}
+	HOST_TEST_CHECK(handled == fired, "%u handler calls, %u expiries counted by the wheel", handled, fired);
+	printf("random: %u operations, %u expiries, %u cascades, wheel advanced to %" PRId64 " ticks\n", TEST_OPERATIONS, fired, wheel.cascades, advance_now);
+}
+
+/**
+ * @brief Inserts a timeout a_ticks from now, walking from the head like the kernel's timeout list.
+*/
+static void List_Add(ListTimeout * a_timeout, int64_t a_ticks)
+{
+	ListTimeout * node = list_head.next;
+
+	while((node != &list_head) && (a_ticks >= node->delta)){
+		a_ticks -= node->delta;
+		node = node->next;
+	}
+	if(node != &list_head){
+		node->delta -= a_ticks;
+	}
+	a_timeout->delta      = a_ticks;
+	a_timeout->next       = node;
+	a_timeout->prev       = node->prev;
+	node->prev->next      = a_timeout;
+	node->prev            = a_timeout;
+}
+
+static void List_Remove(ListTimeout * a_timeout)
+{
+	if(a_timeout->next != &list_head){
+		a_timeout->next->delta += a_timeout->delta;
+	}
+	a_timeout->prev->next = a_timeout->next;
+	a_timeout->next->prev = a_timeout->prev;
+}
+
+static void List_Init(uint64_t * a_rng)
+{
+	list_head.next = &list_head;
+	list_head.prev = &list_head;
+	for(uint32_t t = 0; t < TEST_BENCH_TIMERS; t++){
+		List_Add(&list_timeouts[t], Random_Timeout(a_rng));
+	}
+}
+
+/**
+ * @brief 10 simulated minutes of the k_timer model, every timeout re-armed with its next timeout when it expires. A timeout's deadlines don't
+ *        depend on the other timeouts, so instead of running ~400k insertions through the delta list (each walking ~5k timeouts), the deadlines
+ *        of every timeout are marked on a tick bitmap: the model's wakeups are the distinct deadline ticks.
+ * @retval wakeups, one per announced tick with expiring timeouts. a_expiries is set to the timeouts expired.
+*/
+static uint32_t List_Simulate(uint32_t * a_expiries)
+{
+	static uint64_t deadline_ticks[(TEST_SIM_TICKS / 64) + 1];
+	uint32_t wakeups = 0;
+
+	* a_expiries = 0;
+	memset(deadline_ticks, 0, sizeof(deadline_ticks));
+	for(uint32_t t = 0; t < TEST_BENCH_TIMERS; t++){
+		uint64_t rng = 0x1234567887654321ULL + t;
+
+		for(int64_t deadline = Random_Timeout(&rng); deadline <= TEST_SIM_TICKS; deadline += Random_Timeout(&rng)){
+			deadline_ticks[deadline / 64] |= BIT64(deadline % 64);
+			(* a_expiries)++;
+		}
+	}
+	for(size_t i = 0; i < sizeof(deadline_ticks) / sizeof(deadline_ticks[0]); i++){
+		wakeups += (uint32_t)__builtin_popcountll(deadline_ticks[i]);
+	}
+
+	return wakeups;
+}
+
+/**
+ * @brief 10 simulated minutes of the wheel driven from its next event, the same timeouts as the list model.
+*/
+static void Wheel_Simulate(uint32_t a_slack_ms, uint32_t a_list_wakeups, uint32_t a_list_expiries)
+{
+	uint32_t expiries = 0;
+	uint32_t cascade_only = 0;
+	uint64_t lateness = 0;
+	uint32_t slack = (uint32_t)MS_TO_TICKS(a_slack_ms);
+
+	Timer_Wheel_Init(&wheel, 0);
+	advance_now   = 0;
+	handler_churn = false;
+	for(uint32_t t = 0; t < TEST_BENCH_TIMERS; t++){
+		TestTimer * timer = &test_timers[t];
+
+		Timer_Wheel_Timer_Init(&timer->timer, Handler);
+		timer->rng      = 0x1234567887654321ULL + t;
+		timer->fired    = 0;
+		timer->lateness = 0;
+		Arm(timer, Random_Timeout(&timer->rng), slack);
+	}
+
+	for(advance_now = Timer_Wheel_Next_Event(&wheel); advance_now <= TEST_SIM_TICKS; advance_now = Timer_Wheel_Next_Event(&wheel)){
+		uint32_t fired = Timer_Wheel_Advance(&wheel, advance_now);
+
+		expiries     += fired;
+		cascade_only += (fired == 0U);
+	}
+	for(uint32_t t = 0; t < TEST_BENCH_TIMERS; t++){
+		lateness += test_timers[t].lateness;
+	}
+
+	if(slack == 0U){
+		// same deadlines as the list model: same expiries, and every tick the list takes a wakeup at fires timers of the wheel
+		HOST_TEST_CHECK(expiries == a_list_expiries, "%u expiries, the list model has %u", expiries, a_list_expiries);
+		HOST_TEST_CHECK(wheel.wakeups - cascade_only == a_list_wakeups, "%u wakeups fire timers, the list model has %u", wheel.wakeups - cascade_only,
+				a_list_wakeups);
+	}
+	printf("wheel, slack %3u ms: %6u wakeups (%5u cascade only), %u expiries, mean lateness %.2f ms\n", a_slack_ms, wheel.wakeups, cascade_only,
+	       expiries, (expiries != 0U) ? (1000.0 * (double)lateness) / ((double)expiries * CONFIG_SYS_CLOCK_TICKS_PER_SEC) : 0.0);
+}
+
+static void Test_Wakeups(void)
+{
+	static const uint32_t slacks_ms[] = {0U, 1U, 10U, 100U, 500U};
+	uint32_t list_expiries;
+	uint32_t list_wakeups = List_Simulate(&list_expiries);
+
+	printf("wakeups over 10 simulated minutes, %u timers re-armed 1-30 s on expiry\n", TEST_BENCH_TIMERS);
+	printf("k_timer model:      %6u wakeups, %u expiries\n", list_wakeups, list_expiries);
+	for(size_t s = 0; s < sizeof(slacks_ms) / sizeof(slacks_ms[0]); s++){
+		Wheel_Simulate(slacks_ms[s], list_wakeups, list_expiries);
+	}
+}
+
+/**
+ * @brief Cancel + arm of a random timer at a new 1-30 s deadline among 10k armed timers, the per connection timeout refresh.
+*/
+static void Bench_Cancel_Arm(void)
+{
+	uint64_t rng = 0x0123456789ABCDEFULL;
+
+	Timer_Wheel_Init(&wheel, 0);
+	for(uint32_t t = 0; t < TEST_BENCH_TIMERS; t++){
+		Timer_Wheel_Timer_Init(&test_timers[t].timer, Handler);
+		Timer_Wheel_Arm(&wheel, &test_timers[t].timer, Random_Timeout(&rng), 0U);
+	}
+
+	uint64_t start = Monotonic_Ns();
+	for(uint32_t i = 0; i < TEST_BENCH_ARMS; i++){
+		TimerWheelTimer * timer = &test_timers[Random_U64(&rng) % TEST_BENCH_TIMERS].timer;
+
+		(void)Timer_Wheel_Cancel(&wheel, timer);
+		Timer_Wheel_Arm(&wheel, timer, Random_Timeout(&rng), 0U);
+	}
+	uint64_t wheel_ns = Monotonic_Ns() - start;
+	HOST_TEST_CHECK(wheel.armed_count == TEST_BENCH_TIMERS, "armed count %u", wheel.armed_count);
+
+	List_Init(&rng);
+	start = Monotonic_Ns();
+	for(uint32_t i = 0; i < TEST_BENCH_LIST_ARMS; i++){
+		ListTimeout * timeout = &list_timeouts[Random_U64(&rng) % TEST_BENCH_TIMERS];
+
+		List_Remove(timeout);
+		List_Add(timeout, Random_Timeout(&rng));
+	}
+	uint64_t list_ns = Monotonic_Ns() - start;
+
+	printf("cancel + arm with %u armed timers: wheel %.1f ns, k_timer model %.0f ns\n", TEST_BENCH_TIMERS, (double)wheel_ns / TEST_BENCH_ARMS,
+	       (double)list_ns / TEST_BENCH_LIST_ARMS);
+}
+
+int main(void)
+{
+	Test_Random_Operations();
+	Test_Wakeups();
+	Bench_Cancel_Arm();
+
+	return HOST_TEST_RESULT();
+}
@@ -0,0 +1,301 @@
+/**
+ * @author Batto1
+ * @brief  Timestamp codec round trips of periodic, jittered, bursty and wide gap sequences at several block sizes, seeks by sample and by
+ *         timestamp, the stream decoded after every append and a full buffer or index. Then compression ratio and encode / decode MB/s.
+ * @note   MB/s is of 8 byte ticks: input of the encoder, output of the decoder. Ratios are against 8 byte ticks and 12 byte clocks, the seek
+ *         index included.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "timestamp_codec.h"
+
+#include "host_test.h"
+
+#define TEST_SAMPLES 		200000U
+#define TEST_SEEKS 		20000U
+#define TEST_INCREMENTAL 	300U
+#define TEST_BENCH_SAMPLES 	1000000U
+#define TEST_BENCH_ROUNDS 	5U
+
+typedef enum{
+	PATTERN_PERIODIC, 	/* every 100 ticks */
+	PATTERN_JITTERED, 	/* every 100 +-3 ticks */
+	PATTERN_BURSTY, 	/* bursts of 16 samples 1-2 ticks apart, 500-50500 ticks between bursts */
+	PATTERN_WIDE, 		/* repeated samples and gaps of every code size up to 2^44 ticks, one gap of 2^60 ticks */
+	PATTERN_COUNT,
+}TestPattern;
+
+static const char * const pattern_names[PATTERN_COUNT] = { "periodic", "jittered", "bursty", "wide" };
+
+static void Make_Samples(TestPattern a_pattern, int64_t * a_ticks, uint32_t a_count)
+{
+	uint64_t rng = 0x9E3779B97F4A7C15ULL + (uint64_t)a_pattern;
+	int64_t ticks = (a_pattern == PATTERN_WIDE) ? -(int64_t)BIT64(62) : 123456;
+
+	for(uint32_t i = 0; i < a_count; i++){
+		a_ticks[i] = ticks;
+		switch(a_pattern){
+		case PATTERN_PERIODIC:
+			ticks += 100;
+			break;
+		case PATTERN_JITTERED:
+			ticks += 97 + (int64_t)(Random_U64(&rng) % 7U);
+			break;
+		case PATTERN_BURSTY:
+			ticks += ((i % 16U) != 15U) ? 1 + (int64_t)(Random_U64(&rng) % 2U) : 500 + (int64_t)(Random_U64(&rng) % 50001U);
+			break;
+		default:
+			// 0 to 2^44 - 1 ticks, log uniform: repeats and every code size; the 64 bit escape once
+			ticks += (int64_t)(Random_U64(&rng) >> (20U + (Random_U64(&rng) % 44U)));
+			ticks += (i == (a_count / 2U)) ? (int64_t)BIT64(60) : 0;
+			break;
+		}
+	}
+}
+
+static bool Clocks_Equal(const TimeElapsedClock * a_a, const TimeElapsedClock * a_b)
+{
+	return (a_a->day == a_b->day) && (a_a->hour == a_b->hour) && (a_a->min == a_b->min) && (a_a->sec == a_b->sec) && (a_a->m_sec == a_b->m_sec) &&
+	       (a_a->u_sec == a_b->u_sec);
+}
+
+/**
+ * @brief Index of the first sample not smaller than a_ticks, a_count if there is none.
+*/
+static uint32_t Lower_Bound(const int64_t * a_ticks, uint32_t a_count, int64_t a_target)
+{
+	uint32_t low = 0;
+	uint32_t high = a_count;
+
+	while(low < high){
+		uint32_t mid = low + ((high - low) / 2U);
+
+		if(a_ticks[mid] < a_target){
+			low = mid + 1U;
+		}else{
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+/**
+ * @brief Encodes a pattern, decodes it whole as ticks and as clocks, then seeks to random samples and timestamps, with and without the index.
+*/
+static void Test_Round_Trip(TestPattern a_pattern, uint32_t a_block_samples)
+{
+	static int64_t samples[TEST_SAMPLES];
+	static int64_t decoded[TEST_SAMPLES];
+	static TimeElapsedClock clocks[TEST_SAMPLES];
+	static uint8_t buf[TEST_SAMPLES * 13U];
+	static uint32_t index[TEST_SAMPLES];
+	const char * name = pattern_names[a_pattern];
+	uint64_t rng = 0x0123456789ABCDEFULL;
+	TimestampEncoder enc;
+	TimestampDecoder dec;
+
+	Make_Samples(a_pattern, samples, TEST_SAMPLES);
+	Timestamp_Encoder_Init(&enc, buf, sizeof(buf), index, TIMESTAMP_CODEC_INDEX_SIZE(TEST_SAMPLES, a_block_samples), a_block_samples);
+	for(uint32_t i = 0; i < TEST_SAMPLES; i++){
+		HOST_TEST_CHECK(Timestamp_Encoder_Append(&enc, samples[i]) == TIME_UTIL_ERROR_NONE, "%s, %u per block: append %u", name, a_block_samples, i);
+	}
+
+	Timestamp_Decoder_Init_From_Encoder(&dec, &enc);
+	HOST_TEST_CHECK(Timestamp_Decoder_Read_Ticks(&dec, decoded, TEST_SAMPLES + 1U) == TEST_SAMPLES, "%s: samples read", name);
+	for(uint32_t i = 0; i < TEST_SAMPLES; i++){
+		HOST_TEST_CHECK(decoded[i] == samples[i], "%s, %u per block: sample %u is %" PRId64 ", encoded %" PRId64, name, a_block_samples, i,
+				decoded[i], samples[i]);
+	}
+	HOST_TEST_CHECK(Timestamp_Decoder_Read_Ticks(&dec, decoded, 1U) == 0U, "%s: read past the end", name);
+
+	if(samples[0] >= 0){
+		Timestamp_Decoder_Init_From_Encoder(&dec, &enc);
+		HOST_TEST_CHECK(Timestamp_Decoder_Read_Clock(&dec, clocks, TEST_SAMPLES) == TEST_SAMPLES, "%s: clocks read", name);
+		for(uint32_t i = 0; i < TEST_SAMPLES; i++){
+			TimeElapsedClock expected = Ticks_To_Clock_Time(samples[i]);
+
+			HOST_TEST_CHECK(Clocks_Equal(&clocks[i], &expected), "%s, %u per block: clock of sample %u", name, a_block_samples, i);
+		}
+	}
+
+	for(int with_index = 1; with_index >= 0; with_index--){
+		Timestamp_Decoder_Init(&dec, buf, Timestamp_Encoder_Size(&enc), with_index ? index : NULL, a_block_samples, enc.count);
+		for(uint32_t s = 0; s < (with_index ? TEST_SEEKS : TEST_SEEKS / 1000U); s++){
+			uint32_t sample = (uint32_t)(Random_U64(&rng) % TEST_SAMPLES);
+			size_t n = MIN(TEST_SAMPLES - sample, 3U);
+
+			HOST_TEST_CHECK(Timestamp_Decoder_Seek(&dec, sample) == TIME_UTIL_ERROR_NONE, "%s: seek to %u", name, sample);
+			HOST_TEST_CHECK(Timestamp_Decoder_Read_Ticks(&dec, decoded, n) == n, "%s: read after seek to %u", name, sample);
+			for(size_t i = 0; i < n; i++){
+				HOST_TEST_CHECK(decoded[i] == samples[sample + i], "%s, %u per block, index %d: sample %zu after seek to %u", name, a_block_samples,
+						with_index, sample + i, sample);
+			}
+
+			// anywhere from a bit before the first sample to a bit after the last, often right on a sample
+			int64_t span = samples[TEST_SAMPLES - 1U] - samples[0];
+			int64_t target = ((s & 1U) != 0U) ? samples[sample] :
+					 samples[0] - 10 + (int64_t)(Random_U64(&rng) % ((uint64_t)span + 21U));
+			uint32_t expected = Lower_Bound(samples, TEST_SAMPLES, target);
+			TimeAndClockErrors err = Timestamp_Decoder_Seek_Ticks(&dec, target);
+
+			if(expected == TEST_SAMPLES){
+				HOST_TEST_CHECK(err == TIME_UTIL_ERROR_RANGE, "%s: seek to %" PRId64 " after the last sample", name, target);
+				continue;
+			}
+			HOST_TEST_CHECK(err == TIME_UTIL_ERROR_NONE, "%s: seek to %" PRId64, name, target);
+			HOST_TEST_CHECK(dec.position == expected, "%s, %u per block, index %d: seek to %" PRId64 " gives sample %u, expected %u", name,
+					a_block_samples, with_index, target, dec.position, expected);
+			HOST_TEST_CHECK((Timestamp_Decoder_Read_Ticks(&dec, decoded, 1U) == 1U) && (decoded[0] == samples[expected]),
+					"%s: sample read after seek to %" PRId64, name, target);
+		}
+		HOST_TEST_CHECK(Timestamp_Decoder_Seek(&dec, TEST_SAMPLES) == TIME_UTIL_ERROR_RANGE, "%s: seek past the end", name);
+	}
+}
+
+/**
+ * @brief The stream in the buffer decodes to every sample appended so far, after each append.
+*/
+static void Test_Decodable_After_Every_Append(void)
+{
+	int64_t samples[TEST_INCREMENTAL];
+	int64_t decoded[TEST_INCREMENTAL];
+	uint8_t buf[TEST_INCREMENTAL * 13U];
+	uint32_t index[TIMESTAMP_CODEC_INDEX_SIZE(TEST_INCREMENTAL, 7U)];
+	TimestampEncoder enc;
+	TimestampDecoder dec;
+
+	Make_Samples(PATTERN_WIDE, samples, TEST_INCREMENTAL);
+	Timestamp_Encoder_Init(&enc, buf, sizeof(buf), index, sizeof(index) / sizeof(index[0]), 7U);
+	for(uint32_t i = 0; i < TEST_INCREMENTAL; i++){
+		HOST_TEST_CHECK(Timestamp_Encoder_Append(&enc, samples[i]) == TIME_UTIL_ERROR_NONE, "append %u", i);
+
+		Timestamp_Decoder_Init_From_Encoder(&dec, &enc);
+		HOST_TEST_CHECK(Timestamp_Decoder_Read_Ticks(&dec, decoded, TEST_INCREMENTAL) == i + 1U, "samples read after append %u", i);
+		HOST_TEST_CHECK(memcmp(decoded, samples, (i + 1U) * sizeof(samples[0])) == 0, "stream after append %u", i);
+	}
+}
+
+/**
+ * @brief A decreasing timestamp, a full buffer and a full index are refused and leave the encoder and its stream as they were.
+*/
+static void Test_Refused_Appends(void)
+{
+	int64_t samples[TEST_INCREMENTAL];
+	int64_t decoded[TEST_INCREMENTAL];
+	uint8_t buf[64];
+	uint32_t index[3];
+	TimestampEncoder enc;
+	TimestampEncoder saved;
+	TimestampDecoder dec;
+	uint32_t count;
+
+	Make_Samples(PATTERN_JITTERED, samples, TEST_INCREMENTAL);
+
+	// buffer full: whichever block or code size the refused sample needed
+	for(uint32_t block_samples = 1; block_samples <= 40U; block_samples++){
+		Timestamp_Encoder_Init(&enc, buf, sizeof(buf), NULL, 0, block_samples);
+		for(count = 0; count < TEST_INCREMENTAL; count++){
+			saved = enc;
+			if(Timestamp_Encoder_Append(&enc, samples[count]) != TIME_UTIL_ERROR_NONE){
+				break;
+			}
+		}
+		HOST_TEST_CHECK((count < TEST_INCREMENTAL) && (memcmp(&enc, &saved, sizeof(enc)) == 0), "%u per block: full buffer", block_samples);
+		HOST_TEST_CHECK(Timestamp_Encoder_Append(&enc, samples[count]) == TIME_UTIL_ERROR_RANGE, "%u per block: full buffer", block_samples);
+		HOST_TEST_CHECK(Timestamp_Encoder_Size(&enc) <= sizeof(buf), "%u per block: %zu bytes written", block_samples, Timestamp_Encoder_Size(&enc));
+
+		Timestamp_Decoder_Init_From_Encoder(&dec, &enc);
+		HOST_TEST_CHECK((Timestamp_Decoder_Read_Ticks(&dec, decoded, TEST_INCREMENTAL) == count) &&
+				(memcmp(decoded, samples, count * sizeof(samples[0])) == 0), "%u per block: stream of a full buffer", block_samples);
+	}
+
+	// index full
+	Timestamp_Encoder_Init(&enc, buf, sizeof(buf), index, 3U, 4U);
+	for(count = 0; count < 12U; count++){
+		HOST_TEST_CHECK(Timestamp_Encoder_Append(&enc, samples[count]) == TIME_UTIL_ERROR_NONE, "append %u", count);
+	}
+	saved = enc;
+	HOST_TEST_CHECK(Timestamp_Encoder_Append(&enc, samples[count]) == TIME_UTIL_ERROR_RANGE, "full index");
+	HOST_TEST_CHECK(memcmp(&enc, &saved, sizeof(enc)) == 0, "encoder changed by a refused append");
+
+	// decreasing, in and at the start of a block
+	HOST_TEST_CHECK(Timestamp_Encoder_Append(&enc, samples[count - 1U] - 1) == TIME_UTIL_ERROR_NEGATIVE, "decreasing at a block start");
+	Timestamp_Encoder_Init(&enc, buf, sizeof(buf), index, 3U, 4U);
+	(void)Timestamp_Encoder_Append(&enc, 1000);
+	saved = enc;
+	HOST_TEST_CHECK(Timestamp_Encoder_Append(&enc, 999) == TIME_UTIL_ERROR_NEGATIVE, "decreasing in a block");
+	HOST_TEST_CHECK(memcmp(&enc, &saved, sizeof(enc)) == 0, "encoder changed by a refused append");
+	HOST_TEST_CHECK(Timestamp_Encoder_Append(&enc, 1000) == TIME_UTIL_ERROR_NONE, "repeated timestamp");
+}
+
+static double Mb_Per_Sec(uint64_t a_ns)
+{
+	return ((double)TEST_BENCH_SAMPLES * sizeof(int64_t) * 1000.0) / (double)a_ns;
+}
+
+/**
+ * @brief Size and speed of every pattern with the default block size, fastest of TEST_BENCH_ROUNDS runs.
+*/
+static void Bench_Codec(void)
+{
+	static int64_t samples[TEST_BENCH_SAMPLES];
+	static int64_t decoded[TEST_BENCH_SAMPLES];
+	static TimeElapsedClock clocks[TEST_BENCH_SAMPLES];
+	static uint8_t buf[TEST_BENCH_SAMPLES * 13U];
+	static uint32_t index[TIMESTAMP_CODEC_INDEX_SIZE(TEST_BENCH_SAMPLES, TIMESTAMP_CODEC_DEFAULT_BLOCK_SAMPLES)];
+
+	for(TestPattern pattern = 0; pattern < PATTERN_WIDE; pattern++){
+		uint64_t encode_ns = UINT64_MAX;
+		uint64_t decode_ns = UINT64_MAX;
+		uint64_t clock_ns  = UINT64_MAX;
+		TimestampEncoder enc;
+		TimestampDecoder dec;
+
+		Make_Samples(pattern, samples, TEST_BENCH_SAMPLES);
+		for(uint32_t round = 0; round < TEST_BENCH_ROUNDS; round++){
+			uint64_t start = Monotonic_Ns();
+			Timestamp_Encoder_Init(&enc, buf, sizeof(buf), index, sizeof(index) / sizeof(index[0]), TIMESTAMP_CODEC_DEFAULT_BLOCK_SAMPLES);
+			for(uint32_t i = 0; i < TEST_BENCH_SAMPLES; i++){
+				(void)Timestamp_Encoder_Append(&enc, samples[i]);
+			}
+			encode_ns = MIN(encode_ns, Monotonic_Ns() - start);
+
+			start = Monotonic_Ns();
+			Timestamp_Decoder_Init_From_Encoder(&dec, &enc);
+			(void)Timestamp_Decoder_Read_Ticks(&dec, decoded, TEST_BENCH_SAMPLES);
+			decode_ns = MIN(decode_ns, Monotonic_Ns() - start);
+
+			start = Monotonic_Ns();
+			Timestamp_Decoder_Init_From_Encoder(&dec, &enc);
+			(void)Timestamp_Decoder_Read_Clock(&dec, clocks, TEST_BENCH_SAMPLES);
+			clock_ns = MIN(clock_ns, Monotonic_Ns() - start);
+		}
+		HOST_TEST_CHECK(memcmp(decoded, samples, sizeof(samples)) == 0, "%s: benchmark stream", pattern_names[pattern]);
+
+		double bytes = (double)Timestamp_Encoder_Size(&enc) + sizeof(index);
+
+		printf("%s: %.2f bits per sample, %.1fx of ticks, %.1fx of clocks; encode %.0f MB/s, decode %.0f MB/s (clocks %.0f MB/s)\n",
+		       pattern_names[pattern], (bytes * 8.0) / TEST_BENCH_SAMPLES, (8.0 * TEST_BENCH_SAMPLES) / bytes, (12.0 * TEST_BENCH_SAMPLES) / bytes,
+		       Mb_Per_Sec(encode_ns), Mb_Per_Sec(decode_ns), Mb_Per_Sec(clock_ns));
+	}
+}
+
+int main(void)
+{
+	static const uint32_t block_sizes[] = {1U, 2U, 7U, TIMESTAMP_CODEC_DEFAULT_BLOCK_SAMPLES, 1000U};
+
+	for(TestPattern pattern = 0; pattern < PATTERN_COUNT; pattern++){
+		for(size_t b = 0; b < sizeof(block_sizes) / sizeof(block_sizes[0]); b++){
+			Test_Round_Trip(pattern, block_sizes[b]);
+		}
+	}
+	Test_Decodable_After_Every_Append();
+	Test_Refused_Appends();
+	Bench_Codec();
+
+	return HOST_TEST_RESULT();
+}
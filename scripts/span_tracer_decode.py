@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+#
+# Converts span tracer dumps (lines starting with "#ST", see src/span_tracer.c) captured from the console into Chrome trace / Perfetto JSON.
+# Other console lines are ignored, so a raw log can be given as it is.
+#
+#   python3 scripts/span_tracer_decode.py console.log -o trace.json
+#
+# Timestamps are converted the way HW_Cycles_To_Clock_Time_64() does (cycles to micro seconds rounded down), and every event also carries
+# its uptime in the library's clock format "[d:h:m:s.ms,us]" as an argument.
+
+import argparse
+import json
+import sys
+
+TYPES = {0: "B", 1: "E", 2: "i"}
+
+
+def read_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        pos += 1
+        if not byte & 0x80:
+            return value, pos
+
+
+def clock_str(micro_sec):
+    sec, u_sec = divmod(micro_sec, 1000000)
+    m_sec, u_sec = divmod(u_sec, 1000)
+    day, sec = divmod(sec, 86400)
+    hour, sec = divmod(sec, 3600)
+    minute, sec = divmod(sec, 60)
+    return "[%d:%d:%d:%d.%d,%d]" % (day, hour, minute, sec, m_sec, u_sec)
+
+
+def decode(lines, cycles_per_sec):
+    names = {}
+    rings = {}
+    stats = {}
+    records = []  # (ring id, cycles, type, event id)
+    overhead = None
+
+    for line in lines:
+        idx = line.find("#ST ")
+        if idx < 0:
+            continue
+        # names are the last field of N and R lines and may contain spaces: split only the fields before them.
+        rest = line[idx + 4:].rstrip("\r\n")
+        fields = rest.split()
+        if not fields:
+            continue
+        kind = fields[0]
+        if kind == "S":
+            cycles_per_sec = cycles_per_sec or int(fields[1])
+            overhead = int(fields[2])
+        elif kind == "N":
+            fields = rest.split(None, 2)
+            names[int(fields[1])] = fields[2] if len(fields) > 2 else ""
+        elif kind == "R":
+            fields = rest.split(None, 4)
+            ring_id = int(fields[1])
+            rings[ring_id] = fields[4] if len(fields) > 4 else ""
+            stats[ring_id] = (int(fields[2]), int(fields[3]))
+        elif kind == "D":
+            ring_id = int(fields[1])
+            cycles = int(fields[2])
+            data = bytes.fromhex(fields[3]) if len(fields) > 3 else b""
+            pos = 0
+            while pos < len(data):
+                header, pos = read_varint(data, pos)
+                delta, pos = read_varint(data, pos)
+                cycles += delta
+                records.append((ring_id, cycles, header & 3, header >> 2))
+
+    if not cycles_per_sec:
+        sys.exit("HW cycles per second is unknown: no '#ST S' line in the input, give --cycles-per-sec")
+
+    events = []
+    for ring_id, name in sorted(rings.items()):
+        events.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": ring_id, "args": {"name": name}})
+    for ring_id, cycles, event_type, event_id in sorted(records, key=lambda r: r[1]):
+        micro_sec = (cycles * 1000000) // cycles_per_sec
+        event = {
+            "name": names.get(event_id, "event_%d" % event_id),
+            "ph": TYPES.get(event_type, "i"),
+            "ts": micro_sec,
+            "pid": 0,
+            "tid": ring_id,
+            "args": {"uptime": clock_str(micro_sec), "cycles": cycles},
+        }
+        if event["ph"] == "i":
+            event["s"] = "t"
+        events.append(event)
+
+    metadata = {
+        "cycles_per_sec": cycles_per_sec,
+        "record_overhead_cycles": overhead,
+        "rings": {str(r): {"name": rings[r], "recorded": s[0], "dropped": s[1]} for r, s in sorted(stats.items())},
+    }
+    return {"traceEvents": events, "displayTimeUnit": "ns", "otherData": metadata}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert span tracer dumps to Chrome trace / Perfetto JSON")
+    parser.add_argument("input", nargs="?", type=argparse.FileType("r"), default=sys.stdin, help="console log with span tracer dumps")
+    parser.add_argument("-o", "--output", type=argparse.FileType("w"), default=sys.stdout, help="trace JSON file")
+    parser.add_argument("--cycles-per-sec", type=int, default=0, help="HW cycle frequency, overrides the one in the dump")
+    args = parser.parse_args()
+
+    trace = decode(args.input, args.cycles_per_sec)
+    json.dump(trace, args.output)
+    args.output.write("\n")
+
+    for ring_id, stat in trace["otherData"]["rings"].items():
+        if stat["dropped"]:
+            print("warning: ring %s (%s) dropped %d events" % (ring_id, stat["name"], stat["dropped"]), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,42 @@
+/**
+ * @author Batto1
+*/
+
+#include <stdint.h>
+
+#include "time_and_clock_port.h"
+
+#include "cycle_counter_64.h"
+
+
+atomic_t cycle_counter_64_half_periods = 0;
+
+#if !defined(TIME_AND_CLOCK_PORT_POSIX)
+static struct k_timer cycle_counter_64_timer;
+
+static void Cycle_Counter_64_Timer_Handler(struct k_timer * a_timer)
+{
+	ARG_UNUSED(a_timer);
+
+	Cycle_Counter_64_Tick();
+}
+#endif
+
+/**
+ * @brief Starts the periodic update of the extended counter. Call once at start up, before the 32 bit counter wraps for the first time.
+ * @note Update period is a quarter of the 32 bit counter's wrap period (2^30 HW cycles), at least 1 ms. Timer handler runs in ISR context and takes a few cycles.
+ * @note Does nothing but the first update on the POSIX backend; see Cycle_Counter_64_Tick().
+*/
+void Cycle_Counter_64_Init(void)
+{
+	Cycle_Counter_64_Tick();
+
+#if !defined(TIME_AND_CLOCK_PORT_POSIX)
+	uint64_t period_ms = k_cyc_to_ms_floor64(BIT64(30));
+
+	period_ms = MAX(period_ms, 1U);
+
+	k_timer_init(&cycle_counter_64_timer, Cycle_Counter_64_Timer_Handler, NULL);
+	k_timer_start(&cycle_counter_64_timer, K_MSEC(period_ms), K_MSEC(period_ms));
+#endif
+}
@@ -0,0 +1,70 @@
+/**
+ * @author Batto1
+ * @brief  64 bit HW cycle counter extended in software from the 32 bit one (k_cycle_get_32()), for targets where k_cycle_get_64() is missing or costly.
+ * @note   State is a single 32 bit atomic counting half periods (2^31 cycles) of the 32 bit counter. Its lowest bit tells which half of the 32 bit range
+ *         the counter was in when the state was last updated, so a reader can detect a wrap by comparing it with the top bit of the current value.
+ *         Reads take no lock; they are consistent and monotonic from any thread or ISR.
+ * @note   State must be updated at least once every 2^31 cycles. Cycle_Counter_64_Init() starts a kernel timer that does it every 2^30 cycles;
+ *         every read updates it too. On the POSIX backend there is no timer; call Cycle_Counter_64_Tick() periodically or read often enough.
+ * @note   Define TIME_UTIL_SW_CYCLE_COUNTER_64 as 1 to run the Get_Uptime_HW_Cycles_*_64 routines of time_and_clock_utils on top of this counter.
+*/
+
+#ifndef CYCLE_COUNTER_64_H
+#define CYCLE_COUNTER_64_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "time_and_clock_port.h"
+
+/* 32 bit counter the 64 bit one is extended from. Can be overridden i.e. with a fake counter for testing wrap handling. */
+#ifndef CYCLE_COUNTER_64_READ_32
+#define CYCLE_COUNTER_64_READ_32() 	k_cycle_get_32()
+#endif
+
+extern atomic_t cycle_counter_64_half_periods;
+
+void Cycle_Counter_64_Init(void);
+
+/**
+ * @brief Reads the extended 64 bit HW cycle counter. Lock-free, can be called from any thread or ISR.
+ * @note Counter starts from 0 at boot as long as the 32 bit counter does and the first read or Cycle_Counter_64_Init() is done before its first wrap.
+ * @return HW cycles since boot, 64 bit.
+*/
+static inline uint64_t Cycle_Counter_64_Get(void)
+{
+	uint32_t half_periods;
+	uint32_t cycles;
+
+	do{
+		half_periods = (uint32_t)atomic_get(&cycle_counter_64_half_periods);
+		cycles       = CYCLE_COUNTER_64_READ_32();
+		// state changed while reading i.e. reader was preempted for long; cycles may be more than a half period ahead of half_periods.
+	}while(half_periods != (uint32_t)atomic_get(&cycle_counter_64_half_periods));
+
+	if(((half_periods ^ (cycles >> 31)) & 1U) != 0U){ // counter entered the next half period since the last update
+		(void)atomic_cas(&cycle_counter_64_half_periods, (atomic_val_t)half_periods, (atomic_val_t)(half_periods + 1U));
+		half_periods ++;
+	}
+
+	return ((uint64_t)(half_periods >> 1) << 32) | cycles;
+}
+
+/**
+ * @brief Updates the state. Call from a periodic hook (timer, system tick) that runs at least once every 2^31 HW cycles if Cycle_Counter_64_Init()'s timer isn't used.
+*/
+static inline void Cycle_Counter_64_Tick(void)
+{
+	(void)Cycle_Counter_64_Get();
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,150 @@
+/**
+ * @author Batto1
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "time_and_clock_port.h"
+
+#include "latency_histogram.h"
+
+
+/**
+ * @brief Clears all counts. Values recorded concurrently may be kept or cleared.
+*/
+void Latency_Histogram_Reset(LatencyHistogram * a_hist)
+{
+	for(uint32_t i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; i++){
+		(void)atomic_clear(&a_hist->counts[i]);
+	}
+}
+
+/**
+ * @brief Copies the counts of a live histogram so that queries can be done on them while recording goes on.
+ * @param [out] a_snapshot 	Pointer to the user provided snapshot buffer.
+ * @param [in, out] a_hist 	Pointer to the histogram.
+ * @param [in] a_reset 		If true, every bucket is cleared in the same atomic operation it's read with, so no value is lost or counted twice between consecutive snapshots.
+*/
+void Latency_Histogram_Snapshot(LatencyHistogramSnapshot * a_snapshot, LatencyHistogram * a_hist, bool a_reset)
+{
+	a_snapshot->total_count = 0;
+
+	for(uint32_t i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; i++){
+		uint32_t count = (uint32_t)(a_reset ? atomic_clear(&a_hist->counts[i]) : atomic_get(&a_hist->counts[i]));
+
+		a_snapshot->counts[i] = count;
+		a_snapshot->total_count += count;
+	}
+}
+
+/**
+ * @brief Adds the counts of a_src to a_dst i.e. for combining histograms of several CPUs or intervals.
+*/
+void Latency_Histogram_Merge(LatencyHistogramSnapshot * a_dst, const LatencyHistogramSnapshot * a_src)
+{
+	for(uint32_t i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; i++){
+		a_dst->counts[i] += a_src->counts[i];
+	}
+	a_dst->total_count += a_src->total_count;
+}
+
+/**
+ * @brief Highest value in cycles that is counted in given bucket. Reported values are rounded up to it.
+*/
+uint32_t Latency_Histogram_Bucket_Highest_Cycles(uint32_t a_index)
+{
+	if(a_index < (1U << LATENCY_HISTOGRAM_SUB_BUCKET_BITS)){
+		return a_index;
+	}
+
+	uint32_t shift   = (a_index >> (LATENCY_HISTOGRAM_SUB_BUCKET_BITS - 1)) - 1U;
+	uint64_t lowest  = (uint64_t)(a_index - (shift << (LATENCY_HISTOGRAM_SUB_BUCKET_BITS - 1))) << shift;
+	uint64_t highest = lowest + ((uint64_t)1 << shift) - 1U;
+
+	return (highest > UINT32_MAX) ? UINT32_MAX : (uint32_t)highest;
+}
+
+/**
+ * @brief Value that given percentage of the recorded values are less than or equal to.
+ * @param [in] a_snapshot 		Pointer to the snapshot.
+ * @param [in] a_percentile_x100 	percentile in hundredths of a percent i.e. LATENCY_HISTOGRAM_P99_9 (9990) for p99.9.
+ * @return latency in HW cycles, rounded up to the highest value of its bucket. 0 if snapshot is empty.
+*/
+uint32_t Latency_Histogram_Percentile_Cycles(const LatencyHistogramSnapshot * a_snapshot, uint32_t a_percentile_x100)
+{
+	if(a_snapshot->total_count == 0U){
+		return 0;
+	}
+	if(a_percentile_x100 > LATENCY_HISTOGRAM_P100){
+		a_percentile_x100 = LATENCY_HISTOGRAM_P100;
+	}
+
+	// rank of the value, rounded up and at least 1.
+	uint64_t rank = ((a_snapshot->total_count * a_percentile_x100) + (LATENCY_HISTOGRAM_P100 - 1U)) / LATENCY_HISTOGRAM_P100;
+	rank = (rank == 0U) ? 1U : rank;
+
+	uint64_t seen = 0;
+	for(uint32_t i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; i++){
+		seen += a_snapshot->counts[i];
+		if(seen >= rank){
+			return Latency_Histogram_Bucket_Highest_Cycles(i);
+		}
+	}
+
+	return Latency_Histogram_Bucket_Highest_Cycles(LATENCY_HISTOGRAM_BUCKET_COUNT - 1U);
+}
+
+/**
+ * @brief Same as Latency_Histogram_Percentile_Cycles() but in micro seconds.
+*/
+uint64_t Latency_Histogram_Percentile_Micro_Sec(const LatencyHistogramSnapshot * a_snapshot, uint32_t a_percentile_x100)
+{
+	return (uint64_t)HW_Cycles_To_Duration_64(Latency_Histogram_Percentile_Cycles(a_snapshot, a_percentile_x100));
+}
+
+/**
+ * @brief Same as Latency_Histogram_Percentile_Cycles() but in clock format.
+*/
+TimeElapsedClock Latency_Histogram_Percentile_Clock(const LatencyHistogramSnapshot * a_snapshot, uint32_t a_percentile_x100)
+{
+	return HW_Cycles_To_Clock_Time_64(Latency_Histogram_Percentile_Cycles(a_snapshot, a_percentile_x100));
+}
+
+/**
+ * @brief Prints count and p50/p90/p99/p99.9/max of a snapshot i.e. "irq_to_thread: n=1000 p50=12 us p90=... (cycles: ...)"
+*/
+void Latency_Histogram_Print(const LatencyHistogramSnapshot * a_snapshot, const char * a_name)
+{
+	static const uint32_t percentiles[] = {LATENCY_HISTOGRAM_P50, LATENCY_HISTOGRAM_P90, LATENCY_HISTOGRAM_P99, LATENCY_HISTOGRAM_P99_9, LATENCY_HISTOGRAM_P100};
+	static const char * const names[]   = {"p50", "p90", "p99", "p99.9", "max"};
+
+	printk("%s: n=%"PRIu64, a_name, a_snapshot->total_count);
+	for(size_t i = 0; i < ARRAY_SIZE(percentiles); i++){
+		uint32_t cycles = Latency_Histogram_Percentile_Cycles(a_snapshot, percentiles[i]);
+		printk(" %s=%"PRIu64" us (%"PRIu32" cyc)", names[i], (uint64_t)HW_Cycles_To_Duration_64(cycles), cycles);
+	}
+	printk("\n");
+}
+
+/**
+ * @brief Prints count and percentiles of a snapshot as one JSON object per line so that results can be collected from the console and compared between builds.
+ * i.e. {"type":"histogram","name":"irq_to_thread","n":1000,"p50_cyc":12,"p90_cyc":15,"p99_cyc":20,"p99_9_cyc":31,"max_cyc":40,"p50_us":0,...}
+*/
+void Latency_Histogram_Print_Json(const LatencyHistogramSnapshot * a_snapshot, const char * a_name)
+{
+	static const uint32_t percentiles[] = {LATENCY_HISTOGRAM_P50, LATENCY_HISTOGRAM_P90, LATENCY_HISTOGRAM_P99, LATENCY_HISTOGRAM_P99_9, LATENCY_HISTOGRAM_P100};
+	static const char * const names[]   = {"p50", "p90", "p99", "p99_9", "max"};
+	uint32_t cycles[ARRAY_SIZE(percentiles)];
+
+	printk("{\"type\":\"histogram\",\"name\":\"%s\",\"n\":%"PRIu64, a_name, a_snapshot->total_count);
+	for(size_t i = 0; i < ARRAY_SIZE(percentiles); i++){
+		cycles[i] = Latency_Histogram_Percentile_Cycles(a_snapshot, percentiles[i]);
+		printk(",\"%s_cyc\":%"PRIu32, names[i], cycles[i]);
+	}
+	for(size_t i = 0; i < ARRAY_SIZE(percentiles); i++){
+		printk(",\"%s_us\":%"PRIu64, names[i], (uint64_t)HW_Cycles_To_Duration_64(cycles[i]));
+	}
+	printk("}\n");
+}
@@ -0,0 +1,115 @@
+/**
+ * @author Batto1
+ * @brief  Log-linear (HDR style) latency histogram fed with HW cycle deltas. Recording is a single atomic increment without locks so it can be done from ISRs.
+ * @note   Values below 2^LATENCY_HISTOGRAM_SUB_BUCKET_BITS cycles are counted exactly. Above that, every power of two range is split into
+ *         2^(LATENCY_HISTOGRAM_SUB_BUCKET_BITS - 1) equal buckets, so relative error of a reported value is at most 2^-(LATENCY_HISTOGRAM_SUB_BUCKET_BITS - 1).
+ * @note   Range and precision are fixed at compile time; override them with compile definitions for the whole application, not per file.
+*/
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "time_and_clock_utils.h"
+
+#ifndef LATENCY_HISTOGRAM_SUB_BUCKET_BITS
+#define LATENCY_HISTOGRAM_SUB_BUCKET_BITS 	5 	/* precision: 16 buckets per power of two, at most 6.25% relative error */
+#endif
+#ifndef LATENCY_HISTOGRAM_MAX_BITS
+#define LATENCY_HISTOGRAM_MAX_BITS 		32 	/* range: deltas up to 2^32 - 1 cycles, bigger ones are counted in the last bucket */
+#endif
+
+#define LATENCY_HISTOGRAM_BUCKET_COUNT 	((LATENCY_HISTOGRAM_MAX_BITS - LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 2) << (LATENCY_HISTOGRAM_SUB_BUCKET_BITS - 1))
+
+BUILD_ASSERT((LATENCY_HISTOGRAM_SUB_BUCKET_BITS >= 1) && (LATENCY_HISTOGRAM_SUB_BUCKET_BITS < LATENCY_HISTOGRAM_MAX_BITS) && (LATENCY_HISTOGRAM_MAX_BITS <= 32),
+	     "invalid latency histogram range or precision");
+
+/* Percentiles are given in hundredths of a percent */
+#define LATENCY_HISTOGRAM_P50 		5000U
+#define LATENCY_HISTOGRAM_P90 		9000U
+#define LATENCY_HISTOGRAM_P99 		9900U
+#define LATENCY_HISTOGRAM_P99_9 	9990U
+#define LATENCY_HISTOGRAM_P99_99 	9999U
+#define LATENCY_HISTOGRAM_P100 		10000U
+
+/**
+ * @brief struct type for a live histogram that is recorded into. Zero initialized histogram is empty and ready to use.
+*/
+typedef struct latencyHistogram{
+	atomic_t 	counts[LATENCY_HISTOGRAM_BUCKET_COUNT];
+}LatencyHistogram;
+
+/**
+ * @brief struct type for a consistent copy of a histogram that queries are done on. Snapshots can be merged.
+*/
+typedef struct latencyHistogramSnapshot{
+	uint32_t 	counts[LATENCY_HISTOGRAM_BUCKET_COUNT];
+	uint64_t 	total_count;
+}LatencyHistogramSnapshot;
+
+void Latency_Histogram_Reset(LatencyHistogram * a_hist);
+void Latency_Histogram_Snapshot(LatencyHistogramSnapshot * a_snapshot, LatencyHistogram * a_hist, bool a_reset);
+void Latency_Histogram_Merge(LatencyHistogramSnapshot * a_dst, const LatencyHistogramSnapshot * a_src);
+uint32_t Latency_Histogram_Bucket_Highest_Cycles(uint32_t a_index);
+uint32_t Latency_Histogram_Percentile_Cycles(const LatencyHistogramSnapshot * a_snapshot, uint32_t a_percentile_x100);
+uint64_t Latency_Histogram_Percentile_Micro_Sec(const LatencyHistogramSnapshot * a_snapshot, uint32_t a_percentile_x100);
+TimeElapsedClock Latency_Histogram_Percentile_Clock(const LatencyHistogramSnapshot * a_snapshot, uint32_t a_percentile_x100);
+void Latency_Histogram_Print(const LatencyHistogramSnapshot * a_snapshot, const char * a_name);
+void Latency_Histogram_Print_Json(const LatencyHistogramSnapshot * a_snapshot, const char * a_name);
+
+/**
+ * @brief Index of the bucket that counts given value.
+*/
+static inline uint32_t Latency_Histogram_Bucket_Index(uint32_t a_cycles)
+{
+	if(a_cycles < (1U << LATENCY_HISTOGRAM_SUB_BUCKET_BITS)){
+		return a_cycles;
+	}
+
+	uint32_t msb   = 31U - (uint32_t)__builtin_clz(a_cycles);
+	uint32_t shift = msb - LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1U;
+	uint32_t index = (shift << (LATENCY_HISTOGRAM_SUB_BUCKET_BITS - 1)) + (a_cycles >> shift);
+
+	return (index < LATENCY_HISTOGRAM_BUCKET_COUNT) ? index : (LATENCY_HISTOGRAM_BUCKET_COUNT - 1U);
+}
+
+/**
+ * @brief Counts a latency value. Lock-free, single atomic increment; can be called from any thread or ISR.
+ * @param [in, out] a_hist 	Pointer to the histogram.
+ * @param [in] a_cycles 		latency in HW cycles.
+*/
+static inline void Latency_Histogram_Record_Cycles(LatencyHistogram * a_hist, uint32_t a_cycles)
+{
+	(void)atomic_inc(&a_hist->counts[Latency_Histogram_Bucket_Index(a_cycles)]);
+}
+
+/**
+ * @brief Counts the time elapsed since a_start_cycles, a value got from Get_Uptime_HW_Cycles_32(). Wrap around safe for deltas below 2^32.
+*/
+static inline void Latency_Histogram_Record_Since_32(LatencyHistogram * a_hist, uint32_t a_start_cycles)
+{
+	Latency_Histogram_Record_Cycles(a_hist, Get_Uptime_HW_Cycles_32() - a_start_cycles);
+}
+
+/**
+ * @brief Counts the time elapsed since a_start_cycles, a value got from Get_Uptime_HW_Cycles_64(). Deltas of 2^32 cycles or more are counted in the last bucket.
+*/
+static inline void Latency_Histogram_Record_Since_64(LatencyHistogram * a_hist, uint64_t a_start_cycles)
+{
+	uint64_t delta = Get_Uptime_HW_Cycles_64() - a_start_cycles;
+
+	Latency_Histogram_Record_Cycles(a_hist, (delta > UINT32_MAX) ? UINT32_MAX : (uint32_t)delta);
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
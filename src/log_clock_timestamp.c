@@ -0,0 +1,167 @@
+/**
+ * @author Batto1
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "time_and_clock_port.h"
+#if defined(CONFIG_LOG_OUTPUT_FORMAT_CUSTOM_TIMESTAMP)
+#include <zephyr/logging/log_ctrl.h>
+#include <zephyr/logging/log_output.h>
+#include <zephyr/logging/log_output_custom.h>
+#endif
+
+#include "log_clock_timestamp.h"
+
+
+#define LOG_CLOCK_TIMESTAMP_SUB_SEC_FIELDS 	(CLOCK_FIELD_MSEC | CLOCK_FIELD_USEC)
+
+
+/**
+ * @brief Initializes a formatter.
+ * @param [out] a_ts 		Pointer to the formatter owned by the user.
+ * @param [in]  a_source 	counter the raw timestamps are read from.
+ * @param [in]  a_fields 	Bitmask of CLOCK_FIELD_* flags, optionally ORed with CLOCK_FORMAT_ZERO_PAD.
+*/
+void Log_Clock_Timestamp_Setup(LogClockTimestamp * a_ts, LogClockTimestampSource a_source, uint32_t a_fields)
+{
+	memset(a_ts, 0, sizeof(* a_ts));
+	a_ts->source = a_source;
+	a_ts->fields = a_fields;
+}
+
+/**
+ * @brief Extends a 32 bit raw timestamp to 64 bits by its signed distance from the newest timestamp seen.
+ * @note Timestamps may come out of order (e.g. logged from an ISR that preempted a thread between reading and logging its timestamp),
+ *       as long as each one is within 2^31 counts of the newest one. A backwards step is counted as a wrap only if it's longer than that.
+*/
+uint64_t Log_Clock_Timestamp_Extend_32(LogClockTimestamp * a_ts, uint32_t a_raw)
+{
+	int64_t delta = (int32_t)(a_raw - (uint32_t)a_ts->last_raw);
+	uint64_t raw  = a_ts->last_raw + (uint64_t)delta;
+
+	if((delta < 0) && ((uint64_t)(-delta) > a_ts->last_raw)){
+		raw += BIT64(32); // counter doesn't go below 0, so it's ahead by more than 2^31 before the first wrap
+	}
+	if(raw > a_ts->last_raw){
+		a_ts->last_raw = raw;
+	}
+
+	return raw;
+}
+
+/**
+ * @brief Converts a raw timestamp to clock format. The prefix up to seconds is formatted only when the second changes.
+ * @param [in, out] a_ts 	Pointer to the formatter.
+ * @param [out] a_buf 		User provided buffer. Always NUL terminated if a_buf_size is not 0. CLOCK_MAX_STRING_SIZE is enough.
+ * @param [in]  a_buf_size 	Size of a_buf in bytes.
+ * @param [in]  a_raw 		uptime ticks or HW cycles, see a_source of Log_Clock_Timestamp_Setup().
+ * @return length of the whole string without NUL, like Clock_Format().
+*/
+int Log_Clock_Timestamp_Format(LogClockTimestamp * a_ts, char * a_buf, size_t a_buf_size, uint64_t a_raw)
+{
+	char str[2 * CLOCK_MAX_STRING_SIZE];
+	char sub_sec_str[CLOCK_MAX_STRING_SIZE];
+	uint32_t fields = __atomic_load_n(&a_ts->fields, __ATOMIC_RELAXED);
+
+	TimeDuration micro_secs = (a_ts->source == LOG_CLOCK_TIMESTAMP_TICKS) ? Ticks_To_Duration((int64_t)a_raw) : HW_Cycles_To_Duration_64(a_raw);
+	uint64_t secs = Micro_Sec_To_Sec((uint64_t)micro_secs);
+	uint32_t sub_sec_micro_secs = (uint32_t)((uint64_t)micro_secs - (secs * 1000000U));
+
+	if((a_ts->prefix_len == 0U) || (secs != a_ts->prefix_sec) || (fields != a_ts->prefix_fields)){
+		TimeElapsedClock clk;
+
+		(void)Duration_To_Clock(&clk, (TimeDuration)(secs * 1000000U));
+		int len = Clock_Format(a_ts->prefix, sizeof(a_ts->prefix), &clk, fields & ~LOG_CLOCK_TIMESTAMP_SUB_SEC_FIELDS);
+		a_ts->prefix_len    = (uint32_t)len - 1U; // without ']'
+		a_ts->prefix_sec    = secs;
+		a_ts->prefix_fields = fields;
+	}
+
+	// ".ms,us]" part; formatting only sub second fields gives "[.ms,us]".
+	TimeElapsedClock sub_sec_clk = {
+		.m_sec = (uint16_t)(sub_sec_micro_secs / 1000U),
+		.u_sec = (uint16_t)(sub_sec_micro_secs % 1000U),
+	};
+	int sub_sec_len = Clock_Format(sub_sec_str, sizeof(sub_sec_str), &sub_sec_clk, fields & (LOG_CLOCK_TIMESTAMP_SUB_SEC_FIELDS | CLOCK_FORMAT_ZERO_PAD));
+
+	memcpy(str, a_ts->prefix, a_ts->prefix_len);
+	memcpy(&str[a_ts->prefix_len], &sub_sec_str[1], (size_t)sub_sec_len - 1U);
+
+	size_t len = a_ts->prefix_len + (size_t)sub_sec_len - 1U;
+	if(0U != a_buf_size){
+		size_t copy_len = (len < a_buf_size) ? len : (a_buf_size - 1U);
+		memcpy(a_buf, str, copy_len);
+		a_buf[copy_len] = '\0';
+	}
+
+	return (int)len;
+}
+
+
+#if defined(CONFIG_LOG_OUTPUT_FORMAT_CUSTOM_TIMESTAMP)
+static LogClockTimestamp log_clock_timestamp;
+
+static log_timestamp_t Get_Ticks_Timestamp(void)
+{
+	return (log_timestamp_t)k_uptime_ticks();
+}
+
+static log_timestamp_t Get_HW_Cycles_Timestamp(void)
+{
+#if defined(CONFIG_LOG_TIMESTAMP_64BIT)
+	return (log_timestamp_t)Get_Uptime_HW_Cycles_64();
+#else
+	return (log_timestamp_t)k_cycle_get_32();
+#endif
+}
+
+/**
+ * @brief Custom timestamp format hook of log_output, runs in the log processing thread.
+*/
+static int Format_Timestamp(const struct log_output * a_output, const log_timestamp_t a_timestamp, const log_timestamp_printer_t a_printer)
+{
+	char buf[CLOCK_MAX_STRING_SIZE];
+
+#if defined(CONFIG_LOG_TIMESTAMP_64BIT)
+	uint64_t raw = a_timestamp;
+#else
+	uint64_t raw = Log_Clock_Timestamp_Extend_32(&log_clock_timestamp, a_timestamp);
+#endif
+	(void)Log_Clock_Timestamp_Format(&log_clock_timestamp, buf, sizeof(buf), raw);
+
+	return a_printer(a_output, "%s ", buf);
+}
+
+/**
+ * @brief Makes the logging subsystem capture raw ticks or HW cycles as message timestamps and print them in clock format.
+ * @param [in] a_source 	counter to capture. Capturing is a single counter read in the logging context.
+ * @param [in] a_fields 	Bitmask of CLOCK_FIELD_* flags, optionally ORed with CLOCK_FORMAT_ZERO_PAD.
+ * @note Call once at start up, before logging anything; timestamps of messages logged before are in the previous source's units.
+ * @retval 0 on success, negative errno returned by log_set_timestamp_func() otherwise.
+*/
+int Log_Clock_Timestamp_Init(LogClockTimestampSource a_source, uint32_t a_fields)
+{
+	Log_Clock_Timestamp_Setup(&log_clock_timestamp, a_source, a_fields);
+
+	int err = (a_source == LOG_CLOCK_TIMESTAMP_TICKS) ?
+		log_set_timestamp_func(Get_Ticks_Timestamp, CONFIG_SYS_CLOCK_TICKS_PER_SEC) :
+		log_set_timestamp_func(Get_HW_Cycles_Timestamp, (uint32_t)sys_clock_hw_cycles_per_sec());
+	if(err != 0){
+		return err;
+	}
+
+	log_custom_timestamp_set(Format_Timestamp);
+
+	return 0;
+}
+
+/**
+ * @brief Changes the printed fields at run time. Takes effect from the next output message.
+*/
+void Log_Clock_Timestamp_Set_Fields(uint32_t a_fields)
+{
+	__atomic_store_n(&log_clock_timestamp.fields, a_fields, __ATOMIC_RELAXED);
+}
+#endif
@@ -0,0 +1,60 @@
+/**
+ * @author Batto1
+ * @brief  Zephyr log timestamps in clock format ("[d:h:m:s.ms,us]") with the conversion deferred to the log processing thread.
+ *         At log time only the raw tick or HW cycle count is captured; converting and formatting it is done when the message is output.
+ * @note   Requires deferred logging and CONFIG_LOG_OUTPUT_FORMAT_CUSTOM_TIMESTAMP. Replaces printing Get_Uptime_*_As_Clock_Time() + Clock_To_Str() in log arguments.
+ * @note   Consecutive messages in the same second reuse the formatted "[d:h:m:s" prefix, only ".ms,us]" is formatted for them.
+ * @note   With 32 bit log timestamps (CONFIG_LOG_TIMESTAMP_64BIT disabled), wraps are counted in the processing thread. At least one message must be
+ *         output per wrap period: ~5 days for 10 kHz ticks, seconds to minutes for HW cycles. Prefer ticks or 64 bit timestamps.
+*/
+
+#ifndef LOG_CLOCK_TIMESTAMP_H
+#define LOG_CLOCK_TIMESTAMP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "time_and_clock_utils.h"
+
+/**
+ * @brief enum for the counter that log timestamps are taken from.
+*/
+typedef enum LogClockTimestampSource
+{
+	LOG_CLOCK_TIMESTAMP_TICKS = 0,
+	LOG_CLOCK_TIMESTAMP_HW_CYCLES = 1,
+}LogClockTimestampSource;
+
+/**
+ * @brief struct type for the formatter state. Use only through Log_Clock_Timestamp_* routines.
+*/
+typedef struct logClockTimestamp{
+	LogClockTimestampSource source;
+	uint32_t 	fields; 		/* CLOCK_FIELD_* flags, optionally with CLOCK_FORMAT_ZERO_PAD */
+	uint64_t 	last_raw; 		/* newest 32 bit timestamp extended to 64 bits */
+	uint64_t 	prefix_sec; 		/* second the cached prefix belongs to */
+	uint32_t 	prefix_fields; 		/* fields the cached prefix was formatted with */
+	uint32_t 	prefix_len; 		/* 0 if there isn't a cached prefix */
+	char 		prefix[CLOCK_MAX_STRING_SIZE];
+}LogClockTimestamp;
+
+void Log_Clock_Timestamp_Setup(LogClockTimestamp * a_ts, LogClockTimestampSource a_source, uint32_t a_fields);
+uint64_t Log_Clock_Timestamp_Extend_32(LogClockTimestamp * a_ts, uint32_t a_raw);
+int Log_Clock_Timestamp_Format(LogClockTimestamp * a_ts, char * a_buf, size_t a_buf_size, uint64_t a_raw);
+
+#if defined(CONFIG_LOG_OUTPUT_FORMAT_CUSTOM_TIMESTAMP)
+int Log_Clock_Timestamp_Init(LogClockTimestampSource a_source, uint32_t a_fields);
+void Log_Clock_Timestamp_Set_Fields(uint32_t a_fields);
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
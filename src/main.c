@@ -21,7 +21,7 @@ void main(void)
 	err = Clock_Subtract_Two_Time_Points(&difference_time, final_time, prev_time);
 	if(TIME_UTIL_ERROR_NONE == err){
 		char legend_buf[CLOCK_LEGEND_MAX_STRING_SIZE] = ""; // buffer for printing time legend in.
-		char clock_buf[25];
+		char clock_buf[CLOCK_MAX_STRING_SIZE];
 		Clock_To_Str(clock_buf, legend_buf, &difference_time, true, true, true, true, true, true);
 		printk("%s %s\n", legend_buf, clock_buf);
 	}else{
@@ -0,0 +1,295 @@
+/**
+ * @author Batto1
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/logging/log.h>
+
+#include "poweredup_time_store.h"
+
+
+LOG_MODULE_REGISTER(poweredup_time_store, LOG_LEVEL_DBG);
+
+
+/**
+ * @brief Journal record as it's written to flash.
+ * @note Tick rate is stored so that the powered-up time survives a firmware update that changes CONFIG_SYS_CLOCK_TICKS_PER_SEC.
+*/
+typedef struct poweredupRecord{
+	uint32_t 	sequence;
+	uint32_t 	ticks_per_sec;
+	uint64_t 	total_ticks;
+	uint32_t 	reserved;
+	uint32_t 	crc; 		/* crc32_ieee of all the fields above */
+}PoweredupRecord;
+
+BUILD_ASSERT(sizeof(PoweredupRecord) == 24, "record layout must not have padding");
+
+
+/**
+ * @brief Reads the slot at given offset.
+ * @retval 1 if the slot holds a valid record, record is written to a_record.
+ * @retval 0 if the slot is erased.
+ * @retval -EBADMSG if the slot is neither erased nor valid i.e. power was lost while writing it.
+ * @retval other negative errno if flash read failed.
+*/
+static int Read_Slot(PoweredupStore * a_store, uint32_t a_offset, PoweredupRecord * a_record)
+{
+	int err = flash_area_read(a_store->fa, a_offset, a_record, sizeof(* a_record));
+	if(err != 0){
+		return err;
+	}
+	a_store->recovered_records ++;
+
+	uint8_t erased_val = flash_area_erased_val(a_store->fa);
+	const uint8_t * bytes = (const uint8_t *)a_record;
+	bool erased = true;
+	for(size_t i = 0; i < sizeof(* a_record); i++){
+		if(bytes[i] != erased_val){
+			erased = false;
+			break;
+		}
+	}
+	if(erased){
+		return 0;
+	}
+
+	if(a_record->crc != crc32_ieee((const uint8_t *)a_record, offsetof(PoweredupRecord, crc))){
+		return -EBADMSG;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief Converts ticks counted at another tick rate to ticks of the current tick rate.
+*/
+static uint64_t Rescale_Ticks(uint64_t a_ticks, uint32_t a_from_ticks_per_sec)
+{
+	if((a_from_ticks_per_sec == 0U) || (a_from_ticks_per_sec == CONFIG_SYS_CLOCK_TICKS_PER_SEC)){
+		return a_ticks;
+	}
+
+	// divide first so that multiplication doesn't overflow.
+	return ((a_ticks / a_from_ticks_per_sec) * CONFIG_SYS_CLOCK_TICKS_PER_SEC)
+	     + (((a_ticks % a_from_ticks_per_sec) * CONFIG_SYS_CLOCK_TICKS_PER_SEC) / a_from_ticks_per_sec);
+}
+
+/**
+ * @brief Finds the latest valid record and the next free slot. Reads the first slot of every sector and then only the slots of the newest sector.
+ * @param [out] a_total_ticks 	powered-up ticks in the latest valid record, 0 if there isn't any.
+*/
+static int Recover(PoweredupStore * a_store, uint64_t * a_total_ticks)
+{
+	PoweredupRecord record;
+	uint32_t newest_sector = 0;
+	bool found = false;
+	int ret = 0;
+
+	* a_total_ticks = 0;
+	a_store->sequence = 0;
+	a_store->write_offset = 0;
+
+	// newest sector is the one whose first record has the biggest sequence number.
+	for(uint32_t s = 0; s < a_store->sector_count; s++){
+		ret = Read_Slot(a_store, s * a_store->sector_size, &record);
+		if(ret < 0 && ret != -EBADMSG){
+			return ret;
+		}
+		if(ret == 1 && (!found || record.sequence > a_store->sequence)){
+			found = true;
+			newest_sector = s;
+			a_store->sequence = record.sequence;
+		}
+	}
+	if(!found){
+		LOG_INF("No powered-up time record found, starting from 0");
+		return 0;
+	}
+
+	// scan the newest sector for the last valid record and the first slot after the last used one.
+	uint32_t sector_start = newest_sector * a_store->sector_size;
+	uint32_t next_free    = sector_start + a_store->sector_size;
+	for(uint32_t off = sector_start; off + a_store->slot_size <= sector_start + a_store->sector_size; off += a_store->slot_size){
+		ret = Read_Slot(a_store, off, &record);
+		if(ret < 0 && ret != -EBADMSG){
+			return ret;
+		}
+		if(ret == 0){
+			next_free = off;
+			break;
+		}
+		if(ret == 1 && record.sequence >= a_store->sequence){
+			a_store->sequence = record.sequence;
+			* a_total_ticks = Rescale_Ticks(record.total_ticks, record.ticks_per_sec);
+		}
+		// -EBADMSG: interrupted write, slot can't be reused until the sector is erased.
+	}
+
+	// if the newest sector is full, next write starts the following sector (it gets erased then).
+	a_store->write_offset = (next_free + a_store->slot_size > sector_start + a_store->sector_size) ?
+				(((newest_sector + 1U) % a_store->sector_count) * a_store->sector_size) : next_free;
+
+	return 0;
+}
+
+/**
+ * @brief Appends a record to the journal. Erases the sector first if the record is the first one in it.
+*/
+static int Write_Record(PoweredupStore * a_store, uint64_t a_total_ticks)
+{
+	uint8_t slot[POWEREDUP_STORE_MAX_WRITE_BLOCK_SIZE];
+	PoweredupRecord record = {
+		.sequence      = a_store->sequence + 1U,
+		.ticks_per_sec = CONFIG_SYS_CLOCK_TICKS_PER_SEC,
+		.total_ticks   = a_total_ticks,
+		.reserved      = 0,
+	};
+	record.crc = crc32_ieee((const uint8_t *)&record, offsetof(PoweredupRecord, crc));
+
+	memset(slot, flash_area_erased_val(a_store->fa), a_store->slot_size);
+	memcpy(slot, &record, sizeof(record));
+
+	int err = 0;
+	if((a_store->write_offset % a_store->sector_size) == 0U){
+		uint32_t start = k_cycle_get_32();
+		err = flash_area_erase(a_store->fa, a_store->write_offset, a_store->sector_size);
+		a_store->max_erase_cycles = MAX(a_store->max_erase_cycles, k_cycle_get_32() - start);
+		if(err != 0){
+			LOG_ERR("Error %d while erasing sector at 0x%x in %s", err, a_store->write_offset, __func__);
+			return err;
+		}
+		a_store->erase_count ++;
+	}
+
+	uint32_t start = k_cycle_get_32();
+	err = flash_area_write(a_store->fa, a_store->write_offset, slot, a_store->slot_size);
+	a_store->max_write_cycles = MAX(a_store->max_write_cycles, k_cycle_get_32() - start);
+
+	// slot is consumed even if write failed, it can't be written again before erase.
+	a_store->write_offset += a_store->slot_size;
+	if(a_store->write_offset + a_store->slot_size > ROUND_DOWN(a_store->write_offset, a_store->sector_size) + a_store->sector_size){
+		a_store->write_offset = ROUND_UP(a_store->write_offset, a_store->sector_size);
+	}
+	if(a_store->write_offset >= a_store->sector_count * a_store->sector_size){
+		a_store->write_offset = 0;
+	}
+
+	if(err != 0){
+		LOG_ERR("Error %d while writing record in %s", err, __func__);
+		return err;
+	}
+
+	a_store->sequence = record.sequence;
+	a_store->last_saved_ticks = a_total_ticks;
+	a_store->write_count ++;
+
+	return 0;
+}
+
+/**
+ * @brief Opens the flash area, recovers the latest powered-up time from it and initializes the store.
+ * @param [out] a_store 		Pointer to the store owned by the user.
+ * @param [in]  a_flash_area_id 	Flash area to keep the journal in i.e. FIXED_PARTITION_ID(storage_partition). Must not be used by anything else.
+ * @param [in]  a_save_interval_secs 	Minimum time between two records written by Poweredup_Store_Update(). Bigger values mean less flash wear.
+ * @note Recovery time is bounded: it reads one slot per sector and then at most one sector worth of slots.
+ * @retval 0 on success, negative errno otherwise.
+*/
+int Poweredup_Store_Init(PoweredupStore * a_store, uint8_t a_flash_area_id, uint32_t a_save_interval_secs)
+{
+	struct flash_sector sectors[POWEREDUP_STORE_MAX_SECTORS];
+	uint32_t sector_count = ARRAY_SIZE(sectors);
+	uint64_t total_ticks = 0;
+
+	memset(a_store, 0, sizeof(* a_store));
+
+	int err = flash_area_open(a_flash_area_id, &a_store->fa);
+	if(err != 0){
+		LOG_ERR("Error %d while opening flash area %u in %s", err, a_flash_area_id, __func__);
+		return err;
+	}
+
+	err = flash_area_get_sectors(a_flash_area_id, &sector_count, sectors);
+	if(err == -ENOMEM){ // area has more sectors than we use, first ones are enough.
+		sector_count = ARRAY_SIZE(sectors);
+	}else if(err != 0){
+		LOG_ERR("Error %d while getting sectors in %s", err, __func__);
+		return err;
+	}
+	if(sector_count < 2U){
+		LOG_ERR("Flash area needs at least 2 sectors in %s", __func__);
+		return -EINVAL;
+	}
+	for(uint32_t s = 1; s < sector_count; s++){
+		if(sectors[s].fs_size != sectors[0].fs_size){
+			LOG_ERR("Flash area sectors must be of equal size in %s", __func__);
+			return -EINVAL;
+		}
+	}
+
+	uint32_t write_block_size = flash_area_align(a_store->fa);
+	if(write_block_size > POWEREDUP_STORE_MAX_WRITE_BLOCK_SIZE){
+		LOG_ERR("Flash write block size %u isn't supported in %s", write_block_size, __func__);
+		return -ENOTSUP;
+	}
+
+	a_store->sector_size  = (uint32_t)sectors[0].fs_size;
+	a_store->sector_count = sector_count;
+	a_store->slot_size    = ROUND_UP(sizeof(PoweredupRecord), MAX(write_block_size, 1U));
+	a_store->save_interval_ticks = (uint64_t)a_save_interval_secs * CONFIG_SYS_CLOCK_TICKS_PER_SEC;
+
+	err = Recover(a_store, &total_ticks);
+	if(err != 0){
+		LOG_ERR("Error %d while recovering powered-up time in %s", err, __func__);
+		return err;
+	}
+
+	Poweredup_Accumulator_Init(&a_store->acc, total_ticks);
+	a_store->last_saved_ticks = total_ticks;
+
+	return 0;
+}
+
+/**
+ * @brief Updates the powered-up time and writes a record if the save interval has passed since the last written one.
+ * @param [in, out] a_store 	Pointer to the initialized store.
+ * @note Call periodically from a thread or work item, more often than the save interval. Must not be called from ISRs or from more than one thread at a time since it may write flash.
+ * @retval 0 on success, negative errno if writing the record failed. Powered-up time in RAM is kept even on failure and the write is retried on the next call.
+*/
+int Poweredup_Store_Update(PoweredupStore * a_store)
+{
+	Poweredup_Accumulator_Update(&a_store->acc);
+
+	uint64_t total_ticks = Poweredup_Accumulator_Get_Ticks(&a_store->acc);
+	if(total_ticks - a_store->last_saved_ticks < a_store->save_interval_ticks){
+		return 0;
+	}
+
+	return Write_Record(a_store, total_ticks);
+}
+
+/**
+ * @brief Updates the powered-up time and writes a record regardless of the save interval i.e. before a planned reset or power off.
+ * @param [in, out] a_store 	Pointer to the initialized store.
+ * @note Same context restrictions as Poweredup_Store_Update(). Nothing is written if the time didn't change since the last record.
+ * @retval 0 on success, negative errno if writing the record failed.
+*/
+int Poweredup_Store_Flush(PoweredupStore * a_store)
+{
+	Poweredup_Accumulator_Update(&a_store->acc);
+
+	uint64_t total_ticks = Poweredup_Accumulator_Get_Ticks(&a_store->acc);
+	if(total_ticks == a_store->last_saved_ticks){
+		return 0;
+	}
+
+	return Write_Record(a_store, total_ticks);
+}
@@ -0,0 +1,58 @@
+/**
+ * @author Batto1
+ * @brief  Persistent powered-up time store. Keeps the powered-up time of the device in a flash area as a journal of small CRC protected records.
+ * @note   Records are appended one after another and sectors are used as a ring, so every sector is erased equally often (wear levelling).
+ *         A record is written only when the configured save interval has passed or when a flush is requested, so increments are batched.
+ * @note   Needs CONFIG_FLASH and CONFIG_FLASH_MAP. The flash area must have at least 2 sectors of equal size. Works on native_sim with the flash simulator.
+*/
+
+#ifndef POWEREDUP_TIME_STORE_H
+#define POWEREDUP_TIME_STORE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+
+#include "time_and_clock_utils.h"
+
+#define POWEREDUP_STORE_MAX_SECTORS 		16 	/* at most this many sectors of the flash area are used */
+#define POWEREDUP_STORE_MAX_WRITE_BLOCK_SIZE 	32 	/* biggest flash write block size supported */
+
+/**
+ * @brief struct type that holds the state of a persistent powered-up time store.
+ * @note Use only through Poweredup_Store_* routines. Statistic fields can be read directly for diagnostics.
+*/
+typedef struct poweredupStore{
+	const struct flash_area * 	fa;
+	PoweredupAccumulator 		acc; 			/* powered-up time, any thread or ISR can call Poweredup_Accumulator_Update() on it */
+	uint32_t 			sector_size;
+	uint32_t 			sector_count;
+	uint32_t 			slot_size; 		/* record size rounded up to the flash write block size */
+	uint32_t 			write_offset; 		/* offset of the next free slot in the flash area */
+	uint32_t 			sequence; 		/* sequence number of the last written record */
+	uint64_t 			last_saved_ticks;
+	uint64_t 			save_interval_ticks;
+
+	/* statistics since init */
+	uint32_t 			recovered_records; 	/* number of slots read during recovery at init */
+	uint32_t 			write_count;
+	uint32_t 			erase_count;
+	uint32_t 			max_write_cycles; 	/* longest record write, in HW cycles */
+	uint32_t 			max_erase_cycles; 	/* longest sector erase, in HW cycles */
+}PoweredupStore;
+
+int Poweredup_Store_Init(PoweredupStore * a_store, uint8_t a_flash_area_id, uint32_t a_save_interval_secs);
+int Poweredup_Store_Update(PoweredupStore * a_store);
+int Poweredup_Store_Flush(PoweredupStore * a_store);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
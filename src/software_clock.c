@@ -0,0 +1,144 @@
+/**
+ * @author Batto1
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "time_and_clock_port.h"
+
+#include "software_clock.h"
+
+
+/**
+ * @brief Current value, must be called with the lock held.
+*/
+static TimeDuration Current_Value(const SoftwareClock * a_clock, int64_t a_now_ticks)
+{
+	if(!a_clock->running){
+		return a_clock->value;
+	}
+
+	TimeDuration elapsed = Ticks_To_Duration(a_now_ticks - a_clock->base_ticks);
+
+	return a_clock->value + (elapsed - (elapsed % a_clock->resolution));
+}
+
+/**
+ * @brief Initialize a software clock.
+ * @param [out] a_clock 		Pointer to the clock owned by the user.
+ * @param [in]  a_initial 		initial value, NULL for 0.
+ * @param [in]  a_resolution 	micro seconds the clock advances in i.e. SOFTWARE_CLOCK_RESOLUTION_MSEC for a 1 ms increment clock. Must be positive.
+ * @param [in]  a_running 		whether the clock starts running now or paused.
+*/
+void Software_Clock_Init(SoftwareClock * a_clock, const TimeElapsedClock * a_initial, TimeDuration a_resolution, bool a_running)
+{
+	memset(a_clock, 0, sizeof(* a_clock));
+	a_clock->value      = (a_initial != NULL) ? Clock_To_Duration(a_initial) : 0;
+	a_clock->resolution = (a_resolution > 0) ? a_resolution : SOFTWARE_CLOCK_RESOLUTION_USEC;
+	a_clock->running    = a_running;
+	a_clock->base_ticks = k_uptime_ticks();
+}
+
+/**
+ * @brief Sets the clock value. Clock advances from it with the next resolution step one resolution later, like a restarted increment timer.
+*/
+void Software_Clock_Set(SoftwareClock * a_clock, const TimeElapsedClock * a_value)
+{
+	k_spinlock_key_t key = k_spin_lock(&a_clock->lock);
+
+	a_clock->value      = Clock_To_Duration(a_value);
+	a_clock->base_ticks = k_uptime_ticks();
+
+	k_spin_unlock(&a_clock->lock, key);
+}
+
+/**
+ * @brief Moves the clock forward or backward by a_delta without changing its phase, i.e. for correcting it against a reference.
+ * @retval TIME_UTIL_ERROR_NEGATIVE if the clock would become negative; clock is set to 0 then.
+ * @retval TIME_UTIL_ERROR_NONE otherwise.
+*/
+TimeAndClockErrors Software_Clock_Adjust(SoftwareClock * a_clock, TimeDuration a_delta)
+{
+	TimeAndClockErrors error = TIME_UTIL_ERROR_NONE;
+	k_spinlock_key_t key = k_spin_lock(&a_clock->lock);
+
+	int64_t now_ticks = k_uptime_ticks();
+
+	a_clock->value += a_delta; // base_ticks is kept, so the clock keeps stepping at the same moments.
+	if(Duration_Is_Negative(Current_Value(a_clock, now_ticks))){
+		a_clock->value      = 0;
+		a_clock->base_ticks = now_ticks;
+		error = TIME_UTIL_ERROR_NEGATIVE;
+	}
+
+	k_spin_unlock(&a_clock->lock, key);
+
+	return error;
+}
+
+/**
+ * @brief Stops the clock at its current value. Does nothing if it's already paused.
+*/
+void Software_Clock_Pause(SoftwareClock * a_clock)
+{
+	k_spinlock_key_t key = k_spin_lock(&a_clock->lock);
+
+	if(a_clock->running){
+		a_clock->value   = Current_Value(a_clock, k_uptime_ticks());
+		a_clock->running = false;
+	}
+
+	k_spin_unlock(&a_clock->lock, key);
+}
+
+/**
+ * @brief Lets a paused clock run again from its value. Does nothing if it's already running.
+*/
+void Software_Clock_Resume(SoftwareClock * a_clock)
+{
+	k_spinlock_key_t key = k_spin_lock(&a_clock->lock);
+
+	if(!a_clock->running){
+		a_clock->base_ticks = k_uptime_ticks();
+		a_clock->running    = true;
+	}
+
+	k_spin_unlock(&a_clock->lock, key);
+}
+
+/**
+ * @retval true if the clock is running.
+*/
+bool Software_Clock_Is_Running(SoftwareClock * a_clock)
+{
+	k_spinlock_key_t key = k_spin_lock(&a_clock->lock);
+	bool running = a_clock->running;
+	k_spin_unlock(&a_clock->lock, key);
+
+	return running;
+}
+
+/**
+ * @brief Get the clock value as a scalar duration.
+*/
+TimeDuration Software_Clock_Get_Duration(SoftwareClock * a_clock)
+{
+	k_spinlock_key_t key = k_spin_lock(&a_clock->lock);
+	TimeDuration value = Current_Value(a_clock, k_uptime_ticks());
+	k_spin_unlock(&a_clock->lock, key);
+
+	return value;
+}
+
+/**
+ * @brief Get the clock value in clock format. Fields are normalized the same way the Increment_* routines carry them; day is not bounded.
+*/
+TimeElapsedClock Software_Clock_Get(SoftwareClock * a_clock)
+{
+	TimeElapsedClock clk;
+
+	(void)Duration_To_Clock(&clk, Software_Clock_Get_Duration(a_clock));
+
+	return clk;
+}
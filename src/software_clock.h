@@ -0,0 +1,53 @@
+/**
+ * @author Batto1
+ * @brief  Software clock that derives its value from uptime on demand, instead of a periodic timer that calls Increment_a_Millisecond_And_Update_Clock()
+ *         or Increment_a_Second_And_Update_Clock(). It takes no wakeups, so it doesn't keep a tickless kernel out of low power idle.
+ * @note   Value is the one set last plus the uptime elapsed while running, rounded down to a multiple of the resolution since it was set or resumed.
+ *         With SOFTWARE_CLOCK_RESOLUTION_MSEC it reads exactly like a clock incremented by a 1 ms timer that was started at the same moment.
+ * @note   Can be used from any thread or ISR; routines take the clock's spinlock for a few instructions.
+*/
+
+#ifndef SOFTWARE_CLOCK_H
+#define SOFTWARE_CLOCK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "time_and_clock_port.h"
+#include "time_and_clock_utils.h"
+
+#define SOFTWARE_CLOCK_RESOLUTION_USEC 	((TimeDuration)1)
+#define SOFTWARE_CLOCK_RESOLUTION_MSEC 	TIME_DURATION_USEC_PER_MSEC
+#define SOFTWARE_CLOCK_RESOLUTION_SEC 	TIME_DURATION_USEC_PER_SEC
+
+/**
+ * @brief struct type of a software clock. Use only through Software_Clock_* routines.
+*/
+typedef struct softwareClock{
+	TimeDuration 		value; 		/* clock value at base_ticks; the whole value while paused */
+	int64_t 		base_ticks; 	/* uptime ticks when the clock was set or resumed */
+	TimeDuration 		resolution; 	/* micro seconds the clock advances in */
+	bool 			running;
+	struct k_spinlock 	lock;
+}SoftwareClock;
+
+void Software_Clock_Init(SoftwareClock * a_clock, const TimeElapsedClock * a_initial, TimeDuration a_resolution, bool a_running);
+void Software_Clock_Set(SoftwareClock * a_clock, const TimeElapsedClock * a_value);
+TimeAndClockErrors Software_Clock_Adjust(SoftwareClock * a_clock, TimeDuration a_delta);
+void Software_Clock_Pause(SoftwareClock * a_clock);
+void Software_Clock_Resume(SoftwareClock * a_clock);
+bool Software_Clock_Is_Running(SoftwareClock * a_clock);
+TimeDuration Software_Clock_Get_Duration(SoftwareClock * a_clock);
+TimeElapsedClock Software_Clock_Get(SoftwareClock * a_clock);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,221 @@
+/**
+ * @author Batto1
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+
+#include "time_and_clock_port.h"
+
+#include "span_tracer.h"
+
+
+#define SPAN_TRACER_CALIBRATION_BUF_SIZE 	1024 	/* room for all calibration records, power of two */
+
+BUILD_ASSERT(SPAN_TRACER_CALIBRATION_BUF_SIZE >= (SPAN_TRACER_CALIBRATION_ROUNDS * SPAN_TRACER_MAX_RECORD_SIZE), "calibration records must not be dropped");
+
+
+uint32_t span_tracer_record_cycles = 0;
+
+static const char * const * span_tracer_event_names;
+static uint32_t span_tracer_event_count;
+static uint32_t span_tracer_next_ring_id;
+
+static sys_slist_t span_tracer_rings = SYS_SLIST_STATIC_INIT(&span_tracer_rings);
+static struct k_spinlock span_tracer_rings_lock;
+
+#if !defined(TIME_AND_CLOCK_PORT_POSIX)
+static K_THREAD_STACK_DEFINE(span_tracer_drain_stack, SPAN_TRACER_DRAIN_STACK_SIZE);
+static struct k_thread span_tracer_drain_thread;
+#endif
+
+
+/**
+ * @brief Sets up a ring without registering it.
+*/
+static int Ring_Setup(SpanTracerRing * a_ring, const char * a_name, uint8_t * a_buf, uint32_t a_buf_size)
+{
+	if((a_buf_size < (2U * SPAN_TRACER_MAX_RECORD_SIZE)) || ((a_buf_size & (a_buf_size - 1U)) != 0U)){
+		return -EINVAL;
+	}
+
+	memset(a_ring, 0, sizeof(* a_ring));
+	a_ring->name = a_name;
+	a_ring->buf  = a_buf;
+	a_ring->mask = a_buf_size - 1U;
+	a_ring->head_cycles = Get_Uptime_HW_Cycles_64();
+	a_ring->tail_cycles = a_ring->head_cycles;
+
+	return 0;
+}
+
+/**
+ * @brief Sets event names and measures the recording overhead. Call once at start up, before recording any event.
+ * @param [in] a_event_names 	Names indexed by event id, must stay valid i.e. a static array of string literals.
+ * @param [in] a_event_count 	number of names.
+ * @note Overhead is the mean cost of Span_Tracer_Instant() into a ring with room, measured with interrupts locked. It's printed with every dump.
+*/
+void Span_Tracer_Init(const char * const * a_event_names, uint32_t a_event_count)
+{
+	static uint8_t scratch_buf[SPAN_TRACER_CALIBRATION_BUF_SIZE];
+	SpanTracerRing scratch;
+
+	span_tracer_event_names = a_event_names;
+	span_tracer_event_count = a_event_count;
+
+	(void)Ring_Setup(&scratch, "calibration", scratch_buf, sizeof(scratch_buf));
+
+	unsigned int key = irq_lock();
+	uint32_t start = k_cycle_get_32();
+	for(int i = 0; i < SPAN_TRACER_CALIBRATION_ROUNDS; i++){
+		(void)Span_Tracer_Instant(&scratch, 0);
+	}
+	uint32_t cycles = k_cycle_get_32() - start;
+	irq_unlock(key);
+
+	span_tracer_record_cycles = cycles / SPAN_TRACER_CALIBRATION_ROUNDS;
+}
+
+/**
+ * @brief Initializes a ring and adds it to the list of rings that Span_Tracer_Drain_All() drains.
+ * @param [out] a_ring 	Pointer to the ring owned by the user, must stay valid as long as it's used i.e. static.
+ * @param [in]  a_name 	Name of the ring i.e. thread name, shown as thread name in the trace. Must stay valid i.e. a string literal.
+ * @param [in]  a_buf 	buffer for records, must stay valid as long as the ring is used.
+ * @param [in]  a_buf_size 	size of a_buf in bytes, a power of two and at least 2 * SPAN_TRACER_MAX_RECORD_SIZE.
+ * @retval 0 on success, -EINVAL if buffer size isn't valid.
+*/
+int Span_Tracer_Ring_Init(SpanTracerRing * a_ring, const char * a_name, uint8_t * a_buf, uint32_t a_buf_size)
+{
+	int err = Ring_Setup(a_ring, a_name, a_buf, a_buf_size);
+	if(err != 0){
+		return err;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&span_tracer_rings_lock);
+	a_ring->id = span_tracer_next_ring_id++;
+	sys_slist_append(&span_tracer_rings, &a_ring->node);
+	k_spin_unlock(&span_tracer_rings_lock, key);
+
+	return 0;
+}
+
+/**
+ * @brief Reads a varint starting at a_pos of the ring and returns the position after it.
+*/
+static uint32_t Get_Varint(const SpanTracerRing * a_ring, uint32_t a_pos, uint64_t * a_value)
+{
+	uint64_t value = 0;
+	uint32_t shift = 0;
+	uint8_t byte;
+
+	do{
+		byte = a_ring->buf[a_pos & a_ring->mask];
+		value |= (uint64_t)(byte & 0x7FU) << shift;
+		shift += 7U;
+		a_pos ++;
+	}while((byte & 0x80U) != 0U);
+
+	* a_value = value;
+
+	return a_pos;
+}
+
+/**
+ * @brief Prints records of a ring from a_start to a_end (exclusive) as one line, in hex.
+*/
+static void Print_Chunk(const SpanTracerRing * a_ring, uint64_t a_base_cycles, uint32_t a_start, uint32_t a_end)
+{
+	static const char hex[] = "0123456789abcdef";
+	char str[(2 * SPAN_TRACER_DUMP_CHUNK_SIZE) + 1];
+	uint32_t len = 0;
+
+	for(uint32_t pos = a_start; pos != a_end; pos++){
+		uint8_t byte = a_ring->buf[pos & a_ring->mask];
+		str[len++] = hex[byte >> 4];
+		str[len++] = hex[byte & 0x0FU];
+	}
+	str[len] = '\0';
+
+	printk("#ST D %"PRIu32" %"PRIu64" %s\n", a_ring->id, a_base_cycles, str);
+}
+
+/**
+ * @brief Prints the recorded events of a ring and frees their space. Can run concurrently with the writer of the ring; events recorded meanwhile are left for the next drain.
+ * @note Output lines: "#ST R <ring id> <recorded> <dropped> <name>" and "#ST D <ring id> <base cycles> <hex records>"; deltas of the first record on a D line are relative to its base cycles.
+ * @note Must not be called for the same ring from more than one context at a time.
+*/
+void Span_Tracer_Drain(SpanTracerRing * a_ring)
+{
+	uint32_t head  = __atomic_load_n(&a_ring->head, __ATOMIC_ACQUIRE);
+	uint32_t tail  = a_ring->tail;
+	uint32_t chunk = tail;
+	uint64_t chunk_cycles = a_ring->tail_cycles;
+	uint64_t header;
+	uint64_t delta;
+
+	// name is the last field so that it may contain spaces.
+	printk("#ST R %"PRIu32" %"PRIu32" %"PRIu32" %s\n", a_ring->id,
+	       __atomic_load_n(&a_ring->recorded, __ATOMIC_RELAXED), __atomic_load_n(&a_ring->dropped, __ATOMIC_RELAXED), a_ring->name);
+
+	while(tail != head){
+		uint32_t next = Get_Varint(a_ring, Get_Varint(a_ring, tail, &header), &delta);
+
+		if(next - chunk > SPAN_TRACER_DUMP_CHUNK_SIZE){
+			Print_Chunk(a_ring, chunk_cycles, chunk, tail);
+			chunk = tail;
+			chunk_cycles = a_ring->tail_cycles;
+		}
+		a_ring->tail_cycles += delta;
+		tail = next;
+	}
+	if(chunk != tail){
+		Print_Chunk(a_ring, chunk_cycles, chunk, tail);
+	}
+
+	__atomic_store_n(&a_ring->tail, tail, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Prints the header lines and drains all the rings initialized with Span_Tracer_Ring_Init().
+ * @note Header lines: "#ST S <HW cycles per sec> <record overhead cycles>" and "#ST N <event id> <name>" for every event name.
+*/
+void Span_Tracer_Drain_All(void)
+{
+	SpanTracerRing * ring;
+
+	printk("#ST S %d %"PRIu32"\n", Get_HW_Cycles_Per_Sec(), span_tracer_record_cycles);
+	for(uint32_t i = 0; i < span_tracer_event_count; i++){
+		printk("#ST N %"PRIu32" %s\n", i, span_tracer_event_names[i]);
+	}
+	SYS_SLIST_FOR_EACH_CONTAINER(&span_tracer_rings, ring, node){
+		Span_Tracer_Drain(ring);
+	}
+}
+
+#if !defined(TIME_AND_CLOCK_PORT_POSIX)
+static void Drain_Thread_Entry(void * a_period_ms, void * a_unused1, void * a_unused2)
+{
+	ARG_UNUSED(a_unused1);
+	ARG_UNUSED(a_unused2);
+
+	while(true){
+		k_msleep((int32_t)(uintptr_t)a_period_ms);
+		Span_Tracer_Drain_All();
+	}
+}
+
+/**
+ * @brief Starts a thread that drains all rings periodically. Call at most once.
+ * @param [in] a_period_ms 	drain period, rings must be big enough to hold the events of a period.
+ * @param [in] a_priority 	thread priority, should be lower than the traced threads i.e. K_LOWEST_APPLICATION_THREAD_PRIO.
+ * @note Not available on the POSIX backend; call Span_Tracer_Drain_All() from a thread of the application.
+*/
+void Span_Tracer_Start_Drain_Thread(uint32_t a_period_ms, int a_priority)
+{
+	k_thread_create(&span_tracer_drain_thread, span_tracer_drain_stack, K_THREAD_STACK_SIZEOF(span_tracer_drain_stack),
+			Drain_Thread_Entry, (void *)(uintptr_t)a_period_ms, NULL, NULL, a_priority, 0, K_NO_WAIT);
+	k_thread_name_set(&span_tracer_drain_thread, "span_tracer");
+}
+#endif
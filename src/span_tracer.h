@@ -0,0 +1,141 @@
+/**
+ * @author Batto1
+ * @brief  Span tracer: begin/end/instant events recorded into per thread (or per ISR) lock-free ring buffers with HW cycle timestamps, drained as text
+ *         lines that scripts/span_tracer_decode.py converts to Chrome trace / Perfetto JSON.
+ * @note   A record is two varints: (event id << 2 | type) and HW cycles since the previous record of the same ring. Typical record is 3 to 5 bytes.
+ * @note   Each ring has a single writer: one thread, or ISRs that can't preempt each other. Draining can be done from any other context concurrently.
+ *         If a ring is full, new events are dropped and counted; recorded ones are never overwritten so delta chain stays valid.
+*/
+
+#ifndef SPAN_TRACER_H
+#define SPAN_TRACER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "time_and_clock_port.h"
+#include "time_and_clock_utils.h"
+
+#define SPAN_TRACER_MAX_RECORD_SIZE 	13 	/* 3 byte header for event ids below 2^14 and 10 byte delta */
+#define SPAN_TRACER_MAX_EVENT_ID 	0x3FFFU
+#define SPAN_TRACER_DUMP_CHUNK_SIZE 	48 	/* max bytes of records printed per line */
+#define SPAN_TRACER_CALIBRATION_ROUNDS 	64
+
+#ifndef SPAN_TRACER_DRAIN_STACK_SIZE
+#define SPAN_TRACER_DRAIN_STACK_SIZE 	1024
+#endif
+
+/**
+ * @brief enum for event types, Chrome trace phases B, E and i.
+*/
+typedef enum SpanTracerEventType
+{
+	SPAN_TRACER_BEGIN = 0,
+	SPAN_TRACER_END = 1,
+	SPAN_TRACER_INSTANT = 2,
+}SpanTracerEventType;
+
+/**
+ * @brief struct type of a ring buffer. Use only through Span_Tracer_* routines.
+*/
+typedef struct spanTracerRing{
+	sys_snode_t 	node;
+	const char * 	name;
+	uint8_t * 	buf;
+	uint32_t 	mask; 			/* buffer size - 1, size is a power of two */
+	uint32_t 	id;
+	uint32_t 	head; 			/* written by the writer only, free running */
+	uint32_t 	tail; 			/* written by the drainer only, free running */
+	uint64_t 	head_cycles; 		/* HW cycles of the last recorded event, writer only */
+	uint64_t 	tail_cycles; 		/* HW cycles of the last drained event, drainer only */
+	uint32_t 	recorded;
+	uint32_t 	dropped;
+}SpanTracerRing;
+
+extern uint32_t span_tracer_record_cycles;
+
+void Span_Tracer_Init(const char * const * a_event_names, uint32_t a_event_count);
+int Span_Tracer_Ring_Init(SpanTracerRing * a_ring, const char * a_name, uint8_t * a_buf, uint32_t a_buf_size);
+void Span_Tracer_Drain(SpanTracerRing * a_ring);
+void Span_Tracer_Drain_All(void);
+#if !defined(TIME_AND_CLOCK_PORT_POSIX)
+void Span_Tracer_Start_Drain_Thread(uint32_t a_period_ms, int a_priority);
+#endif
+
+/**
+ * @brief Writes a varint (7 bits per byte, least significant first) and returns the byte after it.
+*/
+static inline uint8_t * Span_Tracer_Put_Varint(uint8_t * a_dst, uint64_t a_value)
+{
+	while(a_value >= 0x80U){
+		* a_dst++ = (uint8_t)(a_value | 0x80U);
+		a_value >>= 7;
+	}
+	* a_dst++ = (uint8_t)a_value;
+
+	return a_dst;
+}
+
+/**
+ * @brief Records an event. Lock-free, bounded: encodes at most SPAN_TRACER_MAX_RECORD_SIZE bytes and copies them.
+ * @param [in, out] a_ring 	Pointer to the ring of the calling thread or ISR.
+ * @param [in] a_type 		event type.
+ * @param [in] a_event_id 	index of the event name given to Span_Tracer_Init(), at most SPAN_TRACER_MAX_EVENT_ID.
+ * @retval true if recorded, false if dropped because the ring is full.
+*/
+static inline bool Span_Tracer_Record(SpanTracerRing * a_ring, SpanTracerEventType a_type, uint16_t a_event_id)
+{
+	uint8_t record[SPAN_TRACER_MAX_RECORD_SIZE];
+	uint64_t cycles = Get_Uptime_HW_Cycles_64();
+
+	uint8_t * end = Span_Tracer_Put_Varint(record, ((uint32_t)(a_event_id & SPAN_TRACER_MAX_EVENT_ID) << 2) | (uint32_t)a_type);
+	end = Span_Tracer_Put_Varint(end, cycles - a_ring->head_cycles);
+
+	uint32_t len  = (uint32_t)(end - record);
+	uint32_t head = a_ring->head;
+	uint32_t tail = __atomic_load_n(&a_ring->tail, __ATOMIC_ACQUIRE);
+
+	if(len > (a_ring->mask + 1U) - (head - tail)){
+		a_ring->dropped ++;
+		return false;
+	}
+
+	uint32_t pos   = head & a_ring->mask;
+	uint32_t first = MIN(len, (a_ring->mask + 1U) - pos);
+	memcpy(&a_ring->buf[pos], record, first);
+	memcpy(a_ring->buf, &record[first], len - first);
+
+	a_ring->head_cycles = cycles;
+	a_ring->recorded ++;
+	__atomic_store_n(&a_ring->head, head + len, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+static inline bool Span_Tracer_Begin(SpanTracerRing * a_ring, uint16_t a_event_id)
+{
+	return Span_Tracer_Record(a_ring, SPAN_TRACER_BEGIN, a_event_id);
+}
+
+static inline bool Span_Tracer_End(SpanTracerRing * a_ring, uint16_t a_event_id)
+{
+	return Span_Tracer_Record(a_ring, SPAN_TRACER_END, a_event_id);
+}
+
+static inline bool Span_Tracer_Instant(SpanTracerRing * a_ring, uint16_t a_event_id)
+{
+	return Span_Tracer_Record(a_ring, SPAN_TRACER_INSTANT, a_event_id);
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
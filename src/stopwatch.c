@@ -0,0 +1,202 @@
+/**
+ * @author Batto1
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "time_and_clock_port.h"
+
+#include "stopwatch.h"
+
+
+uint32_t stopwatch_overhead_cycles = 0;
+
+static sys_slist_t stopwatch_sections = SYS_SLIST_STATIC_INIT(&stopwatch_sections);
+static struct k_spinlock stopwatch_sections_lock;
+
+
+/**
+ * @brief Calibrates the measurement overhead. Smallest of STOPWATCH_CALIBRATION_ROUNDS empty measurements is taken as the overhead.
+ * @note Call once at start up, before recording any sample. Interrupts are locked during calibration so that they don't inflate it.
+*/
+void Stopwatch_Init(void)
+{
+	uint32_t overhead = UINT32_MAX;
+
+	stopwatch_overhead_cycles = 0;
+
+	unsigned int key = irq_lock();
+	for(int i = 0; i < STOPWATCH_CALIBRATION_ROUNDS; i++){
+		uint32_t start = Stopwatch_Start();
+		uint32_t end   = k_cycle_get_32();
+		uint32_t cycles = end - start;
+
+		overhead = (cycles < overhead) ? cycles : overhead;
+	}
+	irq_unlock(key);
+
+	stopwatch_overhead_cycles = overhead;
+}
+
+/**
+ * @brief Initializes a section and adds it to the list of sections that Stopwatch_Print_All_Reports() prints.
+ * @param [out] a_section 	Pointer to the section owned by the user, must stay valid as long as it's used i.e. static.
+ * @param [in]  a_name 		Name of the section, must stay valid as long as the section is used i.e. a string literal.
+ * @note Calling it again on a section that is already in the list renames and resets the section; it isn't added twice.
+*/
+void Stopwatch_Section_Init(StopwatchSection * a_section, const char * a_name)
+{
+	StopwatchSection * section;
+	bool registered = false;
+
+	k_spinlock_key_t key = k_spin_lock(&stopwatch_sections_lock);
+	SYS_SLIST_FOR_EACH_CONTAINER(&stopwatch_sections, section, node){
+		if(section == a_section){
+			registered = true;
+			break;
+		}
+	}
+	if(!registered){
+		memset(a_section, 0, sizeof(* a_section));
+		sys_slist_append(&stopwatch_sections, &a_section->node);
+	}
+	a_section->name = a_name;
+	k_spin_unlock(&stopwatch_sections_lock, key);
+
+	if(registered){
+		Stopwatch_Section_Reset(a_section);
+	}
+}
+
+/**
+ * @brief Clears the statistics of a section. Section stays in the list.
+*/
+void Stopwatch_Section_Reset(StopwatchSection * a_section)
+{
+	a_section->count         = 0;
+	a_section->min_cycles    = 0;
+	a_section->max_cycles    = 0;
+	a_section->first_cycles  = 0;
+	a_section->sum_dev       = 0;
+	a_section->sum_dev_sq_lo = 0;
+	a_section->sum_dev_sq_hi = 0;
+}
+
+/**
+ * @brief Square root of a 64 bit value, rounded down.
+*/
+static uint32_t Sqrt_U64(uint64_t a_value)
+{
+	uint64_t result = 0;
+	uint64_t bit = (uint64_t)1 << 62;
+
+	while(bit > a_value){
+		bit >>= 2;
+	}
+	while(bit != 0U){
+		if(a_value >= result + bit){
+			a_value -= result + bit;
+			result = (result >> 1) + bit;
+		}else{
+			result >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return (uint32_t)result;
+}
+
+/**
+ * @brief Generates the report of a section; mean, standard deviation and time conversions are calculated here.
+ * @param [out] a_report 	Pointer to the user provided buffer where the report will be written.
+ * @param [in]  a_section 	Pointer to the section.
+ * @note Standard deviation is the sample standard deviation. Report of an empty section has all values 0.
+*/
+void Stopwatch_Get_Report(StopwatchReport * a_report, const StopwatchSection * a_section)
+{
+	memset(a_report, 0, sizeof(* a_report));
+	a_report->name  = a_section->name;
+	a_report->count = a_section->count;
+
+	if(a_section->count != 0U){
+		double n        = (double)a_section->count;
+		double sum_dev  = (double)a_section->sum_dev;
+		double sum_sq   = ((double)a_section->sum_dev_sq_hi * 18446744073709551616.0) + (double)a_section->sum_dev_sq_lo;
+		double variance = (a_section->count > 1U) ? ((sum_sq - ((sum_dev * sum_dev) / n)) / (n - 1.0)) : 0.0;
+
+		a_report->min_cycles    = a_section->min_cycles;
+		a_report->max_cycles    = a_section->max_cycles;
+		a_report->mean_cycles   = (uint32_t)((int64_t)a_section->first_cycles + (a_section->sum_dev / (int64_t)a_section->count));
+		a_report->stddev_cycles = Sqrt_U64((variance > 0.0) ? (uint64_t)variance : 0U);
+	}
+
+	a_report->min_ns    = k_cyc_to_ns_floor64(a_report->min_cycles);
+	a_report->max_ns    = k_cyc_to_ns_floor64(a_report->max_cycles);
+	a_report->mean_ns   = k_cyc_to_ns_floor64(a_report->mean_cycles);
+	a_report->stddev_ns = k_cyc_to_ns_floor64(a_report->stddev_cycles);
+	a_report->min       = HW_Cycles_To_Clock_Time_64(a_report->min_cycles);
+	a_report->max       = HW_Cycles_To_Clock_Time_64(a_report->max_cycles);
+	a_report->mean      = HW_Cycles_To_Clock_Time_64(a_report->mean_cycles);
+}
+
+/**
+ * @brief Prints the report of a section i.e. "ctrl_loop: n=1000 min=[0:0:0:0.012,345] max=... mean=... stddev=123 ns"
+*/
+void Stopwatch_Print_Report(const StopwatchSection * a_section)
+{
+	StopwatchReport report;
+	char min_buf[CLOCK_MAX_STRING_SIZE];
+	char max_buf[CLOCK_MAX_STRING_SIZE];
+	char mean_buf[CLOCK_MAX_STRING_SIZE];
+
+	Stopwatch_Get_Report(&report, a_section);
+	(void)Clock_Format(min_buf,  sizeof(min_buf),  &report.min,  CLOCK_FIELD_ALL);
+	(void)Clock_Format(max_buf,  sizeof(max_buf),  &report.max,  CLOCK_FIELD_ALL);
+	(void)Clock_Format(mean_buf, sizeof(mean_buf), &report.mean, CLOCK_FIELD_ALL);
+
+	printk("%s: n=%"PRIu32" %s min=%s max=%s mean=%s stddev=%"PRIu64" ns (min=%"PRIu64" max=%"PRIu64" mean=%"PRIu64" ns)\n",
+	       report.name, report.count, Clock_Legend_Str(CLOCK_FIELD_ALL), min_buf, max_buf, mean_buf,
+	       report.stddev_ns, report.min_ns, report.max_ns, report.mean_ns);
+}
+
+/**
+ * @brief Prints the report of a section as one JSON object per line so that results can be collected from the console and compared between builds.
+ * i.e. {"type":"stopwatch","name":"ctrl_loop","n":1000,"min_cyc":10,"max_cyc":20,"mean_cyc":12,"stddev_cyc":2,"mean_ns":71,"overhead_cyc":4}
+*/
+void Stopwatch_Print_Report_Json(const StopwatchSection * a_section)
+{
+	StopwatchReport report;
+
+	Stopwatch_Get_Report(&report, a_section);
+	printk("{\"type\":\"stopwatch\",\"name\":\"%s\",\"n\":%"PRIu32",\"min_cyc\":%"PRIu32",\"max_cyc\":%"PRIu32",\"mean_cyc\":%"PRIu32
+	       ",\"stddev_cyc\":%"PRIu32",\"min_ns\":%"PRIu64",\"max_ns\":%"PRIu64",\"mean_ns\":%"PRIu64",\"stddev_ns\":%"PRIu64",\"overhead_cyc\":%"PRIu32"}\n",
+	       report.name, report.count, report.min_cycles, report.max_cycles, report.mean_cycles,
+	       report.stddev_cycles, report.min_ns, report.max_ns, report.mean_ns, report.stddev_ns, stopwatch_overhead_cycles);
+}
+
+/**
+ * @brief Prints the reports of all sections initialized with Stopwatch_Section_Init().
+*/
+void Stopwatch_Print_All_Reports(void)
+{
+	StopwatchSection * section;
+
+	printk("* I: stopwatch overhead = %"PRIu32" cycles (subtracted)\n", stopwatch_overhead_cycles);
+	SYS_SLIST_FOR_EACH_CONTAINER(&stopwatch_sections, section, node){
+		Stopwatch_Print_Report(section);
+	}
+}
+
+/**
+ * @brief Prints the reports of all sections as JSON lines, see Stopwatch_Print_Report_Json().
+*/
+void Stopwatch_Print_All_Reports_Json(void)
+{
+	StopwatchSection * section;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&stopwatch_sections, section, node){
+		Stopwatch_Print_Report_Json(section);
+	}
+}
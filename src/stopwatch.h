@@ -0,0 +1,121 @@
+/**
+ * @author Batto1
+ * @brief  Stopwatch for profiling code sections with HW cycle resolution. Hot path only reads the HW cycle counter and updates a few integers;
+ *         conversion to clock format is done only when a report is generated.
+ * @note   Measurement overhead (cost of reading the counter twice) is calibrated at Stopwatch_Init() and subtracted from every sample.
+ * @note   A section measures regions shorter than 2^32 HW cycles. Samples of a section must be recorded from one thread or ISR at a time.
+*/
+
+#ifndef STOPWATCH_H
+#define STOPWATCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "time_and_clock_utils.h"
+
+#define STOPWATCH_CALIBRATION_ROUNDS 	64 	/* number of empty measurements done for calibrating the overhead */
+
+/**
+ * @brief struct type that holds statistics of a named code section. Use only through Stopwatch_* routines.
+*/
+typedef struct stopwatchSection{
+	sys_snode_t 	node;
+	const char * 	name;
+	uint32_t 	count;
+	uint32_t 	min_cycles;
+	uint32_t 	max_cycles;
+	uint32_t 	first_cycles; 		/* first sample, deviations are accumulated relative to it to keep variance precise */
+	int64_t 	sum_dev; 		/* sum of (sample - first_cycles) */
+	uint64_t 	sum_dev_sq_lo; 		/* sum of (sample - first_cycles)^2, 128 bit */
+	uint64_t 	sum_dev_sq_hi;
+}StopwatchSection;
+
+/**
+ * @brief struct type that holds a report of a section. Generated on demand by Stopwatch_Get_Report().
+*/
+typedef struct stopwatchReport{
+	const char * 		name;
+	uint32_t 		count;
+	uint32_t 		min_cycles;
+	uint32_t 		max_cycles;
+	uint32_t 		mean_cycles;
+	uint32_t 		stddev_cycles;
+	uint64_t 		min_ns;
+	uint64_t 		max_ns;
+	uint64_t 		mean_ns;
+	uint64_t 		stddev_ns;
+	TimeElapsedClock 	min;
+	TimeElapsedClock 	max;
+	TimeElapsedClock 	mean;
+}StopwatchReport;
+
+extern uint32_t stopwatch_overhead_cycles;
+
+void Stopwatch_Init(void);
+void Stopwatch_Section_Init(StopwatchSection * a_section, const char * a_name);
+void Stopwatch_Section_Reset(StopwatchSection * a_section);
+void Stopwatch_Get_Report(StopwatchReport * a_report, const StopwatchSection * a_section);
+void Stopwatch_Print_Report(const StopwatchSection * a_section);
+void Stopwatch_Print_All_Reports(void);
+void Stopwatch_Print_Report_Json(const StopwatchSection * a_section);
+void Stopwatch_Print_All_Reports_Json(void);
+
+/**
+ * @brief Adds a sample to the section. Calibrated overhead is subtracted. Hot path, no conversion is done.
+ * @param [in, out] a_section 	Pointer to the initialized section.
+ * @param [in] a_cycles 		measured duration in HW cycles, including the measurement overhead.
+*/
+static inline void Stopwatch_Record(StopwatchSection * a_section, uint32_t a_cycles)
+{
+	uint32_t cycles = (a_cycles > stopwatch_overhead_cycles) ? (a_cycles - stopwatch_overhead_cycles) : 0U;
+
+	if(a_section->count == 0U){
+		a_section->first_cycles = cycles;
+		a_section->min_cycles   = cycles;
+		a_section->max_cycles   = cycles;
+	}
+	a_section->min_cycles = (cycles < a_section->min_cycles) ? cycles : a_section->min_cycles;
+	a_section->max_cycles = (cycles > a_section->max_cycles) ? cycles : a_section->max_cycles;
+
+	int64_t  dev     = (int64_t)cycles - (int64_t)a_section->first_cycles;
+	uint64_t dev_abs = (dev < 0) ? (uint64_t)(-dev) : (uint64_t)dev;
+	uint64_t dev_sq  = dev_abs * dev_abs; // |dev| < 2^32, can't overflow
+
+	a_section->sum_dev       += dev;
+	a_section->sum_dev_sq_lo += dev_sq;
+	a_section->sum_dev_sq_hi += (a_section->sum_dev_sq_lo < dev_sq) ? 1U : 0U; // carry
+	a_section->count ++;
+}
+
+/**
+ * @brief Starts measuring a section.
+ * @return start value to be passed to Stopwatch_Stop().
+*/
+static inline uint32_t Stopwatch_Start(void)
+{
+	return k_cycle_get_32();
+}
+
+/**
+ * @brief Stops measuring a section that was started with Stopwatch_Start() and records the sample.
+ * @param [in, out] a_section 	Pointer to the initialized section.
+ * @param [in] a_start 		value returned from Stopwatch_Start().
+*/
+static inline void Stopwatch_Stop(StopwatchSection * a_section, uint32_t a_start)
+{
+	uint32_t end = k_cycle_get_32();
+
+	Stopwatch_Record(a_section, end - a_start);
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,338 @@
+/**
+ * @author Batto1
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "time_and_clock_port.h"
+
+#include "thread_usage.h"
+
+
+#define THREAD_USAGE_OVERFLOW_INDEX 	THREAD_USAGE_MAX_THREADS
+
+/* A single state is switched and sampled with interrupts locked, which doesn't exclude the other CPUs. */
+BUILD_ASSERT(!IS_ENABLED(CONFIG_SMP), "thread usage accounting is single core only");
+
+static ThreadUsage thread_usage = {
+	.current = &thread_usage.entries[THREAD_USAGE_OVERFLOW_INDEX],
+};
+
+static const uint8_t thread_usage_windows[THREAD_USAGE_WINDOW_COUNT] = {
+	THREAD_USAGE_WINDOW_SHORT, THREAD_USAGE_WINDOW_MEDIUM, THREAD_USAGE_WINDOW_LONG
+};
+
+#if !defined(TIME_AND_CLOCK_PORT_POSIX)
+static struct k_timer thread_usage_timer;
+#endif
+
+
+/**
+ * @brief Home index of a thread in the table, a multiplicative hash of the thread pointer.
+*/
+static inline uint32_t Home_Index(const void * a_thread)
+{
+	return ((((uint32_t)((uintptr_t)a_thread >> 3)) * 0x9E3779B1U) >> 16) & (THREAD_USAGE_MAX_THREADS - 1);
+}
+
+/**
+ * @brief Finds the entry of a thread, open addressing with linear probing from its home index.
+ * @param [in] a_insert 	Takes a free entry if the thread isn't found. If the table is full, returns the overflow entry.
+ * @retval entry of the thread, NULL if it isn't found and a_insert is false.
+*/
+static inline ThreadUsageEntry * Find_Entry(const void * a_thread, bool a_insert)
+{
+	if(a_thread == NULL){
+		return &thread_usage.entries[THREAD_USAGE_OVERFLOW_INDEX];
+	}
+
+	uint32_t index = Home_Index(a_thread);
+
+	for(uint32_t i = 0; i < THREAD_USAGE_MAX_THREADS; i++){
+		ThreadUsageEntry * entry = &thread_usage.entries[(index + i) & (THREAD_USAGE_MAX_THREADS - 1)];
+
+		if(entry->thread == a_thread){
+			return entry;
+		}
+		if(entry->thread == NULL){
+			if(!a_insert){
+				return NULL;
+			}
+			entry->thread = a_thread;
+			return entry;
+		}
+	}
+
+	return a_insert ? &thread_usage.entries[THREAD_USAGE_OVERFLOW_INDEX] : NULL;
+}
+
+/**
+ * @brief Frees an entry of the table. Entries probed past it are shifted back into the hole (no tombstones), so lookups stay as short as
+ *        before the thread was added. Called with interrupts locked.
+*/
+static void Remove_Entry(ThreadUsageEntry * a_entry)
+{
+	uint32_t hole  = (uint32_t)(a_entry - thread_usage.entries);
+	uint32_t start = hole;
+
+	for(uint32_t i = 1; i < THREAD_USAGE_MAX_THREADS; i++){
+		uint32_t index = (start + i) & (THREAD_USAGE_MAX_THREADS - 1);
+		ThreadUsageEntry * entry = &thread_usage.entries[index];
+
+		if(entry->thread == NULL){
+			break;
+		}
+		// an entry can move back to the hole only if its home isn't between the hole and where it is now.
+		uint32_t home = Home_Index(entry->thread);
+		if(((index - home) & (THREAD_USAGE_MAX_THREADS - 1)) >= ((index - hole) & (THREAD_USAGE_MAX_THREADS - 1))){
+			thread_usage.entries[hole] = * entry;
+			if(thread_usage.current == entry){
+				thread_usage.current = &thread_usage.entries[hole];
+			}
+			hole = index;
+		}
+	}
+	memset(&thread_usage.entries[hole], 0, sizeof(thread_usage.entries[hole]));
+}
+
+/**
+ * @brief Marks a thread as running. Called from the thread switch hook, with interrupts locked.
+ * @param [in] a_thread 	thread that is switched in, k_tid_t.
+*/
+void Thread_Usage_Switched_In(const void * a_thread)
+{
+	thread_usage.current            = Find_Entry(a_thread, true);
+	thread_usage.switched_in_cycles = k_cycle_get_32();
+}
+
+/**
+ * @brief Adds the cycles the running thread has run to its total. Called from the thread switch hook, with interrupts locked.
+*/
+void Thread_Usage_Switched_Out(void)
+{
+	uint32_t now = k_cycle_get_32();
+
+	thread_usage.current->total_cycles += (uint32_t)(now - thread_usage.switched_in_cycles);
+}
+
+/**
+ * @brief Clears all totals and histories. Running thread keeps being accounted.
+*/
+void Thread_Usage_Reset(void)
+{
+	unsigned int key = irq_lock();
+	const void * running = thread_usage.current->thread;
+	uint32_t now = k_cycle_get_32();
+
+	memset(thread_usage.entries, 0, sizeof(thread_usage.entries));
+	thread_usage.current            = Find_Entry(running, true);
+	thread_usage.switched_in_cycles = now;
+	thread_usage.sampled_cycles     = now;
+	thread_usage.head               = 0;
+	thread_usage.sample_count       = 0;
+	irq_unlock(key);
+}
+
+/**
+ * @brief Releases the entry of a thread that exited or was aborted, so that the table doesn't fill up with dead threads and a new thread
+ *        created at the same address starts from zero. Time of the thread is dropped with it.
+ * @param [in] a_thread 	thread, k_tid_t. Nothing is done if it isn't tracked.
+ * @note Called from the sys_trace_thread_abort_user() hook on zephyr, which runs for k_thread_abort() and for threads returning from their entry.
+ *       If the thread aborts itself, the rest of its last run is accounted to the overflow entry.
+*/
+void Thread_Usage_Thread_Exited(const void * a_thread)
+{
+	if(a_thread == NULL){
+		return;
+	}
+
+	unsigned int key = irq_lock();
+	ThreadUsageEntry * entry = Find_Entry(a_thread, false);
+
+	if(entry != NULL){
+		if(entry == thread_usage.current){
+			thread_usage.current            = &thread_usage.entries[THREAD_USAGE_OVERFLOW_INDEX];
+			thread_usage.switched_in_cycles = k_cycle_get_32();
+		}
+		Remove_Entry(entry);
+	}
+	irq_unlock(key);
+}
+
+/**
+ * @brief Records the utilization of every thread since the previous sample into its history.
+ * @note Call every THREAD_USAGE_SAMPLE_PERIOD_MS, from an ISR or a thread. Thread_Usage_Init() starts a kernel timer for it on zephyr.
+ *       Utilization is relative to the time elapsed between the samples, so a late sample doesn't skew it.
+*/
+void Thread_Usage_Sample(void)
+{
+	unsigned int key = irq_lock();
+	uint32_t now    = k_cycle_get_32();
+	uint32_t period = now - thread_usage.sampled_cycles;
+
+	// close the running span so that a thread that doesn't switch out is accounted every period, and its delta can't wrap.
+	thread_usage.current->total_cycles += (uint32_t)(now - thread_usage.switched_in_cycles);
+	thread_usage.switched_in_cycles     = now;
+
+	if(period == 0U){
+		irq_unlock(key);
+		return;
+	}
+	thread_usage.sampled_cycles = now;
+
+	for(uint32_t i = 0; i <= THREAD_USAGE_MAX_THREADS; i++){
+		ThreadUsageEntry * entry = &thread_usage.entries[i];
+		uint64_t delta = entry->total_cycles - entry->sampled_cycles;
+
+		entry->sampled_cycles = entry->total_cycles;
+		entry->history[thread_usage.head] = (uint16_t)MIN((delta * THREAD_USAGE_FULL) / period, (uint64_t)THREAD_USAGE_FULL);
+	}
+
+	thread_usage.head = (uint8_t)((thread_usage.head + 1U < THREAD_USAGE_HISTORY) ? (thread_usage.head + 1U) : 0U);
+	if(thread_usage.sample_count < THREAD_USAGE_HISTORY){
+		thread_usage.sample_count++;
+	}
+	irq_unlock(key);
+}
+
+/**
+ * @brief Copies an entry, with the running span of the current thread added to its total. Called with interrupts locked.
+*/
+static void Entry_Copy(ThreadUsageEntry * a_copy, const ThreadUsageEntry * a_entry)
+{
+	* a_copy = * a_entry;
+	if(a_entry == thread_usage.current){
+		a_copy->total_cycles += (uint32_t)(k_cycle_get_32() - thread_usage.switched_in_cycles);
+	}
+}
+
+/**
+ * @brief Fills the stats from a copy of an entry, taken with the history head and sample count at the same time.
+*/
+static void Entry_Stats(const ThreadUsageEntry * a_copy, uint8_t a_head, uint8_t a_count, ThreadUsageStats * a_stats)
+{
+	a_stats->total_cycles = a_copy->total_cycles;
+	a_stats->total        = HW_Cycles_To_Clock_Time_64(a_copy->total_cycles);
+
+	for(uint32_t w = 0; w < THREAD_USAGE_WINDOW_COUNT; w++){
+		uint32_t samples = MIN((uint32_t)thread_usage_windows[w], (uint32_t)a_count);
+		uint32_t index = a_head;
+		uint32_t sum = 0;
+
+		for(uint32_t i = 0; i < samples; i++){
+			index = (index == 0U) ? (THREAD_USAGE_HISTORY - 1U) : (index - 1U);
+			sum += a_copy->history[index];
+		}
+		a_stats->window[w]         = (uint16_t)((samples != 0U) ? (sum / samples) : 0U);
+		a_stats->window_samples[w] = (uint8_t)samples;
+	}
+}
+
+/**
+ * @brief Gets the CPU time and windowed utilization of a thread.
+ * @param [in]  a_thread 	thread, k_tid_t. NULL gives the overflow entry, time of the threads that didn't fit in the table.
+ * @param [out] a_stats 	usage of the thread.
+ * @retval TIME_UTIL_ERROR_NOT_FOUND if the thread hasn't run since accounting started or was reset.
+*/
+TimeAndClockErrors Thread_Usage_Get(const void * a_thread, ThreadUsageStats * a_stats)
+{
+	ThreadUsageEntry copy;
+
+	// entries move when others are released, so the entry is copied while it's found.
+	unsigned int key = irq_lock();
+	const ThreadUsageEntry * entry = Find_Entry(a_thread, false);
+	if(entry == NULL){
+		irq_unlock(key);
+		return TIME_UTIL_ERROR_NOT_FOUND;
+	}
+	Entry_Copy(&copy, entry);
+	uint8_t head  = thread_usage.head;
+	uint8_t count = thread_usage.sample_count;
+	irq_unlock(key);
+
+	Entry_Stats(&copy, head, count, a_stats);
+
+	return TIME_UTIL_ERROR_NONE;
+}
+
+/**
+ * @brief Prints the usage of every thread i.e. "main: cpu=[0:0:1:23.456,789] 12.34% 10.05% 9.87%" for the 1, 10 and 60 sample windows.
+*/
+void Thread_Usage_Print_Report(void)
+{
+	printk("* I: thread usage, utilization over the last %u/%u/%u samples of %u ms\n", (unsigned int)THREAD_USAGE_WINDOW_SHORT,
+	       (unsigned int)THREAD_USAGE_WINDOW_MEDIUM, (unsigned int)THREAD_USAGE_WINDOW_LONG, (unsigned int)THREAD_USAGE_SAMPLE_PERIOD_MS);
+
+	for(uint32_t i = 0; i <= THREAD_USAGE_MAX_THREADS; i++){
+		ThreadUsageEntry copy;
+		ThreadUsageStats stats;
+		char clock_buf[40];
+
+		unsigned int key = irq_lock();
+		Entry_Copy(&copy, &thread_usage.entries[i]);
+		uint8_t head  = thread_usage.head;
+		uint8_t count = thread_usage.sample_count;
+		irq_unlock(key);
+
+		const void * thread = copy.thread;
+		if((thread == NULL) && ((i != THREAD_USAGE_OVERFLOW_INDEX) || (copy.total_cycles == 0U))){
+			continue;
+		}
+		Entry_Stats(&copy, head, count, &stats);
+		(void)Clock_Format(clock_buf, sizeof(clock_buf), &stats.total, CLOCK_FIELD_ALL);
+
+		const char * name = NULL;
+#if !defined(TIME_AND_CLOCK_PORT_POSIX) && defined(CONFIG_THREAD_NAME)
+		name = (thread != NULL) ? k_thread_name_get((k_tid_t)thread) : NULL;
+#endif
+		if((name == NULL) || (name[0] == '\0')){
+			printk("%p", thread);
+		}else{
+			printk("%s", name);
+		}
+		printk(": cpu=%s %u.%02u%% %u.%02u%% %u.%02u%%\n", clock_buf,
+		       stats.window[0] / 100U, stats.window[0] % 100U, stats.window[1] / 100U, stats.window[1] % 100U,
+		       stats.window[2] / 100U, stats.window[2] % 100U);
+	}
+}
+
+#if !defined(TIME_AND_CLOCK_PORT_POSIX)
+static void Thread_Usage_Timer_Handler(struct k_timer * a_timer)
+{
+	ARG_UNUSED(a_timer);
+	Thread_Usage_Sample();
+}
+
+#if defined(CONFIG_TRACING_USER)
+void sys_trace_thread_switched_in_user(void)
+{
+	Thread_Usage_Switched_In(k_current_get());
+}
+
+void sys_trace_thread_switched_out_user(void)
+{
+	Thread_Usage_Switched_Out();
+}
+
+void sys_trace_thread_abort_user(struct k_thread * thread)
+{
+	Thread_Usage_Thread_Exited(thread);
+}
+#endif
+#endif
+
+/**
+ * @brief Starts accounting from zero. On zephyr starts the kernel timer that samples every THREAD_USAGE_SAMPLE_PERIOD_MS; call once.
+ * @note On the POSIX backend there are no thread switches: call Thread_Usage_Switched_In/Out() and Thread_Usage_Sample() from the application.
+*/
+void Thread_Usage_Init(void)
+{
+	Thread_Usage_Reset();
+
+#if !defined(TIME_AND_CLOCK_PORT_POSIX)
+	k_timer_init(&thread_usage_timer, Thread_Usage_Timer_Handler, NULL);
+	k_timer_start(&thread_usage_timer, K_MSEC(THREAD_USAGE_SAMPLE_PERIOD_MS), K_MSEC(THREAD_USAGE_SAMPLE_PERIOD_MS));
+#endif
+}
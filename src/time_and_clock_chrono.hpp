@@ -0,0 +1,233 @@
+/**
+ * @author Batto1
+ * @brief  C++17 std::chrono adapters of the library, header-only.
+ *         uptime_tick_clock and hw_cycle_clock meet the TrivialClock requirements; their periods are the Kconfig rates as std::ratio, so
+ *         duration_cast between them and std::chrono units is a multiplication or a division by a constant that the compiler resolves at build time.
+ * @note   Conversions to/from TimeElapsedClock and format_clock() are constexpr: they can be used in static_assert and constant initializers.
+ *         format_clock() gives the same string as Clock_Format().
+ * @note   hw_cycle_clock is available only if the HW cycle rate is a build time constant, not with CONFIG_TIMER_READS_ITS_FREQUENCY_AT_RUNTIME.
+ *         Use Cycle_Conversion_* routines for runtime rates.
+ * @note   now() is noexcept. Built with C++ exceptions (CONFIG_CPP_EXCEPTIONS), hw_cycle_clock::now() can't tail call Get_Uptime_HW_Cycles_64()
+ *         since C routines aren't known not to throw, which costs a stack adjustment; without them, the default, it's the same code as the C call.
+*/
+
+#ifndef TIME_AND_CLOCK_CHRONO_HPP
+#define TIME_AND_CLOCK_CHRONO_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ratio>
+#include <string_view>
+
+#include "time_and_clock_port.h"
+#include "time_and_clock_utils.h"
+
+#if !defined(CONFIG_TIMER_READS_ITS_FREQUENCY_AT_RUNTIME) && defined(CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC) && (CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC > 0)
+#define TIME_AND_CLOCK_CHRONO_HW_CYCLE_CLOCK 1
+#else
+#define TIME_AND_CLOCK_CHRONO_HW_CYCLE_CLOCK 0
+#endif
+
+namespace time_and_clock {
+
+/**
+ * @brief Uptime in system ticks, k_uptime_ticks().
+*/
+struct uptime_tick_clock{
+	using rep        = int64_t;
+	using period     = std::ratio<1, CONFIG_SYS_CLOCK_TICKS_PER_SEC>;
+	using duration   = std::chrono::duration<rep, period>;
+	using time_point = std::chrono::time_point<uptime_tick_clock>;
+
+	static constexpr bool is_steady = true;
+
+	static time_point now() noexcept
+	{
+		return time_point(duration(k_uptime_ticks()));
+	}
+};
+
+#if TIME_AND_CLOCK_CHRONO_HW_CYCLE_CLOCK
+/**
+ * @brief Uptime in 64 bit HW cycles, Get_Uptime_HW_Cycles_64().
+*/
+struct hw_cycle_clock{
+	using rep        = int64_t;
+	using period     = std::ratio<1, CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC>;
+	using duration   = std::chrono::duration<rep, period>;
+	using time_point = std::chrono::time_point<hw_cycle_clock>;
+
+	static constexpr bool is_steady = true;
+
+	static time_point now() noexcept
+	{
+		return time_point(duration(static_cast<rep>(Get_Uptime_HW_Cycles_64())));
+	}
+};
+#endif
+
+/**
+ * @brief Split a duration into clock fields. Rounds down to micro seconds like the library's conversions; negative durations give a zero clock.
+*/
+template <class Rep, class Period>
+constexpr TimeElapsedClock to_clock(std::chrono::duration<Rep, Period> a_duration) noexcept
+{
+	if(a_duration.count() <= 0){
+		return TimeElapsedClock{};
+	}
+
+	// non-negative from here on, so truncation is rounding down.
+	uint64_t total = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(a_duration).count());
+	uint64_t secs  = total / 1000000U;
+	uint32_t sub   = static_cast<uint32_t>(total % 1000000U);
+	TimeElapsedClock clk{};
+
+	clk.u_sec = static_cast<uint16_t>(sub % 1000U);
+	clk.m_sec = static_cast<uint16_t>(sub / 1000U);
+	clk.sec   = static_cast<uint8_t>(secs % 60U);
+	clk.min   = static_cast<uint8_t>((secs / 60U) % 60U);
+	clk.hour  = static_cast<uint8_t>((secs / 3600U) % 24U);
+	clk.day   = static_cast<uint32_t>(secs / 86400U);
+
+	return clk;
+}
+
+/**
+ * @brief Clock fields of a time point, i.e. uptime_tick_clock::now().
+*/
+template <class Clock, class Duration>
+constexpr TimeElapsedClock to_clock(std::chrono::time_point<Clock, Duration> a_time_point) noexcept
+{
+	return to_clock(a_time_point.time_since_epoch());
+}
+
+/**
+ * @brief Duration of clock fields. Lossless, fields don't need to be normalized.
+*/
+constexpr std::chrono::microseconds from_clock(const TimeElapsedClock & a_clock) noexcept
+{
+	return std::chrono::microseconds(
+		(static_cast<int64_t>(a_clock.day) * 86400000000LL) + (static_cast<int64_t>(a_clock.hour) * 3600000000LL)
+		+ (static_cast<int64_t>(a_clock.min) * 60000000LL) + (static_cast<int64_t>(a_clock.sec) * 1000000LL)
+		+ (static_cast<int64_t>(a_clock.m_sec) * 1000LL) + static_cast<int64_t>(a_clock.u_sec));
+}
+
+/**
+ * @brief std::chrono duration of a TimeDuration, and back.
+*/
+constexpr std::chrono::microseconds from_duration(TimeDuration a_duration) noexcept
+{
+	return std::chrono::microseconds(a_duration);
+}
+
+template <class Rep, class Period>
+constexpr TimeDuration to_duration(std::chrono::duration<Rep, Period> a_duration) noexcept
+{
+	return static_cast<TimeDuration>(std::chrono::floor<std::chrono::microseconds>(a_duration).count());
+}
+
+/**
+ * @brief String of a formatted clock, returned by value from format_clock().
+*/
+struct clock_string{
+	char 		data[40] = {}; 	/* enough even for not normalized clocks, like Clock_Format() */
+	std::size_t 	size = 0;
+
+	constexpr const char * c_str() const noexcept
+	{
+		return data;
+	}
+
+	constexpr std::string_view view() const noexcept
+	{
+		return std::string_view(data, size);
+	}
+
+	friend constexpr bool operator==(const clock_string & a_str, std::string_view a_other) noexcept
+	{
+		return a_str.view() == a_other;
+	}
+
+	friend constexpr bool operator!=(const clock_string & a_str, std::string_view a_other) noexcept
+	{
+		return a_str.view() != a_other;
+	}
+};
+
+namespace detail {
+
+constexpr void append_uint(clock_string & a_str, uint32_t a_value, uint32_t a_min_width) noexcept
+{
+	char digits[10] = {};
+	uint32_t len = 0;
+
+	do{
+		digits[len++] = static_cast<char>('0' + (a_value % 10U));
+		a_value /= 10U;
+	}while(a_value != 0U);
+	while(len < a_min_width){
+		digits[len++] = '0';
+	}
+	while(len > 0U){
+		a_str.data[a_str.size++] = digits[--len];
+	}
+}
+
+} // namespace detail
+
+/**
+ * @brief Formats clock fields like Clock_Format() i.e. "[1:2:3:4.5,6]", or "[1:02:03:04.005,006]" with CLOCK_FORMAT_ZERO_PAD.
+ * @param [in] a_clock 	clock value.
+ * @param [in] a_fields 	Bitmask of CLOCK_FIELD_* flags, optionally ORed with CLOCK_FORMAT_ZERO_PAD.
+*/
+constexpr clock_string format_clock(const TimeElapsedClock & a_clock, uint32_t a_fields = CLOCK_FIELD_ALL) noexcept
+{
+	clock_string str;
+	uint32_t pad = ((a_fields & CLOCK_FORMAT_ZERO_PAD) != 0U) ? 1U : 0U;
+
+	str.data[str.size++] = '[';
+	if((a_fields & CLOCK_FIELD_DAY) != 0U){
+		detail::append_uint(str, a_clock.day, 1U);
+	}
+	if((a_fields & CLOCK_FIELD_HOUR) != 0U){
+		str.data[str.size++] = ':';
+		detail::append_uint(str, a_clock.hour, 1U + pad);
+	}
+	if((a_fields & CLOCK_FIELD_MIN) != 0U){
+		str.data[str.size++] = ':';
+		detail::append_uint(str, a_clock.min, 1U + pad);
+	}
+	if((a_fields & CLOCK_FIELD_SEC) != 0U){
+		str.data[str.size++] = ':';
+		detail::append_uint(str, a_clock.sec, 1U + pad);
+	}
+	if((a_fields & CLOCK_FIELD_MSEC) != 0U){
+		str.data[str.size++] = '.';
+		detail::append_uint(str, a_clock.m_sec, 1U + (2U * pad));
+	}
+	if((a_fields & CLOCK_FIELD_USEC) != 0U){
+		str.data[str.size++] = ',';
+		detail::append_uint(str, a_clock.u_sec, 1U + (2U * pad));
+	}
+	str.data[str.size++] = ']';
+
+	return str;
+}
+
+/**
+ * @brief Formats a duration in clock format, see format_clock().
+*/
+template <class Rep, class Period>
+constexpr clock_string format_clock(std::chrono::duration<Rep, Period> a_duration, uint32_t a_fields = CLOCK_FIELD_ALL) noexcept
+{
+	return format_clock(to_clock(a_duration), a_fields);
+}
+
+static_assert(format_clock(std::chrono::hours(26) + std::chrono::microseconds(4005006)) == "[1:2:0:4.5,6]");
+static_assert(format_clock(std::chrono::milliseconds(3723004), CLOCK_FIELD_ALL | CLOCK_FORMAT_ZERO_PAD) == "[0:01:02:03.004,000]");
+static_assert(from_clock(to_clock(std::chrono::seconds(987654321))) == std::chrono::seconds(987654321));
+
+} // namespace time_and_clock
+
+#endif
@@ -0,0 +1,25 @@
+/**
+ * @author Batto1
+ * @brief  Internal to the library: decimal digit table shared by the formatters of time_and_clock_utils.c and wall_clock.c.
+*/
+
+#ifndef TIME_AND_CLOCK_DIGITS_H
+#define TIME_AND_CLOCK_DIGITS_H
+
+#include <stdint.h>
+#include <string.h>
+
+/* "00".."99", two characters are emitted at once while writing numbers. Defined in time_and_clock_utils.c. */
+extern const char time_and_clock_digit_pairs[200];
+
+/**
+ * @brief Writes a number below 100 as two digits and returns the character after them. No NUL is written.
+*/
+static inline char * Time_And_Clock_Put_2_Digits(char * a_dst, uint32_t a_value)
+{
+	memcpy(a_dst, &time_and_clock_digit_pairs[a_value * 2U], 2);
+
+	return a_dst + 2;
+}
+
+#endif
@@ -0,0 +1,23 @@
+/**
+ * @author Batto1
+ * @brief  Clock source backend selection for the library. Library sources include this header instead of zephyr headers directly.
+ * @note   Backend is selected at compile time:
+ *         - Zephyr (default): kernel APIs are used as they are.
+ *         - POSIX (TIME_AND_CLOCK_PORT_POSIX is defined): time_and_clock_port_posix.h provides the subset of zephyr APIs the library uses
+ *           (uptime ticks, HW cycles, their frequencies and unit conversions) on top of clock_gettime() or rdtsc. See host/CMakeLists.txt.
+*/
+
+#ifndef TIME_AND_CLOCK_PORT_H
+#define TIME_AND_CLOCK_PORT_H
+
+#if defined(TIME_AND_CLOCK_PORT_POSIX)
+#include "time_and_clock_port_posix.h"
+#else
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/slist.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/logging/log.h>
+#endif
+
+#endif
@@ -0,0 +1,74 @@
+/**
+ * @author Batto1
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "time_and_clock_port.h"
+
+
+#if defined(TIME_AND_CLOCK_PORT_POSIX_FAKE_UPTIME)
+int64_t port_posix_fake_uptime_ticks;
+uint64_t port_posix_fake_cycles;
+#endif
+
+
+#if defined(TIME_AND_CLOCK_PORT_POSIX_RDTSC)
+
+#define PORT_POSIX_CALIBRATION_NS 	20000000U 	/* 20 ms */
+
+static uint32_t cycles_per_sec;
+
+/**
+ * @brief Measures the time stamp counter frequency against CLOCK_MONOTONIC.
+ * @note HW cycle rate is 32 bits wide like sys_clock_hw_cycles_per_sec() of zephyr; a counter faster than 4.29 GHz aborts the program instead of
+ *       wrapping to a wrong rate. Build without TIME_AND_CLOCK_PORT_POSIX_RDTSC on such hosts.
+*/
+static uint32_t Calibrate_Cycles_Per_Sec(void)
+{
+	uint64_t start_ns     = Port_Posix_Monotonic_Ns();
+	uint64_t start_cycles = __builtin_ia32_rdtsc();
+	uint64_t end_ns       = start_ns;
+
+	while(end_ns - start_ns < PORT_POSIX_CALIBRATION_NS){
+		end_ns = Port_Posix_Monotonic_Ns();
+	}
+	uint64_t end_cycles = __builtin_ia32_rdtsc();
+
+	uint64_t freq = ((end_cycles - start_cycles) * 1000000000U) / (end_ns - start_ns);
+
+	if((freq == 0U) || (freq > UINT32_MAX)){
+		fprintf(stderr, "time stamp counter runs at %llu Hz, which doesn't fit the 32 bit HW cycle rate\n", (unsigned long long)freq);
+		abort();
+	}
+
+	return (uint32_t)freq;
+}
+
+/**
+ * @brief Frequency of the time stamp counter. Calibrated once at the first call; concurrent first calls may calibrate more than once but
+ * all of them see a valid value.
+*/
+uint32_t Port_Posix_Cycles_Per_Sec(void)
+{
+	uint32_t freq = __atomic_load_n(&cycles_per_sec, __ATOMIC_ACQUIRE);
+
+	if(freq == 0U){
+		freq = Calibrate_Cycles_Per_Sec();
+		__atomic_store_n(&cycles_per_sec, freq, __ATOMIC_RELEASE);
+	}
+
+	return freq;
+}
+
+#else
+
+uint32_t Port_Posix_Cycles_Per_Sec(void)
+{
+	return CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC;
+}
+
+#endif
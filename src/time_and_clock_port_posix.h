@@ -0,0 +1,295 @@
+/**
+ * @author Batto1
+ * @brief  POSIX clock source backend. Provides the subset of zephyr APIs the library uses so that it can be built and profiled on a host without zephyr.
+ * @note   Uptime ticks come from CLOCK_MONOTONIC at CONFIG_SYS_CLOCK_TICKS_PER_SEC (default 10000). If TIME_AND_CLOCK_PORT_POSIX_FAKE_UPTIME is
+ *         defined, uptime ticks and HW cycles are set by the program with Port_Posix_Set_Uptime_Ticks() and Port_Posix_Set_Cycles() instead,
+ *         so that a test can drive the library through a simulated uptime.
+ * @note   HW cycles come from CLOCK_MONOTONIC in nanoseconds (1 GHz) by default. If TIME_AND_CLOCK_PORT_POSIX_RDTSC is defined on x86, they come
+ *         from the time stamp counter and its frequency is calibrated against CLOCK_MONOTONIC at the first use (CONFIG_TIMER_READS_ITS_FREQUENCY_AT_RUNTIME).
+ * @note   Interrupt locking is a no-op and spinlocks are plain spinning locks; there are no ISRs on the host.
+*/
+
+#ifndef TIME_AND_CLOCK_PORT_POSIX_H
+#define TIME_AND_CLOCK_PORT_POSIX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+
+
+/* ------------------  CONFIGURATION ------------------ */
+#ifndef CONFIG_SYS_CLOCK_TICKS_PER_SEC
+#define CONFIG_SYS_CLOCK_TICKS_PER_SEC 		10000
+#endif
+
+#if defined(TIME_AND_CLOCK_PORT_POSIX_RDTSC)
+#define CONFIG_TIMER_READS_ITS_FREQUENCY_AT_RUNTIME 	1
+#define CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC 		0 	/* not known at build time */
+#else
+#define CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC 		1000000000
+#endif
+
+
+/* ------------------  UTILITIES ------------------ */
+#define ALWAYS_INLINE 		inline __attribute__((always_inline))
+#ifndef __aligned
+#define __aligned(a_x) 		__attribute__((__aligned__(a_x)))
+#endif
+#ifdef __cplusplus
+#define BUILD_ASSERT(a_cond, ...) 	static_assert(a_cond, "" __VA_ARGS__)
+#else
+#define BUILD_ASSERT(a_cond, ...) 	_Static_assert(a_cond, "" __VA_ARGS__)
+#endif
+#define BIT64(a_n) 		((uint64_t)1 << (a_n))
+/* 1 if a_config is defined to 1, 0 otherwise; works in BUILD_ASSERT and #if like zephyr's */
+#define IS_ENABLED(a_config) 				Z_IS_ENABLED1(a_config)
+#define Z_IS_ENABLED1(a_config) 			Z_IS_ENABLED2(_XXXX##a_config)
+#define _XXXX1 						_YYYY,
+#define Z_IS_ENABLED2(a_one_or_two_args) 		Z_IS_ENABLED3(a_one_or_two_args 1, 0)
+#define Z_IS_ENABLED3(a_ignore_this, a_val, ...) 	a_val
+#define ARRAY_SIZE(a_array) 	(sizeof(a_array) / sizeof((a_array)[0]))
+#ifndef MAX
+#define MAX(a, b) 		(((a) > (b)) ? (a) : (b))
+#endif
+#ifndef MIN
+#define MIN(a, b) 		(((a) < (b)) ? (a) : (b))
+#endif
+#ifndef CLAMP
+#define CLAMP(val, low, high) 	(((val) <= (low)) ? (low) : MIN(val, high))
+#endif
+#define ROUND_UP(x, align) 	((((x) + (align) - 1) / (align)) * (align))
+#define ROUND_DOWN(x, align) 	(((x) / (align)) * (align))
+#define ARG_UNUSED(a_x) 	(void)(a_x)
+#define CONTAINER_OF(a_ptr, a_type, a_field) 	((a_type *)(((char *)(a_ptr)) - offsetof(a_type, a_field)))
+
+#define printk 		printf
+#define snprintk 	snprintf
+
+#define LOG_MODULE_REGISTER(...)
+#define LOG_MODULE_DECLARE(...)
+#define LOG_ERR(a_fmt, ...) 	fprintf(stderr, "<err> " a_fmt "\n", ##__VA_ARGS__)
+#define LOG_WRN(a_fmt, ...) 	fprintf(stderr, "<wrn> " a_fmt "\n", ##__VA_ARGS__)
+#define LOG_INF(a_fmt, ...) 	fprintf(stderr, "<inf> " a_fmt "\n", ##__VA_ARGS__)
+#define LOG_DBG(a_fmt, ...) 	do { } while(0)
+
+
+/* ------------------  CLOCK SOURCE ------------------ */
+uint32_t Port_Posix_Cycles_Per_Sec(void);
+
+/**
+ * @brief CLOCK_MONOTONIC in nanoseconds.
+*/
+static inline uint64_t Port_Posix_Monotonic_Ns(void)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Converts between two frequencies, rounding down. Same selection as zephyr's z_tmcvt(): exact ratios are a single multiplication or
+ * division, the rest is computed with 128 bit intermediate so it doesn't overflow.
+*/
+static inline uint64_t Port_Posix_Convert(uint64_t a_t, uint32_t a_from_hz, uint32_t a_to_hz)
+{
+	if(a_from_hz == a_to_hz){
+		return a_t;
+	}
+	if((a_to_hz > a_from_hz) && ((a_to_hz % a_from_hz) == 0U)){
+		return a_t * (a_to_hz / a_from_hz);
+	}
+	if((a_from_hz > a_to_hz) && ((a_from_hz % a_to_hz) == 0U)){
+		return a_t / (a_from_hz / a_to_hz);
+	}
+
+	return (uint64_t)(((unsigned __int128)a_t * a_to_hz) / a_from_hz);
+}
+
+/**
+ * @brief Same as Port_Posix_Convert(), rounded up.
+*/
+static inline uint64_t Port_Posix_Convert_Ceil(uint64_t a_t, uint32_t a_from_hz, uint32_t a_to_hz)
+{
+	return (uint64_t)((((unsigned __int128)a_t * a_to_hz) + a_from_hz - 1U) / a_from_hz);
+}
+
+static inline int sys_clock_hw_cycles_per_sec(void)
+{
+#if defined(TIME_AND_CLOCK_PORT_POSIX_RDTSC)
+	return (int)Port_Posix_Cycles_Per_Sec();
+#else
+	return CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC;
+#endif
+}
+
+#if defined(TIME_AND_CLOCK_PORT_POSIX_FAKE_UPTIME)
+extern int64_t port_posix_fake_uptime_ticks;
+extern uint64_t port_posix_fake_cycles;
+
+/**
+ * @brief Sets the uptime k_uptime_ticks() returns from now on. Independent of the HW cycles.
+*/
+static inline void Port_Posix_Set_Uptime_Ticks(int64_t a_ticks)
+{
+	__atomic_store_n(&port_posix_fake_uptime_ticks, a_ticks, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Sets the HW cycle count k_cycle_get_64() and k_cycle_get_32() return from now on. Independent of the uptime ticks.
+*/
+static inline void Port_Posix_Set_Cycles(uint64_t a_cycles)
+{
+	__atomic_store_n(&port_posix_fake_cycles, a_cycles, __ATOMIC_RELAXED);
+}
+#endif
+
+static inline int64_t k_uptime_ticks(void)
+{
+#if defined(TIME_AND_CLOCK_PORT_POSIX_FAKE_UPTIME)
+	return __atomic_load_n(&port_posix_fake_uptime_ticks, __ATOMIC_RELAXED);
+#else
+	return (int64_t)Port_Posix_Convert(Port_Posix_Monotonic_Ns(), 1000000000U, CONFIG_SYS_CLOCK_TICKS_PER_SEC);
+#endif
+}
+
+static inline uint64_t k_cycle_get_64(void)
+{
+#if defined(TIME_AND_CLOCK_PORT_POSIX_FAKE_UPTIME)
+	return __atomic_load_n(&port_posix_fake_cycles, __ATOMIC_RELAXED);
+#elif defined(TIME_AND_CLOCK_PORT_POSIX_RDTSC)
+	return __builtin_ia32_rdtsc();
+#else
+	return Port_Posix_Monotonic_Ns();
+#endif
+}
+
+static inline uint32_t k_cycle_get_32(void)
+{
+	return (uint32_t)k_cycle_get_64();
+}
+
+static inline void k_busy_wait(uint32_t a_usec_to_wait)
+{
+	uint64_t end = Port_Posix_Monotonic_Ns() + ((uint64_t)a_usec_to_wait * 1000U);
+
+	while(Port_Posix_Monotonic_Ns() < end){
+	}
+}
+
+#define k_ticks_to_us_floor64(t) 	Port_Posix_Convert((uint64_t)(t), CONFIG_SYS_CLOCK_TICKS_PER_SEC, 1000000U)
+#define k_ticks_to_ms_floor64(t) 	Port_Posix_Convert((uint64_t)(t), CONFIG_SYS_CLOCK_TICKS_PER_SEC, 1000U)
+#define k_us_to_ticks_floor64(t) 	Port_Posix_Convert((uint64_t)(t), 1000000U, CONFIG_SYS_CLOCK_TICKS_PER_SEC)
+#define k_us_to_ticks_ceil64(t) 	Port_Posix_Convert_Ceil((uint64_t)(t), 1000000U, CONFIG_SYS_CLOCK_TICKS_PER_SEC)
+#define k_cyc_to_us_floor64(t) 		Port_Posix_Convert((uint64_t)(t), (uint32_t)sys_clock_hw_cycles_per_sec(), 1000000U)
+#define k_cyc_to_ms_floor64(t) 		Port_Posix_Convert((uint64_t)(t), (uint32_t)sys_clock_hw_cycles_per_sec(), 1000U)
+#define k_cyc_to_ns_floor64(t) 		Port_Posix_Convert((uint64_t)(t), (uint32_t)sys_clock_hw_cycles_per_sec(), 1000000000U)
+#define k_cyc_to_us_floor32(t) 		((uint32_t)k_cyc_to_us_floor64((uint32_t)(t)))
+#define k_cyc_to_ms_floor32(t) 		((uint32_t)k_cyc_to_ms_floor64((uint32_t)(t)))
+
+
+/* ------------------  LOCKS AND ATOMICS ------------------ */
+struct k_spinlock{
+	volatile bool 	locked;
+};
+typedef int k_spinlock_key_t;
+
+static inline k_spinlock_key_t k_spin_lock(struct k_spinlock * a_lock)
+{
+	while(__atomic_test_and_set(&a_lock->locked, __ATOMIC_ACQUIRE)){
+	}
+	return 0;
+}
+
+static inline void k_spin_unlock(struct k_spinlock * a_lock, k_spinlock_key_t a_key)
+{
+	(void)a_key;
+	__atomic_clear(&a_lock->locked, __ATOMIC_RELEASE);
+}
+
+static inline unsigned int irq_lock(void)
+{
+	return 0;
+}
+
+static inline void irq_unlock(unsigned int a_key)
+{
+	(void)a_key;
+}
+
+typedef long atomic_t;
+typedef long atomic_val_t;
+
+static inline atomic_val_t atomic_get(const atomic_t * a_target)
+{
+	return __atomic_load_n(a_target, __ATOMIC_SEQ_CST);
+}
+
+static inline atomic_val_t atomic_set(atomic_t * a_target, atomic_val_t a_value)
+{
+	return __atomic_exchange_n(a_target, a_value, __ATOMIC_SEQ_CST);
+}
+
+static inline atomic_val_t atomic_clear(atomic_t * a_target)
+{
+	return atomic_set(a_target, 0);
+}
+
+static inline atomic_val_t atomic_add(atomic_t * a_target, atomic_val_t a_value)
+{
+	return __atomic_fetch_add(a_target, a_value, __ATOMIC_SEQ_CST);
+}
+
+static inline atomic_val_t atomic_inc(atomic_t * a_target)
+{
+	return atomic_add(a_target, 1);
+}
+
+static inline bool atomic_cas(atomic_t * a_target, atomic_val_t a_old_value, atomic_val_t a_new_value)
+{
+	return __atomic_compare_exchange_n(a_target, &a_old_value, a_new_value, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+
+/* ------------------  SINGLY LINKED LIST ------------------ */
+typedef struct _snode{
+	struct _snode * 	next;
+}sys_snode_t;
+
+typedef struct{
+	sys_snode_t * 	head;
+	sys_snode_t * 	tail;
+}sys_slist_t;
+
+#define SYS_SLIST_STATIC_INIT(a_list) 	{NULL, NULL}
+
+static inline void sys_slist_append(sys_slist_t * a_list, sys_snode_t * a_node)
+{
+	a_node->next = NULL;
+	if(a_list->tail != NULL){
+		a_list->tail->next = a_node;
+	}else{
+		a_list->head = a_node;
+	}
+	a_list->tail = a_node;
+}
+
+#define SYS_SLIST_FOR_EACH_CONTAINER(a_list, a_container, a_field) 							\
+	for((a_container) = ((a_list)->head != NULL) ? CONTAINER_OF((a_list)->head, __typeof__(*(a_container)), a_field) : NULL; 	\
+	    (a_container) != NULL; 												\
+	    (a_container) = ((a_container)->a_field.next != NULL) ? CONTAINER_OF((a_container)->a_field.next, __typeof__(*(a_container)), a_field) : NULL)
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -7,10 +7,11 @@
 #include <string.h>
 #include <inttypes.h>
 
-#include "zephyr/kernel.h"
-#include <zephyr/logging/log.h>
+#include "time_and_clock_port.h"
 
 #include "time_and_clock_utils.h"
+#include "time_and_clock_digits.h"
+#include "cycle_counter_64.h"
 
 
 LOG_MODULE_REGISTER(time_and_clock_utils, LOG_LEVEL_DBG);
@@ -31,6 +32,244 @@ uint64_t Micro_Sec_To_Sec(uint64_t a_micro_sec)
 
 
 
+/* ------------------  DIVISION-FREE DECOMPOSITION ------------------ */
+/*
+ * Clock decomposition is done without any 64 bit division. Divisions by constants are replaced with multiply-shift
+ * reciprocals (Granlund-Montgomery round-up method) that are exact for every 64 bit dividend. The reciprocals are
+ * evaluated by the compiler since all divisors are either fixed (1000000, 86400) or come from Kconfig.
+ * Total time is split into whole seconds and sub-second micro seconds; then into days and second of the day. After the
+ * split, all clock fields are derived with 32 bit math only.
+ */
+
+#define TCU_USEC_PER_SEC 	1000000U
+#define TCU_SEC_PER_DAY 	86400U
+
+/* ceil(log2(d)) of the divisor. Valid for 2 <= d <= 2^32. */
+#define TCU_RECIP_SHIFT(d) 	((uint8_t)(64 - __builtin_clzll((uint64_t)(d) - 1U)))
+/* 2^l - d, the distance of the divisor to the next power of two. */
+#define TCU_RECIP_GAP(d) 	(BIT64(TCU_RECIP_SHIFT(d)) - (uint64_t)(d))
+/* floor(2^64 * (2^l - d) / d) + 1, computed as a two step long division so that it fits in 64 bit constant math. */
+#define TCU_RECIP_MUL(d) 	((((TCU_RECIP_GAP(d) << 32) / (uint64_t)(d)) << 32) 					\
+					+ ((((TCU_RECIP_GAP(d) << 32) % (uint64_t)(d)) << 32) / (uint64_t)(d)) + 1U)
+
+/* Divide a 64 bit value by a constant divisor without a division instruction or a libgcc call. */
+#define TCU_DIV_U64_BY_CONST(n, d) 	Div_U64_By_Reciprocal((n), TCU_RECIP_MUL(d), TCU_RECIP_SHIFT(d))
+
+/**
+ * @brief Returns the upper 64 bits of the 128 bit product of two 64 bit values.
+ * @note Uses native 128 bit math where the compiler supports it, four 32x32 multiplications otherwise.
+*/
+static ALWAYS_INLINE uint64_t Mul_High_U64(uint64_t a_x, uint64_t a_y)
+{
+#if defined(__SIZEOF_INT128__)
+	return (uint64_t)(((unsigned __int128)a_x * a_y) >> 64);
+#else
+	uint32_t x_lo = (uint32_t)a_x;
+	uint32_t x_hi = (uint32_t)(a_x >> 32);
+	uint32_t y_lo = (uint32_t)a_y;
+	uint32_t y_hi = (uint32_t)(a_y >> 32);
+
+	uint64_t lo_lo = (uint64_t)x_lo * y_lo;
+	uint64_t hi_lo = (uint64_t)x_hi * y_lo;
+	uint64_t lo_hi = (uint64_t)x_lo * y_hi;
+	uint64_t hi_hi = (uint64_t)x_hi * y_hi;
+
+	uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi; // can not overflow, see Hacker's Delight 8-2.
+
+	return hi_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+}
+
+/**
+ * @brief Divides a 64 bit value by using a precomputed reciprocal. Use TCU_DIV_U64_BY_CONST() instead of calling it directly.
+ * @param [in] a_dividend 	value to be divided.
+ * @param [in] a_mul 		reciprocal multiplier, TCU_RECIP_MUL(divisor).
+ * @param [in] a_shift 	reciprocal shift, TCU_RECIP_SHIFT(divisor).
+ * @return floor(a_dividend / divisor) for every 64 bit dividend.
+*/
+static ALWAYS_INLINE uint64_t Div_U64_By_Reciprocal(uint64_t a_dividend, uint64_t a_mul, uint8_t a_shift)
+{
+	uint64_t t = Mul_High_U64(a_dividend, a_mul);
+
+	return (t + ((a_dividend - t) >> 1)) >> (a_shift - 1);
+}
+
+/**
+ * @brief Convert ticks to micro seconds. Gives the same result as k_ticks_to_us_floor64().
+ * @note If tick rate is an integer multiple of 1 MHz, zephyr's conversion is a 64 bit division; it is replaced with a reciprocal here. 
+ * Other tick rates are either a multiplication or a power of two division in zephyr's conversion already, so they are left to it.
+*/
+static ALWAYS_INLINE uint64_t Ticks_To_Micro_Sec_Fast(uint64_t a_ticks)
+{
+#if (CONFIG_SYS_CLOCK_TICKS_PER_SEC > TCU_USEC_PER_SEC) && ((CONFIG_SYS_CLOCK_TICKS_PER_SEC % TCU_USEC_PER_SEC) == 0)
+	return TCU_DIV_U64_BY_CONST(a_ticks, CONFIG_SYS_CLOCK_TICKS_PER_SEC / TCU_USEC_PER_SEC);
+#else
+	return k_ticks_to_us_floor64(a_ticks);
+#endif
+}
+
+/**
+ * @brief Returns bits [a_shift, a_shift + 64) of the 128 bit product of two 64 bit values. a_shift must be between 1 and 127.
+*/
+static ALWAYS_INLINE uint64_t Mul_Shift_U64(uint64_t a_x, uint64_t a_y, uint32_t a_shift)
+{
+	uint64_t high = Mul_High_U64(a_x, a_y);
+
+	if(a_shift >= 64U){
+		return high >> (a_shift - 64U);
+	}
+
+	return (high << (64U - a_shift)) | ((a_x * a_y) >> a_shift);
+}
+
+/* Library's HW cycle conversion, set up from sys_clock_hw_cycles_per_sec() at the first use. */
+static CycleConversion hw_cycles_conversion;
+
+/**
+ * @brief Converts counts with a consistent copy of the conversion factor. Lock-free; retries only if the factor was updated meanwhile.
+*/
+static ALWAYS_INLINE uint64_t Cycle_Conversion_Apply(const CycleConversion * a_conv, uint64_t a_counts)
+{
+	uint32_t sequence;
+	uint64_t mult;
+	uint32_t shift;
+
+	do{
+		sequence = __atomic_load_n(&a_conv->sequence, __ATOMIC_ACQUIRE);
+
+		mult  = a_conv->mult;
+		shift = a_conv->shift;
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	}while(((sequence & 1U) != 0U) || (sequence != __atomic_load_n(&a_conv->sequence, __ATOMIC_RELAXED)));
+
+	return Mul_Shift_U64(a_counts, mult, shift);
+}
+
+/**
+ * @brief Convert HW cycles to micro seconds. Gives the same result as k_cyc_to_us_floor64().
+ * @note If HW cycle rate is a build time constant and an integer multiple of 1 MHz (i.e. 64 MHz, 168 MHz), zephyr's conversion is a 64 bit 
+ * division; it is replaced with a reciprocal here. If CONFIG_TIMER_READS_ITS_FREQUENCY_AT_RUNTIME is defined, rate isn't known at build time and zephyr's conversion is used.
+ * @note If TIME_UTIL_RUNTIME_CYCLE_CONVERSION is set to 1, the calibrated conversion of Get_HW_Cycles_Conversion() is used instead: one multiply-high,
+ * result is k_cyc_to_us_floor64() or 1 micro second less when no drift correction is applied. Off by default for that reason.
+*/
+static ALWAYS_INLINE uint64_t HW_Cycles_To_Micro_Sec_Fast(uint64_t a_cycles)
+{
+#if TIME_UTIL_RUNTIME_CYCLE_CONVERSION
+	if(0U == __atomic_load_n(&hw_cycles_conversion.counts_per_sec, __ATOMIC_RELAXED)){
+		(void)Get_HW_Cycles_Conversion();
+	}
+	return Cycle_Conversion_Apply(&hw_cycles_conversion, a_cycles);
+#elif !defined(CONFIG_TIMER_READS_ITS_FREQUENCY_AT_RUNTIME) && defined(CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC) && \
+	(CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC > TCU_USEC_PER_SEC) && ((CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC % TCU_USEC_PER_SEC) == 0)
+	return TCU_DIV_U64_BY_CONST(a_cycles, CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC / TCU_USEC_PER_SEC);
+#else
+	return k_cyc_to_us_floor64(a_cycles);
+#endif
+}
+
+/**
+ * @brief Convert HW cycles to milli seconds. Same as k_cyc_to_ms_floor64(), or derived from HW_Cycles_To_Micro_Sec_Fast() if TIME_UTIL_RUNTIME_CYCLE_CONVERSION is 1.
+*/
+static ALWAYS_INLINE uint64_t HW_Cycles_To_Milli_Sec_Fast(uint64_t a_cycles)
+{
+#if TIME_UTIL_RUNTIME_CYCLE_CONVERSION
+	return TCU_DIV_U64_BY_CONST(HW_Cycles_To_Micro_Sec_Fast(a_cycles), 1000U);
+#else
+	return k_cyc_to_ms_floor64(a_cycles);
+#endif
+}
+
+/**
+ * @brief 32 bit versions of the above: k_cyc_to_us_floor32() and k_cyc_to_ms_floor32(), or the calibrated conversion.
+*/
+static ALWAYS_INLINE uint32_t HW_Cycles_To_Micro_Sec_Fast_32(uint32_t a_cycles)
+{
+#if TIME_UTIL_RUNTIME_CYCLE_CONVERSION
+	return (uint32_t)HW_Cycles_To_Micro_Sec_Fast(a_cycles);
+#else
+	return k_cyc_to_us_floor32(a_cycles);
+#endif
+}
+
+static ALWAYS_INLINE uint32_t HW_Cycles_To_Milli_Sec_Fast_32(uint32_t a_cycles)
+{
+#if TIME_UTIL_RUNTIME_CYCLE_CONVERSION
+	return (uint32_t)HW_Cycles_To_Milli_Sec_Fast(a_cycles);
+#else
+	return k_cyc_to_ms_floor32(a_cycles);
+#endif
+}
+
+/**
+ * @brief Split seconds of a day into clock fields. 32 bit math only.
+*/
+static ALWAYS_INLINE void Sec_Of_Day_To_Clock(TimeElapsedClock * a_clk, uint32_t a_sec_of_day)
+{
+	uint32_t total_minutes = a_sec_of_day / 60U;
+
+	a_clk->sec  = (uint8_t)(a_sec_of_day  - (total_minutes * 60U));
+	a_clk->min  = (uint8_t)(total_minutes % 60U);
+	a_clk->hour = (uint8_t)(total_minutes / 60U);
+}
+
+/**
+ * @brief Split micro seconds into clock fields. Days and sub-day parts are separated with reciprocals, the rest is 32 bit math.
+ * @note Gives the same result as dividing a_total_micro_sec successively by 1000, 1000, 60, 60, 24.
+*/
+static ALWAYS_INLINE TimeElapsedClock Micro_Sec_To_Clock_Fast(uint64_t a_total_micro_sec)
+{
+	TimeElapsedClock clk;
+
+	uint64_t total_sec  = TCU_DIV_U64_BY_CONST(a_total_micro_sec, TCU_USEC_PER_SEC);
+	uint32_t sub_sec_us = (uint32_t)(a_total_micro_sec - (total_sec * TCU_USEC_PER_SEC));
+	uint64_t total_days = TCU_DIV_U64_BY_CONST(total_sec, TCU_SEC_PER_DAY);
+	uint32_t sec_of_day = (uint32_t)(total_sec - (total_days * TCU_SEC_PER_DAY));
+
+	clk.u_sec = (uint16_t)(sub_sec_us % 1000U);
+	clk.m_sec = (uint16_t)(sub_sec_us / 1000U);
+	Sec_Of_Day_To_Clock(&clk, sec_of_day);
+	clk.day   = (uint32_t)total_days;
+
+	return clk;
+}
+
+/**
+ * @brief Split 32 bit micro seconds into clock fields.
+ * @note Gives the same result as dividing a_total_micro_sec successively by 1000, 1000, 60, 60, 24.
+*/
+static ALWAYS_INLINE TimeElapsedClock Micro_Sec_To_Clock_Fast_32(uint32_t a_total_micro_sec)
+{
+	TimeElapsedClock clk;
+
+	uint32_t total_sec  = a_total_micro_sec / TCU_USEC_PER_SEC;
+	uint32_t sub_sec_us = a_total_micro_sec - (total_sec * TCU_USEC_PER_SEC);
+	uint32_t total_days = total_sec / TCU_SEC_PER_DAY;
+
+	clk.u_sec = (uint16_t)(sub_sec_us % 1000U);
+	clk.m_sec = (uint16_t)(sub_sec_us / 1000U);
+	Sec_Of_Day_To_Clock(&clk, total_sec - (total_days * TCU_SEC_PER_DAY));
+	clk.day   = total_days;
+
+	return clk;
+}
+
+
+
+
+/**
+ * @brief Reads the 64 bit HW cycle counter that the Get_Uptime_HW_Cycles_*_64 routines use: the kernel's or the software extended one (TIME_UTIL_SW_CYCLE_COUNTER_64).
+*/
+static ALWAYS_INLINE uint64_t Read_HW_Cycles_64(void)
+{
+#if TIME_UTIL_SW_CYCLE_COUNTER_64
+	return Cycle_Counter_64_Get();
+#else
+	return k_cycle_get_64();
+#endif
+}
+
+
 /* ------------------  CLOCK ------------------ */
 /**
  * @brief Takes two positive time values in clock format and subtracts them. Final time value needs to be bigger than the initial time. 
@@ -234,9 +473,168 @@ void Increment_a_Second_And_Update_Clock(TimeElapsedClock * a_clock)
 	}
 }
 
+/*
+ * Clock legends for every combination of CLOCK_FIELD_* flags, indexed by the flags. Generated with the same rules as
+ * the legends Clock_To_Str() always printed: "[" + "d" + ":h" + ":m" + ":s" + ".ms" + ",us" + "]" for the selected fields.
+ */
+static const char * const clock_legends[CLOCK_FIELD_ALL + 1] = {
+	"[]",              "[,us]",           "[.ms]",           "[.ms,us]",
+	"[:s]",            "[:s,us]",         "[:s.ms]",         "[:s.ms,us]",
+	"[:m]",            "[:m,us]",         "[:m.ms]",         "[:m.ms,us]",
+	"[:m:s]",          "[:m:s,us]",       "[:m:s.ms]",       "[:m:s.ms,us]",
+	"[:h]",            "[:h,us]",         "[:h.ms]",         "[:h.ms,us]",
+	"[:h:s]",          "[:h:s,us]",       "[:h:s.ms]",       "[:h:s.ms,us]",
+	"[:h:m]",          "[:h:m,us]",       "[:h:m.ms]",       "[:h:m.ms,us]",
+	"[:h:m:s]",        "[:h:m:s,us]",     "[:h:m:s.ms]",     "[:h:m:s.ms,us]",
+	"[d]",             "[d,us]",          "[d.ms]",          "[d.ms,us]",
+	"[d:s]",           "[d:s,us]",        "[d:s.ms]",        "[d:s.ms,us]",
+	"[d:m]",           "[d:m,us]",        "[d:m.ms]",        "[d:m.ms,us]",
+	"[d:m:s]",         "[d:m:s,us]",      "[d:m:s.ms]",      "[d:m:s.ms,us]",
+	"[d:h]",           "[d:h,us]",        "[d:h.ms]",        "[d:h.ms,us]",
+	"[d:h:s]",         "[d:h:s,us]",      "[d:h:s.ms]",      "[d:h:s.ms,us]",
+	"[d:h:m]",         "[d:h:m,us]",      "[d:h:m.ms]",      "[d:h:m.ms,us]",
+	"[d:h:m:s]",       "[d:h:m:s,us]",    "[d:h:m:s.ms]",    "[d:h:m:s.ms,us]",
+};
+
+/* "00".."99", see time_and_clock_digits.h. */
+const char time_and_clock_digit_pairs[200] = {
+	'0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+	'1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+	'2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+	'3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+	'4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+	'5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+	'6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+	'7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+	'8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+	'9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9',
+};
+
+/**
+ * @brief Length of the legend of given fields without building it.
+*/
+static inline size_t Clock_Legend_Len(uint32_t a_fields)
+{
+	return 2U + ((a_fields >> 5) & 1U)
+		+ 2U * (((a_fields >> 4) & 1U) + ((a_fields >> 3) & 1U) + ((a_fields >> 2) & 1U))
+		+ 3U * (((a_fields >> 1) & 1U) + (a_fields & 1U));
+}
+
+/**
+ * @brief Writes a number in decimal to a_dst with at least a_min_width digits (zero padded). No NUL is written.
+ * @return pointer to the character after the last written digit.
+*/
+static char * Emit_Uint(char * a_dst, uint32_t a_value, uint32_t a_min_width)
+{
+	char digits[10]; // uint32_t has at most 10 digits
+	char * p = &digits[sizeof(digits)];
+
+	while(a_value >= 100U){
+		uint32_t pair = (a_value % 100U) * 2U;
+		a_value /= 100U;
+		*--p = time_and_clock_digit_pairs[pair + 1U];
+		*--p = time_and_clock_digit_pairs[pair];
+	}
+	if(a_value >= 10U){
+		*--p = time_and_clock_digit_pairs[(a_value * 2U) + 1U];
+		*--p = time_and_clock_digit_pairs[a_value * 2U];
+	}else{
+		*--p = (char)('0' + a_value);
+	}
+
+	size_t len = (size_t)(&digits[sizeof(digits)] - p);
+	while(len < a_min_width){
+		*a_dst++ = '0';
+		a_min_width--;
+	}
+	memcpy(a_dst, p, len);
+
+	return a_dst + len;
+}
+
+/**
+ * @brief Get the legend string of given clock fields i.e. "[d:h:m:s.ms,us]" for CLOCK_FIELD_ALL.
+ * @param [in] a_fields 	bitmask of CLOCK_FIELD_* flags. Other bits are ignored.
+ * @return pointer to a constant string, it's never NULL.
+*/
+const char * Clock_Legend_Str(uint32_t a_fields)
+{
+	return clock_legends[a_fields & CLOCK_FIELD_ALL];
+}
+
+/**
+ * @brief Converts given clock value to a string in a single pass. i.e. "[1:2:3:4.5,6]" or "[1:02:03:04.005,006]" if CLOCK_FORMAT_ZERO_PAD is given.
+ * @param [out] a_buf 		User provided buffer for writing the clock value in. Always NUL terminated if a_buf_size is not 0.
+ * @param [in]  a_buf_size 	Size of a_buf in bytes. CLOCK_MAX_STRING_SIZE is enough for every clock value.
+ * @param [in]  a_clock 		Pointer to the clock variable that user provides the clock values in it.
+ * @param [in]  a_fields 		Bitmask of CLOCK_FIELD_* flags for the fields to be included, optionally ORed with CLOCK_FORMAT_ZERO_PAD.
+ * @return length of the whole string without NUL, like snprintk(). If it's equal or bigger than a_buf_size, output was truncated.
+*/
+int Clock_Format(char * a_buf, size_t a_buf_size, const TimeElapsedClock * a_clock, uint32_t a_fields)
+{
+	char str[40]; // enough even for not normalized clocks: "[4294967295:255:255:255.65535,65535]"
+	char * p = str;
+	uint32_t pad = (0U != (a_fields & CLOCK_FORMAT_ZERO_PAD)) ? 1U : 0U;
+
+	*p++ = '[';
+	if(a_fields & CLOCK_FIELD_DAY){
+		p = Emit_Uint(p, a_clock->day, 1U);
+	}
+	if(a_fields & CLOCK_FIELD_HOUR){
+		*p++ = ':';
+		p = Emit_Uint(p, a_clock->hour, 1U + pad);
+	}
+	if(a_fields & CLOCK_FIELD_MIN){
+		*p++ = ':';
+		p = Emit_Uint(p, a_clock->min, 1U + pad);
+	}
+	if(a_fields & CLOCK_FIELD_SEC){
+		*p++ = ':';
+		p = Emit_Uint(p, a_clock->sec, 1U + pad);
+	}
+	if(a_fields & CLOCK_FIELD_MSEC){
+		*p++ = '.';
+		p = Emit_Uint(p, a_clock->m_sec, 1U + (2U * pad));
+	}
+	if(a_fields & CLOCK_FIELD_USEC){
+		*p++ = ',';
+		p = Emit_Uint(p, a_clock->u_sec, 1U + (2U * pad));
+	}
+	*p++ = ']';
+
+	size_t len = (size_t)(p - str);
+	if(0U != a_buf_size){
+		size_t copy_len = (len < a_buf_size) ? len : (a_buf_size - 1U);
+		memcpy(a_buf, str, copy_len);
+		a_buf[copy_len] = '\0';
+	}
+
+	return (int)len;
+}
+
+/**
+ * @brief Writes the legend of given clock fields to a buffer. See Clock_Legend_Str().
+ * @param [out] a_buf 		User provided buffer. Always NUL terminated if a_buf_size is not 0.
+ * @param [in]  a_buf_size 	Size of a_buf in bytes. CLOCK_LEGEND_MAX_STRING_SIZE is enough for every legend.
+ * @param [in]  a_fields 		Bitmask of CLOCK_FIELD_* flags.
+ * @return length of the whole legend without NUL, like snprintk(). If it's equal or bigger than a_buf_size, output was truncated.
+*/
+int Clock_Legend_Format(char * a_buf, size_t a_buf_size, uint32_t a_fields)
+{
+	size_t len = Clock_Legend_Len(a_fields);
+
+	if(0U != a_buf_size){
+		size_t copy_len = (len < a_buf_size) ? len : (a_buf_size - 1U);
+		memcpy(a_buf, clock_legends[a_fields & CLOCK_FIELD_ALL], copy_len);
+		a_buf[copy_len] = '\0';
+	}
+
+	return (int)len;
+}
+
 /**
  * @brief Converts given clock value to a string.
- * @param [out] a_clk_buf 	User provided buffer for writing the clock value in. Buffer size is recommended to be at least 25 bytes.
+ * @param [out] a_clk_buf 	User provided buffer for writing the clock value in. Buffer size is recommended to be at least CLOCK_MAX_STRING_SIZE bytes.
  * @param [out] a_legend_buf  User provided buffer for writing the clock legend values as [d:h:m:s.ms,us]. Buffer size is recommended to be at least 16 bytes.
  * @param [in] a_clock 		Pointer to the clock variable that user provides the clock values in it.
  * @param [in] a_print_usec	Whether to include micro seconds in the clock string. True includes, false doesn't.
@@ -245,77 +643,416 @@ void Increment_a_Second_And_Update_Clock(TimeElapsedClock * a_clock)
  * @param [in] a_print_min	Whether to include minutes in the clock string.True includes, false doesn't.
  * @param [in] a_print_hour	Whether to include hours in the clock string. True includes, false doesn't.
  * @param [in] a_print_day	Whether to include days in the clock string. True includes, false doesn't. 
- * @todo return values of functions should be checked and error coded
+ * @note Wrapper of Clock_Format() and Clock_Legend_Format(); use them for bounded output and length return. At most CLOCK_MAX_STRING_SIZE bytes are written to a_clk_buf.
 */
 void Clock_To_Str(char * a_clk_buf, char * a_legend_buf, TimeElapsedClock * a_clock, bool a_print_usec, bool a_print_msec, bool a_print_sec, bool a_print_min, bool a_print_hour, bool a_print_day)
 {
+	uint32_t fields = (a_print_usec ? CLOCK_FIELD_USEC : 0U)
+			| (a_print_msec ? CLOCK_FIELD_MSEC : 0U)
+			| (a_print_sec  ? CLOCK_FIELD_SEC  : 0U)
+			| (a_print_min  ? CLOCK_FIELD_MIN  : 0U)
+			| (a_print_hour ? CLOCK_FIELD_HOUR : 0U)
+			| (a_print_day  ? CLOCK_FIELD_DAY  : 0U);
 
 	// if clk legend printing is enabled, print it according to what user chose to wrote.
 	if(NULL != a_legend_buf){
-		// make ready the clock legend buffer
-		char clk_legend_buf[16]; 
-		snprintk(clk_legend_buf, 16, "");
-		strcat(clk_legend_buf,"[");
-		if(a_print_day){
-			strcat(clk_legend_buf,"d");
+		(void)Clock_Legend_Format(a_legend_buf, CLOCK_LEGEND_MAX_STRING_SIZE, fields);
+	}
+
+	(void)Clock_Format(a_clk_buf, CLOCK_MAX_STRING_SIZE, a_clock, fields);
+}
+
+/**
+ * @brief Reads at most a_max_digits + 1 decimal digits starting at a_pos.
+ * @return number of digits read, 0 if there isn't a digit at a_pos.
+*/
+static inline size_t Parse_Digits(const char * a_str, size_t a_len, size_t a_pos, size_t a_max_digits, uint64_t * a_value)
+{
+	uint64_t value = 0;
+	size_t count = 0;
+
+	while(((a_pos + count) < a_len) && (count <= a_max_digits)){
+		uint32_t digit = (uint32_t)(uint8_t)a_str[a_pos + count] - (uint32_t)'0';
+		if(digit > 9U){
+			break;
 		}
-		if(a_print_hour){
-			strcat(clk_legend_buf, ":h");
+		value = (value * 10U) + digit;
+		count++;
+	}
+	* a_value = value;
+
+	return count;
+}
+
+/**
+ * @brief Sets the error position if it's requested and returns the error.
+*/
+static inline TimeAndClockErrors Parse_Fail(size_t * a_end, size_t a_pos, TimeAndClockErrors a_err)
+{
+	if(NULL != a_end){
+		* a_end = a_pos;
+	}
+
+	return a_err;
+}
+
+/**
+ * @brief Parses a clock string written by Clock_Format() or Clock_To_Str() back to a clock value, i.e. "[1:02:03:04.005,006]" or "[1:2:3:4.5,6]".
+ *        Works on the given length only: a_str doesn't need to be NUL terminated and nothing is copied or allocated.
+ * @param [out] a_clock 	Pointer to the user provided buffer. Fields that aren't in a_fields are set to 0. Not modified if parsing fails.
+ * @param [in]  a_str 		characters to parse, the clock must start at a_str[0]. Characters after the closing ']' are not read.
+ * @param [in]  a_len 		number of characters available at a_str.
+ * @param [in]  a_fields 	Bitmask of CLOCK_FIELD_* flags the string was written with, i.e. from Clock_Legend_Parse(). Zero padded and
+ * 				unpadded values are both accepted.
+ * @param [out] a_end 		If not NULL, index after the closing ']' on success, index of the offending character on failure.
+ * @retval TIME_UTIL_ERROR_SYNTAX if a bracket, separator or digit is missing where the fields require it.
+ * @retval TIME_UTIL_ERROR_RANGE if a value has too many digits or is out of range: day above UINT32_MAX, hour above 23, min or sec above 59,
+ * 	   ms or us above 999. a_end points to the first digit of the value.
+ * @retval TIME_UTIL_ERROR_NONE otherwise.
+*/
+TimeAndClockErrors Clock_Parse(TimeElapsedClock * a_clock, const char * a_str, size_t a_len, uint32_t a_fields, size_t * a_end)
+{
+	/* fields in the order Clock_Format() writes them */
+	static const struct{
+		uint32_t 	field;
+		char 		separator;
+		uint8_t 	max_digits;
+		uint32_t 	max_value;
+	}layout[6] = {
+		{ CLOCK_FIELD_DAY,  '\0', 10U, UINT32_MAX },
+		{ CLOCK_FIELD_HOUR, ':',   2U,  23U },
+		{ CLOCK_FIELD_MIN,  ':',   2U,  59U },
+		{ CLOCK_FIELD_SEC,  ':',   2U,  59U },
+		{ CLOCK_FIELD_MSEC, '.',   3U,  999U },
+		{ CLOCK_FIELD_USEC, ',',   3U,  999U },
+	};
+	uint32_t values[6] = {0};
+	size_t pos = 0;
+
+	if((pos >= a_len) || ('[' != a_str[pos])){
+		return Parse_Fail(a_end, pos, TIME_UTIL_ERROR_SYNTAX);
+	}
+	pos++;
+
+	for(uint32_t i = 0; i < 6U; i++){
+		uint64_t value;
+
+		if(0U == (a_fields & layout[i].field)){
+			continue;
 		}
-		if(a_print_min){
-			strcat(clk_legend_buf, ":m");
+		if('\0' != layout[i].separator){
+			if((pos >= a_len) || (layout[i].separator != a_str[pos])){
+				return Parse_Fail(a_end, pos, TIME_UTIL_ERROR_SYNTAX);
+			}
+			pos++;
 		}
-		if(a_print_sec){
-			strcat(clk_legend_buf, ":s");
+
+		size_t count = Parse_Digits(a_str, a_len, pos, layout[i].max_digits, &value);
+		if(0U == count){
+			return Parse_Fail(a_end, pos, TIME_UTIL_ERROR_SYNTAX);
 		}
-		if(a_print_msec){
-			strcat(clk_legend_buf, ".ms");
+		if((count > layout[i].max_digits) || (value > layout[i].max_value)){
+			return Parse_Fail(a_end, pos, TIME_UTIL_ERROR_RANGE);
 		}
-		if(a_print_usec){
-			strcat(clk_legend_buf, ",us");
+		values[i] = (uint32_t)value;
+		pos += count;
+	}
+
+	if((pos >= a_len) || (']' != a_str[pos])){
+		return Parse_Fail(a_end, pos, TIME_UTIL_ERROR_SYNTAX);
+	}
+	pos++;
+
+	a_clock->day   = values[0];
+	a_clock->hour  = (uint8_t)values[1];
+	a_clock->min   = (uint8_t)values[2];
+	a_clock->sec   = (uint8_t)values[3];
+	a_clock->m_sec = (uint16_t)values[4];
+	a_clock->u_sec = (uint16_t)values[5];
+
+	if(NULL != a_end){
+		* a_end = pos;
+	}
+
+	return TIME_UTIL_ERROR_NONE;
+}
+
+/**
+ * @brief Parses a clock legend i.e. "[d:h:m:s.ms,us]" to the CLOCK_FIELD_* flags it was written for. Inverse of Clock_Legend_Str().
+ * @param [out] a_fields 	Pointer to the user provided buffer for the flags. Not modified if parsing fails.
+ * @param [in]  a_str 		characters to parse, the legend must start at a_str[0]. Doesn't need to be NUL terminated.
+ * @param [in]  a_len 		number of characters available at a_str.
+ * @param [out] a_end 		If not NULL, index after the closing ']' on success, 0 on failure.
+ * @retval TIME_UTIL_ERROR_SYNTAX if the characters up to the first ']' aren't one of the legends.
+ * @retval TIME_UTIL_ERROR_NONE otherwise.
+*/
+TimeAndClockErrors Clock_Legend_Parse(uint32_t * a_fields, const char * a_str, size_t a_len, size_t * a_end)
+{
+	const char * close = memchr(a_str, ']', MIN(a_len, (size_t)CLOCK_LEGEND_MAX_STRING_SIZE));
+
+	if(NULL != close){
+		size_t len = (size_t)(close - a_str) + 1U;
+
+		for(uint32_t fields = 0; fields <= CLOCK_FIELD_ALL; fields++){
+			if((Clock_Legend_Len(fields) == len) && (0 == memcmp(clock_legends[fields], a_str, len))){
+				* a_fields = fields;
+				if(NULL != a_end){
+					* a_end = len;
+				}
+				return TIME_UTIL_ERROR_NONE;
+			}
 		}
-		strcat(clk_legend_buf,"]");
-		// copy the string to user provided buffer.
-		strcpy(a_legend_buf, clk_legend_buf); 
 	}
 
-	// make ready the clock values buffer
-	char clk_values_buf[30]; 
-	snprintk(clk_values_buf, 30, "");
-	char temp[10]; // temp char that will hold individual clock value elements.
+	return Parse_Fail(a_end, 0, TIME_UTIL_ERROR_SYNTAX);
+}
+
+
+
+
+
+/* ------------------  DURATION ------------------ */
+/**
+ * @brief Convert a clock value to a scalar duration. Lossless.
+ * @param [in] a_clock 	Pointer to the clock value to be converted.
+ * @return duration in micro seconds.
+*/
+TimeDuration Clock_To_Duration(const TimeElapsedClock * a_clock)
+{
+	return ((TimeDuration)a_clock->day   * TIME_DURATION_USEC_PER_DAY)
+	     + ((TimeDuration)a_clock->hour  * TIME_DURATION_USEC_PER_HOUR)
+	     + ((TimeDuration)a_clock->min   * TIME_DURATION_USEC_PER_MIN)
+	     + ((TimeDuration)a_clock->sec   * TIME_DURATION_USEC_PER_SEC)
+	     + ((TimeDuration)a_clock->m_sec * TIME_DURATION_USEC_PER_MSEC)
+	     +  (TimeDuration)a_clock->u_sec;
+}
 
-	strcat(clk_values_buf,"[");
-	if(a_print_day){
-		snprintk(temp, 10, "%"PRIu32, a_clock->day);
-		strcat(clk_values_buf, temp);
+/**
+ * @brief Convert a scalar duration to clock format. Lossless for every non-negative duration.
+ * @param [out] a_clock 	Pointer to the user provided buffer where the clock value will be written.
+ * @param [in]  a_duration 	duration in micro seconds.
+ * @retval TIME_UTIL_ERROR_NEGATIVE if a_duration is negative, a_clock isn't modified in that case.
+ * @retval TIME_UTIL_ERROR_NONE otherwise.
+*/
+TimeAndClockErrors Duration_To_Clock(TimeElapsedClock * a_clock, TimeDuration a_duration)
+{
+	if(a_duration < 0){
+		return TIME_UTIL_ERROR_NEGATIVE;
 	}
-	if(a_print_hour){
-		snprintk(temp, 10, ":%"PRIu8, a_clock->hour);
-		strcat(clk_values_buf, temp);
+
+	* a_clock = Micro_Sec_To_Clock_Fast((uint64_t)a_duration);
+
+	return TIME_UTIL_ERROR_NONE;
+}
+
+/**
+ * @brief Convert time categories to a scalar duration. Fields don't need to be normalized i.e. 90 minutes is accepted.
+ * @param [out] a_duration 	Pointer to the user provided buffer where the duration will be written.
+ * @param [in]  a_categories 	Pointer to the time categories to be converted.
+ * @retval TIME_UTIL_ERROR_UNSUPPORTED if any of months, years, centuries or milleniums is non-zero; they don't have a fixed length. a_duration isn't modified in that case.
+ * @retval TIME_UTIL_ERROR_NONE otherwise.
+*/
+TimeAndClockErrors Time_Categories_To_Duration(TimeDuration * a_duration, const TimeCategories * a_categories)
+{
+	if((0 != a_categories->months) || (0 != a_categories->years) || (0 != a_categories->centuries) || (0 != a_categories->milleniums)){
+		return TIME_UTIL_ERROR_UNSUPPORTED;
 	}
-	if(a_print_min){
-		snprintk(temp, 10, ":%"PRIu8, a_clock->min);
-		strcat(clk_values_buf, temp);
+
+	* a_duration = (a_categories->weeks  * TIME_DURATION_USEC_PER_WEEK)
+		     + (a_categories->days   * TIME_DURATION_USEC_PER_DAY)
+		     + (a_categories->hours  * TIME_DURATION_USEC_PER_HOUR)
+		     + (a_categories->mins   * TIME_DURATION_USEC_PER_MIN)
+		     + (a_categories->secs   * TIME_DURATION_USEC_PER_SEC)
+		     + (a_categories->m_secs * TIME_DURATION_USEC_PER_MSEC)
+		     +  a_categories->u_secs;
+
+	return TIME_UTIL_ERROR_NONE;
+}
+
+/**
+ * @brief Convert a scalar duration to time categories. Each field holds the remainder of its unit i.e. mins is 0-59, days is 0-6 and weeks holds the rest.
+ * @param [out] a_categories 	Pointer to the user provided buffer where the time categories will be written.
+ * @param [in]  a_duration 	duration in micro seconds.
+ * @note months, years, centuries and milleniums are set to 0 since they don't have a fixed length. For negative durations all fields are negative or zero.
+*/
+void Duration_To_Time_Categories(TimeCategories * a_categories, TimeDuration a_duration)
+{
+	uint64_t magnitude = (a_duration < 0) ? (0U - (uint64_t)a_duration) : (uint64_t)a_duration;
+	int64_t  sign      = (a_duration < 0) ? -1 : 1;
+
+	TimeElapsedClock clk = Micro_Sec_To_Clock_Fast(magnitude);
+
+	a_categories->u_secs     = sign * (int64_t)clk.u_sec;
+	a_categories->m_secs     = sign * (int64_t)clk.m_sec;
+	a_categories->secs       = sign * (int64_t)clk.sec;
+	a_categories->mins       = sign * (int64_t)clk.min;
+	a_categories->hours      = sign * (int64_t)clk.hour;
+	a_categories->days       = sign * (int64_t)(clk.day % 7U);
+	a_categories->weeks      = sign * (int64_t)(clk.day / 7U);
+	a_categories->months     = 0;
+	a_categories->years      = 0;
+	a_categories->centuries  = 0;
+	a_categories->milleniums = 0;
+}
+
+/**
+ * @brief Parses a compact duration literal i.e. "1d2h3m4.5s", "250ms", "1.5h" or "-20us" to a scalar duration.
+ *        Works on the given length only: a_str doesn't need to be NUL terminated and nothing is copied or allocated.
+ * @param [out] a_duration 	Pointer to the user provided buffer for the duration in micro seconds. Not modified if parsing fails.
+ * @param [in]  a_str 		characters to parse, the literal must start at a_str[0]. Parsing stops at the first character that can't start
+ * 				another term, so a literal followed by other text i.e. in a log line can be parsed in place.
+ * @param [in]  a_len 		number of characters available at a_str.
+ * @param [out] a_end 		If not NULL, index after the literal on success, index of the offending character on failure.
+ * @note Grammar: optional '-', then one or more terms of digits, optional '.' and fraction digits, and a unit: w, d, h, m, s, ms or us.
+ * 	 Units must be in decreasing order and each can appear once. A fraction must be a whole number of micro seconds i.e. "1.5us" is rejected.
+ * @retval TIME_UTIL_ERROR_SYNTAX if there isn't a term, a number has no unit, or units are repeated or out of order.
+ * @retval TIME_UTIL_ERROR_RANGE if the duration doesn't fit in TimeDuration or a fraction is finer than a micro second.
+ * @retval TIME_UTIL_ERROR_NONE otherwise.
+*/
+TimeAndClockErrors Duration_Parse(TimeDuration * a_duration, const char * a_str, size_t a_len, size_t * a_end)
+{
+	/* units in the order they must appear */
+	static const uint64_t unit_micros[7] = {
+		(uint64_t)TIME_DURATION_USEC_PER_WEEK, (uint64_t)TIME_DURATION_USEC_PER_DAY, (uint64_t)TIME_DURATION_USEC_PER_HOUR,
+		(uint64_t)TIME_DURATION_USEC_PER_MIN, (uint64_t)TIME_DURATION_USEC_PER_SEC, (uint64_t)TIME_DURATION_USEC_PER_MSEC, 1U,
+	};
+	const uint64_t limit = (uint64_t)INT64_MAX;
+	uint64_t total = 0;
+	uint32_t next_unit = 0; // units before it have been used already
+	bool negative = false;
+	size_t pos = 0;
+
+	if((pos < a_len) && ('-' == a_str[pos])){
+		negative = true;
+		pos++;
 	}
-	if(a_print_sec){
-		snprintk(temp, 10, ":%"PRIu8, a_clock->sec);
-		strcat(clk_values_buf, temp);
+
+	while(pos < a_len){
+		uint64_t whole = 0;
+		uint64_t fraction = 0;
+		size_t term_start = pos;
+		size_t fraction_pos = 0;
+		size_t fraction_len = 0;
+		uint32_t unit;
+
+		// integer part
+		while(pos < a_len){
+			uint32_t digit = (uint32_t)(uint8_t)a_str[pos] - (uint32_t)'0';
+			if(digit > 9U){
+				break;
+			}
+			if(whole > ((limit - digit) / 10U)){
+				return Parse_Fail(a_end, term_start, TIME_UTIL_ERROR_RANGE);
+			}
+			whole = (whole * 10U) + digit;
+			pos++;
+		}
+		if(pos == term_start){
+			if(0U == next_unit){
+				return Parse_Fail(a_end, pos, TIME_UTIL_ERROR_SYNTAX); // not even one term
+			}
+			break; // end of the literal
+		}
+
+		// fraction part, digits are converted once the unit is known
+		if((pos < a_len) && ('.' == a_str[pos])){
+			pos++;
+			fraction_pos = pos;
+			while((pos < a_len) && ((uint32_t)(uint8_t)a_str[pos] - (uint32_t)'0' <= 9U)){
+				pos++;
+			}
+			fraction_len = pos - fraction_pos;
+			if(0U == fraction_len){
+				return Parse_Fail(a_end, pos, TIME_UTIL_ERROR_SYNTAX);
+			}
+		}
+
+		// unit
+		if(pos >= a_len){
+			return Parse_Fail(a_end, pos, TIME_UTIL_ERROR_SYNTAX);
+		}
+		size_t unit_pos = pos;
+		bool next_is_s = ((pos + 1U) < a_len) && ('s' == a_str[pos + 1U]);
+		switch(a_str[pos]){
+			case 'w': unit = 0U; break;
+			case 'd': unit = 1U; break;
+			case 'h': unit = 2U; break;
+			case 'm': unit = next_is_s ? 5U : 3U; break;
+			case 's': unit = 4U; break;
+			case 'u': unit = next_is_s ? 6U : 7U; break;
+			default:  unit = 7U; break;
+		}
+		if((unit >= 7U) || (unit < next_unit)){
+			return Parse_Fail(a_end, unit_pos, TIME_UTIL_ERROR_SYNTAX);
+		}
+		pos += (unit >= 5U) ? 2U : 1U;
+		next_unit = unit + 1U;
+
+		// fraction digits scale the unit down by 10 each; a non-zero digit beyond micro seconds can't be represented.
+		uint64_t scale = unit_micros[unit];
+		for(size_t i = 0; i < fraction_len; i++){
+			uint32_t digit = (uint32_t)(uint8_t)a_str[fraction_pos + i] - (uint32_t)'0';
+			if(0U != (scale % 10U)){
+				if(0U != digit){
+					return Parse_Fail(a_end, fraction_pos + i, TIME_UTIL_ERROR_RANGE);
+				}
+				continue;
+			}
+			scale /= 10U;
+			fraction += digit * scale;
+		}
+
+		if((whole > ((limit - fraction) / unit_micros[unit])) || ((whole * unit_micros[unit]) + fraction > (limit - total))){
+			return Parse_Fail(a_end, term_start, TIME_UTIL_ERROR_RANGE);
+		}
+		total += (whole * unit_micros[unit]) + fraction;
 	}
-	if(a_print_msec){
-		snprintk(temp, 10, ".%"PRIu16, a_clock->m_sec);
-		strcat(clk_values_buf, temp);
+
+	if(0U == next_unit){
+		return Parse_Fail(a_end, pos, TIME_UTIL_ERROR_SYNTAX);
 	}
-	if(a_print_usec){
-		snprintk(temp, 10, ",%"PRIu16, a_clock->u_sec);
-		strcat(clk_values_buf, temp);
+
+	* a_duration = negative ? -(TimeDuration)total : (TimeDuration)total;
+	if(NULL != a_end){
+		* a_end = pos;
 	}
-	strcat(clk_values_buf,"]");
 
-	// copy the string to user provided buffer.
-	strcpy(a_clk_buf, clk_values_buf); 
+	return TIME_UTIL_ERROR_NONE;
 }
 
+/**
+ * @brief Convert ticks to a scalar duration. Gives the same micro seconds as k_ticks_to_us_floor64().
+*/
+TimeDuration Ticks_To_Duration(int64_t a_ticks)
+{
+	return (TimeDuration)Ticks_To_Micro_Sec_Fast((uint64_t)a_ticks);
+}
+
+/**
+ * @brief Get system uptime tracked by ticks as a scalar duration.
+*/
+TimeDuration Get_Uptime_Ticks_As_Duration(void)
+{
+	return Ticks_To_Duration(k_uptime_ticks());
+}
+
+/**
+ * @brief Convert HW cycles to a scalar duration. Gives the same micro seconds as k_cyc_to_us_floor64().
+ * @note 64 bit.
+*/
+TimeDuration HW_Cycles_To_Duration_64(uint64_t a_cycles)
+{
+	return (TimeDuration)HW_Cycles_To_Micro_Sec_Fast(a_cycles);
+}
 
+/**
+ * @brief Get system uptime tracked by HW cycles as a scalar duration.
+ * @note 64 bit.
+*/
+TimeDuration Get_Uptime_HW_Cycles_As_Duration_64(void)
+{
+	return HW_Cycles_To_Duration_64(Read_HW_Cycles_64());
+}
 
 
 
@@ -374,27 +1111,12 @@ uint64_t Get_Uptime_Ticks_As_Seconds(void)
 /**
  * @brief Convert ticks to clock time.
  * @warning in some test code, getting clock data from these ticks caused around +100ms increase on clock time when everytime device was reset, comparing to a clock working with timer interrupts. Other than that it's pretty accurate. I haven't observed a single milliseconds changing inaccurately over some time.  
+ * @note Division-free, see DIVISION-FREE DECOMPOSITION section. Gives the same result as successive division of the micro seconds.
  * @return clock time of type TimeElapsedClock. 
 */
 TimeElapsedClock Ticks_To_Clock_Time(int64_t ticks)
 {
-	TimeElapsedClock clk; // not inited because all of its elements will be set later anyways.
-	
-	uint64_t total_micro_sec = k_ticks_to_us_floor64((uint64_t)ticks); // func tanımına baktığıma göre k_ticks_to_us_floor64() ve k_ticks_to_ms_floor64() arasında fark yok.
-	uint64_t total_milli_sec = total_micro_sec / (uint64_t)1000;
-	uint64_t total_sec 		= total_milli_sec / (uint64_t)1000;
-	uint64_t total_minutes	= total_sec 	   / (uint64_t)60;
-	uint64_t total_hours 	= total_minutes   / (uint64_t)60;
-	uint64_t total_days 	= total_hours 	   / (uint64_t)24;
-
-	clk.u_sec = (uint16_t)(total_micro_sec % 1000);
-	clk.m_sec = (uint16_t)(total_milli_sec % 1000);
-	clk.sec 	= (uint8_t) (total_sec 	    % 60);
-	clk.min 	= (uint8_t) (total_minutes   % 60);
-	clk.hour  = (uint8_t) (total_hours     % 24);
-	clk.day 	= (uint32_t)(total_days);
-
-	return clk;
+	return Micro_Sec_To_Clock_Fast(Ticks_To_Micro_Sec_Fast((uint64_t)ticks));
 }
 
 /**
@@ -478,7 +1200,7 @@ uint32_t Get_Uptime_HW_Cycles_32()
 */
 uint32_t HW_Cycles_To_Milliseconds_32(uint32_t a_cycles)
 {
-	return (k_cyc_to_ms_floor32(a_cycles));
+	return (HW_Cycles_To_Milli_Sec_Fast_32(a_cycles));
 }
 
 /**
@@ -489,7 +1211,7 @@ uint32_t HW_Cycles_To_Milliseconds_32(uint32_t a_cycles)
 */
 uint32_t HW_Cycles_To_Seconds_32(uint32_t a_cycles)
 {
-	return (k_cyc_to_ms_floor32(a_cycles) / (uint32_t)1000);
+	return (HW_Cycles_To_Milli_Sec_Fast_32(a_cycles) / (uint32_t)1000);
 }
 
 /**
@@ -499,7 +1221,7 @@ uint32_t HW_Cycles_To_Seconds_32(uint32_t a_cycles)
 */
 uint32_t Get_Uptime_HW_Cycles_As_Milliseconds_32(void)
 {
-	return k_cyc_to_ms_floor32(k_cycle_get_32());
+	return HW_Cycles_To_Milli_Sec_Fast_32(k_cycle_get_32());
 }
 
 /**
@@ -514,26 +1236,12 @@ uint32_t Get_Uptime_HW_Cycles_As_Seconds_32(void)
 
 /**
  * @brief Convert HW cycles to clock time.
+ * @note Division-free, see DIVISION-FREE DECOMPOSITION section. Gives the same result as successive division of the micro seconds.
  * @return clock time of type TimeElapsedClock. 
 */
 TimeElapsedClock HW_Cycles_To_Clock_Time_32(uint32_t a_cycles)
 {
-	TimeElapsedClock clk; // not inited because all of its elements will be set later anyways.
-	
-	uint32_t total_micro_sec = k_cyc_to_us_floor32(a_cycles); 
-	uint32_t total_milli_sec = total_micro_sec / (uint32_t)1000;
-	uint32_t total_sec 		= total_milli_sec / (uint32_t)1000;
-	uint32_t total_minutes   = total_sec 	   / (uint32_t)60;
-	uint32_t total_hours 	= total_minutes   / (uint32_t)60;
-	uint32_t total_days 	= total_hours 	   / (uint32_t)24;
-
-	clk.u_sec = (uint16_t)(total_micro_sec % 1000);
-	clk.m_sec = (uint16_t)(total_milli_sec % 1000);
-	clk.sec 	= (uint8_t) (total_sec 	    % 60);
-	clk.min 	= (uint8_t) (total_minutes   % 60);
-	clk.hour  = (uint8_t) (total_hours     % 24);
-	clk.day 	= total_days;
-	return clk;
+	return Micro_Sec_To_Clock_Fast_32(HW_Cycles_To_Micro_Sec_Fast_32(a_cycles));
 }
 
 /**
@@ -556,7 +1264,7 @@ TimeElapsedClock Get_Uptime_HW_Cycles_As_Clock_Time_32(void)
 */
 uint64_t Get_Uptime_HW_Cycles_64()
 {
-	return k_cycle_get_64();
+	return Read_HW_Cycles_64();
 }
 
 /**
@@ -566,7 +1274,7 @@ uint64_t Get_Uptime_HW_Cycles_64()
 */
 uint64_t HW_Cycles_To_Milliseconds_64(uint64_t a_cycles)
 {
-	return (k_cyc_to_ms_floor64(a_cycles));
+	return (HW_Cycles_To_Milli_Sec_Fast(a_cycles));
 }
 
 /**
@@ -577,7 +1285,7 @@ uint64_t HW_Cycles_To_Milliseconds_64(uint64_t a_cycles)
 */
 uint64_t HW_Cycles_To_Seconds_64(uint64_t a_cycles)
 {
-	return (k_cyc_to_ms_floor64(a_cycles) / (uint64_t)1000);
+	return (HW_Cycles_To_Milli_Sec_Fast(a_cycles) / (uint64_t)1000);
 }
 
 /**
@@ -587,7 +1295,7 @@ uint64_t HW_Cycles_To_Seconds_64(uint64_t a_cycles)
 */
 uint64_t Get_Uptime_HW_Cycles_As_Milliseconds_64(void)
 {
-	return k_cyc_to_ms_floor64(k_cycle_get_64());
+	return HW_Cycles_To_Milli_Sec_Fast(Read_HW_Cycles_64());
 }
 
 /**
@@ -597,32 +1305,17 @@ uint64_t Get_Uptime_HW_Cycles_As_Milliseconds_64(void)
 */
 uint64_t Get_Uptime_HW_Cycles_As_Seconds_64(void)
 {
-	return HW_Cycles_To_Seconds_64(k_cycle_get_64());
+	return HW_Cycles_To_Seconds_64(Read_HW_Cycles_64());
 }
 
 /**
  * @brief Convert HW cycles to clock time.
+ * @note Division-free, see DIVISION-FREE DECOMPOSITION section. Gives the same result as successive division of the micro seconds.
  * @return clock time of type TimeElapsedClock. 
 */
 TimeElapsedClock HW_Cycles_To_Clock_Time_64(uint64_t a_cycles)
 {
-	TimeElapsedClock clk; // not inited because all of its elements will be set later anyways.
-	
-	uint64_t total_micro_sec = k_cyc_to_us_floor64(a_cycles); 
-	uint64_t total_milli_sec = total_micro_sec / (uint64_t)1000;
-	uint64_t total_sec 		= total_milli_sec / (uint64_t)1000;
-	uint64_t total_minutes	= total_sec 	   / (uint64_t)60;
-	uint64_t total_hours 	= total_minutes   / (uint64_t)60;
-	uint64_t total_days 	= total_hours 	   / (uint64_t)24;
-
-	clk.u_sec = (uint16_t)(total_micro_sec % 1000);
-	clk.m_sec = (uint16_t)(total_milli_sec % 1000);
-	clk.sec 	= (uint8_t) (total_sec 	    % 60);
-	clk.min 	= (uint8_t) (total_minutes   % 60);
-	clk.hour  = (uint8_t) (total_hours     % 24);
-	clk.day 	= (uint32_t)(total_days);
-
-	return clk;
+	return Micro_Sec_To_Clock_Fast(HW_Cycles_To_Micro_Sec_Fast(a_cycles));
 }
 
 /**
@@ -631,7 +1324,383 @@ TimeElapsedClock HW_Cycles_To_Clock_Time_64(uint64_t a_cycles)
 */
 TimeElapsedClock Get_Uptime_HW_Cycles_As_Clock_Time_64(void)
 {
-	return HW_Cycles_To_Clock_Time_64(k_cycle_get_64());
+	return HW_Cycles_To_Clock_Time_64(Read_HW_Cycles_64());
+}
+
+
+
+/* ------------------  RUNTIME CALIBRATED CONVERSION ------------------ */
+/*
+ * Counts are converted with one multiply-high: micro seconds = (counts * mult) >> shift. mult is 10^6 / (rate * (1 + drift)) scaled by 2^shift
+ * so that it has its top bit set; relative error of the factor is below 2^-63, so the result is the exact floor or 1 micro second less
+ * for every result below 2^63 micro seconds (292000 years). The factor is computed with a bitwise long division only when the rate or the correction changes.
+ */
+
+static struct k_spinlock cycle_conversion_lock;
+
+/**
+ * @brief Computes mult and shift for converting counts of the given rate and drift to micro seconds.
+*/
+static void Cycle_Conversion_Compute(uint32_t a_counts_per_sec, int32_t a_correction_ppb, uint64_t * a_mult, uint32_t * a_shift)
+{
+	// micro seconds per count = 10^15 / (rate * (10^9 + ppb)); divisor is below 2^63 for every rate and the clamped correction.
+	uint64_t dividend = 1000000000000000ULL;
+	uint64_t divisor  = (uint64_t)a_counts_per_sec * (uint64_t)(1000000000LL + a_correction_ppb);
+	uint64_t quotient = dividend / divisor;
+	uint64_t remainder = dividend % divisor;
+	uint32_t shift = 0;
+
+	while((quotient & BIT64(63)) == 0U){
+		remainder <<= 1;
+		quotient = (quotient << 1) | ((remainder >= divisor) ? 1U : 0U);
+		if(remainder >= divisor){
+			remainder -= divisor;
+		}
+		shift++;
+	}
+
+	* a_mult  = quotient;
+	* a_shift = shift;
+}
+
+/* Parts of the conversion Cycle_Conversion_Update() keeps from its current state instead of the given values. */
+#define CYCLE_CONVERSION_KEEP_RATE 		(1U << 0)
+#define CYCLE_CONVERSION_KEEP_CORRECTION 	(1U << 1)
+
+/**
+ * @brief Publishes a new rate and correction with their factor. Readers see either the old or the new factor, never a mix.
+ * @param [in] a_keep 	CYCLE_CONVERSION_KEEP_* flags. Kept values are read under the lock, so concurrent updates of the rate and of the
+ * 			correction don't undo each other.
+ * @note The factor is computed under the lock too; it's a loop of at most 64 shift-subtract steps.
+*/
+static void Cycle_Conversion_Update(CycleConversion * a_conv, uint32_t a_counts_per_sec, int32_t a_correction_ppb, uint32_t a_keep)
+{
+	uint64_t mult;
+	uint32_t shift;
+
+	k_spinlock_key_t key = k_spin_lock(&cycle_conversion_lock);
+
+	if(a_keep & CYCLE_CONVERSION_KEEP_RATE){
+		a_counts_per_sec = a_conv->counts_per_sec;
+	}
+	if(a_keep & CYCLE_CONVERSION_KEEP_CORRECTION){
+		a_correction_ppb = a_conv->correction_ppb;
+	}
+	a_counts_per_sec = MAX(a_counts_per_sec, 1U);
+	a_correction_ppb = CLAMP(a_correction_ppb, -CYCLE_CONVERSION_MAX_CORRECTION_PPB, CYCLE_CONVERSION_MAX_CORRECTION_PPB);
+	Cycle_Conversion_Compute(a_counts_per_sec, a_correction_ppb, &mult, &shift);
+
+	__atomic_store_n(&a_conv->sequence, a_conv->sequence + 1U, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	a_conv->mult           = mult;
+	a_conv->shift          = shift;
+	a_conv->correction_ppb = a_correction_ppb;
+	__atomic_store_n(&a_conv->counts_per_sec, a_counts_per_sec, __ATOMIC_RELAXED);
+
+	__atomic_store_n(&a_conv->sequence, a_conv->sequence + 1U, __ATOMIC_RELEASE);
+
+	k_spin_unlock(&cycle_conversion_lock, key);
+}
+
+/**
+ * @brief Initializes a conversion.
+ * @param [out] a_conv 		Pointer to the conversion owned by the user.
+ * @param [in]  a_counts_per_sec 	nominal rate of the counter, i.e. sys_clock_hw_cycles_per_sec() or CONFIG_SYS_CLOCK_TICKS_PER_SEC.
+ * @param [in]  a_correction_ppb 	drift of the counter in parts per billion, positive if it runs fast; i.e. from Drift_Estimator_Get(), or 0.
+ * 				Clamped to +-CYCLE_CONVERSION_MAX_CORRECTION_PPB.
+*/
+void Cycle_Conversion_Init(CycleConversion * a_conv, uint32_t a_counts_per_sec, int32_t a_correction_ppb)
+{
+	a_conv->sequence = 0;
+	Cycle_Conversion_Update(a_conv, a_counts_per_sec, a_correction_ppb, 0U);
+}
+
+/**
+ * @brief Changes the nominal rate, i.e. after the timer frequency changed. Drift correction is kept.
+*/
+void Cycle_Conversion_Set_Frequency(CycleConversion * a_conv, uint32_t a_counts_per_sec)
+{
+	Cycle_Conversion_Update(a_conv, a_counts_per_sec, 0, CYCLE_CONVERSION_KEEP_CORRECTION);
+}
+
+/**
+ * @brief Applies a drift correction in parts per billion, i.e. DriftEstimate.cycles_ppb. Replaces the previous correction.
+*/
+void Cycle_Conversion_Set_Correction(CycleConversion * a_conv, int32_t a_correction_ppb)
+{
+	Cycle_Conversion_Update(a_conv, 0U, a_correction_ppb, CYCLE_CONVERSION_KEEP_RATE);
+}
+
+/**
+ * @brief Convert counts to micro seconds, drift corrected. One multiply-high, no division. Can be called from any thread or ISR.
+*/
+uint64_t Cycle_Conversion_To_Micro_Sec(const CycleConversion * a_conv, uint64_t a_counts)
+{
+	return Cycle_Conversion_Apply(a_conv, a_counts);
+}
+
+/**
+ * @brief Convert counts to a scalar duration, drift corrected.
+*/
+TimeDuration Cycle_Conversion_To_Duration(const CycleConversion * a_conv, uint64_t a_counts)
+{
+	return (TimeDuration)Cycle_Conversion_Apply(a_conv, a_counts);
+}
+
+/**
+ * @brief Convert counts to clock format, drift corrected.
+*/
+TimeElapsedClock Cycle_Conversion_To_Clock_Time(const CycleConversion * a_conv, uint64_t a_counts)
+{
+	return Micro_Sec_To_Clock_Fast(Cycle_Conversion_Apply(a_conv, a_counts));
+}
+
+/**
+ * @brief Get the library's HW cycle conversion. It's set up from sys_clock_hw_cycles_per_sec() at the first use.
+ * @note If TIME_UTIL_RUNTIME_CYCLE_CONVERSION is 1, all HW_Cycles_To_* routines convert with it; update it with Cycle_Conversion_Set_Frequency()
+ * when the timer frequency changes and with Cycle_Conversion_Set_Correction() after a drift estimate.
+*/
+CycleConversion * Get_HW_Cycles_Conversion(void)
+{
+	if(0U == __atomic_load_n(&hw_cycles_conversion.counts_per_sec, __ATOMIC_ACQUIRE)){
+		Cycle_Conversion_Update(&hw_cycles_conversion, (uint32_t)sys_clock_hw_cycles_per_sec(), 0, 0U);
+	}
+
+	return &hw_cycles_conversion;
+}
+
+/**
+ * @brief Starts a drift estimate: samples 64 bit HW cycles and uptime ticks together with the given reference count.
+ * @param [out] a_est 		Pointer to the estimator owned by the user.
+ * @param [in]  a_ref_count 	current count of the reference counter i.e. an RTC, read right before calling.
+ * @param [in]  a_ref_per_sec 	nominal rate of the reference counter.
+*/
+void Drift_Estimator_Start(DriftEstimator * a_est, uint64_t a_ref_count, uint32_t a_ref_per_sec)
+{
+	unsigned int key = irq_lock();
+	a_est->start_cycles = Read_HW_Cycles_64();
+	a_est->start_ticks  = k_uptime_ticks();
+	irq_unlock(key);
+
+	a_est->start_ref   = a_ref_count;
+	a_est->ref_per_sec = a_ref_per_sec;
+}
+
+/**
+ * @brief Relative rate error of a counter in parts per billion, clamped to the int32_t range.
+*/
+static int32_t Drift_Ppb(uint64_t a_counted, uint64_t a_ref_elapsed, uint32_t a_ref_per_sec, uint32_t a_counts_per_sec)
+{
+	double expected = ((double)a_ref_elapsed * (double)a_counts_per_sec) / (double)a_ref_per_sec;
+	double ppb = (((double)a_counted - expected) * 1e9) / expected;
+
+	ppb = CLAMP(ppb, (double)INT32_MIN, (double)INT32_MAX);
+
+	return (int32_t)((ppb < 0.0) ? (ppb - 0.5) : (ppb + 0.5));
+}
+
+/**
+ * @brief Estimates the drift of HW cycles and uptime ticks since Drift_Estimator_Start(). Can be called repeatedly; longer windows give finer estimates
+ * (resolution is about 10^9 / (reference seconds * counter rate) ppb, plus the latency of reading the reference).
+ * @param [in]  a_est 		Pointer to a started estimator.
+ * @param [in]  a_ref_count 	current count of the reference counter, read right before calling.
+ * @param [out] a_estimate 	Pointer to the user provided buffer. Apply cycles_ppb with Cycle_Conversion_Set_Correction() and ticks_ppb to a tick conversion.
+ * @retval TIME_UTIL_ERROR_UNSUPPORTED if less than one second of the reference elapsed; a_estimate isn't modified in that case.
+ * @retval TIME_UTIL_ERROR_NONE otherwise.
+*/
+TimeAndClockErrors Drift_Estimator_Get(const DriftEstimator * a_est, uint64_t a_ref_count, DriftEstimate * a_estimate)
+{
+	unsigned int key = irq_lock();
+	uint64_t cycles = Read_HW_Cycles_64();
+	int64_t  ticks  = k_uptime_ticks();
+	irq_unlock(key);
+
+	uint64_t ref_elapsed = a_ref_count - a_est->start_ref;
+	if((0U == a_est->ref_per_sec) || (ref_elapsed < a_est->ref_per_sec)){
+		return TIME_UTIL_ERROR_UNSUPPORTED;
+	}
+
+	a_estimate->cycles_ppb  = Drift_Ppb(cycles - a_est->start_cycles, ref_elapsed, a_est->ref_per_sec, (uint32_t)sys_clock_hw_cycles_per_sec());
+	a_estimate->ticks_ppb   = Drift_Ppb((uint64_t)(ticks - a_est->start_ticks), ref_elapsed, a_est->ref_per_sec, CONFIG_SYS_CLOCK_TICKS_PER_SEC);
+	a_estimate->ref_elapsed = ref_elapsed;
+
+	return TIME_UTIL_ERROR_NONE;
+}
+
+
+
+/* ------------------  CACHED CONVERSION ------------------ */
+/*
+ * Cached routines remember the last converted time point in a caller owned ClockConversionCache. If the new time point
+ * is at most CLOCK_CONVERSION_CACHE_MAX_STEP_US ahead of the cached one, the cached clock is advanced by the difference
+ * with carries instead of decomposing the whole value again. Large jumps and going backwards fall back to full conversion.
+ * Results are always the same as the non-cached routines.
+ */
+
+/**
+ * @brief Convert micro seconds to clock by using and updating the cache.
+*/
+static TimeElapsedClock Micro_Sec_To_Clock_Cached(ClockConversionCache * a_cache, uint64_t a_total_micro_sec)
+{
+	uint64_t step = a_total_micro_sec - a_cache->last_micro_sec;
+
+	if((a_total_micro_sec < a_cache->last_micro_sec) || (step >= CLOCK_CONVERSION_CACHE_MAX_STEP_US)){
+		a_cache->last_clk = Micro_Sec_To_Clock_Fast(a_total_micro_sec);
+		a_cache->last_micro_sec = a_total_micro_sec;
+		return a_cache->last_clk;
+	}
+
+	TimeElapsedClock * clk = &a_cache->last_clk;
+	uint32_t step_ms = (uint32_t)step / 1000U;
+	uint32_t u_sec   = (uint32_t)clk->u_sec + ((uint32_t)step - (step_ms * 1000U));
+	uint32_t m_sec   = (uint32_t)clk->m_sec + step_ms;
+
+	if(u_sec >= 1000U){
+		u_sec -= 1000U;
+		m_sec ++;
+	}
+	if(m_sec >= 1000U){ // step is less than a second so at most one second carry.
+		m_sec -= 1000U;
+		Increment_a_Second_And_Update_Clock(clk);
+	}
+	clk->u_sec = (uint16_t)u_sec;
+	clk->m_sec = (uint16_t)m_sec;
+
+	a_cache->last_micro_sec = a_total_micro_sec;
+
+	return * clk;
+}
+
+/**
+ * @brief Convert ticks to clock time incrementally from the last conversion in the cache. Gives the same result as Ticks_To_Clock_Time().
+ * @param [in, out] a_cache 	caller owned cache. Must be zero initialized before the first use and mustn't be shared between threads/ISRs.
+ * @param [in] a_ticks 		ticks to be converted.
+ * @note Cheapest when called frequently with increasing values i.e. uptime.
+*/
+TimeElapsedClock Ticks_To_Clock_Time_Cached(ClockConversionCache * a_cache, int64_t a_ticks)
+{
+	return Micro_Sec_To_Clock_Cached(a_cache, Ticks_To_Micro_Sec_Fast((uint64_t)a_ticks));
+}
+
+/**
+ * @brief Get system uptime tracked by ticks in clock format, incrementally from the last conversion in the cache.
+ * @param [in, out] a_cache 	caller owned cache. Must be zero initialized before the first use and mustn't be shared between threads/ISRs.
+*/
+TimeElapsedClock Get_Uptime_Ticks_As_Clock_Time_Cached(ClockConversionCache * a_cache)
+{
+	return Ticks_To_Clock_Time_Cached(a_cache, k_uptime_ticks());
+}
+
+/**
+ * @brief Convert HW cycles to clock time incrementally from the last conversion in the cache. Gives the same result as HW_Cycles_To_Clock_Time_64().
+ * @note 64 bit.
+ * @param [in, out] a_cache 	caller owned cache. Must be zero initialized before the first use and mustn't be shared between threads/ISRs.
+ * @param [in] a_cycles 		HW cycles to be converted.
+*/
+TimeElapsedClock HW_Cycles_To_Clock_Time_Cached_64(ClockConversionCache * a_cache, uint64_t a_cycles)
+{
+	return Micro_Sec_To_Clock_Cached(a_cache, HW_Cycles_To_Micro_Sec_Fast(a_cycles));
+}
+
+/**
+ * @brief Get system uptime tracked by HW cycles in clock format, incrementally from the last conversion in the cache.
+ * @note 64 bit.
+ * @param [in, out] a_cache 	caller owned cache. Must be zero initialized before the first use and mustn't be shared between threads/ISRs.
+*/
+TimeElapsedClock Get_Uptime_HW_Cycles_As_Clock_Time_Cached_64(ClockConversionCache * a_cache)
+{
+	return HW_Cycles_To_Clock_Time_Cached_64(a_cache, Read_HW_Cycles_64());
+}
+
+
+/* ------------------  BATCH CONVERSION ------------------ */
+/*
+ * Batch routines convert many raw time points at once and write results as structure of arrays. Loops are branch-free
+ * and output arrays are restrict qualified so that the compiler can vectorize them where the target allows it.
+ */
+
+/*
+ * Loop bodies of the batch routines. Every pointer is a restrict qualified parameter so that the compiler can prove that
+ * input and output arrays don't alias and vectorize the loop without run-time overlap checks.
+ */
+#define TCU_CLOCK_ARRAYS_LOOP(a_in, a_count, a_to_clock) 					\
+	for(size_t i = 0; i < (a_count); i++){ 						\
+		TimeElapsedClock clk = a_to_clock((a_in)[i]); 				\
+		a_day[i]   = clk.day; 							\
+		a_hour[i]  = clk.hour; 							\
+		a_min[i]   = clk.min; 							\
+		a_sec[i]   = clk.sec; 							\
+		a_m_sec[i] = clk.m_sec; 						\
+		a_u_sec[i] = clk.u_sec; 						\
+	}
+
+static ALWAYS_INLINE TimeElapsedClock Ticks_To_Clock_Fast(int64_t a_ticks)
+{
+	return Micro_Sec_To_Clock_Fast(Ticks_To_Micro_Sec_Fast((uint64_t)a_ticks));
+}
+
+static ALWAYS_INLINE TimeElapsedClock HW_Cycles_To_Clock_Fast_32(uint32_t a_cycles)
+{
+	return Micro_Sec_To_Clock_Fast_32(HW_Cycles_To_Micro_Sec_Fast_32(a_cycles));
+}
+
+static ALWAYS_INLINE TimeElapsedClock HW_Cycles_To_Clock_Fast_64(uint64_t a_cycles)
+{
+	return Micro_Sec_To_Clock_Fast(HW_Cycles_To_Micro_Sec_Fast(a_cycles));
+}
+
+static void Ticks_To_Clock_Arrays(const int64_t * restrict a_ticks, size_t a_count, uint32_t * restrict a_day, uint8_t * restrict a_hour, 
+				  uint8_t * restrict a_min, uint8_t * restrict a_sec, uint16_t * restrict a_m_sec, uint16_t * restrict a_u_sec)
+{
+	TCU_CLOCK_ARRAYS_LOOP(a_ticks, a_count, Ticks_To_Clock_Fast)
+}
+
+static void HW_Cycles_To_Clock_Arrays_32(const uint32_t * restrict a_cycles, size_t a_count, uint32_t * restrict a_day, uint8_t * restrict a_hour, 
+					 uint8_t * restrict a_min, uint8_t * restrict a_sec, uint16_t * restrict a_m_sec, uint16_t * restrict a_u_sec)
+{
+	TCU_CLOCK_ARRAYS_LOOP(a_cycles, a_count, HW_Cycles_To_Clock_Fast_32)
+}
+
+static void HW_Cycles_To_Clock_Arrays_64(const uint64_t * restrict a_cycles, size_t a_count, uint32_t * restrict a_day, uint8_t * restrict a_hour, 
+					 uint8_t * restrict a_min, uint8_t * restrict a_sec, uint16_t * restrict a_m_sec, uint16_t * restrict a_u_sec)
+{
+	TCU_CLOCK_ARRAYS_LOOP(a_cycles, a_count, HW_Cycles_To_Clock_Fast_64)
+}
+
+/**
+ * @brief Convert an array of ticks to clock time. Gives the same result as calling Ticks_To_Clock_Time() for every element.
+ * @param [in]  a_ticks 	array of ticks i.e. values got from Get_Uptime_Ticks().
+ * @param [in]  a_count 	number of elements in a_ticks.
+ * @param [out] a_out 	output arrays, each of them must have room for a_count elements and they must not overlap with each other or with a_ticks.
+*/
+void Ticks_To_Clock_Time_Batch(const int64_t * a_ticks, size_t a_count, TimeElapsedClockArrays * a_out)
+{
+	Ticks_To_Clock_Arrays(a_ticks, a_count, a_out->day, a_out->hour, a_out->min, a_out->sec, a_out->m_sec, a_out->u_sec);
+}
+
+/**
+ * @brief Convert an array of HW cycles to clock time. Gives the same result as calling HW_Cycles_To_Clock_Time_32() for every element.
+ * @note 32 bit.
+ * @param [in]  a_cycles 	array of HW cycles i.e. values got from Get_Uptime_HW_Cycles_32().
+ * @param [in]  a_count 	number of elements in a_cycles.
+ * @param [out] a_out 	output arrays, each of them must have room for a_count elements and they must not overlap with each other or with a_cycles.
+*/
+void HW_Cycles_To_Clock_Time_Batch_32(const uint32_t * a_cycles, size_t a_count, TimeElapsedClockArrays * a_out)
+{
+	HW_Cycles_To_Clock_Arrays_32(a_cycles, a_count, a_out->day, a_out->hour, a_out->min, a_out->sec, a_out->m_sec, a_out->u_sec);
+}
+
+/**
+ * @brief Convert an array of HW cycles to clock time. Gives the same result as calling HW_Cycles_To_Clock_Time_64() for every element.
+ * @note 64 bit.
+ * @param [in]  a_cycles 	array of HW cycles i.e. values got from Get_Uptime_HW_Cycles_64().
+ * @param [in]  a_count 	number of elements in a_cycles.
+ * @param [out] a_out 	output arrays, each of them must have room for a_count elements and they must not overlap with each other or with a_cycles.
+*/
+void HW_Cycles_To_Clock_Time_Batch_64(const uint64_t * a_cycles, size_t a_count, TimeElapsedClockArrays * a_out)
+{
+	HW_Cycles_To_Clock_Arrays_64(a_cycles, a_count, a_out->day, a_out->hour, a_out->min, a_out->sec, a_out->m_sec, a_out->u_sec);
 }
 
 
@@ -684,72 +1753,220 @@ void Create_Poweredup_Time_Secs(uint64_t * a_secs_buff)
  * @brief Helps to accumulate time everytime that this function is called. Data is in TimeElapsedClock format. 
  * @param [out] a_clk  pointer to the user provided buffer where the accumulated time data will be written.
  * @param [in, out]  a_previous_clk Pointer to a variable where the previous values needed for accumulated time calculations. For usual accumulated time calculations this variable shouldn't be modified after it's proper initialization and should be left only for use of this function. But, user can indicate a custom previous time i.e. with some offset. This can be provided modified beforehand if some different type of accumulated time regarding the use case is wanted to be calculated.
+ * @note Calculations are done on TimeDuration, clock values are converted only once in and once out. If the elapsed time is negative (a_previous_clk is in the future), nothing is accumulated.
+ * @retval one of the error values from enum TimeAndClockErrors
  * @warning pointer to the a_clk variable provided in this function should be an appropriate type of variable where it can hold accumulated time values i.e. RAM retained variable if data is wanted to be retained. It's up to user to provide synchronisation and protection as well as maintain this variable as needed, before and after it's manipulated in this function.
 */
 TimeAndClockErrors Accumulate_Time_Clk(TimeElapsedClock * a_clk, TimeElapsedClock * a_previous_clk)
 {
-     TimeElapsedClock current_clk = Get_Uptime_Ticks_As_Clock_Time();
-
-     TimeElapsedClock time_diff_to_be_added = {0};
+	TimeDuration current_time = Get_Uptime_Ticks_As_Duration();
 
-     TimeAndClockErrors err = 0;
-     err = Clock_Subtract_Two_Time_Points(&time_diff_to_be_added, current_clk, * a_previous_clk);
-     if(err != TIME_UTIL_ERROR_NONE){
-          LOG_ERR("Error while subtracting time in %s", __func__);
-     }
+	TimeDuration time_diff_to_be_added = Duration_Sub(current_time, Clock_To_Duration(a_previous_clk));
 
-     * a_previous_clk = current_clk; // update previous value to current for later iterations
+	(void)Duration_To_Clock(a_previous_clk, current_time); // update previous value to current for later iterations, uptime can't be negative.
 
-     err = Clock_Sum_Two_Time_Points(a_clk, time_diff_to_be_added, *a_clk);
-	if(err != TIME_UTIL_ERROR_NONE){
-          LOG_ERR("Error while summing time in %s", __func__);
-     }
+	if(Duration_Is_Negative(time_diff_to_be_added)){
+		LOG_ERR("Error while subtracting time in %s", __func__);
+		return TIME_UTIL_ERROR_NEGATIVE;
+	}
 
-	return err;
+	return Duration_To_Clock(a_clk, Duration_Add(Clock_To_Duration(a_clk), time_diff_to_be_added));
 }
 
 
 /**
  * @brief Helps to accumulate time everytime that this function is called to create time data that is tracked since the power up of the device. Data is in TimeElapsedClock format.
  * @param [out] a_clk  pointer to the user provided buffer where the powered up time data will be written.
+ * @note Calculations are done on TimeDuration, clock values are converted only once in and once out.
+ * @retval one of the error values from enum TimeAndClockErrors
  * @warning pointer to the a_clk variable provided in this function should be an appropriate type of variable where it can hold poweredup time values i.e. ram retained variable. It's up to user to provide synchronisation and protection as well as maintain this variable as needed, before and after it's manipulated in this function.
 */
 TimeAndClockErrors Create_Poweredup_Time_Clk(TimeElapsedClock * a_clk)
 {
 
-	static TimeElapsedClock prev_clk = {0};
+	static TimeDuration prev_time = {0};
 
-     TimeElapsedClock current_clk = Get_Uptime_Ticks_As_Clock_Time();
+	TimeDuration current_time = Get_Uptime_Ticks_As_Duration();
 
-     TimeElapsedClock time_diff_to_be_added = {0};
+	TimeDuration time_diff_to_be_added = Duration_Sub(current_time, prev_time);
 
-     TimeAndClockErrors err = 0;
-     err = Clock_Subtract_Two_Time_Points(&time_diff_to_be_added, current_clk, prev_clk);
-     if(err != TIME_UTIL_ERROR_NONE){
-          LOG_ERR("Error while subtracting time in %s", __func__);
-     }
+	prev_time = current_time; // update previous value to current for later iterations
+
+	if(Duration_Is_Negative(time_diff_to_be_added)){
+		LOG_ERR("Error while subtracting time in %s", __func__);
+		return TIME_UTIL_ERROR_NEGATIVE;
+	}
+
+	return Duration_To_Clock(a_clk, Duration_Add(Clock_To_Duration(a_clk), time_diff_to_be_added));
+}
 
-     prev_clk = current_clk; // update previous value to current for later iterations
 
-	err = Clock_Sum_Two_Time_Points(a_clk, time_diff_to_be_added, *a_clk);
-	if(err != TIME_UTIL_ERROR_NONE){
-          LOG_ERR("Error while summing time in %s", __func__);
-     }
 
-     
-	return err;
+/**
+ * @brief Initialize a powered-up time accumulator.
+ * @param [out] a_acc 		Pointer to the accumulator owned by the user.
+ * @param [in]  a_base_ticks 	Powered-up time before this boot in ticks i.e. restored from a retained variable, 0 if there isn't any.
+ * @note Must be called before any other thread or ISR uses the accumulator.
+*/
+void Poweredup_Accumulator_Init(PoweredupAccumulator * a_acc, uint64_t a_base_ticks)
+{
+	memset(a_acc, 0, sizeof(* a_acc));
+	a_acc->base_ticks = a_base_ticks;
 }
 
+/**
+ * @brief Adds the time elapsed since the last update to the accumulator. Can be called from any thread or ISR concurrently, on SMP too.
+ * @param [in, out] a_acc 	Pointer to the initialized accumulator.
+ * @note Only the latest uptime sample is kept, so updates that race with each other never count the same interval twice. If 64 bit atomics 
+ * are lock-free on the target, update is a compare-and-swap that retries only while other updaters are publishing older samples; no locks are taken.
+*/
+void Poweredup_Accumulator_Update(PoweredupAccumulator * a_acc)
+{
+	uint64_t current_ticks = (uint64_t)k_uptime_ticks();
 
+#if TIME_UTIL_ATOMIC64_LOCK_FREE
+	uint64_t last_ticks = __atomic_load_n(&a_acc->last_uptime_ticks, __ATOMIC_RELAXED);
+
+	while(last_ticks < current_ticks){
+		if(__atomic_compare_exchange_n(&a_acc->last_uptime_ticks, &last_ticks, current_ticks, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)){
+			break;
+		}
+		// last_ticks is refreshed by the failed compare-and-swap; a newer sample may already be published.
+	}
+#else
+	k_spinlock_key_t key = k_spin_lock(&a_acc->lock);
+
+	if(a_acc->last_uptime_ticks < current_ticks){
+		a_acc->last_uptime_ticks = current_ticks;
+	}
+
+	k_spin_unlock(&a_acc->lock, key);
+#endif
+}
+
+/**
+ * @brief Get the accumulated powered-up time in ticks as of the last update. Consistent even if updates run concurrently.
+ * @param [in] a_acc 	Pointer to the initialized accumulator.
+*/
+uint64_t Poweredup_Accumulator_Get_Ticks(PoweredupAccumulator * a_acc)
+{
+#if TIME_UTIL_ATOMIC64_LOCK_FREE
+	uint64_t last_ticks = __atomic_load_n(&a_acc->last_uptime_ticks, __ATOMIC_ACQUIRE);
+#else
+	k_spinlock_key_t key = k_spin_lock(&a_acc->lock);
+	uint64_t last_ticks = a_acc->last_uptime_ticks;
+	k_spin_unlock(&a_acc->lock, key);
+#endif
+
+	return a_acc->base_ticks + last_ticks;
+}
+
+/**
+ * @brief Get the accumulated powered-up time in seconds as of the last update.
+ * @warning Throws away the fraction part.
+*/
+uint64_t Poweredup_Accumulator_Get_Secs(PoweredupAccumulator * a_acc)
+{
+	return Ticks_To_Seconds(Poweredup_Accumulator_Get_Ticks(a_acc));
+}
+
+/**
+ * @brief Get the accumulated powered-up time as a scalar duration as of the last update.
+*/
+TimeDuration Poweredup_Accumulator_Get_Duration(PoweredupAccumulator * a_acc)
+{
+	return Ticks_To_Duration((int64_t)Poweredup_Accumulator_Get_Ticks(a_acc));
+}
+
+/**
+ * @brief Get the accumulated powered-up time in clock format as of the last update.
+*/
+TimeElapsedClock Poweredup_Accumulator_Get_Clock(PoweredupAccumulator * a_acc)
+{
+	return Ticks_To_Clock_Time((int64_t)Poweredup_Accumulator_Get_Ticks(a_acc));
+}
 
 
 
+/**
+ * @brief Reads the counter of a raw time accumulator.
+*/
+static uint64_t Raw_Time_Accumulator_Read(const RawTimeAccumulator * a_acc)
+{
+	return (a_acc->source == TIME_ACCUMULATOR_HW_CYCLES) ? Get_Uptime_HW_Cycles_64() : (uint64_t)k_uptime_ticks();
+}
 
+/**
+ * @brief Initialize a raw time accumulator. Accumulation starts from the current counter value.
+ * @param [out] a_acc 			Pointer to the accumulator owned by the user.
+ * @param [in]  a_source 		counter to accumulate.
+ * @param [in]  a_base_total 		time accumulated before i.e. total of a retained accumulator from the previous boot, 0 if there isn't any.
+ * @param [in]  a_base_units_per_sec 	rate a_base_total was accumulated in (its units_per_sec). If it differs from the current rate i.e. after a firmware update, total is rescaled.
+ * @note Not thread safe, like Accumulate_Time_*; use PoweredupAccumulator for concurrent updates.
+*/
+void Raw_Time_Accumulator_Init(RawTimeAccumulator * a_acc, TimeAccumulatorSource a_source, uint64_t a_base_total, uint32_t a_base_units_per_sec)
+{
+	uint32_t units_per_sec = (a_source == TIME_ACCUMULATOR_HW_CYCLES) ? (uint32_t)sys_clock_hw_cycles_per_sec() : CONFIG_SYS_CLOCK_TICKS_PER_SEC;
+
+	a_acc->source        = (uint8_t)a_source;
+	a_acc->units_per_sec = units_per_sec;
+	a_acc->total         = a_base_total;
+	if((a_base_units_per_sec != 0U) && (a_base_units_per_sec != units_per_sec)){
+		// divide first so that multiplication doesn't overflow.
+		a_acc->total = ((a_base_total / a_base_units_per_sec) * units_per_sec)
+			     + (((a_base_total % a_base_units_per_sec) * units_per_sec) / a_base_units_per_sec);
+	}
+	a_acc->last_raw = Raw_Time_Accumulator_Read(a_acc);
+}
 
+/**
+ * @brief Adds the time elapsed since the last update (or init). Reads the counter and does a 64 bit subtraction and addition; no conversion.
+*/
+void Raw_Time_Accumulator_Update(RawTimeAccumulator * a_acc)
+{
+	uint64_t raw = Raw_Time_Accumulator_Read(a_acc);
 
+	a_acc->total   += raw - a_acc->last_raw;
+	a_acc->last_raw = raw;
+}
 
+/**
+ * @brief Get the accumulated time in seconds, as of the last update.
+ * @warning Throws away the fraction part of the result; accumulated total keeps it.
+*/
+uint64_t Raw_Time_Accumulator_Get_Secs(const RawTimeAccumulator * a_acc)
+{
+	return a_acc->total / a_acc->units_per_sec;
+}
 
+/**
+ * @brief Get the accumulated time as a scalar duration, as of the last update. Exact: micro seconds are rounded down from the whole raw total.
+*/
+TimeDuration Raw_Time_Accumulator_Get_Duration(const RawTimeAccumulator * a_acc)
+{
+	uint64_t secs      = a_acc->total / a_acc->units_per_sec;
+	uint64_t remainder = a_acc->total - (secs * a_acc->units_per_sec);
 
+	// remainder < units_per_sec < 2^32, multiplication can't overflow.
+	return (TimeDuration)((secs * TIME_DURATION_USEC_PER_SEC) + ((remainder * TIME_DURATION_USEC_PER_SEC) / a_acc->units_per_sec));
+}
 
+/**
+ * @brief Get the accumulated time in clock format, as of the last update.
+*/
+TimeElapsedClock Raw_Time_Accumulator_Get_Clock(const RawTimeAccumulator * a_acc)
+{
+	TimeElapsedClock clk;
 
+	(void)Duration_To_Clock(&clk, Raw_Time_Accumulator_Get_Duration(a_acc));
 
+	return clk;
+}
+
+/**
+ * @brief Get the accumulated time in every time category, as of the last update. See Duration_To_Time_Categories().
+*/
+void Raw_Time_Accumulator_Get_Time_Categories(TimeCategories * a_categories, const RawTimeAccumulator * a_acc)
+{
+	Duration_To_Time_Categories(a_categories, Raw_Time_Accumulator_Get_Duration(a_acc));
+}
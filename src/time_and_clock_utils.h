@@ -13,10 +13,24 @@ extern "C" {
 #endif
 
 #include <stdint.h>
-#include <zephyr/kernel.h>
-#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "time_and_clock_port.h"
 
 #define CLOCK_LEGEND_MAX_STRING_SIZE 16
+#define CLOCK_MAX_STRING_SIZE 30 /* "[4294967295:23:59:59.999,999]" and NUL */
+
+/* Field flags for selecting which clock fields are formatted, they can be ORed together. */
+#define CLOCK_FIELD_USEC 	(1U << 0)
+#define CLOCK_FIELD_MSEC 	(1U << 1)
+#define CLOCK_FIELD_SEC 	(1U << 2)
+#define CLOCK_FIELD_MIN 	(1U << 3)
+#define CLOCK_FIELD_HOUR 	(1U << 4)
+#define CLOCK_FIELD_DAY 	(1U << 5)
+#define CLOCK_FIELD_ALL 	(0x3FU)
+/* Format flag: print hour, min, sec with 2 and ms, us with 3 digits, zero padded i.e. [0:01:02:03.004,005] */
+#define CLOCK_FORMAT_ZERO_PAD 	(1U << 6)
 
 /** 
  * @brief enum for encoding errors
@@ -25,6 +39,10 @@ typedef enum TimeAndClockErrors
 {
 	TIME_UTIL_ERROR_NONE = 0,
 	TIME_UTIL_ERROR_NEGATIVE = 1, /* if one of the values related to time or clock is negative while it mustn't be while making calculations */
+	TIME_UTIL_ERROR_UNSUPPORTED = 2, /* if a value can't be represented in the requested format i.e. calendar units (months, years) in a duration */
+	TIME_UTIL_ERROR_SYNTAX = 3, /* if a parsed string doesn't match the expected format */
+	TIME_UTIL_ERROR_RANGE = 4, /* if a parsed value is out of the range of its field or overflows */
+	TIME_UTIL_ERROR_NOT_FOUND = 5, /* if the object a query is made for isn't tracked i.e. a thread that never ran */
 }TimeAndClockErrors;
 
 /**
@@ -39,6 +57,19 @@ typedef struct timeElapsedClock{
 	uint8_t	hour;
 }TimeElapsedClock;
 
+/**
+ * @brief struct type that will hold clock values of many time points as separate arrays (structure of arrays). Used by batch conversion routines.
+ * @note each array must have room for as many elements as the converted time points and arrays must not overlap with each other.
+*/
+typedef struct timeElapsedClockArrays{
+	uint32_t *	day;
+	uint8_t  *	hour;
+	uint8_t  *	min;
+	uint8_t  *	sec;
+	uint16_t *	m_sec;
+	uint16_t *	u_sec;
+}TimeElapsedClockArrays;
+
 /**
  * @brief struct type that will hold all the units of time variables.
 */
@@ -56,6 +87,124 @@ typedef struct timeCategories{
 	int64_t 	centuries;
 }TimeCategories;
 
+/**
+ * @brief struct type that keeps the last converted time point of a caller, for cached (incremental) clock conversions.
+ * @note Zero initialize before the first use i.e. ClockConversionCache cache = {0}; A zero cache is a valid cache of time 0.
+ * @note Each thread or ISR must use its own cache object; routines don't synchronise access to it.
+*/
+typedef struct clockConversionCache{
+	uint64_t 		last_micro_sec;
+	TimeElapsedClock 	last_clk;
+}ClockConversionCache;
+
+/* If 1, 64 bit HW cycle routines read the software extended counter of cycle_counter_64.h instead of k_cycle_get_64(). */
+#ifndef TIME_UTIL_SW_CYCLE_COUNTER_64
+#define TIME_UTIL_SW_CYCLE_COUNTER_64 0
+#endif
+
+/* 64 bit atomics are lock-free on this target if the compiler says so (i.e. 64 bit targets, ARMv7-A/R); otherwise a spinlock is used. */
+#if defined(__GCC_ATOMIC_LLONG_LOCK_FREE) && (__GCC_ATOMIC_LLONG_LOCK_FREE == 2)
+#define TIME_UTIL_ATOMIC64_LOCK_FREE 1
+#else
+#define TIME_UTIL_ATOMIC64_LOCK_FREE 0
+#endif
+
+/**
+ * @brief struct type for a powered-up time accumulator that can be updated from any thread or ISR concurrently.
+ * @note Use only through Poweredup_Accumulator_* routines. Unlike Create_Poweredup_Time_*, state is owned by the user; there is no hidden static.
+ * @note Updates are lock-free, not wait-free: with 64 bit atomics Poweredup_Accumulator_Update() is a compare-and-swap retry loop, an updater
+ * retries while others publish older samples. It can't retry more times than there are concurrent updaters. Without them a spinlock is taken.
+*/
+typedef struct poweredupAccumulator{
+	uint64_t 		base_ticks; 		/* powered-up ticks before this boot i.e. restored from a retained variable. Set at init only. */
+	uint64_t 		last_uptime_ticks __aligned(8); /* latest uptime sample, only increases. Updated atomically, 64 bit atomics need it 8 byte aligned. */
+#if !TIME_UTIL_ATOMIC64_LOCK_FREE
+	struct k_spinlock 	lock;
+#endif
+}PoweredupAccumulator;
+
+/**
+ * @brief enum for the counter a raw time accumulator counts in.
+*/
+typedef enum TimeAccumulatorSource
+{
+	TIME_ACCUMULATOR_TICKS = 0,
+	TIME_ACCUMULATOR_HW_CYCLES = 1, /* 64 bit HW cycles, see Get_Uptime_HW_Cycles_64() */
+}TimeAccumulatorSource;
+
+/**
+ * @brief struct type for an accumulator that keeps time in raw ticks or HW cycles and converts it only when it's read.
+ * @note Use only through Raw_Time_Accumulator_* routines. Total is kept in raw units, so fractions of a second are never thrown away and long totals don't drift.
+ * @note Keep total and units_per_sec i.e. in a retained variable to carry the total over reboots, see Raw_Time_Accumulator_Init().
+*/
+typedef struct rawTimeAccumulator{
+	uint64_t 	total; 			/* accumulated time in raw units */
+	uint64_t 	last_raw; 		/* counter value at the last update */
+	uint32_t 	units_per_sec; 		/* rate of the raw units, ticks or HW cycles per second */
+	uint8_t 	source; 		/* TimeAccumulatorSource */
+}RawTimeAccumulator;
+
+/*
+ * If 1, HW cycle conversions of this library (HW_Cycles_To_*) use the runtime calibrated conversion returned by Get_HW_Cycles_Conversion():
+ * one multiply-high per conversion instead of a division by the runtime frequency, and drift correction can be applied to it.
+ * Defaults to 0: the calibrated factor is rounded down, so a conversion can give 1 micro second less than k_cyc_to_us_floor64() i.e.
+ * HW_Cycles_To_Seconds_64(n * rate) would be n - 1. Use Cycle_Conversion_* with Get_HW_Cycles_Conversion() for the calibrated path without it.
+ */
+#ifndef TIME_UTIL_RUNTIME_CYCLE_CONVERSION
+#define TIME_UTIL_RUNTIME_CYCLE_CONVERSION 0
+#endif
+
+/* Largest drift correction accepted, parts per billion. Corrections are clamped to it. */
+#define CYCLE_CONVERSION_MAX_CORRECTION_PPB 	100000000
+
+/**
+ * @brief struct type for a fixed-point counter to micro seconds conversion: micro seconds = (counts * mult) >> shift, with drift correction folded into mult.
+ * @note Use only through Cycle_Conversion_* routines. Converting is lock-free and can be done from any thread or ISR while it's being updated.
+ * @note Works for any counter with a known nominal rate, i.e. HW cycles or ticks.
+*/
+typedef struct cycleConversion{
+	uint32_t 	sequence; 		/* odd while being updated */
+	uint32_t 	counts_per_sec; 	/* nominal rate of the counter */
+	int32_t 	correction_ppb; 	/* drift of the counter, parts per billion; positive if it runs fast */
+	uint32_t 	shift;
+	uint64_t 	mult;
+}CycleConversion;
+
+/**
+ * @brief struct type for estimating the drift of HW cycles and ticks against a reference counter i.e. an RTC. Use only through Drift_Estimator_* routines.
+*/
+typedef struct driftEstimator{
+	uint64_t 	start_ref;
+	uint64_t 	start_cycles;
+	int64_t 	start_ticks;
+	uint32_t 	ref_per_sec;
+}DriftEstimator;
+
+/**
+ * @brief struct type for a drift estimate. Positive ppb means the counter runs fast compared to the reference.
+*/
+typedef struct driftEstimate{
+	int32_t 	cycles_ppb;
+	int32_t 	ticks_ppb;
+	uint64_t 	ref_elapsed; 		/* reference counts the estimate was taken over */
+}DriftEstimate;
+
+/* If the time advanced less than this since the last cached conversion, only the low clock fields are advanced. Otherwise full conversion is done. */
+#define CLOCK_CONVERSION_CACHE_MAX_STEP_US 	1000000U
+
+/**
+ * @brief Scalar duration type. Holds a signed amount of time in micro seconds, covers about +-292000 years.
+ * @note Prefer this type over TimeElapsedClock for arithmetic; add, subtract, compare etc. are single instructions on it. Convert to TimeElapsedClock only for presenting.
+*/
+typedef int64_t TimeDuration;
+
+#define TIME_DURATION_USEC_PER_MSEC 	((TimeDuration)1000)
+#define TIME_DURATION_USEC_PER_SEC 	((TimeDuration)1000000)
+#define TIME_DURATION_USEC_PER_MIN 	(TIME_DURATION_USEC_PER_SEC  * 60)
+#define TIME_DURATION_USEC_PER_HOUR 	(TIME_DURATION_USEC_PER_MIN  * 60)
+#define TIME_DURATION_USEC_PER_DAY 	(TIME_DURATION_USEC_PER_HOUR * 24)
+#define TIME_DURATION_USEC_PER_WEEK 	(TIME_DURATION_USEC_PER_DAY  * 7)
+
 
 /* ------------------  CONVERSION UTILS ------------------ */
 uint64_t Micro_Sec_To_Milli_Sec(uint64_t a_micro_sec);
@@ -67,8 +216,67 @@ TimeAndClockErrors Clock_Subtract_Two_Time_Points(TimeElapsedClock * a_result_bu
 TimeAndClockErrors Clock_Sum_Two_Time_Points(TimeElapsedClock * a_result_buf, TimeElapsedClock a_first_time, TimeElapsedClock a_second_time);
 void Increment_a_Millisecond_And_Update_Clock(TimeElapsedClock * a_clock);
 void Increment_a_Second_And_Update_Clock(TimeElapsedClock * a_clock);
+int Clock_Format(char * a_buf, size_t a_buf_size, const TimeElapsedClock * a_clock, uint32_t a_fields);
+int Clock_Legend_Format(char * a_buf, size_t a_buf_size, uint32_t a_fields);
+const char * Clock_Legend_Str(uint32_t a_fields);
 void Clock_To_Str(char * a_clk_buf, char * a_legend_buf, TimeElapsedClock * a_clock, bool a_print_usec, bool a_print_msec, bool a_print_sec, bool a_print_min, bool a_print_hour, bool a_print_day);
+TimeAndClockErrors Clock_Parse(TimeElapsedClock * a_clock, const char * a_str, size_t a_len, uint32_t a_fields, size_t * a_end);
+TimeAndClockErrors Clock_Legend_Parse(uint32_t * a_fields, const char * a_str, size_t a_len, size_t * a_end);
+
+
 
+/* ------------------  DURATION ------------------ */
+TimeDuration Clock_To_Duration(const TimeElapsedClock * a_clock);
+TimeAndClockErrors Duration_To_Clock(TimeElapsedClock * a_clock, TimeDuration a_duration);
+TimeAndClockErrors Time_Categories_To_Duration(TimeDuration * a_duration, const TimeCategories * a_categories);
+void Duration_To_Time_Categories(TimeCategories * a_categories, TimeDuration a_duration);
+TimeAndClockErrors Duration_Parse(TimeDuration * a_duration, const char * a_str, size_t a_len, size_t * a_end);
+TimeDuration Ticks_To_Duration(int64_t a_ticks);
+TimeDuration Get_Uptime_Ticks_As_Duration(void);
+TimeDuration HW_Cycles_To_Duration_64(uint64_t a_cycles);
+TimeDuration Get_Uptime_HW_Cycles_As_Duration_64(void);
+
+/** @brief Sum of two durations. */
+static inline TimeDuration Duration_Add(TimeDuration a_first, TimeDuration a_second)
+{
+	return a_first + a_second;
+}
+
+/** @brief Difference of two durations (a_final - a_initial). Result is negative if a_initial is bigger. */
+static inline TimeDuration Duration_Sub(TimeDuration a_final, TimeDuration a_initial)
+{
+	return a_final - a_initial;
+}
+
+/** @brief Multiply a duration with an integer factor. */
+static inline TimeDuration Duration_Scale(TimeDuration a_duration, int64_t a_factor)
+{
+	return a_duration * a_factor;
+}
+
+/** @retval -1 if a_first < a_second, 0 if equal, 1 if a_first > a_second. Branch-free. */
+static inline int Duration_Compare(TimeDuration a_first, TimeDuration a_second)
+{
+	return (a_first > a_second) - (a_first < a_second);
+}
+
+/** @brief Smaller of two durations. */
+static inline TimeDuration Duration_Min(TimeDuration a_first, TimeDuration a_second)
+{
+	return (a_first < a_second) ? a_first : a_second;
+}
+
+/** @brief Bigger of two durations. */
+static inline TimeDuration Duration_Max(TimeDuration a_first, TimeDuration a_second)
+{
+	return (a_first > a_second) ? a_first : a_second;
+}
+
+/** @retval true if the duration is negative. */
+static inline bool Duration_Is_Negative(TimeDuration a_duration)
+{
+	return a_duration < 0;
+}
 
 
 /* ------------------  TICKS ------------------ */
@@ -107,12 +315,57 @@ uint64_t Get_Uptime_HW_Cycles_As_Seconds_64(void);
 TimeElapsedClock HW_Cycles_To_Clock_Time_64(uint64_t a_cycles);
 TimeElapsedClock Get_Uptime_HW_Cycles_As_Clock_Time_64(void);
 
+/* ------------------  CACHED CONVERSION ------------------ */
+TimeElapsedClock Ticks_To_Clock_Time_Cached(ClockConversionCache * a_cache, int64_t a_ticks);
+TimeElapsedClock Get_Uptime_Ticks_As_Clock_Time_Cached(ClockConversionCache * a_cache);
+TimeElapsedClock HW_Cycles_To_Clock_Time_Cached_64(ClockConversionCache * a_cache, uint64_t a_cycles);
+TimeElapsedClock Get_Uptime_HW_Cycles_As_Clock_Time_Cached_64(ClockConversionCache * a_cache);
+
+/* ------------------  RUNTIME CALIBRATED CONVERSION ------------------ */
+void Cycle_Conversion_Init(CycleConversion * a_conv, uint32_t a_counts_per_sec, int32_t a_correction_ppb);
+void Cycle_Conversion_Set_Frequency(CycleConversion * a_conv, uint32_t a_counts_per_sec);
+void Cycle_Conversion_Set_Correction(CycleConversion * a_conv, int32_t a_correction_ppb);
+uint64_t Cycle_Conversion_To_Micro_Sec(const CycleConversion * a_conv, uint64_t a_counts);
+TimeDuration Cycle_Conversion_To_Duration(const CycleConversion * a_conv, uint64_t a_counts);
+TimeElapsedClock Cycle_Conversion_To_Clock_Time(const CycleConversion * a_conv, uint64_t a_counts);
+CycleConversion * Get_HW_Cycles_Conversion(void);
+
+void Drift_Estimator_Start(DriftEstimator * a_est, uint64_t a_ref_count, uint32_t a_ref_per_sec);
+TimeAndClockErrors Drift_Estimator_Get(const DriftEstimator * a_est, uint64_t a_ref_count, DriftEstimate * a_estimate);
+
+/* ------------------  BATCH CONVERSION ------------------ */
+void Ticks_To_Clock_Time_Batch(const int64_t * a_ticks, size_t a_count, TimeElapsedClockArrays * a_out);
+void HW_Cycles_To_Clock_Time_Batch_32(const uint32_t * a_cycles, size_t a_count, TimeElapsedClockArrays * a_out);
+void HW_Cycles_To_Clock_Time_Batch_64(const uint64_t * a_cycles, size_t a_count, TimeElapsedClockArrays * a_out);
+
 /* ------------------  POWEREDUP TIME ------------------ */
 void Accumulate_Time_Secs(uint64_t * a_secs_buff, uint64_t * a_prev_secs);
 void Create_Poweredup_Time_Secs(uint64_t * a_secs_buff);
 TimeAndClockErrors Accumulate_Time_Clk(TimeElapsedClock * a_clk, TimeElapsedClock * a_previous_clk);
 TimeAndClockErrors Create_Poweredup_Time_Clk(TimeElapsedClock * a_clk);
 
+void Poweredup_Accumulator_Init(PoweredupAccumulator * a_acc, uint64_t a_base_ticks);
+void Poweredup_Accumulator_Update(PoweredupAccumulator * a_acc);
+uint64_t Poweredup_Accumulator_Get_Ticks(PoweredupAccumulator * a_acc);
+uint64_t Poweredup_Accumulator_Get_Secs(PoweredupAccumulator * a_acc);
+TimeDuration Poweredup_Accumulator_Get_Duration(PoweredupAccumulator * a_acc);
+TimeElapsedClock Poweredup_Accumulator_Get_Clock(PoweredupAccumulator * a_acc);
+
+void Raw_Time_Accumulator_Init(RawTimeAccumulator * a_acc, TimeAccumulatorSource a_source, uint64_t a_base_total, uint32_t a_base_units_per_sec);
+void Raw_Time_Accumulator_Update(RawTimeAccumulator * a_acc);
+uint64_t Raw_Time_Accumulator_Get_Secs(const RawTimeAccumulator * a_acc);
+TimeDuration Raw_Time_Accumulator_Get_Duration(const RawTimeAccumulator * a_acc);
+TimeElapsedClock Raw_Time_Accumulator_Get_Clock(const RawTimeAccumulator * a_acc);
+void Raw_Time_Accumulator_Get_Time_Categories(TimeCategories * a_categories, const RawTimeAccumulator * a_acc);
+
+/**
+ * @brief Adds an interval that's already measured in the accumulator's raw units, i.e. a HW cycle delta. Single 64 bit addition, no conversion.
+*/
+static inline void Raw_Time_Accumulator_Add(RawTimeAccumulator * a_acc, uint64_t a_raw_delta)
+{
+	a_acc->total += a_raw_delta;
+}
+
 
 
 #ifdef __cplusplus
@@ -0,0 +1,367 @@
+/**
+ * @author Batto1
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "time_and_clock_port.h"
+
+#include "timer_wheel.h"
+
+
+#define TIMER_WHEEL_SLOT_MASK 		((uint64_t)TIMER_WHEEL_SLOTS - 1U)
+
+
+/**
+ * @brief Tick in [a_expiry, a_expiry + a_slack] with the most trailing zero bits: a_expiry - 1 and a_expiry + a_slack differ first at bit m,
+ *        so a_expiry + a_slack with its bits below m cleared is in the range and no other tick in it is a multiple of a bigger power of two.
+*/
+static inline int64_t Fire_Tick(int64_t a_expiry, uint32_t a_slack)
+{
+	if((a_slack == 0U) || (a_expiry <= 0)){
+		return a_expiry;
+	}
+
+	uint64_t last = (uint64_t)a_expiry + a_slack;
+	uint32_t m = 63U - (uint32_t)__builtin_clzll(((uint64_t)a_expiry - 1U) ^ last);
+
+	return (int64_t)((last >> m) << m);
+}
+
+static inline void Slot_Add(TimerWheel * a_wheel, TimerWheelTimer * a_timer, uint32_t a_level, uint32_t a_slot)
+{
+	TimerWheelTimer ** head = &a_wheel->slots[a_level][a_slot];
+
+	a_timer->next = * head;
+	if(* head != NULL){
+		(* head)->pprev = &a_timer->next;
+	}
+	* head         = a_timer;
+	a_timer->pprev = head;
+	a_timer->level = (uint8_t)a_level;
+	a_timer->slot  = (uint8_t)a_slot;
+	a_wheel->occupied[a_level] |= BIT64(a_slot);
+}
+
+static inline void Unlink(TimerWheelTimer * a_timer)
+{
+	* a_timer->pprev = a_timer->next;
+	if(a_timer->next != NULL){
+		a_timer->next->pprev = a_timer->pprev;
+	}
+	a_timer->pprev = NULL;
+}
+
+/**
+ * @brief Hashes a timer into the level its remaining time falls in: level l holds timers 64^l to 64^(l + 1) - 1 ticks away,
+ *        in the slot of their fire tick. Such a slot is reached (and cascaded) once before the timer fires.
+*/
+static void Insert(TimerWheel * a_wheel, TimerWheelTimer * a_timer)
+{
+	int64_t fire = MAX(a_timer->fire, a_wheel->current);
+	uint64_t delta = (uint64_t)(fire - a_wheel->current);
+	uint32_t level = 0;
+
+	if(delta >= (uint64_t)TIMER_WHEEL_RANGE){
+		// parked in the last level, re-hashed when its slot is cascaded.
+		delta = (uint64_t)TIMER_WHEEL_RANGE - 1U;
+		fire  = a_wheel->current + (int64_t)delta;
+	}
+	if(delta >= TIMER_WHEEL_SLOTS){
+		level = (63U - (uint32_t)__builtin_clzll(delta)) / TIMER_WHEEL_SLOT_BITS;
+	}
+
+	Slot_Add(a_wheel, a_timer, level, (uint32_t)(((uint64_t)fire >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK));
+}
+
+/**
+ * @brief Unlinks an armed timer. It may be on the expiring list of Timer_Wheel_Advance() instead of its slot; the slot's bit is cleared only
+ *        if the slot is empty either way.
+*/
+static void Remove(TimerWheel * a_wheel, TimerWheelTimer * a_timer)
+{
+	Unlink(a_timer);
+	if(a_wheel->slots[a_timer->level][a_timer->slot] == NULL){
+		a_wheel->occupied[a_timer->level] &= ~BIT64(a_timer->slot);
+	}
+	a_wheel->armed_count--;
+}
+
+/**
+ * @brief First tick at which a slot has to be processed: a level 0 slot fires at its tick, an upper level slot is cascaded at its start.
+ *        Found from the occupied bitmaps in O(levels).
+*/
+static int64_t Next_Event_Locked(const TimerWheel * a_wheel)
+{
+	int64_t next = TIMER_WHEEL_NO_EVENT;
+
+	for(uint32_t level = 0; level < TIMER_WHEEL_LEVELS; level++){
+		uint64_t occupied = a_wheel->occupied[level];
+
+		if(occupied == 0U){
+			continue;
+		}
+
+		uint32_t shift  = level * TIMER_WHEEL_SLOT_BITS;
+		uint64_t period = (uint64_t)a_wheel->current >> shift;
+		uint32_t index  = (uint32_t)(period & TIMER_WHEEL_SLOT_MASK);
+		uint64_t rotated = (index != 0U) ? ((occupied >> index) | (occupied << (64U - index))) : occupied;
+		uint32_t ahead;
+
+		// slot of the current period has timers of the next round, unless the period starts at the current tick.
+		if((((uint64_t)a_wheel->current & (BIT64(shift) - 1U)) != 0U) && ((rotated & 1U) != 0U)){
+			rotated &= ~(uint64_t)1U;
+			ahead = (rotated != 0U) ? (uint32_t)__builtin_ctzll(rotated) : TIMER_WHEEL_SLOTS;
+		}else{
+			ahead = (uint32_t)__builtin_ctzll(rotated);
+		}
+		next = MIN(next, (int64_t)((period + ahead) << shift));
+	}
+
+	return next;
+}
+
+/**
+ * @brief Moves the timers of the upper level slots that start at a_tick down, highest level first so that they can land in a lower slot
+ *        that is cascaded at the same tick.
+*/
+static void Cascade(TimerWheel * a_wheel, int64_t a_tick)
+{
+	for(uint32_t level = TIMER_WHEEL_LEVELS - 1U; level >= 1U; level--){
+		uint32_t shift = level * TIMER_WHEEL_SLOT_BITS;
+
+		if(((uint64_t)a_tick & ((BIT64(shift)) - 1U)) != 0U){
+			continue;
+		}
+
+		uint32_t slot = (uint32_t)(((uint64_t)a_tick >> shift) & TIMER_WHEEL_SLOT_MASK);
+		TimerWheelTimer * timer = a_wheel->slots[level][slot];
+
+		a_wheel->slots[level][slot] = NULL;
+		a_wheel->occupied[level] &= ~BIT64(slot);
+		while(timer != NULL){
+			TimerWheelTimer * next = timer->next;
+
+			Insert(a_wheel, timer);
+			a_wheel->cascades++;
+			timer = next;
+		}
+	}
+}
+
+#if !defined(TIME_AND_CLOCK_PORT_POSIX)
+/**
+ * @brief Programs the kernel timer for the next event, with the wheel's lock held.
+*/
+static void Program_Kernel_Timer(TimerWheel * a_wheel)
+{
+	int64_t next = Next_Event_Locked(a_wheel);
+
+	if(!a_wheel->started || (next == a_wheel->programmed)){
+		return;
+	}
+	a_wheel->programmed = next;
+	if(next == TIMER_WHEEL_NO_EVENT){
+		k_timer_stop(&a_wheel->kernel_timer);
+		return;
+	}
+#if defined(CONFIG_TIMEOUT_64BIT)
+	k_timer_start(&a_wheel->kernel_timer, K_TIMEOUT_ABS_TICKS(next), K_NO_WAIT);
+#else
+	k_timer_start(&a_wheel->kernel_timer, K_TICKS(MAX(next - k_uptime_ticks(), 0)), K_NO_WAIT);
+#endif
+}
+
+static void Timer_Wheel_Kernel_Timer_Handler(struct k_timer * a_timer)
+{
+	TimerWheel * wheel = CONTAINER_OF(a_timer, TimerWheel, kernel_timer);
+
+	wheel->programmed = TIMER_WHEEL_NO_EVENT;
+	(void)Timer_Wheel_Advance(wheel, k_uptime_ticks());
+}
+#endif
+
+/**
+ * @brief Initializes an empty wheel.
+ * @param [out] a_wheel 	Pointer to the wheel owned by the user.
+ * @param [in]  a_now_ticks 	current uptime ticks i.e. k_uptime_ticks(), first tick processed.
+*/
+void Timer_Wheel_Init(TimerWheel * a_wheel, int64_t a_now_ticks)
+{
+	memset(a_wheel, 0, sizeof(* a_wheel));
+	a_wheel->current = a_now_ticks;
+#if !defined(TIME_AND_CLOCK_PORT_POSIX)
+	a_wheel->programmed = TIMER_WHEEL_NO_EVENT;
+	k_timer_init(&a_wheel->kernel_timer, Timer_Wheel_Kernel_Timer_Handler, NULL);
+#endif
+}
+
+/**
+ * @brief Initializes a timer, not armed.
+ * @param [out] a_timer 	Pointer to the timer, embedded in the user's object.
+ * @param [in]  a_handler 	called when the timer expires.
+*/
+void Timer_Wheel_Timer_Init(TimerWheelTimer * a_timer, TimerWheelHandler a_handler)
+{
+	memset(a_timer, 0, sizeof(* a_timer));
+	a_timer->handler = a_handler;
+}
+
+/**
+ * @brief Arms a timer, or re-arms it if it's armed.
+ * @param [in] a_expiry_ticks 	deadline in uptime ticks. A deadline that has passed fires at the next processed tick.
+ * @param [in] a_slack_ticks 	ticks the timer may fire after its deadline, to fire together with other timers. 0 fires exactly at the deadline.
+*/
+void Timer_Wheel_Arm(TimerWheel * a_wheel, TimerWheelTimer * a_timer, int64_t a_expiry_ticks, uint32_t a_slack_ticks)
+{
+	k_spinlock_key_t key = k_spin_lock(&a_wheel->lock);
+
+	if(a_timer->pprev != NULL){
+		Remove(a_wheel, a_timer);
+	}
+	a_timer->expiry = a_expiry_ticks;
+	a_timer->fire   = Fire_Tick(a_expiry_ticks, a_slack_ticks);
+	Insert(a_wheel, a_timer);
+	a_wheel->armed_count++;
+#if !defined(TIME_AND_CLOCK_PORT_POSIX)
+	Program_Kernel_Timer(a_wheel);
+#endif
+
+	k_spin_unlock(&a_wheel->lock, key);
+}
+
+/**
+ * @brief Arms a timer to expire a_timeout from now (uptime), rounded up to ticks.
+ * @param [in] a_slack 	time the timer may fire late, rounded down to ticks.
+*/
+void Timer_Wheel_Arm_Duration(TimerWheel * a_wheel, TimerWheelTimer * a_timer, TimeDuration a_timeout, TimeDuration a_slack)
+{
+	int64_t timeout_ticks = (int64_t)k_us_to_ticks_ceil64((uint64_t)MAX(a_timeout, (TimeDuration)0));
+	uint64_t slack_ticks  = k_us_to_ticks_floor64((uint64_t)MAX(a_slack, (TimeDuration)0));
+
+	Timer_Wheel_Arm(a_wheel, a_timer, k_uptime_ticks() + timeout_ticks, (uint32_t)MIN(slack_ticks, (uint64_t)UINT32_MAX));
+}
+
+/**
+ * @brief Cancels a timer.
+ * @retval true if the timer was armed; false if it wasn't, or it has expired and its handler is being called or was called.
+*/
+bool Timer_Wheel_Cancel(TimerWheel * a_wheel, TimerWheelTimer * a_timer)
+{
+	k_spinlock_key_t key = k_spin_lock(&a_wheel->lock);
+	bool armed = (a_timer->pprev != NULL);
+
+	if(armed){
+		Remove(a_wheel, a_timer);
+	}
+
+	k_spin_unlock(&a_wheel->lock, key);
+
+	return armed;
+}
+
+bool Timer_Wheel_Timer_Is_Armed(const TimerWheelTimer * a_timer)
+{
+	return (a_timer->pprev != NULL);
+}
+
+/**
+ * @brief Deadline of a timer as uptime in clock format.
+*/
+TimeElapsedClock Timer_Wheel_Timer_Expiry_Clock(const TimerWheelTimer * a_timer)
+{
+	return Ticks_To_Clock_Time(a_timer->expiry);
+}
+
+/**
+ * @brief Time left until a timer's deadline in clock format, zero if it has passed.
+*/
+TimeElapsedClock Timer_Wheel_Timer_Remaining_Clock(const TimerWheelTimer * a_timer, int64_t a_now_ticks)
+{
+	return Ticks_To_Clock_Time(MAX(a_timer->expiry - a_now_ticks, (int64_t)0));
+}
+
+/**
+ * @brief Tick the wheel has to be advanced at next, for programming a wakeup. Either a timer fires at it, or timers are cascaded at it.
+ * @retval TIMER_WHEEL_NO_EVENT if no timer is armed.
+*/
+int64_t Timer_Wheel_Next_Event(TimerWheel * a_wheel)
+{
+	k_spinlock_key_t key = k_spin_lock(&a_wheel->lock);
+	int64_t next = Next_Event_Locked(a_wheel);
+	k_spin_unlock(&a_wheel->lock, key);
+
+	return next;
+}
+
+/**
+ * @brief Processes all ticks up to a_now_ticks: cascades timers and calls the handlers of the expired ones, in fire tick order.
+ *        Ticks without an event are skipped through the occupied bitmaps, so the cost doesn't depend on the time elapsed.
+ * @param [in] a_now_ticks 	current uptime ticks, not smaller than the previous call's.
+ * @retval number of timers expired.
+*/
+uint32_t Timer_Wheel_Advance(TimerWheel * a_wheel, int64_t a_now_ticks)
+{
+	uint32_t expired = 0;
+	k_spinlock_key_t key = k_spin_lock(&a_wheel->lock);
+	int64_t tick = Next_Event_Locked(a_wheel);
+
+	if(tick <= a_now_ticks){
+		a_wheel->wakeups++;
+	}
+
+	while(tick <= a_now_ticks){
+		uint32_t slot = (uint32_t)((uint64_t)tick & TIMER_WHEEL_SLOT_MASK);
+		TimerWheelTimer * expiring = NULL;
+
+		a_wheel->current = tick;
+		Cascade(a_wheel, tick);
+
+		// handlers can cancel timers of this slot, so they are kept on a list of their own while being called.
+		expiring = a_wheel->slots[0][slot];
+		if(expiring != NULL){
+			expiring->pprev = &expiring;
+		}
+		a_wheel->slots[0][slot] = NULL;
+		a_wheel->occupied[0] &= ~BIT64(slot);
+		a_wheel->current = tick + 1;
+
+		while(expiring != NULL){
+			TimerWheelTimer * timer = expiring;
+
+			Unlink(timer);
+			a_wheel->armed_count--;
+			expired++;
+
+			k_spin_unlock(&a_wheel->lock, key);
+			timer->handler(timer, tick);
+			key = k_spin_lock(&a_wheel->lock);
+		}
+		tick = Next_Event_Locked(a_wheel);
+	}
+	a_wheel->current = MAX(a_wheel->current, a_now_ticks + 1);
+#if !defined(TIME_AND_CLOCK_PORT_POSIX)
+	Program_Kernel_Timer(a_wheel);
+#endif
+
+	k_spin_unlock(&a_wheel->lock, key);
+
+	return expired;
+}
+
+#if !defined(TIME_AND_CLOCK_PORT_POSIX)
+/**
+ * @brief Drives the wheel with a kernel timer that is programmed for its next event only, so idle ticks take no wakeups.
+ *        Handlers are called from the kernel timer's expiry function, in ISR context.
+*/
+void Timer_Wheel_Start(TimerWheel * a_wheel)
+{
+	k_spinlock_key_t key = k_spin_lock(&a_wheel->lock);
+
+	a_wheel->started = true;
+	Program_Kernel_Timer(a_wheel);
+
+	k_spin_unlock(&a_wheel->lock, key);
+}
+#endif
@@ -0,0 +1,99 @@
+/**
+ * @author Batto1
+ * @brief  Hierarchical timing wheel for many software timeouts on uptime ticks. Timers are intrusive nodes owned by the user; arm, cancel and
+ *         expiring a timer are O(1), and a single kernel timer (or any other wakeup source) is programmed for the whole wheel.
+ * @note   TIMER_WHEEL_LEVELS levels of 64 slots; a slot of level l is 64^l ticks wide. A timer is hashed into the level its remaining time falls in
+ *         and moved down (cascaded) when its slot is reached. Timers beyond the range of the wheel are parked in the last level and re-hashed.
+ * @note   Slack: a timer armed with slack s may fire at any tick in [expiry, expiry + s]. The tick in that range with the most trailing zero bits is
+ *         taken, so nearby deadlines meet on the same tick and fire in one wakeup. That tick is a multiple of the biggest power of two the slack
+ *         allows, so it's also the start of upper level slots: with a slack of a few slot widths, cascading a long timer falls on a wakeup that
+ *         timers fire in instead of taking a wakeup of its own.
+ * @note   Routines take the wheel's spinlock; handlers are called without it and may arm or cancel any timer of the wheel, including their own.
+*/
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "time_and_clock_port.h"
+#include "time_and_clock_utils.h"
+
+#ifndef TIMER_WHEEL_LEVELS
+#define TIMER_WHEEL_LEVELS 		5 	/* range 2^30 ticks: 29.8 h at 10 kHz ticks */
+#endif
+
+#define TIMER_WHEEL_SLOT_BITS 		6
+#define TIMER_WHEEL_SLOTS 		(1U << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_RANGE 		((int64_t)1 << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS))
+
+BUILD_ASSERT((TIMER_WHEEL_LEVELS >= 2) && (TIMER_WHEEL_LEVELS <= 10), "invalid TIMER_WHEEL_LEVELS, timers beyond the range are parked in an upper level");
+
+/* Next event of an empty wheel */
+#define TIMER_WHEEL_NO_EVENT 		INT64_MAX
+
+struct timerWheelTimer;
+
+/**
+ * @brief Expiry handler of a timer.
+ * @param [in] a_timer 		expired timer, not armed anymore. Use CONTAINER_OF() to get the object it's embedded in.
+ * @param [in] a_now_ticks 	tick the timer fired at; a_now_ticks - expiry is the lateness, slack included.
+*/
+typedef void (* TimerWheelHandler)(struct timerWheelTimer * a_timer, int64_t a_now_ticks);
+
+/**
+ * @brief struct type of a timer, embedded in the user's object. Use only through Timer_Wheel_* routines.
+*/
+typedef struct timerWheelTimer{
+	struct timerWheelTimer * 	next;
+	struct timerWheelTimer ** 	pprev; 		/* link that points to this timer, NULL if not armed */
+	int64_t 			expiry; 	/* deadline, uptime ticks */
+	int64_t 			fire; 		/* tick it fires at, expiry moved within slack */
+	TimerWheelHandler 		handler;
+	uint8_t 			level;
+	uint8_t 			slot;
+}TimerWheelTimer;
+
+/**
+ * @brief struct type of a wheel. Use only through Timer_Wheel_* routines.
+*/
+typedef struct timerWheel{
+	TimerWheelTimer * 	slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+	uint64_t 		occupied[TIMER_WHEEL_LEVELS]; 	/* bit of every slot that isn't empty */
+	int64_t 		current; 			/* first tick not processed yet */
+	uint32_t 		armed_count;
+	uint32_t 		wakeups; 			/* Timer_Wheel_Advance() calls that found an event */
+	uint32_t 		cascades; 			/* timers moved down a level */
+	struct k_spinlock 	lock;
+#if !defined(TIME_AND_CLOCK_PORT_POSIX)
+	struct k_timer 		kernel_timer; 			/* drives the wheel after Timer_Wheel_Start() */
+	int64_t 		programmed; 			/* tick kernel_timer expires at, TIMER_WHEEL_NO_EVENT if stopped */
+	bool 			started;
+#endif
+}TimerWheel;
+
+void Timer_Wheel_Init(TimerWheel * a_wheel, int64_t a_now_ticks);
+void Timer_Wheel_Timer_Init(TimerWheelTimer * a_timer, TimerWheelHandler a_handler);
+void Timer_Wheel_Arm(TimerWheel * a_wheel, TimerWheelTimer * a_timer, int64_t a_expiry_ticks, uint32_t a_slack_ticks);
+void Timer_Wheel_Arm_Duration(TimerWheel * a_wheel, TimerWheelTimer * a_timer, TimeDuration a_timeout, TimeDuration a_slack);
+bool Timer_Wheel_Cancel(TimerWheel * a_wheel, TimerWheelTimer * a_timer);
+bool Timer_Wheel_Timer_Is_Armed(const TimerWheelTimer * a_timer);
+TimeElapsedClock Timer_Wheel_Timer_Expiry_Clock(const TimerWheelTimer * a_timer);
+TimeElapsedClock Timer_Wheel_Timer_Remaining_Clock(const TimerWheelTimer * a_timer, int64_t a_now_ticks);
+int64_t Timer_Wheel_Next_Event(TimerWheel * a_wheel);
+uint32_t Timer_Wheel_Advance(TimerWheel * a_wheel, int64_t a_now_ticks);
+#if !defined(TIME_AND_CLOCK_PORT_POSIX)
+void Timer_Wheel_Start(TimerWheel * a_wheel);
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
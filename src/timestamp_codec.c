@@ -0,0 +1,379 @@
+/**
+ * @author Batto1
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "time_and_clock_port.h"
+
+#include "timestamp_codec.h"
+
+
+#define TIMESTAMP_CODEC_HEADER_BITS 	64U
+#define TIMESTAMP_CODEC_ESCAPE 		0xFFFFFFFFU
+
+/**
+ * @brief Prefix length and payload bits of the delta-of-delta codes, indexed by the first 4 bits of a code.
+*/
+static const uint8_t dod_prefix_bits[16]  = { 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 4, 4 };
+static const uint8_t dod_payload_bits[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 7, 7, 7, 7, 9, 9, 12, 32 };
+
+
+static inline uint64_t Zigzag_Encode(int64_t a_value)
+{
+	return ((uint64_t)a_value << 1) ^ (uint64_t)(a_value >> 63);
+}
+
+static inline int64_t Zigzag_Decode(uint64_t a_value)
+{
+	return (int64_t)(a_value >> 1) ^ -(int64_t)(a_value & 1U);
+}
+
+/**
+ * @brief Bits of the code of a delta-of-delta, prefix included.
+*/
+static inline uint32_t Dod_Code_Bits(uint64_t a_zigzag)
+{
+	if(a_zigzag == 0U){
+		return 1U;
+	}else if(a_zigzag < BIT64(7)){
+		return 2U + 7U;
+	}else if(a_zigzag < BIT64(9)){
+		return 3U + 9U;
+	}else if(a_zigzag < BIT64(12)){
+		return 4U + 12U;
+	}else if(a_zigzag < TIMESTAMP_CODEC_ESCAPE){
+		return 4U + 32U;
+	}
+
+	return 4U + 32U + 64U;
+}
+
+/**
+ * @brief Appends up to 32 bits to the stream. Caller has checked that they fit.
+*/
+static inline void Put_Bits(TimestampEncoder * a_enc, uint32_t a_value, uint32_t a_bits)
+{
+	a_enc->acc       = (a_enc->acc << a_bits) | a_value;
+	a_enc->acc_bits += a_bits;
+
+	while(a_enc->acc_bits >= 8U){
+		a_enc->acc_bits -= 8U;
+		a_enc->buf[a_enc->byte_pos++] = (uint8_t)(a_enc->acc >> a_enc->acc_bits);
+	}
+}
+
+static inline void Put_Bits_64(TimestampEncoder * a_enc, uint64_t a_value)
+{
+	Put_Bits(a_enc, (uint32_t)(a_value >> 32), 32U);
+	Put_Bits(a_enc, (uint32_t)a_value, 32U);
+}
+
+static void Put_Dod(TimestampEncoder * a_enc, uint64_t a_zigzag)
+{
+	if(a_zigzag == 0U){
+		Put_Bits(a_enc, 0x0U, 1U);
+	}else if(a_zigzag < BIT64(7)){
+		Put_Bits(a_enc, (0x2U << 7) | (uint32_t)a_zigzag, 2U + 7U);
+	}else if(a_zigzag < BIT64(9)){
+		Put_Bits(a_enc, (0x6U << 9) | (uint32_t)a_zigzag, 3U + 9U);
+	}else if(a_zigzag < BIT64(12)){
+		Put_Bits(a_enc, (0xEU << 12) | (uint32_t)a_zigzag, 4U + 12U);
+	}else if(a_zigzag < TIMESTAMP_CODEC_ESCAPE){
+		Put_Bits(a_enc, 0xFU, 4U);
+		Put_Bits(a_enc, (uint32_t)a_zigzag, 32U);
+	}else{
+		Put_Bits(a_enc, 0xFU, 4U);
+		Put_Bits(a_enc, TIMESTAMP_CODEC_ESCAPE, 32U);
+		Put_Bits_64(a_enc, a_zigzag);
+	}
+}
+
+/**
+ * @brief Initializes an encoder on an empty buffer.
+ * @param [out] a_enc 		Pointer to the encoder owned by the user.
+ * @param [out] a_buf 		buffer the stream is written to.
+ * @param [in]  a_buf_size 	size of a_buf in bytes.
+ * @param [out] a_index 	seek index, byte offset of every block is written to it. NULL if no index is kept.
+ * @param [in]  a_index_size 	entries in a_index, see TIMESTAMP_CODEC_INDEX_SIZE().
+ * @param [in]  a_block_samples 	samples per block, at least 1 i.e. TIMESTAMP_CODEC_DEFAULT_BLOCK_SAMPLES.
+ *                            	Smaller blocks seek faster, bigger blocks spend less on block headers and index entries.
+*/
+void Timestamp_Encoder_Init(TimestampEncoder * a_enc, uint8_t * a_buf, size_t a_buf_size, uint32_t * a_index, uint32_t a_index_size, uint32_t a_block_samples)
+{
+	memset(a_enc, 0, sizeof(* a_enc));
+	a_enc->buf           = a_buf;
+	a_enc->buf_size      = a_buf_size;
+	a_enc->index         = a_index;
+	a_enc->index_size    = (a_index != NULL) ? a_index_size : 0U;
+	a_enc->block_samples = MAX(a_block_samples, 1U);
+}
+
+/**
+ * @brief Appends a timestamp to the stream. Stream in the buffer is decodable after every append.
+ * @param [in] a_ticks 	timestamp i.e. k_uptime_ticks(), not smaller than the previous one.
+ * @retval TIME_UTIL_ERROR_NEGATIVE if a_ticks is smaller than the previous timestamp. TIME_UTIL_ERROR_RANGE if the buffer or the index is full.
+ *         Encoder is left unchanged on errors.
+*/
+TimeAndClockErrors Timestamp_Encoder_Append(TimestampEncoder * a_enc, int64_t a_ticks)
+{
+	size_t used_bits = (a_enc->byte_pos * 8U) + a_enc->acc_bits;
+	uint32_t in_block = a_enc->count % a_enc->block_samples;
+
+	if(in_block == 0U){
+		uint32_t block = a_enc->count / a_enc->block_samples;
+		size_t start = a_enc->byte_pos + ((a_enc->acc_bits != 0U) ? 1U : 0U);
+
+		if((a_enc->count != 0U) && (a_ticks < a_enc->prev)){
+			return TIME_UTIL_ERROR_NEGATIVE;
+		}
+		if(((start * 8U) + TIMESTAMP_CODEC_HEADER_BITS > a_enc->buf_size * 8U) || ((a_enc->index != NULL) && (block >= a_enc->index_size))){
+			return TIME_UTIL_ERROR_RANGE;
+		}
+
+		// blocks start byte aligned, the last byte of the previous block is already in buf with zero padding.
+		a_enc->byte_pos = start;
+		a_enc->acc      = 0;
+		a_enc->acc_bits = 0;
+		if(a_enc->index != NULL){
+			a_enc->index[block] = (uint32_t)start;
+		}
+		Put_Bits_64(a_enc, (uint64_t)a_ticks);
+		a_enc->prev_delta = 0;
+	}else{
+		int64_t delta = a_ticks - a_enc->prev;
+
+		if(delta < 0){
+			return TIME_UTIL_ERROR_NEGATIVE;
+		}
+
+		uint64_t zigzag = Zigzag_Encode(delta - a_enc->prev_delta);
+
+		if(used_bits + Dod_Code_Bits(zigzag) > a_enc->buf_size * 8U){
+			return TIME_UTIL_ERROR_RANGE;
+		}
+		Put_Dod(a_enc, zigzag);
+		a_enc->prev_delta = delta;
+	}
+
+	if(a_enc->acc_bits != 0U){
+		a_enc->buf[a_enc->byte_pos] = (uint8_t)(a_enc->acc << (8U - a_enc->acc_bits));
+	}
+	a_enc->prev = a_ticks;
+	a_enc->count++;
+
+	return TIME_UTIL_ERROR_NONE;
+}
+
+/**
+ * @brief Bytes of the buffer used by the stream, partial last byte included.
+*/
+size_t Timestamp_Encoder_Size(const TimestampEncoder * a_enc)
+{
+	return a_enc->byte_pos + ((a_enc->acc_bits != 0U) ? 1U : 0U);
+}
+
+static inline void Refill(TimestampDecoder * a_dec)
+{
+	while((a_dec->window_bits <= 56U) && (a_dec->byte_pos < a_dec->buf_size)){
+		a_dec->window      |= (uint64_t)a_dec->buf[a_dec->byte_pos++] << (56U - a_dec->window_bits);
+		a_dec->window_bits += 8U;
+	}
+}
+
+/**
+ * @brief Takes 1 to 32 bits from the window, refilled by the caller. Bits past the end of the buffer read as zero.
+*/
+static inline uint32_t Get_Bits(TimestampDecoder * a_dec, uint32_t a_bits)
+{
+	uint32_t value = (uint32_t)(a_dec->window >> (64U - a_bits));
+
+	a_dec->window      <<= a_bits;
+	a_dec->window_bits  = (a_dec->window_bits > a_bits) ? (a_dec->window_bits - a_bits) : 0U;
+
+	return value;
+}
+
+static inline uint64_t Get_Bits_64(TimestampDecoder * a_dec)
+{
+	uint64_t high;
+
+	Refill(a_dec);
+	high = Get_Bits(a_dec, 32U);
+	Refill(a_dec);
+
+	return (high << 32) | Get_Bits(a_dec, 32U);
+}
+
+/**
+ * @brief Positions the decoder at the start of a block.
+*/
+static void Start_Block(TimestampDecoder * a_dec, uint32_t a_block, size_t a_offset)
+{
+	a_dec->position    = a_block * a_dec->block_samples;
+	a_dec->byte_pos    = a_offset;
+	a_dec->window      = 0;
+	a_dec->window_bits = 0;
+}
+
+/**
+ * @brief Decodes the next sample. Caller checks that position is below count.
+*/
+static inline int64_t Decode_Next(TimestampDecoder * a_dec)
+{
+	if((a_dec->position % a_dec->block_samples) == 0U){
+		// drop the padding at the end of the previous block.
+		a_dec->window     <<= (a_dec->window_bits % 8U);
+		a_dec->window_bits -= (a_dec->window_bits % 8U);
+		a_dec->prev         = (int64_t)Get_Bits_64(a_dec);
+		a_dec->prev_delta   = 0;
+	}else{
+		Refill(a_dec);
+
+		uint32_t code = (uint32_t)(a_dec->window >> 60);
+		uint32_t payload_bits = dod_payload_bits[code];
+
+		(void)Get_Bits(a_dec, dod_prefix_bits[code]);
+		if(payload_bits != 0U){
+			uint64_t zigzag = Get_Bits(a_dec, payload_bits);
+
+			if(zigzag == TIMESTAMP_CODEC_ESCAPE){
+				zigzag = Get_Bits_64(a_dec);
+			}
+			a_dec->prev_delta += Zigzag_Decode(zigzag);
+		}
+		a_dec->prev += a_dec->prev_delta;
+	}
+	a_dec->position++;
+
+	return a_dec->prev;
+}
+
+/**
+ * @brief Initializes a decoder at the first sample of a stream.
+ * @param [in] a_buf 		stream written by an encoder.
+ * @param [in] a_buf_size 	size of a_buf in bytes, at least Timestamp_Encoder_Size().
+ * @param [in] a_index 		seek index written by the encoder, NULL if it wasn't kept.
+ * @param [in] a_block_samples 	samples per block the stream was encoded with.
+ * @param [in] a_count 		samples in the stream, the encoder's count.
+*/
+void Timestamp_Decoder_Init(TimestampDecoder * a_dec, const uint8_t * a_buf, size_t a_buf_size, const uint32_t * a_index, uint32_t a_block_samples,
+			    uint32_t a_count)
+{
+	memset(a_dec, 0, sizeof(* a_dec));
+	a_dec->buf           = a_buf;
+	a_dec->buf_size      = a_buf_size;
+	a_dec->index         = a_index;
+	a_dec->block_samples = MAX(a_block_samples, 1U);
+	a_dec->count         = a_count;
+}
+
+/**
+ * @brief Initializes a decoder on the stream an encoder has written so far.
+*/
+void Timestamp_Decoder_Init_From_Encoder(TimestampDecoder * a_dec, const TimestampEncoder * a_enc)
+{
+	Timestamp_Decoder_Init(a_dec, a_enc->buf, Timestamp_Encoder_Size(a_enc), a_enc->index, a_enc->block_samples, a_enc->count);
+}
+
+/**
+ * @brief Moves the decoder to a sample. Jumps to its block through the index and decodes at most block_samples - 1 samples.
+ * @retval TIME_UTIL_ERROR_RANGE if a_sample isn't in the stream.
+*/
+TimeAndClockErrors Timestamp_Decoder_Seek(TimestampDecoder * a_dec, uint32_t a_sample)
+{
+	if(a_sample >= a_dec->count){
+		return TIME_UTIL_ERROR_RANGE;
+	}
+
+	uint32_t block = a_sample / a_dec->block_samples;
+
+	if(a_dec->index != NULL){
+		Start_Block(a_dec, block, a_dec->index[block]);
+	}else if(a_sample < a_dec->position){
+		Start_Block(a_dec, 0, 0);
+	}
+	while(a_dec->position < a_sample){
+		(void)Decode_Next(a_dec);
+	}
+
+	return TIME_UTIL_ERROR_NONE;
+}
+
+/**
+ * @brief Moves the decoder to the first sample not smaller than a_ticks. Blocks are binary searched on their headers through the index.
+ * @retval TIME_UTIL_ERROR_RANGE if all samples are smaller than a_ticks.
+*/
+TimeAndClockErrors Timestamp_Decoder_Seek_Ticks(TimestampDecoder * a_dec, int64_t a_ticks)
+{
+	uint32_t blocks = TIMESTAMP_CODEC_INDEX_SIZE(a_dec->count, a_dec->block_samples);
+	uint32_t low = 0;
+
+	if(a_dec->count == 0U){
+		return TIME_UTIL_ERROR_RANGE;
+	}
+
+	if(a_dec->index != NULL){
+		uint32_t high = blocks;
+
+		// last block whose first sample is smaller than a_ticks, equal samples may end the block before.
+		while(high - low > 1U){
+			uint32_t mid = low + ((high - low) / 2U);
+			TimestampDecoder header;
+
+			Timestamp_Decoder_Init(&header, a_dec->buf, a_dec->buf_size, NULL, a_dec->block_samples, a_dec->count);
+			Start_Block(&header, mid, a_dec->index[mid]);
+			if(Decode_Next(&header) < a_ticks){
+				low = mid;
+			}else{
+				high = mid;
+			}
+		}
+		Start_Block(a_dec, low, a_dec->index[low]);
+	}else{
+		Start_Block(a_dec, 0, 0);
+	}
+
+	while(a_dec->position < a_dec->count){
+		TimestampDecoder saved = * a_dec;
+
+		if(Decode_Next(a_dec) >= a_ticks){
+			* a_dec = saved;
+			return TIME_UTIL_ERROR_NONE;
+		}
+	}
+
+	return TIME_UTIL_ERROR_RANGE;
+}
+
+/**
+ * @brief Decodes the next samples as ticks.
+ * @retval number of samples decoded, less than a_max at the end of the stream.
+*/
+size_t Timestamp_Decoder_Read_Ticks(TimestampDecoder * a_dec, int64_t * a_ticks, size_t a_max)
+{
+	size_t n = MIN(a_max, (size_t)(a_dec->count - a_dec->position));
+
+	for(size_t i = 0; i < n; i++){
+		a_ticks[i] = Decode_Next(a_dec);
+	}
+
+	return n;
+}
+
+/**
+ * @brief Decodes the next samples as clock fields, same as Ticks_To_Clock_Time() of each. Converted incrementally from the previous sample
+ *        through the decoder's ClockConversionCache.
+ * @retval number of samples decoded, less than a_max at the end of the stream.
+*/
+size_t Timestamp_Decoder_Read_Clock(TimestampDecoder * a_dec, TimeElapsedClock * a_clocks, size_t a_max)
+{
+	size_t n = MIN(a_max, (size_t)(a_dec->count - a_dec->position));
+
+	for(size_t i = 0; i < n; i++){
+		a_clocks[i] = Ticks_To_Clock_Time_Cached(&a_dec->clock_cache, Decode_Next(a_dec));
+	}
+
+	return n;
+}
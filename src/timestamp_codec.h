@@ -0,0 +1,87 @@
+/**
+ * @author Batto1
+ * @brief  Streaming codec for monotonic timestamp sequences (uptime ticks), packed as delta-of-delta bit codes like Gorilla time series.
+ *         Past the block header, a periodic sequence costs 1 bit per sample and a delta-of-delta in [-64, 63] ticks 9 bits, instead of 8 bytes of ticks or
+ *         12 bytes of clock fields.
+ * @note   Stream is split in blocks of block_samples samples. Every block starts byte aligned with the absolute timestamp of its first sample,
+ *         so it can be decoded on its own; the byte offset of each block is recorded in a seek index owned by the user.
+ * @note   Code of a delta-of-delta d, zigzag encoded as z:  d == 0: '0'   z < 2^7: '10' + 7 bits   z < 2^9: '110' + 9 bits
+ *         z < 2^12: '1110' + 12 bits   z < 2^32 - 1: '1111' + 32 bits   else: '1111' + 0xFFFFFFFF + 64 bits.  Bits are written MSB first.
+ * @note   Encoder and decoder work in the buffers given to them, with a few words of state; no heap.
+*/
+
+#ifndef TIMESTAMP_CODEC_H
+#define TIMESTAMP_CODEC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "time_and_clock_port.h"
+#include "time_and_clock_utils.h"
+
+#ifndef TIMESTAMP_CODEC_DEFAULT_BLOCK_SAMPLES
+#define TIMESTAMP_CODEC_DEFAULT_BLOCK_SAMPLES 	64 	/* 4 bytes of index and ~9 bytes of block header per 64 samples */
+#endif
+
+/**
+ * @brief Index entries needed for a_samples samples.
+*/
+#define TIMESTAMP_CODEC_INDEX_SIZE(a_samples, a_block_samples) 	(((a_samples) + (a_block_samples) - 1U) / (a_block_samples))
+
+/**
+ * @brief struct type of an encoder. Use only through Timestamp_Encoder_* routines.
+*/
+typedef struct timestampEncoder{
+	uint8_t * 	buf;
+	size_t 		buf_size;
+	uint32_t * 	index; 			/* byte offset of every block in buf, may be NULL */
+	uint32_t 	index_size;
+	uint32_t 	block_samples;
+	uint32_t 	count; 			/* samples encoded */
+	size_t 		byte_pos; 		/* complete bytes written */
+	uint64_t 	acc; 			/* bits not written as a complete byte yet, in the low acc_bits bits */
+	uint32_t 	acc_bits;
+	int64_t 	prev;
+	int64_t 	prev_delta;
+}TimestampEncoder;
+
+/**
+ * @brief struct type of a decoder. Use only through Timestamp_Decoder_* routines.
+*/
+typedef struct timestampDecoder{
+	const uint8_t * 	buf;
+	size_t 			buf_size;
+	const uint32_t * 	index; 		/* may be NULL, then seeking decodes from the start */
+	uint32_t 		block_samples;
+	uint32_t 		count;
+	uint32_t 		position; 	/* index of the sample read next */
+	size_t 			byte_pos; 	/* next byte loaded into window */
+	uint64_t 		window; 	/* loaded bits, MSB aligned */
+	uint32_t 		window_bits;
+	int64_t 		prev;
+	int64_t 		prev_delta;
+	ClockConversionCache 	clock_cache;
+}TimestampDecoder;
+
+void Timestamp_Encoder_Init(TimestampEncoder * a_enc, uint8_t * a_buf, size_t a_buf_size, uint32_t * a_index, uint32_t a_index_size, uint32_t a_block_samples);
+TimeAndClockErrors Timestamp_Encoder_Append(TimestampEncoder * a_enc, int64_t a_ticks);
+size_t Timestamp_Encoder_Size(const TimestampEncoder * a_enc);
+
+void Timestamp_Decoder_Init(TimestampDecoder * a_dec, const uint8_t * a_buf, size_t a_buf_size, const uint32_t * a_index, uint32_t a_block_samples,
+			    uint32_t a_count);
+void Timestamp_Decoder_Init_From_Encoder(TimestampDecoder * a_dec, const TimestampEncoder * a_enc);
+TimeAndClockErrors Timestamp_Decoder_Seek(TimestampDecoder * a_dec, uint32_t a_sample);
+TimeAndClockErrors Timestamp_Decoder_Seek_Ticks(TimestampDecoder * a_dec, int64_t a_ticks);
+size_t Timestamp_Decoder_Read_Ticks(TimestampDecoder * a_dec, int64_t * a_ticks, size_t a_max);
+size_t Timestamp_Decoder_Read_Clock(TimestampDecoder * a_dec, TimeElapsedClock * a_clocks, size_t a_max);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
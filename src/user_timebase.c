@@ -0,0 +1,150 @@
+/**
+ * @author Batto1
+*/
+
+#include <stdint.h>
+
+#include "time_and_clock_port.h"
+#if defined(CONFIG_USERSPACE)
+#include <zephyr/app_memory/app_memdomain.h>
+#endif
+
+#include "user_timebase.h"
+
+
+#if defined(CONFIG_USERSPACE)
+K_APPMEM_PARTITION_DEFINE(user_timebase_partition);
+K_APP_BMEM(user_timebase_partition) volatile UserTimebasePage user_timebase_page;
+#else
+volatile UserTimebasePage user_timebase_page;
+#endif
+
+static struct k_spinlock user_timebase_lock;
+
+/* A timer publishes only if readers can't extrapolate with the HW cycle counter. */
+#if !defined(TIME_AND_CLOCK_PORT_POSIX) && !defined(USER_TIMEBASE_READ_CYCLES) && (USER_TIMEBASE_PUBLISH_PERIOD_MS > 0)
+#define USER_TIMEBASE_PERIODIC 	1
+#else
+#define USER_TIMEBASE_PERIODIC 	0
+#endif
+
+#if USER_TIMEBASE_PERIODIC
+static struct k_timer user_timebase_timer;
+
+static void User_Timebase_Timer_Handler(struct k_timer * a_timer)
+{
+	ARG_UNUSED(a_timer);
+
+	User_Timebase_Publish();
+}
+#endif
+
+
+/**
+ * @brief Publishes current uptime ticks, HW cycles and their rates to the shared page. Kernel side; called by User_Timebase_Init() and by its timer if there's one.
+ * @note If USER_TIMEBASE_READ_CYCLES() is defined, call it after the HW cycle rate changes i.e. once it's calibrated at runtime.
+ * @note Ticks and cycles are sampled with interrupts locked so that they belong to the same moment.
+*/
+void User_Timebase_Publish(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&user_timebase_lock);
+
+	uint32_t sequence = user_timebase_page.sequence;
+
+	__atomic_store_n(&user_timebase_page.sequence, sequence + 1U, __ATOMIC_RELAXED); // odd: readers retry
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	user_timebase_page.ticks          = (uint64_t)k_uptime_ticks();
+	user_timebase_page.cycles         = Get_Uptime_HW_Cycles_64();
+	user_timebase_page.cycles_per_sec = (uint32_t)sys_clock_hw_cycles_per_sec();
+	user_timebase_page.ticks_per_sec  = CONFIG_SYS_CLOCK_TICKS_PER_SEC;
+
+	__atomic_store_n(&user_timebase_page.sequence, sequence + 2U, __ATOMIC_RELEASE);
+
+	k_spin_unlock(&user_timebase_lock, key);
+}
+
+/**
+ * @brief Publishes the first values and, unless USER_TIMEBASE_READ_CYCLES() is defined, starts publishing them every USER_TIMEBASE_PUBLISH_PERIOD_MS.
+ * Call once from supervisor mode at start up, before user_timebase_partition is added to any memory domain.
+ * @note On the POSIX backend there is no timer; call User_Timebase_Publish() periodically if USER_TIMEBASE_READ_CYCLES() isn't defined.
+*/
+void User_Timebase_Init(void)
+{
+#if defined(CONFIG_USERSPACE)
+	user_timebase_partition.attr = K_MEM_PARTITION_P_RW_U_RO;
+#endif
+
+	User_Timebase_Publish();
+
+#if USER_TIMEBASE_PERIODIC
+	k_timer_init(&user_timebase_timer, User_Timebase_Timer_Handler, NULL);
+	k_timer_start(&user_timebase_timer, K_MSEC(USER_TIMEBASE_PUBLISH_PERIOD_MS), K_MSEC(USER_TIMEBASE_PUBLISH_PERIOD_MS));
+#endif
+}
+
+/**
+ * @brief HW cycles passed since the snapshot was published, if user mode can read the counter (USER_TIMEBASE_READ_CYCLES()), otherwise 0.
+*/
+static inline uint64_t Cycles_Since_Publish(const UserTimebaseSnapshot * a_snapshot)
+{
+#if defined(USER_TIMEBASE_READ_CYCLES)
+	if(a_snapshot->cycles_per_sec == 0U){ // not published yet
+		return 0;
+	}
+
+	return (uint64_t)USER_TIMEBASE_READ_CYCLES() - a_snapshot->cycles;
+#else
+	ARG_UNUSED(a_snapshot);
+	return 0;
+#endif
+}
+
+/**
+ * @brief Converts a count from one rate to another, rounded down. Divides first so that counts of any length don't overflow.
+*/
+static inline uint64_t Scale(uint64_t a_count, uint32_t a_from_per_sec, uint32_t a_to_per_sec)
+{
+	if(a_count == 0U){
+		return 0;
+	}
+
+	return ((a_count / a_from_per_sec) * a_to_per_sec) + (((a_count % a_from_per_sec) * a_to_per_sec) / a_from_per_sec);
+}
+
+/**
+ * @brief Get system uptime in ticks without a system call. Can be called from user mode, kernel threads and ISRs.
+ * @return uptime ticks as of the last publish, extrapolated with the HW cycle counter if USER_TIMEBASE_READ_CYCLES() is defined.
+*/
+int64_t User_Timebase_Get_Ticks(void)
+{
+	UserTimebaseSnapshot snapshot;
+
+	User_Timebase_Snapshot(&snapshot);
+
+	return (int64_t)(snapshot.ticks + Scale(Cycles_Since_Publish(&snapshot), snapshot.cycles_per_sec, snapshot.ticks_per_sec));
+}
+
+/**
+ * @brief Get system uptime in micro seconds without a system call. Same resolution as User_Timebase_Get_Ticks() unless extrapolated with HW cycles.
+*/
+uint64_t User_Timebase_Get_Micro_Sec(void)
+{
+	UserTimebaseSnapshot snapshot;
+
+	User_Timebase_Snapshot(&snapshot);
+
+	return k_ticks_to_us_floor64(snapshot.ticks) + Scale(Cycles_Since_Publish(&snapshot), snapshot.cycles_per_sec, 1000000U);
+}
+
+/**
+ * @brief Get system uptime in clock format without a system call.
+*/
+TimeElapsedClock User_Timebase_Get_Clock_Time(void)
+{
+	TimeElapsedClock clk;
+
+	(void)Duration_To_Clock(&clk, (TimeDuration)User_Timebase_Get_Micro_Sec());
+
+	return clk;
+}
@@ -0,0 +1,90 @@
+/**
+ * @author Batto1
+ * @brief  Uptime for user mode threads without system calls. Kernel publishes uptime ticks and HW cycles sampled together, with their rates, to a
+ *         shared page; user threads read it through a sequence lock (seqlock) instead of calling k_uptime_ticks() which is a system call with CONFIG_USERSPACE.
+ * @note   With CONFIG_USERSPACE the page is in user_timebase_partition, which User_Timebase_Init() makes read-only for user mode.
+ *         Add it to the memory domain of the user threads that read the timebase i.e. k_mem_domain_add_partition(&domain, &user_timebase_partition);
+ * @note   If user mode can read the 64 bit HW cycle counter (i.e. x86 TSC as the system timer), define USER_TIMEBASE_READ_CYCLES() to read it. Readings are
+ *         then extrapolated from the page with the published rates, and the page is written only at init and when the rates change (User_Timebase_Publish()),
+ *         so no timer runs and tickless idle isn't affected.
+ * @note   Otherwise (i.e. Cortex-M, whose counters are privileged) the page is published every USER_TIMEBASE_PUBLISH_PERIOD_MS and readings step in that period.
+*/
+
+#ifndef USER_TIMEBASE_H
+#define USER_TIMEBASE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "time_and_clock_port.h"
+#include "time_and_clock_utils.h"
+
+/* Publish period when USER_TIMEBASE_READ_CYCLES() isn't defined, it's the resolution of the readings. Each publish wakes the CPU up, keep it coarse.
+ * 0: publish only at init and when User_Timebase_Publish() is called. */
+#ifndef USER_TIMEBASE_PUBLISH_PERIOD_MS
+#define USER_TIMEBASE_PUBLISH_PERIOD_MS 	10
+#endif
+
+/**
+ * @brief struct type of the shared page. Written only by the kernel side (User_Timebase_Publish()), read by anyone through User_Timebase_Snapshot().
+*/
+typedef struct userTimebasePage{
+	uint32_t 	sequence; 		/* odd while being written */
+	uint32_t 	cycles_per_sec; 	/* scale factors of the values below, updated together with them */
+	uint32_t 	ticks_per_sec;
+	uint32_t 	reserved;
+	uint64_t 	ticks; 			/* uptime ticks at the publish */
+	uint64_t 	cycles; 		/* 64 bit HW cycles at the same moment */
+}UserTimebasePage;
+
+/**
+ * @brief struct type for a consistent copy of the page: ticks and cycles were sampled together.
+*/
+typedef struct userTimebaseSnapshot{
+	uint64_t 	ticks;
+	uint64_t 	cycles;
+	uint32_t 	cycles_per_sec;
+	uint32_t 	ticks_per_sec;
+}UserTimebaseSnapshot;
+
+#if defined(CONFIG_USERSPACE)
+extern struct k_mem_partition user_timebase_partition;
+#endif
+extern volatile UserTimebasePage user_timebase_page;
+
+void User_Timebase_Init(void);
+void User_Timebase_Publish(void);
+int64_t User_Timebase_Get_Ticks(void);
+uint64_t User_Timebase_Get_Micro_Sec(void);
+TimeElapsedClock User_Timebase_Get_Clock_Time(void);
+
+/**
+ * @brief Copies the page consistently. Lock-free and syscall-free; retries only if the kernel published while it was copying.
+ * @param [out] a_snapshot 	Pointer to the user provided snapshot buffer.
+*/
+static inline void User_Timebase_Snapshot(UserTimebaseSnapshot * a_snapshot)
+{
+	uint32_t sequence;
+
+	do{
+		sequence = __atomic_load_n(&user_timebase_page.sequence, __ATOMIC_ACQUIRE);
+
+		a_snapshot->ticks          = user_timebase_page.ticks;
+		a_snapshot->cycles         = user_timebase_page.cycles;
+		a_snapshot->cycles_per_sec = user_timebase_page.cycles_per_sec;
+		a_snapshot->ticks_per_sec  = user_timebase_page.ticks_per_sec;
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	}while(((sequence & 1U) != 0U) || (sequence != __atomic_load_n(&user_timebase_page.sequence, __ATOMIC_RELAXED)));
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,289 @@
+/**
+ * @author Batto1
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "time_and_clock_port.h"
+
+#include "wall_clock.h"
+#include "time_and_clock_digits.h"
+
+
+#define WALL_CLOCK_DAYS_PER_ERA 		146097 	/* days in 400 years */
+#define WALL_CLOCK_EPOCH_DAYS_FROM_0300 	719468 	/* days from 0000-03-01 to 1970-01-01 */
+
+
+
+/**
+ * @brief Division rounding towards negative infinity, a_divisor must be positive.
+*/
+static inline int64_t Floor_Div(int64_t a_dividend, int64_t a_divisor)
+{
+	int64_t quotient = a_dividend / a_divisor;
+
+	return quotient - ((quotient * a_divisor) > a_dividend);
+}
+
+/**
+ * @brief Days since 1970-01-01 of a civil date. O(1), no loops.
+ * @param [in] a_year 	year, negative years are before 1 BC (proleptic Gregorian).
+ * @param [in] a_month 	1-12.
+ * @param [in] a_day 	1-31, not checked against the length of the month.
+ * @return days, negative for dates before 1970-01-01.
+*/
+int64_t Days_From_Civil(int32_t a_year, uint32_t a_month, uint32_t a_day)
+{
+	// years start on March 1st so that the leap day is the last day of the year.
+	int64_t  year  = (int64_t)a_year - (a_month <= 2U);
+	int64_t  era   = Floor_Div(year, 400);
+	uint32_t yoe   = (uint32_t)(year - (era * 400)); 					// [0, 399]
+	uint32_t doy   = (((153U * ((a_month > 2U) ? (a_month - 3U) : (a_month + 9U))) + 2U) / 5U) + a_day - 1U; 	// [0, 365]
+	uint32_t doe   = (yoe * 365U) + (yoe / 4U) - (yoe / 100U) + doy; 			// [0, 146096]
+
+	return (era * WALL_CLOCK_DAYS_PER_ERA) + (int64_t)doe - WALL_CLOCK_EPOCH_DAYS_FROM_0300;
+}
+
+/**
+ * @brief Civil date and day of the year (1-366) of the given days since 1970-01-01.
+*/
+static inline void Days_To_Civil(int64_t a_days, int32_t * a_year, uint8_t * a_month, uint8_t * a_day, uint16_t * a_year_day)
+{
+	int64_t  z   = a_days + WALL_CLOCK_EPOCH_DAYS_FROM_0300;
+	int64_t  era = Floor_Div(z, WALL_CLOCK_DAYS_PER_ERA);
+	uint32_t doe = (uint32_t)(z - (era * WALL_CLOCK_DAYS_PER_ERA)); 				// [0, 146096]
+	uint32_t yoe = (doe - (doe / 1460U) + (doe / 36524U) - (doe / 146096U)) / 365U; 	// [0, 399]
+	uint32_t doy = doe - ((365U * yoe) + (yoe / 4U) - (yoe / 100U)); 			// [0, 365], March 1st is 0
+	uint32_t mp  = ((5U * doy) + 2U) / 153U; 						// [0, 11], March is 0
+	uint32_t is_jan_feb = (mp >= 10U);
+	uint32_t is_leap = ((yoe % 4U) == 0U) & (((yoe % 100U) != 0U) | (yoe == 0U)); 		// of the year March 1st belongs to
+
+	* a_day      = (uint8_t)(doy - (((153U * mp) + 2U) / 5U) + 1U);
+	* a_month    = (uint8_t)(is_jan_feb ? (mp - 9U) : (mp + 3U));
+	* a_year     = (int32_t)(((int64_t)yoe + (era * 400)) + is_jan_feb);
+	* a_year_day = (uint16_t)(is_jan_feb ? (doy - 305U) : (doy + 60U + is_leap));
+}
+
+/**
+ * @brief Civil date of the given days since 1970-01-01. O(1), no loops. Inverse of Days_From_Civil().
+*/
+void Civil_From_Days(int64_t a_days, int32_t * a_year, uint8_t * a_month, uint8_t * a_day)
+{
+	uint16_t year_day;
+
+	Days_To_Civil(a_days, a_year, a_month, a_day, &year_day);
+}
+
+/**
+ * @brief Converts wall time to civil date and time of day.
+ * @param [out] a_civil 		Pointer to the user provided buffer.
+ * @param [in]  a_wall_time 	micro seconds since the Unix epoch, may be negative.
+*/
+void Wall_Time_To_Civil(CivilDateTime * a_civil, int64_t a_wall_time)
+{
+	int64_t  days       = Floor_Div(a_wall_time, TIME_DURATION_USEC_PER_DAY);
+	uint64_t day_micros = (uint64_t)(a_wall_time - (days * TIME_DURATION_USEC_PER_DAY));
+	uint32_t day_secs   = (uint32_t)(day_micros / 1000000U);
+	uint32_t sub_micros = (uint32_t)(day_micros - ((uint64_t)day_secs * 1000000U));
+
+	Days_To_Civil(days, &a_civil->year, &a_civil->month, &a_civil->day, &a_civil->year_day);
+
+	a_civil->week_day = (uint8_t)((days + 4) - (Floor_Div(days + 4, 7) * 7)); // 1970-01-01 was a Thursday
+	a_civil->hour     = (uint8_t)(day_secs / 3600U);
+	a_civil->min      = (uint8_t)((day_secs / 60U) % 60U);
+	a_civil->sec      = (uint8_t)(day_secs % 60U);
+	a_civil->m_sec    = (uint16_t)(sub_micros / 1000U);
+	a_civil->u_sec    = (uint16_t)(sub_micros % 1000U);
+}
+
+/**
+ * @brief Converts civil date and time of day to wall time. week_day and year_day are ignored.
+ * @return micro seconds since the Unix epoch.
+*/
+int64_t Civil_To_Wall_Time(const CivilDateTime * a_civil)
+{
+	int64_t days = Days_From_Civil(a_civil->year, a_civil->month, a_civil->day);
+	int64_t secs = ((int64_t)a_civil->hour * 3600) + ((int64_t)a_civil->min * 60) + a_civil->sec;
+
+	return (days * TIME_DURATION_USEC_PER_DAY) + (secs * TIME_DURATION_USEC_PER_SEC) + ((int64_t)a_civil->m_sec * 1000) + a_civil->u_sec;
+}
+
+/**
+ * @brief Decomposes wall time into every time category in one pass: calendar time elapsed since the epoch.
+ * @param [out] a_categories 	Pointer to the user provided buffer. Each field holds the remainder of its unit like Duration_To_Time_Categories():
+ * 				milleniums, centuries and years (0-99) elapsed since 1970, months (0-11) since the start of the year,
+ * 				weeks (0-4) and days (0-6) since the start of the month, then hours, mins, secs, m_secs, u_secs of the day.
+ * @param [in]  a_wall_time 	micro seconds since the Unix epoch, must not be negative. Negative values give all fields 0.
+*/
+void Wall_Time_To_Time_Categories(TimeCategories * a_categories, int64_t a_wall_time)
+{
+	CivilDateTime civil;
+
+	if(a_wall_time < 0){
+		a_wall_time = 0;
+	}
+	Wall_Time_To_Civil(&civil, a_wall_time);
+
+	int64_t years = (int64_t)civil.year - 1970;
+
+	a_categories->milleniums = years / 1000;
+	a_categories->centuries  = (years / 100) % 10;
+	a_categories->years      = years % 100;
+	a_categories->months     = (int64_t)civil.month - 1;
+	a_categories->weeks      = ((int64_t)civil.day - 1) / 7;
+	a_categories->days       = ((int64_t)civil.day - 1) % 7;
+	a_categories->hours      = civil.hour;
+	a_categories->mins       = civil.min;
+	a_categories->secs       = civil.sec;
+	a_categories->m_secs     = civil.m_sec;
+	a_categories->u_secs     = civil.u_sec;
+}
+
+/**
+ * @brief Sets the wall clock. Only the offset to uptime is stored, the clock advances with uptime ticks.
+ * @param [in, out] a_clock 	Pointer to the clock owned by the user.
+ * @param [in] a_wall_time 	current UTC time, micro seconds since the Unix epoch.
+*/
+void Wall_Clock_Set(WallClock * a_clock, int64_t a_wall_time)
+{
+	k_spinlock_key_t key = k_spin_lock(&a_clock->lock);
+
+	a_clock->offset = a_wall_time - Get_Uptime_Ticks_As_Duration();
+	a_clock->is_set = true;
+
+	k_spin_unlock(&a_clock->lock, key);
+}
+
+/**
+ * @brief Sets the wall clock from a civil date and time, i.e. read from an RTC.
+*/
+void Wall_Clock_Set_Civil(WallClock * a_clock, const CivilDateTime * a_civil)
+{
+	Wall_Clock_Set(a_clock, Civil_To_Wall_Time(a_civil));
+}
+
+/**
+ * @retval true if the clock has been set at least once.
+*/
+bool Wall_Clock_Is_Set(WallClock * a_clock)
+{
+	k_spinlock_key_t key = k_spin_lock(&a_clock->lock);
+	bool is_set = a_clock->is_set;
+	k_spin_unlock(&a_clock->lock, key);
+
+	return is_set;
+}
+
+/**
+ * @brief Wall time of a moment given in uptime ticks i.e. a timestamp captured earlier.
+ * @note If the clock isn't set, offset is 0 and the result is the uptime.
+*/
+int64_t Wall_Clock_From_Uptime_Ticks(WallClock * a_clock, int64_t a_ticks)
+{
+	k_spinlock_key_t key = k_spin_lock(&a_clock->lock);
+	int64_t offset = a_clock->offset;
+	k_spin_unlock(&a_clock->lock, key);
+
+	return offset + Ticks_To_Duration(a_ticks);
+}
+
+/**
+ * @brief Get current UTC time, micro seconds since the Unix epoch. Resolution is one uptime tick.
+*/
+int64_t Wall_Clock_Get(WallClock * a_clock)
+{
+	return Wall_Clock_From_Uptime_Ticks(a_clock, Get_Uptime_Ticks());
+}
+
+/**
+ * @brief Get current UTC time as civil date and time of day.
+*/
+void Wall_Clock_Get_Civil(WallClock * a_clock, CivilDateTime * a_civil)
+{
+	Wall_Time_To_Civil(a_civil, Wall_Clock_Get(a_clock));
+}
+
+/**
+ * @brief Sets up an RFC 3339 formatter.
+ * @param [out] a_fmt 		Pointer to the formatter owned by the user.
+ * @param [in]  a_precision 	number of second fraction digits.
+*/
+void Wall_Clock_Rfc3339_Setup(WallClockRfc3339 * a_fmt, WallClockPrecision a_precision)
+{
+	a_fmt->precision    = a_precision;
+	a_fmt->prefix_hour  = 0;
+	a_fmt->prefix_valid = false;
+}
+
+/**
+ * @brief Formats wall time as an RFC 3339 UTC timestamp i.e. "2026-10-17T12:34:56Z", "2026-10-17T12:34:56.789Z" or "2026-10-17T12:34:56.789123Z".
+ * @param [in, out] a_fmt 	Pointer to the formatter, its cached prefix is updated when the hour changes.
+ * @param [out] a_buf 		User provided buffer. Always NUL terminated if a_buf_size is not 0.
+ * @param [in]  a_buf_size 	Size of a_buf in bytes. WALL_CLOCK_RFC3339_MAX_STRING_SIZE is enough for every precision.
+ * @param [in]  a_wall_time 	micro seconds since the Unix epoch, i.e. from Wall_Clock_Get(). Fraction digits are truncated, not rounded.
+ * @return length of the whole string without NUL, like snprintk(). If it's equal or bigger than a_buf_size, output was truncated.
+ * 	   -ERANGE if the year isn't between 0000 and 9999; nothing is written then.
+*/
+int Wall_Clock_Rfc3339_Format(WallClockRfc3339 * a_fmt, char * a_buf, size_t a_buf_size, int64_t a_wall_time)
+{
+	char str[WALL_CLOCK_RFC3339_MAX_STRING_SIZE];
+	int64_t hour = Floor_Div(a_wall_time, TIME_DURATION_USEC_PER_HOUR);
+
+	if((false == a_fmt->prefix_valid) || (hour != a_fmt->prefix_hour)){
+		CivilDateTime civil;
+
+		Wall_Time_To_Civil(&civil, a_wall_time);
+		if((civil.year < 0) || (civil.year > 9999)){
+			return -ERANGE;
+		}
+
+		char * p = a_fmt->prefix;
+		p = Time_And_Clock_Put_2_Digits(p, (uint32_t)civil.year / 100U);
+		p = Time_And_Clock_Put_2_Digits(p, (uint32_t)civil.year % 100U);
+		*p++ = '-';
+		p = Time_And_Clock_Put_2_Digits(p, civil.month);
+		*p++ = '-';
+		p = Time_And_Clock_Put_2_Digits(p, civil.day);
+		*p++ = 'T';
+		p = Time_And_Clock_Put_2_Digits(p, civil.hour);
+		*p = ':';
+
+		a_fmt->prefix_hour  = hour;
+		a_fmt->prefix_valid = true;
+	}
+
+	// micro seconds within the hour, below 3.6e9 so 32 bit math is enough from here on.
+	uint32_t hour_micros = (uint32_t)(a_wall_time - (hour * TIME_DURATION_USEC_PER_HOUR));
+	uint32_t secs        = hour_micros / 1000000U;
+	uint32_t fraction    = hour_micros - (secs * 1000000U);
+	char * p = &str[WALL_CLOCK_RFC3339_PREFIX_LEN];
+
+	memcpy(str, a_fmt->prefix, WALL_CLOCK_RFC3339_PREFIX_LEN);
+	p = Time_And_Clock_Put_2_Digits(p, secs / 60U);
+	*p++ = ':';
+	p = Time_And_Clock_Put_2_Digits(p, secs % 60U);
+	if(WALL_CLOCK_PRECISION_MSEC == a_fmt->precision){
+		uint32_t m_sec = fraction / 1000U;
+		*p++ = '.';
+		*p++ = (char)('0' + (m_sec / 100U));
+		p = Time_And_Clock_Put_2_Digits(p, m_sec % 100U);
+	}
+	else if(WALL_CLOCK_PRECISION_USEC == a_fmt->precision){
+		*p++ = '.';
+		p = Time_And_Clock_Put_2_Digits(p, fraction / 10000U);
+		p = Time_And_Clock_Put_2_Digits(p, (fraction / 100U) % 100U);
+		p = Time_And_Clock_Put_2_Digits(p, fraction % 100U);
+	}
+	*p++ = 'Z';
+
+	size_t len = (size_t)(p - str);
+	if(0U != a_buf_size){
+		size_t copy_len = (len < a_buf_size) ? len : (a_buf_size - 1U);
+		memcpy(a_buf, str, copy_len);
+		a_buf[copy_len] = '\0';
+	}
+
+	return (int)len;
+}
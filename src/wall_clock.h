@@ -0,0 +1,95 @@
+/**
+ * @author Batto1
+ * @brief  UTC wall clock anchored to uptime and civil (proleptic Gregorian) calendar conversions.
+ * @note   Wall time is kept as micro seconds since the Unix epoch (1970-01-01T00:00:00Z), like TimeDuration. Setting the clock i.e. from an RTC or
+ *         a network time sync only stores the offset between wall time and uptime; reading it adds the offset to the uptime.
+ * @note   Date conversions are O(1) without loops over years or months (days-from-civil / civil-from-days by H. Hinnant). Leap seconds are not counted.
+ * @note   RFC 3339 formatter ("2026-10-17T12:34:56.789123Z") caches the "YYYY-MM-DDTHH:" prefix; within the same hour only minute, second and
+ *         fraction digits are written.
+*/
+
+#ifndef WALL_CLOCK_H
+#define WALL_CLOCK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "time_and_clock_port.h"
+#include "time_and_clock_utils.h"
+
+#define WALL_CLOCK_RFC3339_MAX_STRING_SIZE 	28 	/* "2026-10-17T12:34:56.789123Z" and NUL */
+#define WALL_CLOCK_RFC3339_PREFIX_LEN 		14 	/* "2026-10-17T12:" */
+
+/**
+ * @brief enum for the number of second fraction digits of RFC 3339 strings.
+*/
+typedef enum WallClockPrecision
+{
+	WALL_CLOCK_PRECISION_SEC = 0,
+	WALL_CLOCK_PRECISION_MSEC = 3,
+	WALL_CLOCK_PRECISION_USEC = 6,
+}WallClockPrecision;
+
+/**
+ * @brief struct type for a civil date and time of day, UTC.
+*/
+typedef struct civilDateTime{
+	int32_t 	year;
+	uint16_t 	year_day; 	/* 1-366 */
+	uint8_t 	month; 		/* 1-12 */
+	uint8_t 	day; 		/* 1-31 */
+	uint8_t 	week_day; 	/* 0-6, 0 is Sunday */
+	uint8_t 	hour;
+	uint8_t 	min;
+	uint8_t 	sec;
+	uint16_t 	m_sec;
+	uint16_t 	u_sec;
+}CivilDateTime;
+
+/**
+ * @brief struct type for a wall clock. Use only through Wall_Clock_* routines. Zero initialized clock is not set.
+*/
+typedef struct wallClock{
+	int64_t 		offset; 	/* wall time at uptime 0, micro seconds */
+	bool 			is_set;
+	struct k_spinlock 	lock;
+}WallClock;
+
+/**
+ * @brief struct type for the RFC 3339 formatter state. Use only through Wall_Clock_Rfc3339_* routines. Not thread safe, use one per thread.
+*/
+typedef struct wallClockRfc3339{
+	WallClockPrecision 	precision;
+	int64_t 		prefix_hour; 	/* hours since the epoch the cached prefix belongs to */
+	bool 			prefix_valid;
+	char 			prefix[WALL_CLOCK_RFC3339_PREFIX_LEN];
+}WallClockRfc3339;
+
+int64_t Days_From_Civil(int32_t a_year, uint32_t a_month, uint32_t a_day);
+void Civil_From_Days(int64_t a_days, int32_t * a_year, uint8_t * a_month, uint8_t * a_day);
+void Wall_Time_To_Civil(CivilDateTime * a_civil, int64_t a_wall_time);
+int64_t Civil_To_Wall_Time(const CivilDateTime * a_civil);
+void Wall_Time_To_Time_Categories(TimeCategories * a_categories, int64_t a_wall_time);
+
+void Wall_Clock_Set(WallClock * a_clock, int64_t a_wall_time);
+void Wall_Clock_Set_Civil(WallClock * a_clock, const CivilDateTime * a_civil);
+bool Wall_Clock_Is_Set(WallClock * a_clock);
+int64_t Wall_Clock_Get(WallClock * a_clock);
+void Wall_Clock_Get_Civil(WallClock * a_clock, CivilDateTime * a_civil);
+int64_t Wall_Clock_From_Uptime_Ticks(WallClock * a_clock, int64_t a_ticks);
+
+void Wall_Clock_Rfc3339_Setup(WallClockRfc3339 * a_fmt, WallClockPrecision a_precision);
+int Wall_Clock_Rfc3339_Format(WallClockRfc3339 * a_fmt, char * a_buf, size_t a_buf_size, int64_t a_wall_time);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
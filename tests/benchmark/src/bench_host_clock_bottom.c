@@ -0,0 +1,17 @@
+/**
+ * @author Batto1
+ * @brief  Host clock for the benchmark on native_sim. Built in the runner context (native_simulator target) so that it can call the host's libc;
+ *         the benchmark calls it as a plain extern function.
+*/
+
+#include <stdint.h>
+#include <time.h>
+
+uint64_t Bench_Host_Clock_Ns(void)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
@@ -0,0 +1,650 @@
+/**
+ * @author Batto1
+ * @brief  Benchmark of the time and clock utilities: HW cycles per call of every conversion, Get_Uptime_*, clock arithmetic and formatting routine
+ *         and of the latency histogram record routines.
+ * @note   Every routine is called BENCH_WARMUP times without measuring, then BENCH_REPETITIONS times with each call measured on its own.
+ *         Calls are timed with the stopwatch (calibrated overhead subtracted) and counted in a latency histogram. For every routine a stopwatch
+ *         line (min/max/mean/stddev) and a histogram line (p50/p90/p99/p99.9/max) are printed as JSON, so results can be compared between commits:
+ *         twister ... && grep '^{' twister-out/<platform>/.../handler.log
+ * @note   *_Batch routines are compared with a loop of their per element routine (*_Loop) over BENCH_BATCH_SIZE elements, a throughput line
+ *         (cycles per element, elements/s) is printed for both.
+ * @note   The Reference_* lines are the implementations the routines had before they were optimized (the five division clock decomposition and
+ *         the snprintk/strcat Clock_To_Str), kept as baselines.
+ * @note   On native_sim code runs in zero simulated time, so HW cycles can't measure it. There, BENCH_HOST_REPETITIONS calls are timed as one batch
+ *         with the host's CLOCK_MONOTONIC (bench_host_clock_bottom.c, built in the runner) and the mean time per call is printed instead, loop overhead
+ *         included: {"type":"loop","name":"Ticks_To_Clock_Time","n":100000,"ns_per_call":3.25}. Figures are of the host CPU; take target figures from
+ *         qemu_cortex_m3 (relative only, cycles come from the emulated SysTick) or from real hardware.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "time_and_clock_utils.h"
+#include "cycle_counter_64.h"
+#include "stopwatch.h"
+#include "latency_histogram.h"
+
+#ifndef BENCH_WARMUP
+#define BENCH_WARMUP 		100U
+#endif
+
+#ifndef BENCH_REPETITIONS
+#define BENCH_REPETITIONS 	1000U
+#endif
+
+#ifndef BENCH_BATCH_SIZE
+#define BENCH_BATCH_SIZE 	64U
+#endif
+
+/**
+ * @brief Benchmarks a statement: warm-up, then BENCH_REPETITIONS measured calls, then prints the JSON lines.
+ * @note The statement stores its result to a bench_* sink so that the call can't be optimized away.
+*/
+#define BENCH(a_name, a_statement) 	BENCH_ELEMENTS(a_name, 1U, a_statement)
+
+#if defined(CONFIG_NATIVE_LIBRARY)
+#define BENCH_HOST_CLOCK 	1
+#else
+#define BENCH_HOST_CLOCK 	0
+#endif
+
+#ifndef BENCH_HOST_REPETITIONS
+#define BENCH_HOST_REPETITIONS 	100000U
+#endif
+
+#if BENCH_HOST_CLOCK
+/* CLOCK_MONOTONIC of the host in nanoseconds, see bench_host_clock_bottom.c. */
+extern uint64_t Bench_Host_Clock_Ns(void);
+
+/* Number of times a BENCH() runs its statement, warm-up included. */
+#define BENCH_CALLS 	(BENCH_WARMUP + BENCH_HOST_REPETITIONS)
+
+/**
+ * @brief Same as BENCH() for a statement that converts a_elements elements per call. Timed as one batch of BENCH_HOST_REPETITIONS calls.
+*/
+#define BENCH_ELEMENTS(a_name, a_elements, a_statement) 					\
+	do{ 											\
+		for(uint32_t rep = 0; rep < BENCH_WARMUP; rep++){ 				\
+			a_statement; 								\
+		} 										\
+		uint64_t start_ns = Bench_Host_Clock_Ns(); 					\
+		for(uint32_t rep = 0; rep < BENCH_HOST_REPETITIONS; rep++){ 			\
+			a_statement; 								\
+			compiler_barrier(); /* every call's result is stored, not only the last */ \
+		} 										\
+		Bench_Host_End(a_name, a_elements, Bench_Host_Clock_Ns() - start_ns); 		\
+	}while(0)
+#else
+#define BENCH_CALLS 	(BENCH_WARMUP + BENCH_REPETITIONS)
+
+/**
+ * @brief Same as BENCH() for a statement that converts a_elements elements per call. A throughput line (elements/s) is printed in addition.
+*/
+#define BENCH_ELEMENTS(a_name, a_elements, a_statement) 					\
+	do{ 											\
+		static StopwatchSection section; 						\
+												\
+		Bench_Begin(&section, a_name); 							\
+		for(uint32_t rep = 0; rep < BENCH_WARMUP + BENCH_REPETITIONS; rep++){ 	\
+			uint32_t start = Stopwatch_Start(); 					\
+			a_statement; 								\
+			uint32_t cycles = k_cycle_get_32() - start; 				\
+												\
+			if(rep >= BENCH_WARMUP){ 						\
+				Bench_Record(&section, cycles); 				\
+			} 									\
+		} 										\
+		Bench_End(&section, a_elements); 						\
+	}while(0)
+#endif
+
+
+/* Inputs are read through volatiles so that calls aren't folded at build time, results are written to sinks so that they aren't dropped. */
+static volatile int64_t bench_ticks = 123456789;
+static volatile uint32_t bench_cycles_32 = 3456789012U;
+static volatile uint64_t bench_cycles_64 = 987654321987ULL;
+static volatile uint64_t bench_micro_sec = 93784005006ULL;
+
+static volatile uint64_t bench_sink_u64;
+static volatile int64_t bench_sink_i64;
+static volatile int bench_sink_int;
+static TimeElapsedClock bench_sink_clock;
+
+static TimeElapsedClock bench_clock_a = {.day = 1, .hour = 2, .min = 3, .sec = 4, .m_sec = 5, .u_sec = 6};
+static TimeElapsedClock bench_clock_b = {.day = 0, .hour = 23, .min = 59, .sec = 59, .m_sec = 999, .u_sec = 999};
+static char bench_clk_buf[CLOCK_MAX_STRING_SIZE];
+static char bench_legend_buf[CLOCK_LEGEND_MAX_STRING_SIZE];
+
+/* Batch inputs and outputs: structure of arrays for the *_Batch routines, array of structures for the per element loops they are compared with. */
+static int64_t bench_batch_ticks[BENCH_BATCH_SIZE];
+static uint32_t bench_batch_cycles_32[BENCH_BATCH_SIZE];
+static uint64_t bench_batch_cycles_64[BENCH_BATCH_SIZE];
+static uint32_t bench_batch_day[BENCH_BATCH_SIZE];
+static uint8_t bench_batch_hour[BENCH_BATCH_SIZE];
+static uint8_t bench_batch_min[BENCH_BATCH_SIZE];
+static uint8_t bench_batch_sec[BENCH_BATCH_SIZE];
+static uint16_t bench_batch_m_sec[BENCH_BATCH_SIZE];
+static uint16_t bench_batch_u_sec[BENCH_BATCH_SIZE];
+static TimeElapsedClockArrays bench_batch_out = {.day = bench_batch_day, .hour = bench_batch_hour, .min = bench_batch_min, .sec = bench_batch_sec,
+						 .m_sec = bench_batch_m_sec, .u_sec = bench_batch_u_sec};
+static TimeElapsedClock bench_batch_clocks[BENCH_BATCH_SIZE];
+
+#ifndef BENCH_REFERENCE_SAMPLES
+#define BENCH_REFERENCE_SAMPLES 	100000U
+#endif
+
+
+/**
+ * @brief Reference clock decomposition: the five successive divisions by 1000, 1000, 60, 60, 24 that the conversions used before the reciprocal
+ * path (Micro_Sec_To_Clock_Fast). Kept to check that both give bit identical results and to compare their cost.
+*/
+static TimeElapsedClock Reference_Micro_Sec_To_Clock(uint64_t a_total_micro_sec)
+{
+	TimeElapsedClock clk;
+
+	uint64_t total_milli_sec = a_total_micro_sec / 1000;
+	uint64_t total_sec 	 = total_milli_sec / 1000;
+	uint64_t total_minutes 	 = total_sec / 60;
+	uint64_t total_hours 	 = total_minutes / 60;
+	uint64_t total_days 	 = total_hours / 24;
+
+	clk.u_sec = a_total_micro_sec % 1000;
+	clk.m_sec = total_milli_sec % 1000;
+	clk.sec   = total_sec % 60;
+	clk.min   = total_minutes % 60;
+	clk.hour  = total_hours % 24;
+	clk.day   = total_days;
+
+	return clk;
+}
+
+static TimeElapsedClock Reference_Ticks_To_Clock_Time(int64_t a_ticks)
+{
+	return Reference_Micro_Sec_To_Clock(k_ticks_to_us_floor64((uint64_t)a_ticks));
+}
+
+static TimeElapsedClock Reference_HW_Cycles_To_Clock_Time_32(uint32_t a_cycles)
+{
+	return Reference_Micro_Sec_To_Clock(k_cyc_to_us_floor64(a_cycles));
+}
+
+static TimeElapsedClock Reference_HW_Cycles_To_Clock_Time_64(uint64_t a_cycles)
+{
+	return Reference_Micro_Sec_To_Clock(k_cyc_to_us_floor64(a_cycles));
+}
+
+static bool Clock_Is_Equal(const TimeElapsedClock * a_first, const TimeElapsedClock * a_second)
+{
+	return (a_first->day == a_second->day) && (a_first->hour == a_second->hour) && (a_first->min == a_second->min) &&
+	       (a_first->sec == a_second->sec) && (a_first->m_sec == a_second->m_sec) && (a_first->u_sec == a_second->u_sec);
+}
+
+/**
+ * @brief Reference Clock_To_Str: the snprintk/strcat implementation Clock_To_Str had before it was rewritten on Clock_Format. Kept as a baseline
+ * to check that both give the same strings and to compare their cost.
+*/
+static void Reference_Clock_To_Str(char * a_clk_buf, char * a_legend_buf, const TimeElapsedClock * a_clock, bool a_print_usec, bool a_print_msec,
+				   bool a_print_sec, bool a_print_min, bool a_print_hour, bool a_print_day)
+{
+	if(NULL != a_legend_buf){
+		char clk_legend_buf[16];
+		snprintk(clk_legend_buf, 16, "%s", "");
+		strcat(clk_legend_buf, "[");
+		if(a_print_day){
+			strcat(clk_legend_buf, "d");
+		}
+		if(a_print_hour){
+			strcat(clk_legend_buf, ":h");
+		}
+		if(a_print_min){
+			strcat(clk_legend_buf, ":m");
+		}
+		if(a_print_sec){
+			strcat(clk_legend_buf, ":s");
+		}
+		if(a_print_msec){
+			strcat(clk_legend_buf, ".ms");
+		}
+		if(a_print_usec){
+			strcat(clk_legend_buf, ",us");
+		}
+		strcat(clk_legend_buf, "]");
+		strcpy(a_legend_buf, clk_legend_buf);
+	}
+
+	char clk_values_buf[30];
+	snprintk(clk_values_buf, 30, "%s", "");
+	char temp[10];
+
+	strcat(clk_values_buf, "[");
+	if(a_print_day){
+		snprintk(temp, 10, "%"PRIu32, a_clock->day);
+		strcat(clk_values_buf, temp);
+	}
+	if(a_print_hour){
+		snprintk(temp, 10, ":%"PRIu8, a_clock->hour);
+		strcat(clk_values_buf, temp);
+	}
+	if(a_print_min){
+		snprintk(temp, 10, ":%"PRIu8, a_clock->min);
+		strcat(clk_values_buf, temp);
+	}
+	if(a_print_sec){
+		snprintk(temp, 10, ":%"PRIu8, a_clock->sec);
+		strcat(clk_values_buf, temp);
+	}
+	if(a_print_msec){
+		snprintk(temp, 10, ".%"PRIu16, a_clock->m_sec);
+		strcat(clk_values_buf, temp);
+	}
+	if(a_print_usec){
+		snprintk(temp, 10, ",%"PRIu16, a_clock->u_sec);
+		strcat(clk_values_buf, temp);
+	}
+	strcat(clk_values_buf, "]");
+
+	strcpy(a_clk_buf, clk_values_buf);
+}
+
+/**
+ * @brief xorshift64*, inputs of the reference comparison.
+*/
+static uint64_t Bench_Random_U64(uint64_t * a_state)
+{
+	* a_state ^= * a_state >> 12;
+	* a_state ^= * a_state << 25;
+	* a_state ^= * a_state >> 27;
+
+	return * a_state * 0x2545F4914F6CDD1DULL;
+}
+
+
+#if BENCH_HOST_CLOCK
+static void Bench_Host_End(const char * a_name, uint32_t a_elements, uint64_t a_ns)
+{
+	uint64_t ns_x100 = (a_ns * 100U) / BENCH_HOST_REPETITIONS; // calls can take less than a nanosecond, two decimals are printed
+
+	printk("{\"type\":\"loop\",\"name\":\"%s\",\"n\":%"PRIu32",\"ns_per_call\":%"PRIu64".%02"PRIu64"}\n", a_name, BENCH_HOST_REPETITIONS,
+	       ns_x100 / 100U, ns_x100 % 100U);
+
+	if(a_elements > 1U){
+		uint64_t elements = (uint64_t)a_elements * BENCH_HOST_REPETITIONS;
+
+		printk("{\"type\":\"throughput\",\"name\":\"%s\",\"elements\":%"PRIu32",\"ns_per_element\":%"PRIu64",\"elements_per_sec\":%"PRIu64"}\n",
+		       a_name, a_elements, a_ns / elements, (a_ns > 0U) ? (elements * 1000000000U) / a_ns : 0U);
+	}
+}
+#else
+static LatencyHistogram bench_hist;
+static LatencyHistogramSnapshot bench_snapshot;
+
+static void Bench_Begin(StopwatchSection * a_section, const char * a_name)
+{
+	Stopwatch_Section_Init(a_section, a_name);
+	Latency_Histogram_Reset(&bench_hist);
+}
+
+/**
+ * @brief Records a measured call in the stopwatch and in the histogram, both without the measurement overhead.
+*/
+static inline void Bench_Record(StopwatchSection * a_section, uint32_t a_cycles)
+{
+	Stopwatch_Record(a_section, a_cycles);
+	Latency_Histogram_Record_Cycles(&bench_hist, (a_cycles > stopwatch_overhead_cycles) ? (a_cycles - stopwatch_overhead_cycles) : 0U);
+}
+
+static void Bench_End(StopwatchSection * a_section, uint32_t a_elements)
+{
+	Latency_Histogram_Snapshot(&bench_snapshot, &bench_hist, true);
+
+	Stopwatch_Print_Report_Json(a_section);
+	Latency_Histogram_Print_Json(&bench_snapshot, a_section->name);
+
+	if(a_elements > 1U){
+		StopwatchReport report;
+
+		Stopwatch_Get_Report(&report, a_section);
+		printk("{\"type\":\"throughput\",\"name\":\"%s\",\"elements\":%"PRIu32",\"cyc_per_element\":%"PRIu32",\"elements_per_sec\":%"PRIu64"}\n",
+		       a_section->name, a_elements, report.mean_cycles / a_elements, (report.mean_ns > 0U) ? ((uint64_t)a_elements * 1000000000U) / report.mean_ns : 0U);
+	}
+
+	zassert_equal(a_section->count, BENCH_REPETITIONS);
+	zassert_equal(bench_snapshot.total_count, BENCH_REPETITIONS);
+}
+#endif
+
+ZTEST(time_and_clock_benchmark, test_conversions)
+{
+	BENCH("Micro_Sec_To_Milli_Sec", bench_sink_u64 = Micro_Sec_To_Milli_Sec(bench_micro_sec));
+	BENCH("Micro_Sec_To_Sec", bench_sink_u64 = Micro_Sec_To_Sec(bench_micro_sec));
+
+	BENCH("Ticks_To_Milliseconds", bench_sink_u64 = Ticks_To_Milliseconds((uint64_t)bench_ticks));
+	BENCH("Ticks_To_Seconds", bench_sink_u64 = Ticks_To_Seconds((uint64_t)bench_ticks));
+	BENCH("Ticks_To_Clock_Time", bench_sink_clock = Ticks_To_Clock_Time(bench_ticks));
+	BENCH("Reference_Ticks_To_Clock_Time", bench_sink_clock = Reference_Ticks_To_Clock_Time(bench_ticks));
+	BENCH("Ticks_To_Duration", bench_sink_i64 = Ticks_To_Duration(bench_ticks));
+
+	BENCH("HW_Cycles_To_Milliseconds_32", bench_sink_u64 = HW_Cycles_To_Milliseconds_32(bench_cycles_32));
+	BENCH("HW_Cycles_To_Seconds_32", bench_sink_u64 = HW_Cycles_To_Seconds_32(bench_cycles_32));
+	BENCH("HW_Cycles_To_Clock_Time_32", bench_sink_clock = HW_Cycles_To_Clock_Time_32(bench_cycles_32));
+	BENCH("Reference_HW_Cycles_To_Clock_Time_32", bench_sink_clock = Reference_HW_Cycles_To_Clock_Time_32(bench_cycles_32));
+
+	BENCH("HW_Cycles_To_Milliseconds_64", bench_sink_u64 = HW_Cycles_To_Milliseconds_64(bench_cycles_64));
+	BENCH("HW_Cycles_To_Seconds_64", bench_sink_u64 = HW_Cycles_To_Seconds_64(bench_cycles_64));
+	BENCH("HW_Cycles_To_Clock_Time_64", bench_sink_clock = HW_Cycles_To_Clock_Time_64(bench_cycles_64));
+	BENCH("Reference_HW_Cycles_To_Clock_Time_64", bench_sink_clock = Reference_HW_Cycles_To_Clock_Time_64(bench_cycles_64));
+	BENCH("HW_Cycles_To_Duration_64", bench_sink_i64 = HW_Cycles_To_Duration_64(bench_cycles_64));
+
+
+	BENCH("Clock_To_Duration", bench_sink_i64 = Clock_To_Duration(&bench_clock_a));
+	BENCH("Duration_To_Clock", bench_sink_int = Duration_To_Clock(&bench_sink_clock, (TimeDuration)bench_micro_sec));
+	BENCH("Reference_Micro_Sec_To_Clock", bench_sink_clock = Reference_Micro_Sec_To_Clock(bench_micro_sec));
+}
+
+/**
+ * @brief The reciprocal decomposition gives the same fields as the reference one for unit boundaries and random inputs of every width.
+ * Their cost is compared in test_conversions (Reference_* lines).
+*/
+ZTEST(time_and_clock_benchmark, test_reference_decomposition)
+{
+	static const uint64_t boundaries[] = {0U, 999U, 1000U, 999999U, 1000000U, 59999999U, 60000000U, 3599999999ULL, 3600000000ULL,
+					      86399999999ULL, 86400000000ULL, 86400000000ULL * 49710U, (86400000000ULL * 49711U) - 1U};
+	uint64_t state = 0x9E3779B97F4A7C15ULL;
+
+	for(size_t i = 0; i < ARRAY_SIZE(boundaries); i++){
+		TimeElapsedClock fast 	   = {0};
+		TimeElapsedClock reference = Reference_Micro_Sec_To_Clock(boundaries[i]);
+
+		zassert_equal(Duration_To_Clock(&fast, (TimeDuration)boundaries[i]), TIME_UTIL_ERROR_NONE);
+		zassert_true(Clock_Is_Equal(&fast, &reference), "%llu us", (unsigned long long)boundaries[i]);
+	}
+
+	for(uint32_t i = 0; i < BENCH_REFERENCE_SAMPLES; i++){
+		/* Random width so that every field and the day count are exercised, kept below the 64 bit micro second overflow of the conversions. */
+		uint64_t value = Bench_Random_U64(&state) >> (20U + (i % 44U));
+
+		TimeElapsedClock fast 	   = Ticks_To_Clock_Time((int64_t)value);
+		TimeElapsedClock reference = Reference_Ticks_To_Clock_Time((int64_t)value);
+		zassert_true(Clock_Is_Equal(&fast, &reference), "ticks %llu", (unsigned long long)value);
+
+		fast 	  = HW_Cycles_To_Clock_Time_64(value);
+		reference = Reference_HW_Cycles_To_Clock_Time_64(value);
+		zassert_true(Clock_Is_Equal(&fast, &reference), "cycles %llu", (unsigned long long)value);
+
+		fast 	  = HW_Cycles_To_Clock_Time_32((uint32_t)value);
+		reference = Reference_HW_Cycles_To_Clock_Time_32((uint32_t)value);
+		zassert_true(Clock_Is_Equal(&fast, &reference), "cycles %u", (uint32_t)value);
+
+		zassert_equal(Duration_To_Clock(&fast, (TimeDuration)value), TIME_UTIL_ERROR_NONE);
+		reference = Reference_Micro_Sec_To_Clock(value);
+		zassert_true(Clock_Is_Equal(&fast, &reference), "%llu us", (unsigned long long)value);
+	}
+}
+
+/**
+ * @brief Checks that the batch output of every element equals the per element conversion in bench_batch_clocks.
+*/
+static void Bench_Batch_Check(void)
+{
+	for(uint32_t i = 0; i < BENCH_BATCH_SIZE; i++){
+		zassert_equal(bench_batch_day[i], bench_batch_clocks[i].day);
+		zassert_equal(bench_batch_hour[i], bench_batch_clocks[i].hour);
+		zassert_equal(bench_batch_min[i], bench_batch_clocks[i].min);
+		zassert_equal(bench_batch_sec[i], bench_batch_clocks[i].sec);
+		zassert_equal(bench_batch_m_sec[i], bench_batch_clocks[i].m_sec);
+		zassert_equal(bench_batch_u_sec[i], bench_batch_clocks[i].u_sec);
+	}
+}
+
+/**
+ * @brief *_Batch routines against a loop of the per element routine over the same BENCH_BATCH_SIZE inputs.
+*/
+ZTEST(time_and_clock_benchmark, test_batch)
+{
+	uint64_t state = 0xD1B54A32D192ED03ULL;
+
+	for(uint32_t i = 0; i < BENCH_BATCH_SIZE; i++){
+		uint64_t value = Bench_Random_U64(&state) >> 24;
+
+		bench_batch_ticks[i] 	 = (int64_t)value;
+		bench_batch_cycles_32[i] = (uint32_t)value;
+		bench_batch_cycles_64[i] = value;
+	}
+
+	BENCH_ELEMENTS("Ticks_To_Clock_Time_Batch", BENCH_BATCH_SIZE, Ticks_To_Clock_Time_Batch(bench_batch_ticks, BENCH_BATCH_SIZE, &bench_batch_out));
+	BENCH_ELEMENTS("Ticks_To_Clock_Time_Loop", BENCH_BATCH_SIZE,
+		       for(uint32_t i = 0; i < BENCH_BATCH_SIZE; i++){ bench_batch_clocks[i] = Ticks_To_Clock_Time(bench_batch_ticks[i]); });
+	Bench_Batch_Check();
+
+	BENCH_ELEMENTS("HW_Cycles_To_Clock_Time_Batch_32", BENCH_BATCH_SIZE, HW_Cycles_To_Clock_Time_Batch_32(bench_batch_cycles_32, BENCH_BATCH_SIZE, &bench_batch_out));
+	BENCH_ELEMENTS("HW_Cycles_To_Clock_Time_32_Loop", BENCH_BATCH_SIZE,
+		       for(uint32_t i = 0; i < BENCH_BATCH_SIZE; i++){ bench_batch_clocks[i] = HW_Cycles_To_Clock_Time_32(bench_batch_cycles_32[i]); });
+	Bench_Batch_Check();
+
+	BENCH_ELEMENTS("HW_Cycles_To_Clock_Time_Batch_64", BENCH_BATCH_SIZE, HW_Cycles_To_Clock_Time_Batch_64(bench_batch_cycles_64, BENCH_BATCH_SIZE, &bench_batch_out));
+	BENCH_ELEMENTS("HW_Cycles_To_Clock_Time_64_Loop", BENCH_BATCH_SIZE,
+		       for(uint32_t i = 0; i < BENCH_BATCH_SIZE; i++){ bench_batch_clocks[i] = HW_Cycles_To_Clock_Time_64(bench_batch_cycles_64[i]); });
+	Bench_Batch_Check();
+}
+
+/**
+ * @brief Cached conversions called at 1 kHz and 100 kHz, i.e. inputs 1000 us and 10 us apart, next to the uncached conversion of the same inputs.
+ * @note A tick step can't be shorter than a tick, so with CONFIG_SYS_CLOCK_TICKS_PER_SEC below 100000 the 100 kHz tick lines step by one tick.
+ * The cycle lines step by exactly 10 us.
+*/
+ZTEST(time_and_clock_benchmark, test_cached)
+{
+	static const uint32_t rates_hz[] = {1000U, 100000U};
+	static const char * const names[][4] = {
+		{"Ticks_To_Clock_Time_Cached_1kHz", "Ticks_To_Clock_Time_1kHz", "HW_Cycles_To_Clock_Time_Cached_64_1kHz", "HW_Cycles_To_Clock_Time_64_1kHz"},
+		{"Ticks_To_Clock_Time_Cached_100kHz", "Ticks_To_Clock_Time_100kHz", "HW_Cycles_To_Clock_Time_Cached_64_100kHz", "HW_Cycles_To_Clock_Time_64_100kHz"},
+	};
+
+	for(size_t r = 0; r < ARRAY_SIZE(rates_hz); r++){
+		int64_t  tick_step  = MAX(1, (int64_t)CONFIG_SYS_CLOCK_TICKS_PER_SEC / (int64_t)rates_hz[r]);
+		uint64_t cycle_step = MAX(1U, (uint64_t)sys_clock_hw_cycles_per_sec() / rates_hz[r]);
+		ClockConversionCache cache = {0};
+		int64_t ticks;
+		uint64_t cycles;
+
+		ticks = bench_ticks;
+		BENCH(names[r][0], bench_sink_clock = Ticks_To_Clock_Time_Cached(&cache, ticks += tick_step));
+		TimeElapsedClock expected = Ticks_To_Clock_Time(ticks);
+		zassert_true(Clock_Is_Equal(&bench_sink_clock, &expected));
+
+		ticks = bench_ticks;
+		BENCH(names[r][1], bench_sink_clock = Ticks_To_Clock_Time(ticks += tick_step));
+
+		cache  = (ClockConversionCache){0};
+		cycles = bench_cycles_64;
+		BENCH(names[r][2], bench_sink_clock = HW_Cycles_To_Clock_Time_Cached_64(&cache, cycles += cycle_step));
+		expected = HW_Cycles_To_Clock_Time_64(cycles);
+		zassert_true(Clock_Is_Equal(&bench_sink_clock, &expected));
+
+		cycles = bench_cycles_64;
+		BENCH(names[r][3], bench_sink_clock = HW_Cycles_To_Clock_Time_64(cycles += cycle_step));
+	}
+}
+
+ZTEST(time_and_clock_benchmark, test_uptime)
+{
+	BENCH("Get_Uptime_Ticks", bench_sink_i64 = Get_Uptime_Ticks());
+	BENCH("Get_Uptime_Ticks_As_Milliseconds", bench_sink_u64 = Get_Uptime_Ticks_As_Milliseconds());
+	BENCH("Get_Uptime_Ticks_As_Seconds", bench_sink_u64 = Get_Uptime_Ticks_As_Seconds());
+	BENCH("Get_Uptime_Ticks_As_Clock_Time", bench_sink_clock = Get_Uptime_Ticks_As_Clock_Time());
+	BENCH("Get_Uptime_Ticks_As_Duration", bench_sink_i64 = Get_Uptime_Ticks_As_Duration());
+
+	BENCH("Get_Uptime_HW_Cycles_32", bench_sink_u64 = Get_Uptime_HW_Cycles_32());
+	BENCH("Get_Uptime_HW_Cycles_As_Milliseconds_32", bench_sink_u64 = Get_Uptime_HW_Cycles_As_Milliseconds_32());
+	BENCH("Get_Uptime_HW_Cycles_As_Seconds_32", bench_sink_u64 = Get_Uptime_HW_Cycles_As_Seconds_32());
+	BENCH("Get_Uptime_HW_Cycles_As_Clock_Time_32", bench_sink_clock = Get_Uptime_HW_Cycles_As_Clock_Time_32());
+
+	BENCH("Get_Uptime_HW_Cycles_64", bench_sink_u64 = Get_Uptime_HW_Cycles_64());
+	BENCH("Get_Uptime_HW_Cycles_As_Milliseconds_64", bench_sink_u64 = Get_Uptime_HW_Cycles_As_Milliseconds_64());
+	BENCH("Get_Uptime_HW_Cycles_As_Seconds_64", bench_sink_u64 = Get_Uptime_HW_Cycles_As_Seconds_64());
+	BENCH("Get_Uptime_HW_Cycles_As_Clock_Time_64", bench_sink_clock = Get_Uptime_HW_Cycles_As_Clock_Time_64());
+	BENCH("Get_Uptime_HW_Cycles_As_Duration_64", bench_sink_i64 = Get_Uptime_HW_Cycles_As_Duration_64());
+
+	static ClockConversionCache ticks_cache;
+	static ClockConversionCache cycles_cache;
+	BENCH("Get_Uptime_Ticks_As_Clock_Time_Cached", bench_sink_clock = Get_Uptime_Ticks_As_Clock_Time_Cached(&ticks_cache));
+	BENCH("Get_Uptime_HW_Cycles_As_Clock_Time_Cached_64", bench_sink_clock = Get_Uptime_HW_Cycles_As_Clock_Time_Cached_64(&cycles_cache));
+}
+
+ZTEST(time_and_clock_benchmark, test_clock_arithmetic)
+{
+	BENCH("Clock_Subtract_Two_Time_Points", bench_sink_int = Clock_Subtract_Two_Time_Points(&bench_sink_clock, bench_clock_a, bench_clock_b));
+	BENCH("Clock_Sum_Two_Time_Points", bench_sink_int = Clock_Sum_Two_Time_Points(&bench_sink_clock, bench_clock_a, bench_clock_b));
+
+	bench_sink_clock = bench_clock_b;
+	BENCH("Increment_a_Millisecond_And_Update_Clock", Increment_a_Millisecond_And_Update_Clock(&bench_sink_clock));
+	BENCH("Increment_a_Second_And_Update_Clock", Increment_a_Second_And_Update_Clock(&bench_sink_clock));
+
+}
+
+ZTEST(time_and_clock_benchmark, test_duration)
+{
+	TimeDuration a = Clock_To_Duration(&bench_clock_a);
+	TimeDuration b = Clock_To_Duration(&bench_clock_b);
+	TimeCategories categories;
+
+	BENCH("Duration_Add", bench_sink_i64 = Duration_Add(a, b));
+	BENCH("Duration_Sub", bench_sink_i64 = Duration_Sub(a, b));
+	BENCH("Duration_Scale", bench_sink_i64 = Duration_Scale(a, 3));
+	BENCH("Duration_Compare", bench_sink_int = Duration_Compare(a, b));
+	BENCH("Duration_Min", bench_sink_i64 = Duration_Min(a, b));
+	BENCH("Duration_Max", bench_sink_i64 = Duration_Max(a, b));
+	BENCH("Duration_Is_Negative", bench_sink_int = Duration_Is_Negative(Duration_Sub(b, a)));
+
+	BENCH("Duration_To_Time_Categories", Duration_To_Time_Categories(&categories, (TimeDuration)bench_micro_sec));
+	TimeDuration duration = 0;
+	BENCH("Time_Categories_To_Duration", bench_sink_int = Time_Categories_To_Duration(&duration, &categories));
+	zassert_equal(duration, (TimeDuration)bench_micro_sec);
+
+	static const char literal[] = "1d2h3m4.005006s";
+	BENCH("Duration_Parse", bench_sink_int = Duration_Parse(&duration, literal, sizeof(literal) - 1U, NULL));
+	zassert_equal(duration, a);
+}
+
+/**
+ * @brief Runtime calibrated conversion of Get_HW_Cycles_Conversion() and of a user owned one with drift correction.
+*/
+ZTEST(time_and_clock_benchmark, test_cycle_conversion)
+{
+	static CycleConversion conv;
+	const CycleConversion * hw_conv = Get_HW_Cycles_Conversion();
+
+	Cycle_Conversion_Init(&conv, 32768U, 0);
+
+	BENCH("Cycle_Conversion_To_Micro_Sec", bench_sink_u64 = Cycle_Conversion_To_Micro_Sec(hw_conv, bench_cycles_64));
+	BENCH("Cycle_Conversion_To_Duration", bench_sink_i64 = Cycle_Conversion_To_Duration(hw_conv, bench_cycles_64));
+	BENCH("Cycle_Conversion_To_Clock_Time", bench_sink_clock = Cycle_Conversion_To_Clock_Time(hw_conv, bench_cycles_64));
+
+	BENCH("Cycle_Conversion_Set_Correction", Cycle_Conversion_Set_Correction(&conv, (int32_t)(bench_cycles_32 % 20001U) - 10000));
+	BENCH("Cycle_Conversion_Set_Frequency", Cycle_Conversion_Set_Frequency(&conv, 32768U + (bench_cycles_32 % 16U)));
+	BENCH("Cycle_Conversion_Init", Cycle_Conversion_Init(&conv, 32768U, 0));
+	BENCH("Cycle_Conversion_To_Clock_Time_32768Hz", bench_sink_clock = Cycle_Conversion_To_Clock_Time(&conv, bench_cycles_64));
+}
+
+/**
+ * @brief Powered-up time accumulator and raw time accumulator: updating them from the uptime and reading them in every format.
+*/
+ZTEST(time_and_clock_benchmark, test_accumulators)
+{
+	static PoweredupAccumulator poweredup;
+	static RawTimeAccumulator raw;
+
+	Poweredup_Accumulator_Init(&poweredup, 0U);
+	BENCH("Poweredup_Accumulator_Update", Poweredup_Accumulator_Update(&poweredup));
+	BENCH("Poweredup_Accumulator_Get_Ticks", bench_sink_u64 = Poweredup_Accumulator_Get_Ticks(&poweredup));
+	BENCH("Poweredup_Accumulator_Get_Duration", bench_sink_i64 = Poweredup_Accumulator_Get_Duration(&poweredup));
+	BENCH("Poweredup_Accumulator_Get_Clock", bench_sink_clock = Poweredup_Accumulator_Get_Clock(&poweredup));
+
+	Raw_Time_Accumulator_Init(&raw, TIME_ACCUMULATOR_HW_CYCLES, 0U, 0U);
+	BENCH("Raw_Time_Accumulator_Update", Raw_Time_Accumulator_Update(&raw));
+	BENCH("Raw_Time_Accumulator_Add", Raw_Time_Accumulator_Add(&raw, bench_cycles_32));
+	BENCH("Raw_Time_Accumulator_Get_Duration", bench_sink_i64 = Raw_Time_Accumulator_Get_Duration(&raw));
+	BENCH("Raw_Time_Accumulator_Get_Clock", bench_sink_clock = Raw_Time_Accumulator_Get_Clock(&raw));
+}
+
+/**
+ * @brief Cost of counting a latency: Record_Cycles is the atomic increment alone, Record_Since_32/64 add the counter read and the subtraction.
+*/
+ZTEST(time_and_clock_benchmark, test_histogram)
+{
+	static LatencyHistogram hist;
+	static LatencyHistogramSnapshot snapshot;
+	uint32_t start_32 = Get_Uptime_HW_Cycles_32();
+	uint64_t start_64 = Get_Uptime_HW_Cycles_64();
+
+	Latency_Histogram_Reset(&hist);
+	BENCH("Latency_Histogram_Record_Cycles", Latency_Histogram_Record_Cycles(&hist, bench_cycles_32));
+	BENCH("Latency_Histogram_Record_Since_32", Latency_Histogram_Record_Since_32(&hist, start_32));
+	BENCH("Latency_Histogram_Record_Since_64", Latency_Histogram_Record_Since_64(&hist, start_64));
+
+	Latency_Histogram_Snapshot(&snapshot, &hist, true);
+	zassert_equal(snapshot.total_count, 3U * BENCH_CALLS);
+}
+
+ZTEST(time_and_clock_benchmark, test_formatting)
+{
+	BENCH("Clock_To_Str", Clock_To_Str(bench_clk_buf, bench_legend_buf, &bench_clock_a, true, true, true, true, true, true));
+	BENCH("Reference_Clock_To_Str", Reference_Clock_To_Str(bench_clk_buf, bench_legend_buf, &bench_clock_a, true, true, true, true, true, true));
+	BENCH("Clock_To_Str_Sec", Clock_To_Str(bench_clk_buf, NULL, &bench_clock_a, false, false, true, false, false, false));
+	BENCH("Reference_Clock_To_Str_Sec", Reference_Clock_To_Str(bench_clk_buf, NULL, &bench_clock_a, false, false, true, false, false, false));
+	BENCH("Clock_Format", bench_sink_int = Clock_Format(bench_clk_buf, sizeof(bench_clk_buf), &bench_clock_a, CLOCK_FIELD_ALL));
+	BENCH("Clock_Legend_Format", bench_sink_int = Clock_Legend_Format(bench_legend_buf, sizeof(bench_legend_buf), CLOCK_FIELD_ALL));
+
+	uint32_t fields = 0;
+	size_t legend_len = (size_t)Clock_Legend_Format(bench_legend_buf, sizeof(bench_legend_buf), CLOCK_FIELD_ALL);
+	BENCH("Clock_Legend_Parse", bench_sink_int = Clock_Legend_Parse(&fields, bench_legend_buf, legend_len, NULL));
+	zassert_equal(fields, CLOCK_FIELD_ALL);
+
+	size_t len = (size_t)Clock_Format(bench_clk_buf, sizeof(bench_clk_buf), &bench_clock_a, CLOCK_FIELD_ALL);
+	BENCH("Clock_Parse", bench_sink_int = Clock_Parse(&bench_sink_clock, bench_clk_buf, len, CLOCK_FIELD_ALL, NULL));
+	zassert_equal(Clock_To_Duration(&bench_sink_clock), Clock_To_Duration(&bench_clock_a), "parsed clock differs from the formatted one");
+}
+
+/**
+ * @brief Clock_To_Str gives the same value and legend strings as the reference for every field selection, with the widest field values.
+ * @note The reference truncates days of 10 digits (its temp buffer holds 9 digits), so the widest day compared is 999999999.
+*/
+ZTEST(time_and_clock_benchmark, test_reference_clock_to_str)
+{
+	static TimeElapsedClock clocks[] = {
+		{.day = 0, .hour = 0, .min = 0, .sec = 0, .m_sec = 0, .u_sec = 0},
+		{.day = 1, .hour = 2, .min = 3, .sec = 4, .m_sec = 5, .u_sec = 6},
+		{.day = 999999999U, .hour = 23, .min = 59, .sec = 59, .m_sec = 999, .u_sec = 999},
+	};
+	char reference_clk_buf[CLOCK_MAX_STRING_SIZE];
+	char reference_legend_buf[CLOCK_LEGEND_MAX_STRING_SIZE];
+
+	for(size_t c = 0; c < ARRAY_SIZE(clocks); c++){
+		for(uint32_t fields = 0; fields < 64U; fields++){
+			bool usec = (fields & BIT(0)) != 0U, msec = (fields & BIT(1)) != 0U, sec = (fields & BIT(2)) != 0U;
+			bool min  = (fields & BIT(3)) != 0U, hour = (fields & BIT(4)) != 0U, day = (fields & BIT(5)) != 0U;
+
+			Clock_To_Str(bench_clk_buf, bench_legend_buf, &clocks[c], usec, msec, sec, min, hour, day);
+			Reference_Clock_To_Str(reference_clk_buf, reference_legend_buf, &clocks[c], usec, msec, sec, min, hour, day);
+			zassert_str_equal(bench_clk_buf, reference_clk_buf, "fields 0x%02x", fields);
+			zassert_str_equal(bench_legend_buf, reference_legend_buf, "fields 0x%02x", fields);
+		}
+	}
+}
+
+static void * Bench_Setup(void)
+{
+#if TIME_UTIL_SW_CYCLE_COUNTER_64
+	Cycle_Counter_64_Init();
+#endif
+	Stopwatch_Init();
+
+	return NULL;
+}
+
+ZTEST_SUITE(time_and_clock_benchmark, NULL, Bench_Setup, NULL, NULL, NULL);
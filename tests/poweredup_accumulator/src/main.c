@@ -0,0 +1,155 @@
+/**
+ * @author Batto1
+ * @brief  Concurrency test of the powered-up time accumulator: TEST_UPDATERS threads, a timer ISR and a work item update it at the same time
+ *         while the test thread reads it.
+ * @note   Checks that readings never go back, that no update is lost (a reading after an update includes the update's own sample) and that the
+ *         final total is base + the largest uptime sample. Runs on native_sim and qemu_x86_64, on two CPUs with the .smp scenario.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "time_and_clock_utils.h"
+
+#define TEST_UPDATERS 		4
+#define TEST_ISR_UPDATER 	TEST_UPDATERS 		/* slot of the timer ISR */
+#define TEST_WORK_UPDATER 	(TEST_UPDATERS + 1) 	/* slot of the work item */
+#define TEST_SLOTS 		(TEST_UPDATERS + 2)
+#define TEST_DURATION_MS 	500
+#define TEST_STACK_SIZE 	(1024 + CONFIG_TEST_EXTRA_STACK_SIZE)
+#define TEST_BASE_TICKS 	((uint64_t)1 << 40) 	/* as if restored from a previous boot */
+
+static PoweredupAccumulator test_acc;
+
+static K_THREAD_STACK_ARRAY_DEFINE(test_stacks, TEST_UPDATERS, TEST_STACK_SIZE);
+static struct k_thread test_threads[TEST_UPDATERS];
+static volatile bool test_stop;
+
+/* Per updater slot, written only by its updater: uptime read right before and right after its latest update, and its number of updates. */
+static uint64_t test_last_before[TEST_SLOTS];
+static uint64_t test_last_after[TEST_SLOTS];
+static uint64_t test_last_read[TEST_SLOTS];
+static uint32_t test_updates[TEST_SLOTS];
+static atomic_t test_errors; /* checks that failed in an updater; zassert can't be used from an ISR */
+
+static void Test_Work_Handler(struct k_work * a_work);
+static void Test_Timer_Expiry(struct k_timer * a_timer);
+
+static K_WORK_DEFINE(test_work, Test_Work_Handler);
+static K_TIMER_DEFINE(test_timer, Test_Timer_Expiry, NULL);
+
+
+/**
+ * @brief Updates the accumulator, then checks the reading: it doesn't go back and it includes the sample of this update.
+ * @note The sample the update takes lies between before and after, so the reading must be at least base + before.
+*/
+static void Update_And_Check(uint32_t a_slot)
+{
+	uint64_t before = (uint64_t)k_uptime_ticks();
+	Poweredup_Accumulator_Update(&test_acc);
+	uint64_t after  = (uint64_t)k_uptime_ticks();
+	uint64_t read   = Poweredup_Accumulator_Get_Ticks(&test_acc);
+
+	if((read < test_last_read[a_slot]) || (read < (TEST_BASE_TICKS + before))){
+		atomic_inc(&test_errors);
+	}
+	test_last_read[a_slot]   = read;
+	test_last_before[a_slot] = before;
+	test_last_after[a_slot]  = after;
+	test_updates[a_slot] ++;
+}
+
+static void Test_Work_Handler(struct k_work * a_work)
+{
+	ARG_UNUSED(a_work);
+
+	Update_And_Check(TEST_WORK_UPDATER);
+}
+
+static void Test_Timer_Expiry(struct k_timer * a_timer)
+{
+	ARG_UNUSED(a_timer);
+
+	Update_And_Check(TEST_ISR_UPDATER);
+	(void)k_work_submit(&test_work);
+}
+
+static void Test_Updater(void * a_slot, void * a_unused_1, void * a_unused_2)
+{
+	uint32_t slot = (uint32_t)(uintptr_t)a_slot;
+
+	ARG_UNUSED(a_unused_1);
+	ARG_UNUSED(a_unused_2);
+
+	while(!test_stop){
+		Update_And_Check(slot);
+		k_busy_wait(slot + 1U); // different periods so that updaters interleave differently; time also advances on native_sim
+		k_yield();
+	}
+}
+
+ZTEST(poweredup_accumulator, test_sample_is_aligned)
+{
+	zassert_equal((uintptr_t)&test_acc.last_uptime_ticks % 8U, 0U, "64 bit atomics need 8 byte alignment");
+}
+
+ZTEST(poweredup_accumulator, test_concurrent_updates)
+{
+	Poweredup_Accumulator_Init(&test_acc, TEST_BASE_TICKS);
+	test_stop = false;
+
+	// updaters and the reader share one preemptive priority and yield to each other; on SMP they also run in parallel.
+	k_thread_priority_set(k_current_get(), K_PRIO_PREEMPT(1));
+	for(uint32_t i = 0; i < TEST_UPDATERS; i++){
+		k_thread_create(&test_threads[i], test_stacks[i], K_THREAD_STACK_SIZEOF(test_stacks[i]), Test_Updater,
+				(void *)(uintptr_t)i, NULL, NULL, K_PRIO_PREEMPT(1), 0, K_NO_WAIT);
+	}
+	k_timer_start(&test_timer, K_USEC(100), K_USEC(100));
+
+	int64_t end = k_uptime_get() + TEST_DURATION_MS;
+	uint64_t last_read = 0;
+	uint32_t reads = 0;
+
+	while(k_uptime_get() < end){
+		uint64_t read = Poweredup_Accumulator_Get_Ticks(&test_acc);
+
+		zassert_true(read >= last_read, "reading went back: %"PRIu64" after %"PRIu64, read, last_read);
+		last_read = read;
+		reads ++;
+		k_busy_wait(5);
+		k_yield();
+	}
+
+	k_timer_stop(&test_timer);
+	test_stop = true;
+	for(uint32_t i = 0; i < TEST_UPDATERS; i++){
+		zassert_ok(k_thread_join(&test_threads[i], K_FOREVER));
+	}
+	struct k_work_sync sync;
+	(void)k_work_cancel_sync(&test_work, &sync);
+
+	zassert_equal(atomic_get(&test_errors), 0, "%ld updates went back or were lost", atomic_get(&test_errors));
+
+	// Final total is base + the largest sample. Each updater samples between its before and after reads, latest ones are the largest.
+	uint64_t max_before = 0;
+	uint64_t max_after  = 0;
+
+	for(uint32_t i = 0; i < TEST_SLOTS; i++){
+		zassert_true(test_updates[i] > 0U, "updater %u never ran", i);
+		max_before = MAX(max_before, test_last_before[i]);
+		max_after  = MAX(max_after, test_last_after[i]);
+	}
+
+	uint64_t total = Poweredup_Accumulator_Get_Ticks(&test_acc);
+	zassert_between_inclusive(total, TEST_BASE_TICKS + max_before, TEST_BASE_TICKS + max_after);
+
+	printk("updates: threads %u %u %u %u, isr %u, work %u; reads %u; total %"PRIu64" ticks, largest sample in [%"PRIu64", %"PRIu64"]\n",
+	       test_updates[0], test_updates[1], test_updates[2], test_updates[3], test_updates[TEST_ISR_UPDATER], test_updates[TEST_WORK_UPDATER],
+	       reads, total - TEST_BASE_TICKS, max_before, max_after);
+}
+
+ZTEST_SUITE(poweredup_accumulator, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,250 @@
+/**
+ * @author Batto1
+ * @brief  Tests of the persistent powered-up time store on the flash simulator: recovery, torn writes, ring wrap, tick rate rescale,
+ *         and a simulated year of operation that reports erase counts per sector and write latencies.
+ * @note   Reboots are simulated by initializing the store again. Uptime doesn't restart then, so it's taken out of the recovered base.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/crc.h>
+
+#include "poweredup_time_store.h"
+
+#define TEST_AREA_ID 			FIXED_PARTITION_ID(storage_partition)
+#define TEST_SAVE_INTERVAL_SECS 	60U
+#define TEST_DAYS 			365U
+#define TEST_OTHER_TICKS_PER_SEC 	32768U
+
+/**
+ * @brief Layout of a journal record, PoweredupRecord in poweredup_time_store.c. Used to write records of another tick rate.
+*/
+typedef struct testRecord{
+	uint32_t 	sequence;
+	uint32_t 	ticks_per_sec;
+	uint64_t 	total_ticks;
+	uint32_t 	reserved;
+	uint32_t 	crc;
+}TestRecord;
+
+static PoweredupStore store;
+
+
+/**
+ * @brief Erases the whole journal area so that every test starts from an empty store.
+*/
+static void Erase_Area(void * a_fixture)
+{
+	const struct flash_area * fa;
+
+	ARG_UNUSED(a_fixture);
+	zassert_ok(flash_area_open(TEST_AREA_ID, &fa));
+	zassert_ok(flash_area_erase(fa, 0, fa->fa_size));
+	flash_area_close(fa);
+}
+
+/**
+ * @brief Initializes the store again like a reboot would, and checks that the latest record is recovered.
+ * @param [in] a_expected_ticks 	powered-up ticks of the latest record written.
+*/
+static void Simulate_Reboot(uint64_t a_expected_ticks)
+{
+	zassert_ok(Poweredup_Store_Init(&store, TEST_AREA_ID, TEST_SAVE_INTERVAL_SECS));
+	zassert_equal(Poweredup_Accumulator_Get_Ticks(&store.acc), a_expected_ticks, "recovered %llu ticks, expected %llu",
+		      Poweredup_Accumulator_Get_Ticks(&store.acc), a_expected_ticks);
+
+	// uptime keeps counting from the real boot, the accumulator would add it once more.
+	store.acc.base_ticks -= (uint64_t)k_uptime_ticks();
+}
+
+/**
+ * @brief Lets the powered-up time change by a tick and writes a record.
+ * @retval powered-up ticks in the written record.
+*/
+static uint64_t Flush_Next(void)
+{
+	k_sleep(K_TICKS(1));
+	zassert_ok(Poweredup_Store_Flush(&store));
+
+	return store.last_saved_ticks;
+}
+
+ZTEST(poweredup_time_store, test_empty_area_starts_from_zero)
+{
+	zassert_ok(Poweredup_Store_Init(&store, TEST_AREA_ID, TEST_SAVE_INTERVAL_SECS));
+	zassert_equal(Poweredup_Accumulator_Get_Ticks(&store.acc), 0);
+	zassert_equal(store.write_offset, 0);
+	zassert_equal(store.slot_size, 32, "24 byte records are padded to 16 byte write blocks");
+	zassert_true(store.sector_count >= 2U);
+}
+
+ZTEST(poweredup_time_store, test_update_writes_at_save_interval)
+{
+	Simulate_Reboot(0);
+
+	k_sleep(K_SECONDS(TEST_SAVE_INTERVAL_SECS - 1U));
+	zassert_ok(Poweredup_Store_Update(&store));
+	zassert_equal(store.write_count, 0, "written before the save interval");
+
+	k_sleep(K_SECONDS(1));
+	zassert_ok(Poweredup_Store_Update(&store));
+	zassert_equal(store.write_count, 1);
+
+	Simulate_Reboot(store.last_saved_ticks);
+}
+
+ZTEST(poweredup_time_store, test_torn_write_is_skipped)
+{
+	const struct flash_area * fa;
+	uint8_t half_slot[16];
+	uint64_t saved;
+
+	Simulate_Reboot(0);
+	for(uint32_t i = 0; i < 10U; i++){
+		saved = Flush_Next();
+	}
+
+	// power lost in the middle of the next record: its first write block is programmed, the rest is erased.
+	uint32_t torn_offset = store.write_offset;
+	memset(half_slot, 0x5a, sizeof(half_slot));
+	zassert_ok(flash_area_open(TEST_AREA_ID, &fa));
+	zassert_ok(flash_area_write(fa, torn_offset, half_slot, sizeof(half_slot)));
+	flash_area_close(fa);
+
+	Simulate_Reboot(saved);
+	zassert_equal(store.write_offset, torn_offset + store.slot_size, "torn slot must not be written again before erase");
+
+	saved = Flush_Next();
+	Simulate_Reboot(saved);
+}
+
+ZTEST(poweredup_time_store, test_ring_wraps)
+{
+	uint32_t slots_per_sector;
+	uint64_t saved = 0;
+
+	Simulate_Reboot(0);
+	slots_per_sector = store.sector_size / store.slot_size;
+
+	// two rounds over every sector, with a reboot in each sector.
+	for(uint32_t i = 0; i < (2U * store.sector_count * slots_per_sector) + 1U; i++){
+		saved = Flush_Next();
+		if((i % slots_per_sector) == (slots_per_sector / 2U)){
+			Simulate_Reboot(saved);
+		}
+	}
+	zassert_equal(store.write_offset, store.slot_size, "first sector holds the last record");
+	Simulate_Reboot(saved);
+}
+
+ZTEST(poweredup_time_store, test_tick_rate_change_is_rescaled)
+{
+	const struct flash_area * fa;
+	uint8_t slot[32];
+	TestRecord record = {
+		.sequence      = 1,
+		.ticks_per_sec = TEST_OTHER_TICKS_PER_SEC,
+		.total_ticks   = ((uint64_t)TEST_OTHER_TICKS_PER_SEC * 3600U) + (TEST_OTHER_TICKS_PER_SEC / 2U), /* 1 h 0.5 s */
+		.reserved      = 0,
+	};
+	record.crc = crc32_ieee((const uint8_t *)&record, offsetof(TestRecord, crc));
+
+	BUILD_ASSERT(sizeof(TestRecord) == 24, "record layout must not have padding");
+	BUILD_ASSERT(TEST_OTHER_TICKS_PER_SEC != CONFIG_SYS_CLOCK_TICKS_PER_SEC, "pick another tick rate");
+
+	// record written by a firmware with another tick rate.
+	memset(slot, 0xff, sizeof(slot));
+	memcpy(slot, &record, sizeof(record));
+	zassert_ok(flash_area_open(TEST_AREA_ID, &fa));
+	zassert_ok(flash_area_write(fa, 0, slot, sizeof(slot)));
+	flash_area_close(fa);
+
+	Simulate_Reboot((record.total_ticks * CONFIG_SYS_CLOCK_TICKS_PER_SEC) / TEST_OTHER_TICKS_PER_SEC);
+
+	// rescaled total is written in the current tick rate from then on.
+	uint64_t saved = Flush_Next();
+	Simulate_Reboot(saved);
+	zassert_equal(store.sequence, 2);
+}
+
+/**
+ * @brief Statistics of the simulated year, over all boots.
+*/
+typedef struct testYearStats{
+	uint32_t 	sector_erases[POWEREDUP_STORE_MAX_SECTORS];
+	uint32_t 	writes;
+	uint32_t 	erases;
+	uint32_t 	plain_writes; 		/* writes without an erase before them */
+	uint64_t 	plain_write_cycles;
+	uint32_t 	max_write_cycles;
+	uint32_t 	max_erase_cycles;
+}TestYearStats;
+
+/**
+ * @brief Runs Poweredup_Store_Update() or Poweredup_Store_Flush() and records what it wrote and erased, and how long it took.
+*/
+static void Year_Step(TestYearStats * a_stats, bool a_flush)
+{
+	uint32_t offset      = store.write_offset;
+	uint32_t write_count = store.write_count;
+	uint32_t erase_count = store.erase_count;
+
+	uint32_t start = k_cycle_get_32();
+	zassert_ok(a_flush ? Poweredup_Store_Flush(&store) : Poweredup_Store_Update(&store));
+	uint32_t cycles = k_cycle_get_32() - start;
+
+	if(store.erase_count != erase_count){
+		a_stats->sector_erases[offset / store.sector_size]++;
+		a_stats->erases++;
+		a_stats->max_erase_cycles = MAX(a_stats->max_erase_cycles, store.max_erase_cycles);
+	}else if(store.write_count != write_count){
+		a_stats->plain_writes++;
+		a_stats->plain_write_cycles += cycles;
+	}
+	a_stats->writes += store.write_count - write_count;
+	a_stats->max_write_cycles = MAX(a_stats->max_write_cycles, store.max_write_cycles);
+}
+
+/**
+ * @brief One year of Poweredup_Store_Update() once a minute with a reboot every day. Reports erase counts and write latencies.
+ * @note Latencies are of the flash simulator's timing model (CONFIG_FLASH_SIMULATOR_SIMULATE_TIMING), not of real flash.
+ *       Mean write latency is of the whole Poweredup_Store_Update() call, the maximums are of the flash operations alone.
+*/
+ZTEST(poweredup_time_store, test_simulated_year)
+{
+	static TestYearStats stats;
+
+	Simulate_Reboot(0);
+
+	for(uint32_t day = 0; day < TEST_DAYS; day++){
+		for(uint32_t minute = 0; minute < (24U * 60U); minute++){
+			k_sleep(K_SECONDS(TEST_SAVE_INTERVAL_SECS));
+			Year_Step(&stats, false);
+		}
+		Year_Step(&stats, true);
+		Simulate_Reboot(store.last_saved_ticks);
+	}
+
+	uint32_t min_sector_erases = UINT32_MAX;
+	uint32_t max_sector_erases = 0;
+	for(uint32_t s = 0; s < store.sector_count; s++){
+		min_sector_erases = MIN(min_sector_erases, stats.sector_erases[s]);
+		max_sector_erases = MAX(max_sector_erases, stats.sector_erases[s]);
+	}
+
+	TC_PRINT("simulated year: %u writes, %u erases, %u..%u erases per sector of %u\n", stats.writes, stats.erases,
+		 min_sector_erases, max_sector_erases, store.sector_count);
+	TC_PRINT("write latency: mean %u us, max %u us; erase latency max %u us\n",
+		 k_cyc_to_us_floor32((uint32_t)(stats.plain_write_cycles / MAX(stats.plain_writes, 1U))),
+		 k_cyc_to_us_floor32(stats.max_write_cycles), k_cyc_to_us_floor32(stats.max_erase_cycles));
+
+	zassert_true(stats.writes >= TEST_DAYS * 24U * 60U, "a record must be written every save interval");
+	zassert_true(max_sector_erases - min_sector_erases <= 1U, "sectors aren't erased evenly");
+}
+
+ZTEST_SUITE(poweredup_time_store, NULL, NULL, Erase_Area, NULL, NULL);
@@ -0,0 +1,94 @@
+/**
+ * @author Batto1
+ * @brief  Wakeups and CPU idle residency of a clock incremented by a 1 ms k_timer with Increment_a_Millisecond_And_Update_Clock() against the
+ *         software clock, while the test thread sleeps for TEST_DURATION_MS with nothing else to do. Results are printed as JSON lines like
+ *         tests/benchmark, so they can be compared between commits.
+ * @note   Wakeups are the timer expiries in the window; the software clock has no timer. Idle residency is the share of the idle cycles of
+ *         k_thread_runtime_stats_all_get() in the window. native_sim runs code in zero simulated time, so there both residencies are about 100%
+ *         and the wakeups show the difference; take residency figures from qemu_x86_64 or hardware.
+*/
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "time_and_clock_utils.h"
+#include "software_clock.h"
+
+#define TEST_DURATION_MS 	1000
+
+static TimeElapsedClock test_increment_clock;
+static atomic_t test_expiries;
+
+static void Test_Increment_Expiry(struct k_timer * a_timer)
+{
+	ARG_UNUSED(a_timer);
+
+	Increment_a_Millisecond_And_Update_Clock(&test_increment_clock);
+	atomic_inc(&test_expiries);
+}
+
+static K_TIMER_DEFINE(test_increment_timer, Test_Increment_Expiry, NULL);
+
+
+/**
+ * @brief Share of idle cycles between two readings of the whole system's runtime stats, in permille.
+*/
+static uint32_t Idle_Permille(const k_thread_runtime_stats_t * a_before, const k_thread_runtime_stats_t * a_after)
+{
+	uint64_t total = a_after->execution_cycles - a_before->execution_cycles;
+	uint64_t idle  = a_after->idle_cycles - a_before->idle_cycles;
+
+	return (total == 0U) ? 0U : (uint32_t)((idle * 1000U) / total);
+}
+
+static void Print_Result(const char * a_name, uint32_t a_wakeups, uint32_t a_idle_permille, TimeDuration a_clock_value)
+{
+	printk("{\"type\":\"power\",\"name\":\"%s\",\"duration_ms\":%d,\"wakeups\":%"PRIu32",\"idle_permille\":%"PRIu32",\"clock_us\":%"PRId64"}\n",
+	       a_name, TEST_DURATION_MS, a_wakeups, a_idle_permille, a_clock_value);
+}
+
+ZTEST(software_clock_power, test_increment_timer_against_software_clock)
+{
+	k_thread_runtime_stats_t before;
+	k_thread_runtime_stats_t after;
+
+	// 1 ms timer incrementing a clock
+	memset(&test_increment_clock, 0, sizeof(test_increment_clock));
+	(void)atomic_clear(&test_expiries);
+	zassert_ok(k_thread_runtime_stats_all_get(&before));
+	k_timer_start(&test_increment_timer, K_MSEC(1), K_MSEC(1));
+	k_msleep(TEST_DURATION_MS);
+	k_timer_stop(&test_increment_timer);
+	zassert_ok(k_thread_runtime_stats_all_get(&after));
+
+	uint32_t increment_wakeups = (uint32_t)atomic_get(&test_expiries);
+	uint32_t increment_idle    = Idle_Permille(&before, &after);
+	TimeDuration increment_value = Clock_To_Duration(&test_increment_clock);
+
+	// software clock, nothing runs until it's read
+	SoftwareClock clock;
+
+	zassert_ok(k_thread_runtime_stats_all_get(&before));
+	Software_Clock_Init(&clock, NULL, SOFTWARE_CLOCK_RESOLUTION_MSEC, true);
+	k_msleep(TEST_DURATION_MS);
+	TimeDuration software_value = Software_Clock_Get_Duration(&clock);
+	zassert_ok(k_thread_runtime_stats_all_get(&after));
+
+	uint32_t software_idle = Idle_Permille(&before, &after);
+
+	Print_Result("increment timer", increment_wakeups, increment_idle, increment_value);
+	Print_Result("software clock", 0U, software_idle, software_value);
+
+	// a 1 ms timer wakes up the CPU about once per millisecond (less if a millisecond isn't whole ticks); the software clock never does and
+	// still keeps the same time.
+	zassert_true(increment_wakeups >= (TEST_DURATION_MS / 2), "timer expired only %u times", increment_wakeups);
+	zassert_within(software_value, (TimeDuration)TEST_DURATION_MS * TIME_DURATION_USEC_PER_MSEC, 2 * TIME_DURATION_USEC_PER_MSEC,
+		       "software clock reads %"PRId64" us after %d ms", software_value, TEST_DURATION_MS);
+	zassert_true(software_idle >= increment_idle, "software clock idles %u permille, increment timer %u permille", software_idle, increment_idle);
+}
+
+ZTEST_SUITE(software_clock_power, NULL, NULL, NULL, NULL, NULL);
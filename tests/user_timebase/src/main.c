@@ -0,0 +1,109 @@
+/**
+ * @author Batto1
+ * @brief  Tests of the user mode timebase from a user thread, and its cost against the system call path (k_uptime_ticks(), Get_Uptime_*).
+ * @note   HW cycle counters can't be read from user mode on these boards, so every routine is called BENCH_CALLS times in a loop and the loop is timed
+ *         with k_uptime_ticks(). Results are printed as JSON lines: {"type":"loop","name":"User_Timebase_Get_Ticks","n":100000,"ns_per_call":40}
+*/
+
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "time_and_clock_utils.h"
+#include "user_timebase.h"
+
+#define BENCH_CALLS 	100000U
+
+/**
+ * @brief Calls a statement BENCH_CALLS times and prints the mean time per call. Loop overhead is included, it's the same for every statement.
+*/
+#define BENCH_LOOP(a_name, a_statement) 								\
+	do{ 												\
+		int64_t start = k_uptime_ticks(); 							\
+		for(uint32_t call = 0; call < BENCH_CALLS; call++){ 					\
+			a_statement; 									\
+		} 											\
+		Bench_Print(a_name, k_uptime_ticks() - start); 						\
+	}while(0)
+
+/* user threads can access only the test partition */
+ZTEST_BMEM static volatile int64_t bench_sink_i64;
+ZTEST_BMEM static volatile uint64_t bench_sink_u64;
+ZTEST_BMEM static TimeElapsedClock bench_sink_clock;
+ZTEST_BMEM static UserTimebaseSnapshot bench_snapshot;
+
+
+static void Bench_Print(const char * a_name, int64_t a_ticks)
+{
+	uint64_t ns = k_ticks_to_ns_floor64((uint64_t)a_ticks);
+
+	printk("{\"type\":\"loop\",\"name\":\"%s\",\"n\":%u,\"ns_per_call\":%u}\n", a_name, BENCH_CALLS, (uint32_t)(ns / BENCH_CALLS));
+}
+
+ZTEST_USER(user_timebase, test_runs_in_user_mode)
+{
+	zassert_true(k_is_user_context(), "userspace isn't enabled, the system call path isn't measured");
+}
+
+ZTEST_USER(user_timebase, test_snapshot_is_consistent)
+{
+	User_Timebase_Snapshot(&bench_snapshot);
+
+	zassert_equal(bench_snapshot.ticks_per_sec, CONFIG_SYS_CLOCK_TICKS_PER_SEC);
+	zassert_true(bench_snapshot.cycles_per_sec != 0U);
+	zassert_true(bench_snapshot.ticks <= (uint64_t)k_uptime_ticks());
+}
+
+/**
+ * @brief Readings never go back and lag the kernel's uptime by at most one publish period.
+*/
+ZTEST_USER(user_timebase, test_monotonic_and_bounded)
+{
+	const int64_t max_lag = (int64_t)k_ms_to_ticks_ceil64(USER_TIMEBASE_PUBLISH_PERIOD_MS) + 1;
+	int64_t prev_ticks = 0;
+	uint64_t prev_us = 0;
+
+	for(uint32_t i = 0; i < 20000U; i++){
+		int64_t kernel_ticks = k_uptime_ticks();
+		int64_t ticks        = User_Timebase_Get_Ticks();
+		uint64_t us          = User_Timebase_Get_Micro_Sec();
+
+		zassert_true(ticks >= prev_ticks, "ticks went back: %lld after %lld", ticks, prev_ticks);
+		zassert_true(us >= prev_us, "micro seconds went back");
+		zassert_true(ticks <= k_uptime_ticks(), "ahead of the kernel");
+		zassert_true(kernel_ticks - ticks <= max_lag, "lags the kernel by %lld ticks", kernel_ticks - ticks);
+		prev_ticks = ticks;
+		prev_us    = us;
+	}
+}
+
+ZTEST_USER(user_timebase, test_page_is_read_only)
+{
+	ztest_set_fault_valid(true);
+	user_timebase_page.reserved = 1U;
+
+	ztest_test_fail();
+}
+
+ZTEST_USER(user_timebase, test_benchmark_against_syscalls)
+{
+	BENCH_LOOP("k_uptime_ticks", bench_sink_i64 = k_uptime_ticks());
+	BENCH_LOOP("Get_Uptime_Ticks", bench_sink_i64 = Get_Uptime_Ticks());
+	BENCH_LOOP("Get_Uptime_Ticks_As_Clock_Time", bench_sink_clock = Get_Uptime_Ticks_As_Clock_Time());
+
+	BENCH_LOOP("User_Timebase_Snapshot", User_Timebase_Snapshot(&bench_snapshot));
+	BENCH_LOOP("User_Timebase_Get_Ticks", bench_sink_i64 = User_Timebase_Get_Ticks());
+	BENCH_LOOP("User_Timebase_Get_Micro_Sec", bench_sink_u64 = User_Timebase_Get_Micro_Sec());
+	BENCH_LOOP("User_Timebase_Get_Clock_Time", bench_sink_clock = User_Timebase_Get_Clock_Time());
+}
+
+static void * User_Timebase_Setup(void)
+{
+	User_Timebase_Init();
+	zassert_ok(k_mem_domain_add_partition(&k_mem_domain_default, &user_timebase_partition));
+
+	return NULL;
+}
+
+ZTEST_SUITE(user_timebase, NULL, User_Timebase_Setup, NULL, NULL, NULL);